@@ -33,6 +33,7 @@
 #  include "frame.h"
 #  include "js_manager.h"
 #  include "manifest.h"
+#  include "pipeline_metrics.h"
 #  include "player.h"
 #  include "player_externs.h"
 #  include "stats.h"
@@ -15,7 +15,10 @@
 #ifndef SHAKA_EMBEDDED_EME_IMPLEMENTATION_HELPER_H_
 #define SHAKA_EMBEDDED_EME_IMPLEMENTATION_HELPER_H_
 
+#include <stdint.h>
+
 #include <string>
+#include <vector>
 
 #include "../macros.h"
 #include "configuration.h"
@@ -69,6 +72,14 @@ class SHAKA_EXPORT ImplementationHelper {
    */
   virtual void OnKeyStatusChange(const std::string& session_id) const = 0;
 
+  /**
+   * Gets the key the app gave to JsManager::SetEmeStorageKey, or an empty
+   * vector if it didn't give one.  If given, implementations should use this to
+   * encrypt the data they store in DataPathPrefix() instead of a key they
+   * generate and store next to the data.
+   */
+  virtual std::vector<uint8_t> StorageKey() const = 0;
+
  protected:
   virtual ~ImplementationHelper();
 };
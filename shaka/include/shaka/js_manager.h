@@ -15,8 +15,11 @@
 #ifndef SHAKA_EMBEDDED_JS_MANAGER_H_
 #define SHAKA_EMBEDDED_JS_MANAGER_H_
 
+#include <stdint.h>
+
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "async_results.h"
 #include "macros.h"
@@ -42,9 +45,15 @@ class JsManagerImpl;
  */
 
 /**
- * Manages the JavaScript engine.  There must be exactly one instance per
- * program.  This manages a single V8 instance, but can support any number
- * of Player or Video instances.
+ * Manages the JavaScript engine.  This manages a single V8 instance, but can
+ * support any number of Player or Video instances.
+ *
+ * There can be several instances per program.  Each instance has its own
+ * JavaScript engine and event thread, so its players are isolated from the
+ * players of other instances.  Instances share the JavaScript platform, the
+ * network thread, and (when using V8) the compiled code cached in
+ * |dynamic_data_dir|.  Player and Video objects must only be used with the
+ * instance they were created with.
  *
  * @ingroup player
  */
@@ -60,6 +69,9 @@ class SHAKA_EXPORT JsManager final {
      * have complete control over this directory (i.e. other programs won't
      * create/modify files here).
      *
+     * When using V8, compiled code for the scripts we run is cached here so
+     * later runs don't need to compile them again.
+     *
      * If the path is relative, then it is relative to the working directory.
      */
     std::string dynamic_data_dir;
@@ -110,7 +122,38 @@ class SHAKA_EXPORT JsManager final {
    */
   AsyncResults<void> RunScript(const std::string& path);
 
+  /**
+   * Sets the key used to encrypt persistent EME data, like the keys of
+   * persistent ClearKey sessions.  This should be a 16-byte key kept in the
+   * platform's secure storage (e.g. the iOS Keychain).  If this isn't set, a
+   * key is generated and stored in |dynamic_data_dir| next to the data, which
+   * only keeps the data from being read directly out of the files.
+   *
+   * This should be called before creating any Player instances; data stored
+   * with one key can't be loaded with another.
+   *
+   * @return False if the key isn't 16 bytes.
+   */
+  bool SetEmeStorageKey(const std::vector<uint8_t>& key);
+
+  /**
+   * Starts or stops recording trace events.  Recording is off by default.
+   * While on, the library records timing spans (e.g. tasks, decoding, and
+   * rendering) from every thread into fixed-size buffers; once a thread's
+   * buffer is full, its oldest events are dropped.
+   */
+  void SetTracingEnabled(bool enabled);
+
+  /**
+   * Gets the recorded trace events as Chrome trace-event JSON, which can be
+   * loaded in about:tracing.  This can be called while recording.
+   *
+   * @param clear If true, the returned events are removed from the buffers.
+   */
+  std::string ExportTrace(bool clear = false);
+
  private:
+  friend class JsManagerImpl;
   std::unique_ptr<JsManagerImpl> impl_;
 };
 
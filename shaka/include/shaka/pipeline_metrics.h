@@ -0,0 +1,118 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SHAKA_EMBEDDED_PIPELINE_METRICS_H_
+#define SHAKA_EMBEDDED_PIPELINE_METRICS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "macros.h"
+
+namespace shaka {
+
+/**
+ * A histogram of latencies.  Samples are grouped in power-of-two buckets, so
+ * percentiles are accurate to within a factor of two.  Bucket 0 holds samples
+ * under 1 microsecond and bucket @a i holds samples in
+ * [2<sup>i-1</sup>, 2<sup>i</sup>) microseconds; the last bucket also holds
+ * any larger samples.
+ *
+ * @ingroup player
+ */
+struct SHAKA_EXPORT LatencyHistogram final {
+  static constexpr const size_t kBucketCount = 24;
+
+  LatencyHistogram();
+
+  /** The number of samples recorded. */
+  uint64_t count;
+  /** The sum of every sample, in microseconds. */
+  uint64_t total_us;
+  /** The largest sample, in microseconds. */
+  uint64_t max_us;
+  /** The number of samples in each bucket. */
+  uint64_t buckets[kBucketCount];
+
+  /** @return The mean of the samples, in milliseconds. */
+  double MeanMs() const;
+
+  /**
+   * @param percentile The percentile to get, from 0 to 100.
+   * @return An upper bound of the given percentile, in milliseconds.
+   */
+  double PercentileMs(double percentile) const;
+};
+
+/**
+ * Metrics for one stream (audio or video) of the media pipeline.
+ *
+ * @ingroup player
+ */
+struct SHAKA_EXPORT StreamPipelineMetrics final {
+  StreamPipelineMetrics();
+
+  /** The time from an appendBuffer() call until all its frames are demuxed. */
+  LatencyHistogram append_to_demux;
+  /** The time spent demuxing each frame. */
+  LatencyHistogram demux;
+  /** The time spent decoding each frame, including decryption. */
+  LatencyHistogram decode;
+  /** The time spent decrypting each encrypted frame. */
+  LatencyHistogram decrypt;
+
+  /** The number of seconds of demuxed media ahead of the playhead. */
+  double demuxed_buffer_seconds;
+  /** An estimate of the memory used by the demuxed frames. */
+  uint64_t demuxed_buffer_bytes;
+  /** The number of seconds of decoded media ahead of the playhead. */
+  double decoded_buffer_seconds;
+  /** An estimate of the memory used by the decoded frames. */
+  uint64_t decoded_buffer_bytes;
+
+  /**
+   * The number of times the decoder started from a key frame: when playback
+   * starts, after each seek, and when skipping ahead to catch up with the
+   * playhead.
+   */
+  uint64_t decoder_restarts;
+};
+
+/**
+ * A snapshot of the metrics of the media pipeline.  The counters are kept for
+ * the life of the current media source, so to get rates, poll these and
+ * compare with the previous snapshot.
+ *
+ * @ingroup player
+ */
+struct SHAKA_EXPORT PipelineMetrics final {
+  PipelineMetrics();
+
+  StreamPipelineMetrics audio;
+  StreamPipelineMetrics video;
+
+  /** How long after its start time each video frame was first drawn. */
+  LatencyHistogram render_lateness;
+  /** The number of times the audio device ran out of decoded audio. */
+  uint64_t audio_underruns;
+
+  /** The total number of bytes downloaded by network requests. */
+  uint64_t network_bytes_received;
+  /** The number of network requests currently in progress. */
+  uint64_t network_requests_in_flight;
+};
+
+}  // namespace shaka
+
+#endif  // SHAKA_EMBEDDED_PIPELINE_METRICS_H_
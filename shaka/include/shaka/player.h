@@ -16,7 +16,9 @@
 #define SHAKA_EMBEDDED_PLAYER_H_
 
 #include <math.h>
+#include <stddef.h>
 
+#include <functional>
 #include <memory>
 #include <string>
 #include <type_traits>
@@ -42,6 +44,72 @@ struct DefaultValueType final {};
  */
 extern SHAKA_EXPORT const DefaultValueType DefaultValue;
 
+/**
+ * A copy of the current state of a Player and its video.  The Player keeps this
+ * up to date as events happen, so this can be read from any thread without
+ * calling into JavaScript or taking locks; see Player::GetStateSnapshot().
+ *
+ * The values that don't have events (e.g. the buffered ranges and the stats)
+ * are refreshed a few times a second, so they may be slightly out of date.
+ *
+ * @ingroup player
+ */
+struct SHAKA_EXPORT PlayerStateSnapshot final {
+  /** The maximum number of buffered ranges that are stored. */
+  static constexpr const size_t kMaxBufferedRanges = 8;
+
+  struct Range {
+    double start;
+    double end;
+  };
+
+  /** Whether the Player is in a buffering state. */
+  bool is_buffering = false;
+  /** Whether the stream is live. */
+  bool is_live = false;
+  /** Whether the video is paused. */
+  bool paused = true;
+  /** Whether the video is seeking. */
+  bool seeking = false;
+  /** Whether the video has ended. */
+  bool ended = false;
+
+  /** The current time of the video, in seconds. */
+  double current_time = 0;
+  /** The duration of the video, in seconds; NaN if not known. */
+  double duration = NAN;
+  /** The playback rate of the video. */
+  double playback_rate = 1;
+
+  /** The number of entries in |buffered_ranges|. */
+  size_t buffered_range_count = 0;
+  /**
+   * The buffered ranges of the video.  If there are more than
+   * kMaxBufferedRanges, the last range covers the rest.
+   */
+  Range buffered_ranges[kMaxBufferedRanges];
+
+  /** The ID of the active variant track, or NaN if there isn't one. */
+  double variant_id = NAN;
+  /** The bandwidth of the active variant track, in bit/sec. */
+  double variant_bandwidth = NAN;
+  /** The width of the active variant track, or NaN if not known. */
+  double variant_width = NAN;
+  /** The height of the active variant track, or NaN if not known. */
+  double variant_height = NAN;
+
+  /** @name Stats */
+  //@{
+  /** These are the same as the values in Stats. */
+  double estimated_bandwidth = NAN;
+  double stream_bandwidth = NAN;
+  double decoded_frames = NAN;
+  double dropped_frames = NAN;
+  double play_time = NAN;
+  double buffering_time = NAN;
+  //@}
+};
+
 /**
  * Represents a JavaScript shaka.Player instance.  This handles loading
  * manifests and changing tracks.
@@ -77,6 +145,45 @@ class SHAKA_EXPORT Player final {
     virtual void OnBuffering(bool is_buffering);
   };
 
+  /**
+   * Holds several values about the current playback, so they can be gathered
+   * together with a single call to GetPlaybackStatus().
+   */
+  struct SHAKA_EXPORT PlaybackStatus final {
+    PlaybackStatus();
+    PlaybackStatus(const PlaybackStatus&);
+    PlaybackStatus(PlaybackStatus&&);
+    ~PlaybackStatus();
+
+    PlaybackStatus& operator=(const PlaybackStatus&);
+    PlaybackStatus& operator=(PlaybackStatus&&);
+
+    /** Whether the stream is currently audio-only. */
+    bool is_audio_only;
+    /** Whether the Player is in a buffering state. */
+    bool is_buffering;
+    /** Whether the stream is live. */
+    bool is_live;
+    /** The current buffered ranges. */
+    BufferedInfo buffered_info;
+    /** The currently seekable range. */
+    BufferedRange seek_range;
+    /** The playback and adaptation stats. */
+    Stats stats;
+  };
+
+  /**
+   * A function that runs the given task.  This is given to the non-blocking
+   * methods to choose which thread their callbacks are invoked on; for
+   * example, this can post the task to the message loop of the UI thread.
+   */
+  using Executor = std::function<void(std::function<void()>)>;
+
+  /** The callback given the results of a non-blocking method. */
+  template <typename T>
+  using ResultsCallback =
+      std::function<void(const typename AsyncResults<T>::variant_type&)>;
+
   /**
    * Creates a new Player instance.
    * @param engine The JavaScript engine to use.
@@ -224,6 +331,66 @@ class SHAKA_EXPORT Player final {
   /** @return A future to the currently seekable range. */
   AsyncResults<BufferedRange> SeekRange() const;
 
+  /**
+   * Gathers the values in PlaybackStatus.  This only posts one task to the
+   * JavaScript main thread, so it is cheaper than calling each of the
+   * getters when polling for the status of playback.
+   *
+   * @return A future to the current playback status.
+   */
+  AsyncResults<PlaybackStatus> GetPlaybackStatus() const;
+
+  /**
+   * Gets a copy of the current state of the Player and its video.  This
+   * doesn't call into JavaScript or block, so it can be called often (e.g.
+   * every frame) from any thread.
+   */
+  PlayerStateSnapshot GetStateSnapshot() const;
+
+
+  //@{
+  /**
+   * Non-blocking versions of the getters above.  These return immediately and
+   * |callback| is invoked with the results (or the error) once they are
+   * available.  Unlike the AsyncResults versions, these don't block and can
+   * be called from any thread, including from other callbacks.
+   *
+   * If |executor| is given, the callback is passed to it to be run.
+   * Otherwise the callback is invoked on the JavaScript main thread, so it
+   * must not block or wait for the results of other Player methods.
+   */
+  void IsAudioOnly(ResultsCallback<bool> callback,
+                   Executor executor = nullptr) const;
+  void IsBuffering(ResultsCallback<bool> callback,
+                   Executor executor = nullptr) const;
+  void IsInProgress(ResultsCallback<bool> callback,
+                    Executor executor = nullptr) const;
+  void IsLive(ResultsCallback<bool> callback,
+              Executor executor = nullptr) const;
+  void IsTextTrackVisible(ResultsCallback<bool> callback,
+                          Executor executor = nullptr) const;
+  void UsingEmbeddedTextTrack(ResultsCallback<bool> callback,
+                              Executor executor = nullptr) const;
+  void AssetUri(ResultsCallback<optional<std::string>> callback,
+                Executor executor = nullptr) const;
+  void GetBufferedInfo(ResultsCallback<BufferedInfo> callback,
+                       Executor executor = nullptr) const;
+  void GetExpiration(ResultsCallback<double> callback,
+                     Executor executor = nullptr) const;
+  void GetStats(ResultsCallback<Stats> callback,
+                Executor executor = nullptr) const;
+  void GetTextTracks(ResultsCallback<std::vector<Track>> callback,
+                     Executor executor = nullptr) const;
+  void GetVariantTracks(ResultsCallback<std::vector<Track>> callback,
+                        Executor executor = nullptr) const;
+  void KeySystem(ResultsCallback<std::string> callback,
+                 Executor executor = nullptr) const;
+  void SeekRange(ResultsCallback<BufferedRange> callback,
+                 Executor executor = nullptr) const;
+  void GetPlaybackStatus(ResultsCallback<PlaybackStatus> callback,
+                         Executor executor = nullptr) const;
+  //@}
+
 
   /**
    * Loads the given manifest.  Returns a future that will resolve when the
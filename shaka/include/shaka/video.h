@@ -22,6 +22,7 @@
 #include "frame.h"
 #include "js_manager.h"
 #include "macros.h"
+#include "pipeline_metrics.h"
 #include "shaka_config.h"
 #include "text_track.h"
 
@@ -134,6 +135,15 @@ class SHAKA_EXPORT Video final {
   /** Plays the video. */
   void Play();
 
+  /**
+   * Gets a snapshot of the metrics of the media pipeline, such as how long
+   * demuxing and decoding take and how much is buffered.  The pipeline updates
+   * these counters without locking, so this is cheap enough to poll
+   * periodically (e.g. once a second) in production.  This can be called from
+   * any thread.
+   */
+  PipelineMetrics GetPipelineMetrics() const;
+
  private:
   friend class Player;
   js::mse::HTMLVideoElement* GetJavaScriptObject();
@@ -46,6 +46,7 @@
 #include "src/js/events/event_target.h"
 #include "src/js/events/media_encrypted_event.h"
 #include "src/js/events/media_key_message_event.h"
+#include "src/js/events/message_event.h"
 #include "src/js/events/progress_event.h"
 #include "src/js/location.h"
 #include "src/js/mse/media_error.h"
@@ -59,6 +60,7 @@
 #include "src/js/timeouts.h"
 #include "src/js/url.h"
 #include "src/js/vtt_cue.h"
+#include "src/js/worker.h"
 #include "src/js/xml_http_request.h"
 
 namespace shaka {
@@ -102,12 +104,15 @@ struct Environment::Impl {
   js::NavigatorFactory navigator;
   js::URLFactory url;
   js::VTTCueFactory vtt_cue;
+  js::WorkerFactory worker;
+  js::WorkerGlobalScopeFactory worker_global_scope;
   js::XMLHttpRequestFactory xml_http_request;
 
   js::events::EventFactory event;
   js::events::ProgressEventFactory progress_event;
   js::events::MediaEncryptedEventFactory media_encrypted_event;
   js::events::MediaKeyMessageEventFactory media_key_message_event;
+  js::events::MessageEventFactory message_event;
 
   js::dom::NodeFactory node;
   js::dom::AttrFactory attr;
@@ -167,12 +172,39 @@ void Environment::Install() {
   js::Base64::Install();
   js::Timeouts::Install();
 
+#ifdef V8_PLAYER_SNAPSHOT
+  // The library was evaluated when creating the V8 startup snapshot, so it
+  // already exists on the global.
+  LocalVar<JsValue> shaka = GetMemberRaw(engine->global_handle(), "shaka");
+  if (IsObject(shaka))
+    return;
+  LOG(ERROR) << "Shaka Player is missing from the V8 startup snapshot; "
+                "loading it from shaka-player.compiled.js instead.";
+#endif
+
   // Run the script directly since we are initializing, so this is
   // effectively the event thread.
   JsManagerImpl* manager = JsManagerImpl::Instance();
   CHECK(RunScript(manager->GetPathForStaticFile("shaka-player.compiled.js")));
 }
 
+void Environment::InstallWorker() {
+  impl_.reset(new Impl);
+
+#if !defined(NDEBUG) && defined(USING_JSC)
+  RegisterGlobalFunction("gc", &GC);
+#endif
+
+  CreateInstance("console", &impl_->console);
+  CreateInstance("location", &impl_->location);
+  CreateInstance("navigator", &impl_->navigator);
+
+  js::Base64::Install();
+  js::Timeouts::Install();
+
+  js::WorkerGlobalScope::Install();
+}
+
 
 #define ADD_GET_FACTORY(type, member)                             \
   BackingObjectFactoryBase* type::factory() const {               \
@@ -187,6 +219,8 @@ ADD_GET_FACTORY(js::TestType, test_type);
 ADD_GET_FACTORY(js::Navigator, navigator);
 ADD_GET_FACTORY(js::URL, url);
 ADD_GET_FACTORY(js::VTTCue, vtt_cue);
+ADD_GET_FACTORY(js::Worker, worker);
+ADD_GET_FACTORY(js::WorkerGlobalScope, worker_global_scope);
 ADD_GET_FACTORY(js::XMLHttpRequest, xml_http_request);
 
 ADD_GET_FACTORY(js::mse::MediaError, media_error);
@@ -201,6 +235,7 @@ ADD_GET_FACTORY(js::events::Event, event);
 ADD_GET_FACTORY(js::events::ProgressEvent, progress_event);
 ADD_GET_FACTORY(js::events::MediaEncryptedEvent, media_encrypted_event);
 ADD_GET_FACTORY(js::events::MediaKeyMessageEvent, media_key_message_event);
+ADD_GET_FACTORY(js::events::MessageEvent, message_event);
 
 ADD_GET_FACTORY(js::dom::Attr, attr);
 ADD_GET_FACTORY(js::dom::CharacterData, character_data);
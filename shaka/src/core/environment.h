@@ -33,6 +33,13 @@ class Environment {
   /** Populates the global environment into the current V8 isolate. */
   void Install();
 
+  /**
+   * Populates the global environment of a dedicated Web Worker into the
+   * current engine, then runs the worker's script.  This only installs the
+   * globals that make sense without a document (e.g. no "window").
+   */
+  void InstallWorker();
+
  private:
   struct Impl;
   std::unique_ptr<Impl> impl_;
@@ -14,6 +14,12 @@
 
 #include "src/core/js_manager_impl.h"
 
+#include <glog/logging.h>
+
+#include <utility>
+
+#include "src/debug/async_log.h"
+#include "src/debug/lock_profiler.h"
 #include "src/mapping/convert_js.h"
 #include "src/mapping/js_engine.h"
 #include "src/util/file_system.h"
@@ -22,13 +28,34 @@ namespace shaka {
 
 using std::placeholders::_1;
 
+JsManagerImpl::ThreadScope::ThreadScope(JsManagerImpl* manager)
+    : manager_(manager), tracker_(manager ? &manager->tracker_ : nullptr) {}
+
+JsManagerImpl::ThreadScope::~ThreadScope() {}
+
+
 JsManagerImpl::JsManagerImpl(const JsManager::StartupOptions& options)
     : startup_options_(options),
+      network_thread_(NetworkThread::GetShared()),
       event_loop_(std::bind(&JsManagerImpl::EventThreadWrapper, this, _1),
-                  /* is_worker */ false) {}
+                  /* is_worker */ false) {
+  // Keep glog from writing to stderr on the threads that log.
+  AsyncLog::InstallGlogSink();
+}
+
+JsManagerImpl::JsManagerImpl(const JsManager::StartupOptions& options,
+                             std::shared_ptr<js::WorkerConnection> worker)
+    : startup_options_(options),
+      worker_(std::move(worker)),
+      network_thread_(NetworkThread::GetShared()),
+      event_loop_(std::bind(&JsManagerImpl::EventThreadWrapper, this, _1),
+                  "JS Web Worker", /* is_worker */ false) {}
 
 JsManagerImpl::~JsManagerImpl() {
   Stop();
+#ifdef PROFILE_LOCK_CONTENTION
+  LOG(INFO) << LockProfiler::FormatReport();
+#endif
 }
 
 void JsManagerImpl::Trace(memory::HeapTracer* tracer) const {
@@ -47,6 +74,46 @@ std::string JsManagerImpl::GetPathForDynamicFile(
       startup_options_.dynamic_data_dir, file);
 }
 
+bool JsManagerImpl::SetEmeStorageKey(const std::vector<uint8_t>& key) {
+  // This is used as an AES-128 key.
+  if (key.size() != 16) {
+    LOG(ERROR) << "EME storage key must be 16 bytes";
+    return false;
+  }
+  std::unique_lock<Mutex> lock(eme_storage_key_mutex_);
+  eme_storage_key_ = key;
+  return true;
+}
+
+std::vector<uint8_t> JsManagerImpl::GetEmeStorageKey() const {
+  std::unique_lock<Mutex> lock(eme_storage_key_mutex_);
+  return eme_storage_key_;
+}
+
+TaskRunner* JsManagerImpl::BackgroundThread() {
+  DCHECK(event_loop_.BelongsToCurrentThread());
+  if (!background_thread_) {
+    background_thread_.reset(new TaskRunner(
+        [](TaskRunner::RunLoop run_loop) { run_loop(); }, "JS Background",
+        /* is_worker */ true));
+  }
+  return background_thread_.get();
+}
+
+void JsManagerImpl::Terminate() {
+  event_loop_.Stop([this]() {
+    std::unique_lock<Mutex> lock(engine_mutex_);
+    // If the engine hasn't been created yet, it is interrupted once it is.
+    terminated_ = true;
+    if (engine_)
+      engine_->TerminateExecution();
+  });
+}
+
+size_t JsManagerImpl::network_requests_in_flight() const {
+  return network_thread_->RequestsInFlight(this);
+}
+
 void JsManagerImpl::WaitUntilFinished() {
   if (event_loop_.is_running() && event_loop_.HasPendingWork()) {
     event_loop_.WaitUntilFinished();
@@ -76,7 +143,17 @@ std::shared_ptr<ThreadEvent<bool>> JsManagerImpl::RunScript(
 }
 
 void JsManagerImpl::EventThreadWrapper(TaskRunner::RunLoop run_loop) {
+  // Bind this manager for everything that runs on the event thread.  The
+  // engine and the factories bind themselves when they are created.
+  ThreadScope scope(this);
   JsEngine engine;
+  {
+    std::unique_lock<Mutex> lock(engine_mutex_);
+    engine_ = &engine;
+    // Terminate() may have been called while the engine was being created.
+    if (terminated_)
+      engine.TerminateExecution();
+  }
 
   {
     JsEngine::SetupContext setup;
@@ -85,13 +162,21 @@ void JsManagerImpl::EventThreadWrapper(TaskRunner::RunLoop run_loop) {
 #endif
 
     Environment env;
-    env.Install();
+    if (worker_)
+      env.InstallWorker();
+    else
+      env.Install();
 
     run_loop();
 
-    network_thread_.Stop();
+    // The network thread is shared, so only stop our requests; this ensures
+    // it won't use our objects once they are destroyed.
+    network_thread_->AbortAllRequests(this);
     tracker_.Dispose();
   }
+
+  std::unique_lock<Mutex> lock(engine_mutex_);
+  engine_ = nullptr;
 }
 
 }  // namespace shaka
@@ -17,14 +17,17 @@
 
 #include <glog/logging.h>
 
+#include <atomic>
 #include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "shaka/js_manager.h"
 #include "src/core/environment.h"
 #include "src/core/network_thread.h"
 #include "src/core/task_runner.h"
+#include "src/debug/mutex.h"
 #include "src/debug/thread_event.h"
 #include "src/memory/heap_tracer.h"
 #include "src/memory/object_tracker.h"
@@ -35,30 +38,133 @@
 
 namespace shaka {
 
+class JsEngine;
+
+namespace js {
+struct WorkerConnection;
+namespace dom {
+class Document;
+}  // namespace dom
+}  // namespace js
+
+/**
+ * The implementation of JsManager.  This owns a JavaScript engine, an event
+ * thread, and the object tracker for the objects used by that engine.
+ *
+ * Several managers can exist at once.  Code running on a manager's event
+ * thread, or on a thread created from it, has that manager (and its object
+ * tracker, engine, and factories) bound, so Instance() returns the correct
+ * objects.  Other threads (e.g. app threads calling the public API) need to
+ * use a ThreadScope.  If only one manager exists, Instance() returns it on
+ * any thread.
+ */
 class JsManagerImpl : public memory::Traceable,
                       public PseudoSingleton<JsManagerImpl> {
  public:
+  /**
+   * An RAII type that binds the given manager and its object tracker to the
+   * current thread while it is alive.  The manager can be null, which unbinds
+   * the thread.
+   */
+  class ThreadScope {
+   public:
+    explicit ThreadScope(JsManagerImpl* manager);
+    ~ThreadScope();
+
+    NON_COPYABLE_OR_MOVABLE_TYPE(ThreadScope);
+
+   private:
+    PseudoSingleton<JsManagerImpl>::ScopedThreadInstance manager_;
+    memory::ObjectTracker::ScopedThreadInstance tracker_;
+  };
+
   explicit JsManagerImpl(const JsManager::StartupOptions& options);
+  /**
+   * Creates a manager that runs a dedicated Web Worker.  This has its own
+   * engine, object tracker, and event thread, and runs the worker's script
+   * instead of the player library.
+   */
+  JsManagerImpl(const JsManager::StartupOptions& options,
+                std::shared_ptr<js::WorkerConnection> worker);
   ~JsManagerImpl() override;
 
+  /** @return The implementation of the given public manager. */
+  static JsManagerImpl* Get(JsManager* manager) {
+    CHECK(manager) << "Must pass a JsManager instance";
+    return manager->impl_.get();
+  }
+
   void Trace(memory::HeapTracer* tracer) const override;
 
   TaskRunner* MainThread() {
     return &event_loop_;
   }
+  /**
+   * @return A thread for work that doesn't use JavaScript objects, like
+   *   parsing XML.  The thread is created on first use; this must be called
+   *   on the event thread.  Results should be posted back to MainThread().
+   */
+  TaskRunner* BackgroundThread();
+  /** @return The network thread; this is shared by all managers. */
   NetworkThread* NetworkThread() {
-    return &network_thread_;
+    return network_thread_.get();
+  }
+
+  /** Called by network requests when they receive data; used for metrics. */
+  void AddNetworkBytesReceived(size_t bytes) {
+    network_bytes_received_.fetch_add(bytes, std::memory_order_relaxed);
+  }
+
+  /** @return The total number of bytes received by this manager's requests. */
+  uint64_t network_bytes_received() const {
+    return network_bytes_received_.load(std::memory_order_relaxed);
+  }
+
+  /** @return The number of this manager's requests that are in progress. */
+  size_t network_requests_in_flight() const;
+
+  /** @return The global "document" object of this manager's environment. */
+  js::dom::Document* global_document() const {
+    return global_document_.load(std::memory_order_acquire);
+  }
+  void set_global_document(js::dom::Document* document) {
+    global_document_.store(document, std::memory_order_release);
+  }
+
+  const JsManager::StartupOptions& startup_options() const {
+    return startup_options_;
+  }
+
+  /** @return The worker this manager runs, or null for the main manager. */
+  const std::shared_ptr<js::WorkerConnection>& worker_connection() const {
+    return worker_;
   }
 
   std::string GetPathForStaticFile(const std::string& file) const;
   std::string GetPathForDynamicFile(const std::string& file) const;
 
+  /**
+   * Sets the key used to encrypt persistent EME data.  This can be called from
+   * any thread.
+   * @return False if the key isn't 16 bytes.
+   */
+  bool SetEmeStorageKey(const std::vector<uint8_t>& key);
+  /** @return The EME storage key, or an empty vector if it wasn't set. */
+  std::vector<uint8_t> GetEmeStorageKey() const;
+
   void Run();
 
   void Stop() {
     event_loop_.Stop();
   }
 
+  /**
+   * Stops the event thread like Stop(), but also interrupts the script that is
+   * running, so a worker stuck in a loop can still be stopped.  This can be
+   * called from any thread.
+   */
+  void Terminate();
+
   void WaitUntilFinished();
 
   std::shared_ptr<ThreadEvent<bool>> RunScript(const std::string& path);
@@ -74,9 +180,25 @@ class JsManagerImpl : public memory::Traceable,
   memory::V8HeapTracer v8_heap_tracer_{tracker_.heap_tracer(), &tracker_};
 #endif
   JsManager::StartupOptions startup_options_;
-
+  std::shared_ptr<js::WorkerConnection> worker_;
+  std::atomic<js::dom::Document*> global_document_{nullptr};
+  std::atomic<uint64_t> network_bytes_received_{0};
+
+  mutable Mutex eme_storage_key_mutex_{"JsManagerImpl EME storage key"};
+  std::vector<uint8_t> eme_storage_key_;
+
+  // The engine of the event thread, or null when it isn't running.  This is
+  // used by Terminate() from other threads.
+  Mutex engine_mutex_{"JsManagerImpl engine"};
+  JsEngine* engine_ = nullptr;
+  bool terminated_ = false;
+
+  // This is created before the event thread starts since it is used as part
+  // of shutting down the event thread.
+  std::shared_ptr<class NetworkThread> network_thread_;
   TaskRunner event_loop_;
-  class NetworkThread network_thread_;
+  // This is destroyed first, so its tasks can still post to |event_loop_|.
+  std::unique_ptr<TaskRunner> background_thread_;
 };
 
 /**
@@ -86,8 +208,11 @@ class JsManagerImpl : public memory::Traceable,
 template <typename... Args>
 std::function<void(Args...)> MainThreadCallback(
     std::function<void(Args...)> cb) {
+  // Use the manager that created the callback since it may be invoked on a
+  // thread that isn't bound to a manager.
+  JsManagerImpl* manager = JsManagerImpl::Instance();
   return [=](Args... args) {
-    JsManagerImpl::Instance()->MainThread()->AddInternalTask(
+    manager->MainThread()->AddInternalTask(
         TaskPriority::Internal, "", PlainCallbackTask(std::bind(cb, args...)));
   };
 }
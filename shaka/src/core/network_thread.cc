@@ -19,9 +19,11 @@
 
 #include <algorithm>
 #include <cerrno>
+#include <mutex>
 
+#include "src/core/js_manager_impl.h"
 #include "src/js/xml_http_request.h"
-#include "src/util/utils.h"
+#include "src/util/macros.h"
 
 namespace shaka {
 
@@ -30,6 +32,11 @@ namespace {
 constexpr const long kSmallDelayMs = 100;  // NOLINT
 constexpr const long kMaxDelayMs = 500;    // NOLINT
 
+void StopAndDelete(NetworkThread* thread) {
+  thread->Stop();
+  delete thread;
+}
+
 }  // namespace
 
 NetworkThread::NetworkThread()
@@ -47,6 +54,22 @@ NetworkThread::~NetworkThread() {
   curl_multi_cleanup(multi_handle_);
 }
 
+// static
+std::shared_ptr<NetworkThread> NetworkThread::GetShared() {
+  BEGIN_ALLOW_COMPLEX_STATICS
+  static std::mutex mutex;
+  static std::weak_ptr<NetworkThread> shared;
+  END_ALLOW_COMPLEX_STATICS
+
+  std::unique_lock<std::mutex> lock(mutex);
+  std::shared_ptr<NetworkThread> ret = shared.lock();
+  if (!ret) {
+    ret.reset(new NetworkThread, &StopAndDelete);
+    shared = ret;
+  }
+  return ret;
+}
+
 void NetworkThread::Stop() {
   shutdown_.store(true, std::memory_order_release);
   cond_.SignalAllIfNotSet();
@@ -55,14 +78,14 @@ void NetworkThread::Stop() {
 
 bool NetworkThread::ContainsRequest(RefPtr<js::XMLHttpRequest> request) const {
   std::unique_lock<Mutex> lock(mutex_);
-  return util::contains(requests_, request);
+  return ContainsRequestLocked(request);
 }
 
 void NetworkThread::AddRequest(RefPtr<js::XMLHttpRequest> request) {
   std::unique_lock<Mutex> lock(mutex_);
   DCHECK(!shutdown_.load(std::memory_order_acquire));
-  DCHECK(!util::contains(requests_, request));
-  requests_.push_back(request);
+  DCHECK(!ContainsRequestLocked(request));
+  requests_.push_back({request, request->manager_});
   CHECK_EQ(curl_multi_add_handle(multi_handle_, request->curl_), CURLM_OK);
   cond_.SignalAllIfNotSet();
 }
@@ -70,7 +93,7 @@ void NetworkThread::AddRequest(RefPtr<js::XMLHttpRequest> request) {
 void NetworkThread::AbortRequest(RefPtr<js::XMLHttpRequest> request) {
   std::unique_lock<Mutex> lock(mutex_);
   for (auto it = requests_.begin(); it != requests_.end(); it++) {
-    if (*it == request) {
+    if (it->request == request) {
       CHECK_EQ(curl_multi_remove_handle(multi_handle_, request->curl_),
                CURLM_OK);
       requests_.erase(it);
@@ -79,7 +102,43 @@ void NetworkThread::AbortRequest(RefPtr<js::XMLHttpRequest> request) {
   }
 }
 
+void NetworkThread::AbortAllRequests(const JsManagerImpl* manager) {
+  std::unique_lock<Mutex> lock(mutex_);
+  for (auto it = requests_.begin(); it != requests_.end();) {
+    if (it->manager == manager) {
+      CHECK_EQ(curl_multi_remove_handle(multi_handle_, it->request->curl_),
+               CURLM_OK);
+      it = requests_.erase(it);
+    } else {
+      it++;
+    }
+  }
+}
+
+size_t NetworkThread::RequestsInFlight(const JsManagerImpl* manager) const {
+  std::unique_lock<Mutex> lock(mutex_);
+  size_t ret = 0;
+  for (auto& item : requests_) {
+    if (item.manager == manager)
+      ret++;
+  }
+  return ret;
+}
+
+bool NetworkThread::ContainsRequestLocked(
+    const RefPtr<js::XMLHttpRequest>& request) const {
+  for (auto& item : requests_) {
+    if (item.request == request)
+      return true;
+  }
+  return false;
+}
+
 void NetworkThread::ThreadMain() {
+  // This thread is shared, so it isn't bound to the manager that created it.
+  // Each request binds its own manager while being handled.
+  JsManagerImpl::ThreadScope unbound(nullptr);
+
   while (!shutdown_.load(std::memory_order_acquire)) {
     fd_set fdread;
     fd_set fdwrite;
@@ -100,8 +159,10 @@ void NetworkThread::ThreadMain() {
       while (CURLMsg* msg = curl_multi_info_read(multi_handle_, &msg_count)) {
         if (msg->msg == CURLMSG_DONE) {
           for (auto it = requests_.begin(); it != requests_.end(); it++) {
-            if ((*it)->curl_ == msg->easy_handle) {
-              (*it)->OnRequestComplete(msg->data.result);  // NOLINT
+            if (it->request->curl_ == msg->easy_handle) {
+              // Releasing the request also needs the manager bound.
+              JsManagerImpl::ThreadScope scope(it->manager);
+              it->request->OnRequestComplete(msg->data.result);  // NOLINT
               requests_.erase(it);
               break;
             }
@@ -15,8 +15,11 @@
 #ifndef SHAKA_EMBEDDED_CORE_NETWORK_THREAD_H_
 #define SHAKA_EMBEDDED_CORE_NETWORK_THREAD_H_
 
+#include <stdint.h>
+
 #include <atomic>
-#include <vector>
+#include <list>
+#include <memory>
 
 #include "src/core/ref_ptr.h"
 #include "src/debug/mutex.h"
@@ -27,6 +30,8 @@ typedef void CURLM;
 
 namespace shaka {
 
+class JsManagerImpl;
+
 namespace js {
 class XMLHttpRequest;
 }  // namespace js
@@ -37,12 +42,22 @@ class XMLHttpRequest;
  * request happens, the background thread will make calls into the XHR object.
  * The XHR object MUST handle any synchronization required for cross-thread
  * access.
+ *
+ * One network thread is shared by all the JsManager instances.  Each request
+ * remembers the manager that made it, and the manager is bound to this thread
+ * while handling that request.
  */
 class NetworkThread {
  public:
   NetworkThread();
   ~NetworkThread();
 
+  /**
+   * @return The network thread shared by all the managers, creating it if
+   *   needed.  The thread is stopped once the last reference is released.
+   */
+  static std::shared_ptr<NetworkThread> GetShared();
+
   /** Stops the background thread and joins it. */
   void Stop();
 
@@ -64,12 +79,30 @@ class NetworkThread {
    */
   void AbortRequest(RefPtr<js::XMLHttpRequest> request);
 
+  /**
+   * Aborts all the pending requests made by the given manager.  This is called
+   * as part of shutting down the manager.  This must be called on the
+   * manager's event thread.
+   */
+  void AbortAllRequests(const JsManagerImpl* manager);
+
+  /** @return The number of the manager's requests that are in progress. */
+  size_t RequestsInFlight(const JsManagerImpl* manager) const;
+
  private:
+  struct Request {
+    RefPtr<js::XMLHttpRequest> request;
+    JsManagerImpl* manager;
+  };
+
+  bool ContainsRequestLocked(const RefPtr<js::XMLHttpRequest>& request) const;
   void ThreadMain();
 
   mutable Mutex mutex_;
   ThreadEvent<void> cond_;
-  std::vector<RefPtr<js::XMLHttpRequest>> requests_;
+  // This is a list so removing a request doesn't move the others, since
+  // moving a RefPtr needs the owning manager to be bound.
+  std::list<Request> requests_;
   CURLM* multi_handle_;
   std::atomic<bool> shutdown_;
 
@@ -19,6 +19,7 @@
 #include <chrono>
 #include <limits>
 
+#include "src/debug/trace_recorder.h"
 #include "src/mapping/js_wrappers.h"
 #include "src/util/clock.h"
 
@@ -26,9 +27,10 @@ namespace shaka {
 
 namespace impl {
 
-PendingTaskBase::PendingTaskBase(TaskPriority priority, uint64_t delay_ms,
-                                 int id, bool loop)
-    : start_ms(util::Clock::Instance.GetMonotonicTime()),
+PendingTaskBase::PendingTaskBase(const char* name, TaskPriority priority,
+                                 uint64_t delay_ms, int id, bool loop)
+    : name(name),
+      start_ms(util::Clock::Instance.GetMonotonicTime()),
       delay_ms(delay_ms),
       priority(priority),
       id(id),
@@ -40,13 +42,17 @@ PendingTaskBase::~PendingTaskBase() {}
 }  // namespace impl
 
 TaskRunner::TaskRunner(std::function<void(RunLoop)> wrapper, bool is_worker)
+    : TaskRunner(std::move(wrapper), is_worker ? "JS Worker" : "JS Main Thread",
+                 is_worker) {}
+
+TaskRunner::TaskRunner(std::function<void(RunLoop)> wrapper,
+                       const std::string& name, bool is_worker)
     : mutex_(is_worker ? "TaskRunner worker" : "TaskRunner main"),
       waiting_("TaskRunner wait until finished"),
       running_(true),
       next_id_(0),
       is_worker_(is_worker),
-      worker_(is_worker ? "JS Worker" : "JS Main Thread",
-              std::bind(&TaskRunner::Run, this, std::move(wrapper))) {
+      worker_(name, std::bind(&TaskRunner::Run, this, std::move(wrapper))) {
   waiting_.SetProvider(&worker_);
 }
 
@@ -67,7 +73,7 @@ bool TaskRunner::BelongsToCurrentThread() const {
   return running_ && std::this_thread::get_id() == worker_.get_id();
 }
 
-void TaskRunner::Stop() {
+void TaskRunner::Stop(std::function<void()> interrupt) {
   bool join = false;
   {
     std::unique_lock<Mutex> lock(mutex_);
@@ -78,6 +84,10 @@ void TaskRunner::Stop() {
     }
   }
   if (join) {
+    // The worker won't start another task after this since |running_| is
+    // already false.
+    if (interrupt)
+      interrupt();
     worker_.join();
   }
 }
@@ -170,6 +180,8 @@ bool TaskRunner::HandleTask() {
   if (!task)
     return false;
 
+  ScopedTrace trace(task->name);
+
 #ifdef USING_V8
   if (!is_worker_) {
     // V8 attaches v8::Local<T> instances to the most recent v8::HandleScope
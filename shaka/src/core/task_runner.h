@@ -52,12 +52,18 @@ using RetOf = typename std::result_of<Func()>::type;
 /** Defines a base class for a pending task. */
 class PendingTaskBase : public memory::Traceable {
  public:
-  PendingTaskBase(TaskPriority priority, uint64_t delay_ms, int id, bool loop);
+  PendingTaskBase(const char* name, TaskPriority priority, uint64_t delay_ms,
+                  int id, bool loop);
   ~PendingTaskBase() override;
 
   /** Performs the task. */
   virtual void Call() = 0;
 
+  /**
+   * The name of the task, used for debugging and tracing.  This isn't copied,
+   * so it must be a string literal.
+   */
+  const char* const name;
   uint64_t start_ms;
   const uint64_t delay_ms;
   const TaskPriority priority;
@@ -88,20 +94,22 @@ class PendingTask : public PendingTaskBase {
                 "Traceable callback object must be Traceable");
   using Ret = typename std::result_of<Func()>::type;
 
-  PendingTask(Func&& callback, const std::string& name, TaskPriority priority,
+  PendingTask(Func&& callback, const char* name, TaskPriority priority,
               uint64_t delay_ms, int id, bool loop)
-      : PendingTaskBase(priority, delay_ms, id, loop),
-        callback(std::forward<Func>(callback)),
-        event(new ThreadEvent<Ret>(name)) {}
+      : PendingTaskBase(name, priority, delay_ms, id, loop),
+        callback(std::forward<Func>(callback)) {}
 
   void Call() override {
     // If this were C++17, we could use if-constexpr:
     //
     // if constexpr (std::is_same<Ret, void>::value) {
     //   callback();
-    //   event->SignalAllIfNotSet();
-    // } else {
+    //   if (event)
+    //     event->SignalAllIfNotSet();
+    // } else if (event) {
     //   event->SignalAllIfNotSet(callback());
+    // } else {
+    //   callback();
     // }
 
     SetHelper<Func, Ret>::Set(&callback, &event);
@@ -112,6 +120,7 @@ class PendingTask : public PendingTaskBase {
   }
 
   typename std::decay<Func>::type callback;
+  /** The event for the results; this is null if no one waits for them. */
   std::shared_ptr<ThreadEvent<Ret>> event;
 
  private:
@@ -119,7 +128,10 @@ class PendingTask : public PendingTaskBase {
   struct SetHelper {
     static void Set(typename std::decay<F>::type* callback,
                     std::shared_ptr<ThreadEvent<R>>* event) {
-      (*event)->SignalAllIfNotSet((*callback)());
+      if (*event)
+        (*event)->SignalAllIfNotSet((*callback)());
+      else
+        (*callback)();
     }
   };
   template <typename F>
@@ -127,7 +139,8 @@ class PendingTask : public PendingTaskBase {
     static void Set(typename std::decay<F>::type* callback,
                     std::shared_ptr<ThreadEvent<void>>* event) {
       (*callback)();
-      (*event)->SignalAllIfNotSet();
+      if (*event)
+        (*event)->SignalAllIfNotSet();
     }
   };
 };
@@ -209,6 +222,12 @@ class TaskRunner : public memory::Traceable {
   using RunLoop = std::function<void()>;
 
   TaskRunner(std::function<void(RunLoop)> wrapper, bool is_worker);
+  /**
+   * Creates a runner whose thread has the given name.  This is used for the
+   * event threads of Web Workers, which run JavaScript so aren't |is_worker|.
+   */
+  TaskRunner(std::function<void(RunLoop)> wrapper, const std::string& name,
+             bool is_worker);
   ~TaskRunner() override;
 
   /** @return Whether the background thread is running. */
@@ -226,8 +245,11 @@ class TaskRunner : public memory::Traceable {
   /**
    * Stops the worker thread.  Can only be called when running.  Will stop any
    * pending tasks and will block until the worker thread is stopped.
+   *
+   * @param interrupt If given, this is called once the worker has been told to
+   *   stop but before blocking, so it can interrupt the current task.
    */
-  void Stop();
+  void Stop(std::function<void()> interrupt = nullptr);
 
   /** Blocks the calling thread until the worker has no more work to do. */
   void WaitUntilFinished();
@@ -243,25 +265,46 @@ class TaskRunner : public memory::Traceable {
    *
    * @param priority The priority of the task.  Higher priority tasks will run
    *   before lower priority tasks even if the higher task is registered later.
-   * @param name The name of the new task, used for debugging.
+   * @param name The name of the new task, used for debugging.  This must be a
+   *   string literal.
    * @param callback The Traceable callback object.
    * @return The task ID and a future that will hold the results.
    */
   template <typename Func>
   std::shared_ptr<ThreadEvent<impl::RetOf<Func>>> AddInternalTask(
-      TaskPriority priority, const std::string& name, Func&& callback) {
+      TaskPriority priority, const char* name, Func&& callback) {
     DCHECK(priority != TaskPriority::Timer) << "Use AddTimer for timers";
 
     std::unique_lock<Mutex> lock(mutex_);
     const int id = ++next_id_;
     auto pending_task = new impl::PendingTask<Func>(
         std::forward<Func>(callback), name, priority, 0, id, /* loop */ false);
+    pending_task->event.reset(new ThreadEvent<impl::RetOf<Func>>(name));
     tasks_.emplace_back(pending_task);
     pending_task->event->SetProvider(&worker_);
 
     return pending_task->event;
   }
 
+  /**
+   * Registers an internal task to be called on the worker thread.  This is the
+   * same as AddInternalTask, except there is no way to wait for the task or
+   * get its results, so this doesn't need to create a ThreadEvent.  This
+   * should be used when the task reports its own results.
+   *
+   * @see AddInternalTask
+   */
+  template <typename Func>
+  void PostInternalTask(TaskPriority priority, const char* name,
+                        Func&& callback) {
+    DCHECK(priority != TaskPriority::Timer) << "Use AddTimer for timers";
+
+    std::unique_lock<Mutex> lock(mutex_);
+    const int id = ++next_id_;
+    tasks_.emplace_back(new impl::PendingTask<Func>(
+        std::forward<Func>(callback), name, priority, 0, id, /* loop */ false));
+  }
+
   /**
    * Calls the given callback after the given delay on the worker thread.  The
    * given callback must also be a Traceable object.  The callback will be
@@ -0,0 +1,495 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/debug/async_log.h"
+
+#include <glog/logging.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "src/util/macros.h"
+
+namespace shaka {
+
+namespace {
+
+/** The number of buckets used to count the lines for each call site. */
+constexpr const size_t kSiteBucketCount = 256;
+/** The maximum size of a batch of output before it is written. */
+constexpr const size_t kMaxBatchSize = 64 * 1024;
+
+/**
+ * A fixed-size queue that any number of threads can push to without locking,
+ * but only one thread can pop from.  Each cell has a sequence number that says
+ * whether it is ready to be written to or read from for the current position.
+ */
+class EntryQueue {
+ public:
+  EntryQueue() : push_pos_(0), pop_pos_(0) {
+    for (size_t i = 0; i < AsyncLog::kQueueSize; i++)
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+  }
+
+  NON_COPYABLE_OR_MOVABLE_TYPE(EntryQueue);
+
+  /** @return False if the queue is full. */
+  bool Push(AsyncLog::Entry* entry) {
+    size_t pos = push_pos_.load(std::memory_order_relaxed);
+    Cell* cell;
+    while (true) {
+      cell = &cells_[pos % AsyncLog::kQueueSize];
+      const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+      if (sequence == pos) {
+        if (push_pos_.compare_exchange_weak(pos, pos + 1,
+                                            std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (sequence < pos) {
+        // The reader hasn't gotten to this cell since it was last written.
+        return false;
+      } else {
+        // Another thread pushed to this position.
+        pos = push_pos_.load(std::memory_order_relaxed);
+      }
+    }
+
+    cell->entry = entry;
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  /** @return The next entry, or nullptr if none are ready. */
+  AsyncLog::Entry* Pop() {
+    Cell* cell = &cells_[pop_pos_ % AsyncLog::kQueueSize];
+    if (cell->sequence.load(std::memory_order_acquire) != pop_pos_ + 1)
+      return nullptr;
+
+    AsyncLog::Entry* ret = cell->entry;
+    cell->sequence.store(pop_pos_ + AsyncLog::kQueueSize,
+                         std::memory_order_release);
+    pop_pos_++;
+    return ret;
+  }
+
+ private:
+  struct Cell {
+    std::atomic<size_t> sequence;
+    AsyncLog::Entry* entry;
+  };
+
+  Cell cells_[AsyncLog::kQueueSize];
+  std::atomic<size_t> push_pos_;
+  // Only used by the reader.
+  size_t pop_pos_;
+};
+
+/** Counts the lines for the call sites that hash to this bucket. */
+struct SiteBucket {
+  std::atomic<uint64_t> second;
+  std::atomic<uint32_t> count;
+};
+
+void WriteToStdout(const std::string& batch) {
+  fwrite(batch.data(), 1, batch.size(), stdout);
+  fflush(stdout);
+}
+
+void FormatEntry(const AsyncLog::Entry& entry, std::string* out) {
+  if (entry.level[0] != '\0') {
+    out->push_back('[');
+    out->append(entry.level);
+    out->append("]: ");
+  }
+  out->append(entry.prefix);
+  bool is_first = true;
+  for (const AsyncLog::Argument& arg : entry.arguments) {
+    if (!is_first)
+      out->push_back('\t');
+    is_first = false;
+
+    switch (arg.type) {
+      case AsyncLog::Argument::kText:
+        out->append(arg.text);
+        break;
+      case AsyncLog::Argument::kString:
+        AsyncLog::AppendQuotedString(arg.text, out);
+        break;
+      case AsyncLog::Argument::kNumber:
+        AsyncLog::AppendNumber(arg.number, out);
+        break;
+    }
+  }
+  out->push_back('\n');
+  if (!entry.suffix.empty()) {
+    out->append(entry.suffix);
+    out->push_back('\n');
+  }
+}
+
+class Writer {
+ public:
+  Writer()
+      : queued_count_(0),
+        written_count_(0),
+        dropped_count_(0),
+        sleeping_(false),
+        output_(&WriteToStdout) {
+    for (auto& bucket : buckets_) {
+      bucket.second.store(0, std::memory_order_relaxed);
+      bucket.count.store(0, std::memory_order_relaxed);
+    }
+    // The thread runs until the process exits; see GetWriter().
+    std::thread(&Writer::Run, this).detach();
+  }
+
+  NON_COPYABLE_OR_MOVABLE_TYPE(Writer);
+
+  bool Write(std::unique_ptr<AsyncLog::Entry> entry) {
+    if (!AllowSite(entry->site) || !queue_.Push(entry.get())) {
+      // Wake the writer so it reports the dropped line.
+      dropped_count_.fetch_add(1, std::memory_order_seq_cst);
+      WakeWriter();
+      return false;
+    }
+    entry.release();
+    queued_count_.fetch_add(1, std::memory_order_seq_cst);
+    WakeWriter();
+    return true;
+  }
+
+  void Flush() {
+    const uint64_t target = queued_count_.load(std::memory_order_acquire);
+    std::unique_lock<std::mutex> lock(mutex_);
+    written_.wait(lock, [&]() {
+      return written_count_.load(std::memory_order_acquire) >= target;
+    });
+  }
+
+  uint64_t DroppedCount() const {
+    return dropped_count_.load(std::memory_order_relaxed);
+  }
+
+  void SetOutput(std::function<void(const std::string&)> output) {
+    std::unique_lock<std::mutex> lock(output_mutex_);
+    output_ = output ? std::move(output) : &WriteToStdout;
+  }
+
+ private:
+  bool AllowSite(uint64_t site) {
+    if (site == 0)
+      return true;
+
+    // Buckets are reset when a new second starts.  Sites that hash to the same
+    // bucket share the limit.
+    SiteBucket* bucket = &buckets_[site % kSiteBucketCount];
+    const auto since_epoch =
+        std::chrono::steady_clock::now().time_since_epoch();
+    const uint64_t now =
+        std::chrono::duration_cast<std::chrono::seconds>(since_epoch).count();
+    uint64_t second = bucket->second.load(std::memory_order_relaxed);
+    if (second != now && bucket->second.compare_exchange_strong(
+                             second, now, std::memory_order_relaxed)) {
+      bucket->count.store(0, std::memory_order_relaxed);
+    }
+    return bucket->count.fetch_add(1, std::memory_order_relaxed) <
+           AsyncLog::kMaxLinesPerSecond;
+  }
+
+  /**
+   * Wakes the writer thread if it is waiting for lines.  It only waits once
+   * the queue is empty, so this only locks when the queue stops being empty.
+   */
+  void WakeWriter() {
+    if (sleeping_.load(std::memory_order_seq_cst) &&
+        sleeping_.exchange(false, std::memory_order_seq_cst)) {
+      std::unique_lock<std::mutex> lock(mutex_);
+      wake_.notify_one();
+    }
+  }
+
+  /** Called on the writer thread to wait until there is something to do. */
+  void WaitForLines(uint64_t reported_drops) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    sleeping_.store(true, std::memory_order_seq_cst);
+    // Write() only wakes us if it sees |sleeping_|, so check for lines that
+    // were queued (or dropped) before it was set.
+    if (queued_count_.load(std::memory_order_seq_cst) !=
+            written_count_.load(std::memory_order_relaxed) ||
+        dropped_count_.load(std::memory_order_seq_cst) != reported_drops) {
+      sleeping_.store(false, std::memory_order_relaxed);
+      return;
+    }
+    wake_.wait(lock, [this]() {
+      return !sleeping_.load(std::memory_order_relaxed);
+    });
+  }
+
+  void Output(std::string* batch) {
+    std::unique_lock<std::mutex> lock(output_mutex_);
+    output_(*batch);
+    batch->clear();
+  }
+
+  void Run() {
+    std::string batch;
+    uint64_t reported_drops = 0;
+    while (true) {
+      uint64_t count = 0;
+      while (AsyncLog::Entry* entry = queue_.Pop()) {
+        FormatEntry(*entry, &batch);
+        delete entry;
+        count++;
+        if (batch.size() >= kMaxBatchSize)
+          Output(&batch);
+      }
+
+      const uint64_t drops = dropped_count_.load(std::memory_order_relaxed);
+      if (drops != reported_drops) {
+        batch.append("[Warn]: ");
+        batch.append(std::to_string(drops - reported_drops));
+        batch.append(" log lines were dropped\n");
+        reported_drops = drops;
+      }
+
+      if (!batch.empty())
+        Output(&batch);
+      if (count > 0) {
+        written_count_.fetch_add(count, std::memory_order_release);
+        // Flush() checks the count while holding the lock, so lock before
+        // notifying so it can't miss the change.
+        std::unique_lock<std::mutex> lock(mutex_);
+        written_.notify_all();
+      } else {
+        WaitForLines(reported_drops);
+      }
+    }
+  }
+
+  EntryQueue queue_;
+  SiteBucket buckets_[kSiteBucketCount];
+  std::atomic<uint64_t> queued_count_;
+  std::atomic<uint64_t> written_count_;
+  std::atomic<uint64_t> dropped_count_;
+
+  // Used to wait for lines to be queued or written, instead of polling.
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable written_;
+  std::atomic<bool> sleeping_;
+
+  std::mutex output_mutex_;
+  std::function<void(const std::string&)> output_;
+};
+
+/** Queues the glog lines that would otherwise be written to stderr. */
+class GlogSink : public google::LogSink {
+ public:
+  explicit GlogSink(google::LogSeverity min_severity)
+      : min_severity_(min_severity) {}
+
+  NON_COPYABLE_OR_MOVABLE_TYPE(GlogSink);
+
+  void send(google::LogSeverity severity, const char* /* full_filename */,
+            const char* base_filename, int line, const struct ::tm* tm_time,
+            const char* message, size_t message_len) override {
+    // FATAL messages are still written by glog; see InstallGlogSink.
+    if (severity < min_severity_ || severity >= google::GLOG_FATAL)
+      return;
+
+    std::unique_ptr<AsyncLog::Entry> entry(new AsyncLog::Entry);
+    entry->prefix = ToString(severity, base_filename, line, tm_time, message,
+                             message_len);
+    // Only limit the rate of INFO lines (e.g. VLOG), so warnings and errors
+    // are only dropped when the queue is full.
+    if (severity == google::GLOG_INFO) {
+      entry->site = AsyncLog::HashSite(base_filename, std::to_string(line));
+    }
+    AsyncLog::Write(std::move(entry));
+  }
+
+ private:
+  const google::LogSeverity min_severity_;
+};
+
+void FlushAtExit() {
+  AsyncLog::Flush();
+}
+
+Writer* GetWriter() {
+  // Leak the writer so it can be used while other static objects are
+  // destroyed; queued lines are written when the process exits.  Only a
+  // normal exit flushes, so lines that are still queued are lost if the
+  // process aborts, e.g. from a failed CHECK.
+  static Writer* writer = []() {
+    Writer* ret = new Writer;
+    atexit(&FlushAtExit);
+    return ret;
+  }();
+  return writer;
+}
+
+}  // namespace
+
+constexpr const size_t AsyncLog::kQueueSize;
+constexpr const uint32_t AsyncLog::kMaxLinesPerSecond;
+
+// static
+bool AsyncLog::Write(std::unique_ptr<Entry> entry) {
+  return GetWriter()->Write(std::move(entry));
+}
+
+// static
+void AsyncLog::Flush() {
+  GetWriter()->Flush();
+}
+
+// static
+uint64_t AsyncLog::DroppedCount() {
+  return GetWriter()->DroppedCount();
+}
+
+// static
+void AsyncLog::SetOutput(std::function<void(const std::string&)> output) {
+  GetWriter()->SetOutput(std::move(output));
+}
+
+// static
+void AsyncLog::InstallGlogSink() {
+  static bool installed = []() {
+    // Only queue the lines that glog was going to write to stderr.
+    const google::LogSeverity min_severity =
+        FLAGS_logtostderr || FLAGS_alsologtostderr ? google::GLOG_INFO
+                                                   : FLAGS_stderrthreshold;
+    if (FLAGS_logtostderr) {
+      // Stop glog from writing log files instead of writing to stderr.
+      FLAGS_logtostderr = false;
+      for (int i = 0; i < google::NUM_SEVERITIES; i++)
+        google::SetLogDestination(i, "");
+    }
+    FLAGS_alsologtostderr = false;
+    FLAGS_stderrthreshold = google::GLOG_FATAL;
+
+    // Leak the sink since glog can log while static objects are destroyed.
+    google::AddLogSink(new GlogSink(min_severity));
+    return true;
+  }();
+  (void)installed;
+}
+
+// static
+uint64_t AsyncLog::HashSite(const char* level, const std::string& text) {
+  // FNV-1a; this only needs to spread the sites over the buckets.
+  uint64_t hash = 14695981039346656037ull;
+  for (const char* it = level; *it; it++)
+    hash = (hash ^ static_cast<uint8_t>(*it)) * 1099511628211ull;
+  for (char c : text)
+    hash = (hash ^ static_cast<uint8_t>(c)) * 1099511628211ull;
+  return hash ? hash : 1;
+}
+
+// static
+void AsyncLog::AppendQuotedString(const std::string& str, std::string* out) {
+  out->push_back('"');
+  for (const char c : str) {
+    // Using https://en.wikipedia.org/wiki/Escape_sequences_in_C to determine
+    // characters need to be escaped.
+    switch (c) {
+      case '\a':
+        out->append(R"(\a)");
+        break;
+      case '\b':
+        out->append(R"(\b)");
+        break;
+      case '\n':
+        out->append(R"(\n)");
+        break;
+      case '\r':
+        out->append(R"(\r)");
+        break;
+      case '\t':
+        out->append(R"(\t)");
+        break;
+      case '\\':
+        out->append(R"(\\)");
+        break;
+      case '\'':
+        out->append(R"(\')");
+        break;
+      case '"':
+        out->append(R"(\")");
+        break;
+      case '\?':
+        out->append(R"(\?)");
+        break;
+      default:
+        out->push_back(c);
+        break;
+    }
+  }
+  out->push_back('"');
+}
+
+// static
+void AsyncLog::AppendNumber(double number, std::string* out) {
+  if (std::isnan(number)) {
+    out->append("NaN");
+    return;
+  }
+  if (std::isinf(number)) {
+    out->append(number > 0 ? "Infinity" : "-Infinity");
+    return;
+  }
+
+  char buffer[64];
+  if (number == std::floor(number) && std::abs(number) < 1e21) {
+    // This also prints -0 as "0", like JavaScript.
+    snprintf(buffer, sizeof(buffer), "%.0f", number == 0 ? 0 : number);
+    out->append(buffer);
+    return;
+  }
+
+  // Find the shortest representation that reads back as the same number.
+  int precision = 1;
+  for (; precision < 17; precision++) {
+    snprintf(buffer, sizeof(buffer), "%.*g", precision, number);
+    if (strtod(buffer, nullptr) == number)
+      break;
+  }
+  snprintf(buffer, sizeof(buffer), "%.*e", precision - 1, number);
+
+  // JavaScript uses the exponent form only outside of [1e-6, 1e21), and
+  // doesn't pad the exponent.
+  char* exponent_str = strchr(buffer, 'e');
+  const int exponent = atoi(exponent_str + 1);
+  if (exponent >= -6 && exponent < 21) {
+    snprintf(buffer, sizeof(buffer), "%.*f",
+             std::max(precision - 1 - exponent, 0), number);
+    out->append(buffer);
+  } else {
+    out->append(buffer, exponent_str);
+    out->append(exponent < 0 ? "e-" : "e+");
+    out->append(std::to_string(std::abs(exponent)));
+  }
+}
+
+}  // namespace shaka
@@ -0,0 +1,137 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SHAKA_EMBEDDED_DEBUG_ASYNC_LOG_H_
+#define SHAKA_EMBEDDED_DEBUG_ASYNC_LOG_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace shaka {
+
+/**
+ * Writes log lines on a background thread.  The calling thread only copies
+ * the arguments and pushes the line to a fixed-size lock-free queue; the
+ * background thread formats the lines and writes them in batches.  This keeps
+ * verbose logging (e.g. console.log from a debug build of Shaka Player) from
+ * slowing down the thread that logs.
+ *
+ * Each call site (see Entry::site) can only log kMaxLinesPerSecond lines per
+ * second and lines are dropped if the queue is full.  The number of dropped
+ * lines is counted and reported in the output.
+ *
+ * Queued lines are only flushed when the process exits normally, so they are
+ * lost if it aborts (e.g. from a failed CHECK).
+ */
+class AsyncLog final {
+ public:
+  /** The number of lines that can be waiting to be written. */
+  static constexpr const size_t kQueueSize = 4096;
+  /** The number of lines a single call site can log per second. */
+  static constexpr const uint32_t kMaxLinesPerSecond = 200;
+
+  /** An argument to a log line.  These are formatted on the writer thread. */
+  struct Argument {
+    enum Type {
+      /** Text that is written as-is. */
+      kText,
+      /** A string value, written quoted and escaped. */
+      kString,
+      /** A number, written the same as JavaScript would. */
+      kNumber,
+    };
+
+    Argument(Type type, std::string text) : type(type), text(std::move(text)) {}
+    explicit Argument(double number) : type(kNumber), number(number) {}
+
+    Type type;
+    std::string text;
+    double number = 0;
+  };
+
+  struct Entry {
+    /**
+     * The name of the log level, e.g. "Error".  If this is empty, the line is
+     * written without a level, e.g. for glog lines that have their own.
+     */
+    const char* level = "";
+    /**
+     * A value that identifies where the line was logged from, used to limit
+     * the rate of lines from the same place.
+     */
+    uint64_t site = 0;
+    /** Text written before the arguments. */
+    std::string prefix;
+    std::vector<Argument> arguments;
+    /** Text written on the lines after the arguments, e.g. a stack trace. */
+    std::string suffix;
+  };
+
+  /**
+   * Queues the given line to be written.  This doesn't wait for the line to be
+   * written; it only takes a lock to wake the writer thread when the queue was
+   * empty.  The line is dropped if the call site has logged too many lines
+   * recently or the queue is full.
+   *
+   * @return Whether the line was queued.
+   */
+  static bool Write(std::unique_ptr<Entry> entry);
+
+  /** Blocks until all the queued lines have been written. */
+  static void Flush();
+
+  /** @return The total number of lines that have been dropped. */
+  static uint64_t DroppedCount();
+
+  /**
+   * Sets the function that writes the formatted lines; this is given each
+   * batch of lines.  By default, they are written to stdout.  Passing null
+   * restores the default.
+   */
+  static void SetOutput(std::function<void(const std::string&)> output);
+
+  /**
+   * @return A value for Entry::site that identifies the given text, e.g. the
+   *   first argument of a console.log call.
+   */
+  static uint64_t HashSite(const char* level, const std::string& text);
+
+  /**
+   * Adds a glog LogSink that queues the lines glog would write to stderr and
+   * turns off glog's own stderr output, so logging (e.g. VLOG in the media
+   * pipeline) doesn't write synchronously on the calling thread.  FATAL
+   * messages are still written directly since the process aborts before
+   * queued lines are written.
+   *
+   * This only has an effect the first time it is called.  glog must already
+   * be initialized since glog always writes to stderr before that.
+   */
+  static void InstallGlogSink();
+
+  /** Appends the given string to |out|, quoted and escaped. */
+  static void AppendQuotedString(const std::string& str, std::string* out);
+
+  /** Appends the given number to |out| in the same format as JavaScript. */
+  static void AppendNumber(double number, std::string* out);
+};
+
+}  // namespace shaka
+
+#endif  // SHAKA_EMBEDDED_DEBUG_ASYNC_LOG_H_
@@ -0,0 +1,112 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/debug/lock_profiler.h"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "src/util/utils.h"
+
+namespace shaka {
+
+namespace {
+
+struct Registry {
+  // This can't use a Mutex since that would profile itself.
+  std::mutex mutex;
+  std::unordered_map<std::string, std::unique_ptr<LockStats>> stats;
+};
+
+Registry* GetRegistry() {
+  // Leak the registry so it can be used by static Mutex objects during
+  // shutdown.
+  static Registry* registry = new Registry;
+  return registry;
+}
+
+}  // namespace
+
+LockStats::LockStats(const std::string& name)
+    : name_(name), acquisitions_(0), contended_(0) {}
+
+LockStats::~LockStats() {}
+
+
+constexpr const uint32_t LockProfiler::kSampleRate;
+
+LockStats* LockProfiler::GetStats(const std::string& name) {
+  Registry* registry = GetRegistry();
+  std::unique_lock<std::mutex> lock(registry->mutex);
+  auto& ret = registry->stats[name];
+  if (!ret)
+    ret.reset(new LockStats(name));
+  return ret.get();
+}
+
+bool LockProfiler::ShouldSample() {
+  thread_local uint32_t count = 0;
+  return ++count % kSampleRate == 0;
+}
+
+std::vector<LockProfiler::Entry> LockProfiler::GetReport() {
+  std::vector<Entry> ret;
+  {
+    Registry* registry = GetRegistry();
+    std::unique_lock<std::mutex> lock(registry->mutex);
+    ret.reserve(registry->stats.size());
+    for (auto& pair : registry->stats) {
+      const LockStats* stats = pair.second.get();
+      ret.emplace_back();
+      Entry* entry = &ret.back();
+      entry->name = stats->name();
+      entry->acquisitions = stats->acquisitions();
+      entry->contended = stats->contended();
+      stats->wait_times().CopyTo(&entry->wait);
+      stats->hold_times().CopyTo(&entry->hold);
+    }
+  }
+
+  std::sort(ret.begin(), ret.end(), [](const Entry& a, const Entry& b) {
+    if (a.wait.total_us != b.wait.total_us)
+      return a.wait.total_us > b.wait.total_us;
+    if (a.contended != b.contended)
+      return a.contended > b.contended;
+    return a.name < b.name;
+  });
+  return ret;
+}
+
+std::string LockProfiler::FormatReport() {
+  std::string ret = util::StringPrintf(
+      "Lock contention (times sampled 1 in %u acquisitions):\n"
+      "%-32s %12s %10s %12s %10s %10s %10s %10s\n",
+      kSampleRate, "name", "acquisitions", "contended", "total wait",
+      "wait p50", "wait p99", "hold p50", "hold p99");
+  for (const Entry& entry : GetReport()) {
+    ret += util::StringPrintf(
+        "%-32s %12llu %10llu %10.3fms %8.3fms %8.3fms %8.3fms %8.3fms\n",
+        entry.name.c_str(),
+        static_cast<unsigned long long>(entry.acquisitions),  // NOLINT
+        static_cast<unsigned long long>(entry.contended),  // NOLINT
+        entry.EstimatedTotalWaitMs(), entry.wait.PercentileMs(50),
+        entry.wait.PercentileMs(99), entry.hold.PercentileMs(50),
+        entry.hold.PercentileMs(99));
+  }
+  return ret;
+}
+
+}  // namespace shaka
@@ -0,0 +1,221 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SHAKA_EMBEDDED_DEBUG_LOCK_PROFILER_H_
+#define SHAKA_EMBEDDED_DEBUG_LOCK_PROFILER_H_
+
+#include <stdint.h>
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "shaka/pipeline_metrics.h"
+#include "src/util/atomic_histogram.h"
+#include "src/util/macros.h"
+
+namespace shaka {
+
+/**
+ * Contention statistics for every mutex with a given name.  The counters are
+ * exact; the wait and hold times are only recorded for a sample of the
+ * acquisitions.
+ */
+class LockStats final {
+ public:
+  using TimePoint = util::AtomicHistogram::TimePoint;
+
+  explicit LockStats(const std::string& name);
+  ~LockStats();
+
+  NON_COPYABLE_OR_MOVABLE_TYPE(LockStats);
+
+  const std::string& name() const {
+    return name_;
+  }
+
+  /** Called once the lock was acquired without waiting. */
+  void OnAcquired(bool sampled) {
+    acquisitions_.fetch_add(1, std::memory_order_relaxed);
+    if (sampled)
+      wait_times_.Record(0);
+  }
+
+  /** Called once the lock was acquired after waiting since |start|. */
+  void OnAcquiredAfterWait(bool sampled, TimePoint start) {
+    acquisitions_.fetch_add(1, std::memory_order_relaxed);
+    contended_.fetch_add(1, std::memory_order_relaxed);
+    if (sampled)
+      wait_times_.RecordSince(start);
+  }
+
+  /** Called when releasing a sampled lock that was acquired at |start|. */
+  void OnReleased(TimePoint start) {
+    hold_times_.RecordSince(start);
+  }
+
+  uint64_t acquisitions() const {
+    return acquisitions_.load(std::memory_order_relaxed);
+  }
+  uint64_t contended() const {
+    return contended_.load(std::memory_order_relaxed);
+  }
+  const util::AtomicHistogram& wait_times() const {
+    return wait_times_;
+  }
+  const util::AtomicHistogram& hold_times() const {
+    return hold_times_;
+  }
+
+ private:
+  const std::string name_;
+  std::atomic<uint64_t> acquisitions_;
+  std::atomic<uint64_t> contended_;
+  util::AtomicHistogram wait_times_;
+  util::AtomicHistogram hold_times_;
+};
+
+/**
+ * Collects the LockStats for all the named mutexes.  This is used by the
+ * Mutex types when built with the |profile_lock_contention| GN argument, but
+ * it can be used directly by any ProfiledMutex.
+ */
+class LockProfiler final {
+ public:
+  /** One in this many acquisitions (per thread) has its times recorded. */
+  static constexpr const uint32_t kSampleRate = 16;
+
+  struct Entry {
+    std::string name;
+    uint64_t acquisitions;
+    /** The number of acquisitions that had to wait for another thread. */
+    uint64_t contended;
+    /** The sampled wait times, including acquisitions that didn't wait. */
+    LatencyHistogram wait;
+    /** The sampled hold times, only for exclusive locks. */
+    LatencyHistogram hold;
+
+    /** @return An estimate of the total time spent waiting, in ms. */
+    double EstimatedTotalWaitMs() const {
+      return wait.total_us / 1000.0 * kSampleRate;
+    }
+  };
+
+  /**
+   * Gets the stats object for the given mutex name.  All mutexes with the same
+   * name share the same object.  The returned object is never freed.
+   */
+  static LockStats* GetStats(const std::string& name);
+
+  /** @return Whether the next acquisition on this thread should be sampled. */
+  static bool ShouldSample();
+
+  /** @return The stats of every mutex, sorted by total wait time. */
+  static std::vector<Entry> GetReport();
+
+  /** @return A human-readable table of the stats, sorted by total wait. */
+  static std::string FormatReport();
+};
+
+/**
+ * A wrapper around a mutex that records contention statistics to the
+ * LockProfiler.  This implements the same Mutex concepts as _Mutex so it can
+ * be used in std::unique_lock<T> and std::condition_variable_any.
+ *
+ * Hold times are only recorded for exclusive locks since there can be any
+ * number of threads holding a shared lock.
+ */
+template <typename _Mutex>
+class ProfiledMutex {
+ public:
+  using TimePoint = LockStats::TimePoint;
+
+  explicit ProfiledMutex(const std::string& name)
+      : stats_(LockProfiler::GetStats(name)), hold_sampled_(false) {}
+
+  NON_COPYABLE_OR_MOVABLE_TYPE(ProfiledMutex);
+
+  void lock() {
+    const bool sampled = LockProfiler::ShouldSample();
+    if (mutex_.try_lock()) {
+      stats_->OnAcquired(sampled);
+    } else {
+      const TimePoint start = sampled ? util::AtomicHistogram::Now()
+                                      : TimePoint();
+      mutex_.lock();
+      stats_->OnAcquiredAfterWait(sampled, start);
+    }
+    StartHold(sampled);
+  }
+
+  bool try_lock() {
+    if (!mutex_.try_lock())
+      return false;
+    const bool sampled = LockProfiler::ShouldSample();
+    stats_->OnAcquired(sampled);
+    StartHold(sampled);
+    return true;
+  }
+
+  void unlock() {
+    // Copy the fields before unlocking since another thread can change them
+    // once we release the lock.
+    const bool sampled = hold_sampled_;
+    const TimePoint start = hold_start_;
+    mutex_.unlock();
+    if (sampled)
+      stats_->OnReleased(start);
+  }
+
+
+  void lock_shared() {
+    const bool sampled = LockProfiler::ShouldSample();
+    if (mutex_.try_lock_shared()) {
+      stats_->OnAcquired(sampled);
+    } else {
+      const TimePoint start = sampled ? util::AtomicHistogram::Now()
+                                      : TimePoint();
+      mutex_.lock_shared();
+      stats_->OnAcquiredAfterWait(sampled, start);
+    }
+  }
+
+  bool try_lock_shared() {
+    if (!mutex_.try_lock_shared())
+      return false;
+    stats_->OnAcquired(LockProfiler::ShouldSample());
+    return true;
+  }
+
+  void unlock_shared() {
+    mutex_.unlock_shared();
+  }
+
+ private:
+  void StartHold(bool sampled) {
+    // Only the thread holding the exclusive lock touches these.
+    hold_sampled_ = sampled;
+    if (sampled)
+      hold_start_ = util::AtomicHistogram::Now();
+  }
+
+  _Mutex mutex_;
+  LockStats* const stats_;
+  bool hold_sampled_;
+  TimePoint hold_start_;
+};
+
+}  // namespace shaka
+
+#endif  // SHAKA_EMBEDDED_DEBUG_LOCK_PROFILER_H_
@@ -27,6 +27,10 @@
 #include "src/debug/waiting_tracker.h"
 #include "src/util/shared_lock.h"
 
+#ifdef PROFILE_LOCK_CONTENTION
+#  include "src/debug/lock_profiler.h"
+#endif
+
 namespace shaka {
 
 /**
@@ -148,9 +152,12 @@ class DebugMutex : public Waitable {
   std::unordered_set<std::thread::id> shared_locked_by_;
 };
 
-#ifdef DEBUG_DEADLOCKS
+#if defined(DEBUG_DEADLOCKS)
 using Mutex = DebugMutex<std::mutex>;
 using SharedMutex = DebugMutex<util::shared_mutex>;
+#elif defined(PROFILE_LOCK_CONTENTION)
+using Mutex = ProfiledMutex<std::mutex>;
+using SharedMutex = ProfiledMutex<util::shared_mutex>;
 #else
 class Mutex final : public std::mutex {
  public:
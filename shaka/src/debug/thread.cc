@@ -18,6 +18,8 @@
 
 #include <utility>
 
+#include "src/core/js_manager_impl.h"
+#include "src/debug/trace_recorder.h"
 #include "src/debug/waiting_tracker.h"
 #include "src/util/utils.h"
 
@@ -25,7 +27,8 @@ namespace shaka {
 
 namespace {
 
-void ThreadMain(const std::string& name, std::function<void()> callback) {
+void ThreadMain(const std::string& name, JsManagerImpl* manager,
+                std::function<void()> callback) {
   DCHECK_LT(name.size(), 16u) << "Name too long: " << name;
 #if defined(OS_MAC) || defined(OS_IOS)
   pthread_setname_np(name.c_str());
@@ -34,17 +37,21 @@ void ThreadMain(const std::string& name, std::function<void()> callback) {
 #else
 #  error "Not implemented for Windows"
 #endif
+  TraceRecorder::SetThreadName(name);
 
 #ifdef DEBUG_DEADLOCKS
   util::Finally scope(&WaitingTracker::ThreadExit);
 #endif
+  JsManagerImpl::ThreadScope manager_scope(manager);
   callback();
 }
 
 }  // namespace
 
 Thread::Thread(const std::string& name, std::function<void()> callback)
-    : name_(name), thread_(&ThreadMain, name, std::move(callback)) {
+    : name_(name),
+      thread_(&ThreadMain, name, JsManagerImpl::ThreadInstanceOrNull(),
+              std::move(callback)) {
 #ifdef DEBUG_DEADLOCKS
   original_id_ = thread_.get_id();
   WaitingTracker::AddThread(this);
@@ -23,6 +23,10 @@ namespace shaka {
 
 class Thread final {
  public:
+  /**
+   * Creates a new thread that runs the given callback.  If the current thread
+   * is bound to a JsManager, the new thread is bound to the same manager.
+   */
   Thread(const std::string& name, std::function<void()> callback);
   Thread(const Thread&) = delete;
   Thread(Thread&&) = delete;
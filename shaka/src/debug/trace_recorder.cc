@@ -0,0 +1,311 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/debug/trace_recorder.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace shaka {
+
+namespace {
+
+struct TraceEvent {
+  char name[TraceRecorder::kMaxNameSize + 1];
+  uint64_t start_us;
+  uint64_t duration_us;
+  /** The Chrome trace-event phase, 'X' for complete events, 'i' for instant. */
+  char phase;
+};
+
+/**
+ * Stores a TraceEvent as atomic words.  Other threads can copy the event while
+ * the owning thread overwrites it, so every access has to be atomic; the
+ * caller detects torn copies using the buffer's write count.
+ */
+struct EventSlot {
+  static constexpr const size_t kWordCount =
+      (sizeof(TraceEvent) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+  void Store(const TraceEvent& event) {
+    uint64_t temp[kWordCount] = {};
+    memcpy(temp, &event, sizeof(event));
+    for (size_t i = 0; i < kWordCount; i++)
+      words[i].store(temp[i], std::memory_order_relaxed);
+  }
+
+  void Load(TraceEvent* event) const {
+    uint64_t temp[kWordCount];
+    for (size_t i = 0; i < kWordCount; i++)
+      temp[i] = words[i].load(std::memory_order_relaxed);
+    memcpy(event, temp, sizeof(*event));
+  }
+
+  std::atomic<uint64_t> words[kWordCount];
+};
+
+/**
+ * Holds the events for a single thread.  Only the owning thread writes events;
+ * any thread can read them.  This is owned by both the thread and the global
+ * list so it outlives the thread.
+ */
+struct ThreadBuffer {
+  ThreadBuffer(uint32_t id, const std::string& name)
+      : id(id), name(name), write_count(0), start_count(0) {}
+
+  const uint32_t id;
+  const std::string name;
+  EventSlot events[TraceRecorder::kEventsPerThread];
+  /** The total number of events written to this buffer. */
+  std::atomic<uint64_t> write_count;
+  /** The index of the first event to export; updated by Clear(). */
+  std::atomic<uint64_t> start_count;
+};
+
+struct ThreadBufferList {
+  // This uses a plain mutex since the shaka::Mutex may record trace events.
+  std::mutex mutex;
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+  uint32_t next_id = 1;
+};
+
+ThreadBufferList* GetBufferList() {
+  // Leak the list so it can be used while other static objects are destroyed.
+  static ThreadBufferList* list = new ThreadBufferList;
+  return list;
+}
+
+thread_local std::shared_ptr<ThreadBuffer> thread_buffer;
+thread_local std::string thread_name;
+
+ThreadBuffer* GetThreadBuffer() {
+  if (!thread_buffer) {
+    ThreadBufferList* list = GetBufferList();
+    std::unique_lock<std::mutex> lock(list->mutex);
+    const uint32_t id = list->next_id++;
+    thread_buffer.reset(new ThreadBuffer(
+        id, thread_name.empty() ? "Thread " + std::to_string(id)
+                                : thread_name));
+    list->buffers.push_back(thread_buffer);
+  }
+  return thread_buffer.get();
+}
+
+void AddEvent(const char* name, size_t name_size, uint64_t start_us,
+              uint64_t duration_us, char phase) {
+  ThreadBuffer* buffer = GetThreadBuffer();
+  // Only this thread writes to the buffer, so we don't need to synchronize the
+  // count; the release store publishes the event to readers.
+  const uint64_t count = buffer->write_count.load(std::memory_order_relaxed);
+  TraceEvent event;
+  name_size = std::min(name_size, TraceRecorder::kMaxNameSize);
+  memcpy(event.name, name, name_size);
+  event.name[name_size] = '\0';
+  event.start_us = start_us;
+  event.duration_us = duration_us;
+  event.phase = phase;
+  // This pairs with the fence in AppendEvents.  A reader that sees any part of
+  // this event will also see the count from the last event, so it knows the
+  // old event in this slot may be torn.
+  std::atomic_thread_fence(std::memory_order_release);
+  buffer->events[count % TraceRecorder::kEventsPerThread].Store(event);
+  buffer->write_count.store(count + 1, std::memory_order_release);
+}
+
+void AppendJsonString(const char* str, std::string* out) {
+  out->push_back('"');
+  for (const char* it = str; *it; it++) {
+    const char c = *it;
+    if (c == '"' || c == '\\') {
+      out->push_back('\\');
+      out->push_back(c);
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      char buffer[8];
+      snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+      out->append(buffer);
+    } else {
+      out->push_back(c);
+    }
+  }
+  out->push_back('"');
+}
+
+void AppendEvents(const ThreadBuffer& buffer, bool* is_first,
+                  std::string* out) {
+  const uint64_t end = buffer.write_count.load(std::memory_order_acquire);
+  uint64_t begin = buffer.start_count.load(std::memory_order_acquire);
+  if (end > TraceRecorder::kEventsPerThread)
+    begin = std::max(begin, end - TraceRecorder::kEventsPerThread);
+  if (begin >= end)
+    return;
+
+  std::vector<TraceEvent> events(end - begin);
+  for (uint64_t i = begin; i < end; i++)
+    buffer.events[i % TraceRecorder::kEventsPerThread].Load(&events[i - begin]);
+
+  // The owning thread may have overwritten some of the events while we were
+  // copying them.  The event it is writing now replaces the event that is
+  // kEventsPerThread before it, so drop anything at or before that.  The fence
+  // keeps the copies above from being reordered after the count is read, like
+  // util::DoubleBuffer::Load.
+  std::atomic_thread_fence(std::memory_order_acquire);
+  const uint64_t new_end = buffer.write_count.load(std::memory_order_relaxed);
+  uint64_t valid_begin = begin;
+  if (new_end >= TraceRecorder::kEventsPerThread) {
+    valid_begin = std::max(valid_begin,
+                           new_end - TraceRecorder::kEventsPerThread + 1);
+  }
+
+  char numbers[96];
+  for (uint64_t i = valid_begin; i < end; i++) {
+    const TraceEvent& event = events[i - begin];
+    out->append(*is_first ? "\n" : ",\n");
+    *is_first = false;
+    out->append("{\"name\":");
+    AppendJsonString(event.name, out);
+    if (event.phase == 'X') {
+      snprintf(numbers, sizeof(numbers),
+               ",\"ph\":\"X\",\"ts\":%llu,\"dur\":%llu,\"pid\":1,\"tid\":%u}",
+               static_cast<unsigned long long>(event.start_us),  // NOLINT
+               static_cast<unsigned long long>(event.duration_us),  // NOLINT
+               buffer.id);
+    } else {
+      snprintf(numbers, sizeof(numbers),
+               ",\"ph\":\"i\",\"s\":\"t\",\"ts\":%llu,\"pid\":1,\"tid\":%u}",
+               static_cast<unsigned long long>(event.start_us),  // NOLINT
+               buffer.id);
+    }
+    out->append(numbers);
+  }
+}
+
+constexpr const size_t EventSlot::kWordCount;
+
+}  // namespace
+
+constexpr const size_t TraceRecorder::kMaxNameSize;
+constexpr const size_t TraceRecorder::kEventsPerThread;
+std::atomic<bool> TraceRecorder::enabled_{false};
+
+// static
+void TraceRecorder::SetEnabled(bool enabled) {
+  enabled_.store(enabled, std::memory_order_relaxed);
+}
+
+// static
+void TraceRecorder::Clear() {
+  ThreadBufferList* list = GetBufferList();
+  std::unique_lock<std::mutex> lock(list->mutex);
+  for (auto it = list->buffers.begin(); it != list->buffers.end();) {
+    if (it->use_count() == 1) {
+      // The thread has exited, so nothing else will be recorded here.
+      it = list->buffers.erase(it);
+    } else {
+      (*it)->start_count.store(
+          (*it)->write_count.load(std::memory_order_acquire),
+          std::memory_order_release);
+      ++it;
+    }
+  }
+}
+
+// static
+void TraceRecorder::SetThreadName(const std::string& name) {
+  thread_name = name;
+}
+
+// static
+uint64_t TraceRecorder::NowMicros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// static
+void TraceRecorder::AddCompleteEvent(const char* name, uint64_t start_us) {
+  if (!IsEnabled())
+    return;
+  const uint64_t now = NowMicros();
+  AddEvent(name, strlen(name), start_us, now - start_us, 'X');
+}
+
+// static
+void TraceRecorder::AddInstantEvent(const char* name) {
+  if (!IsEnabled())
+    return;
+  AddEvent(name, strlen(name), NowMicros(), 0, 'i');
+}
+
+// static
+std::string TraceRecorder::ExportJson() {
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+  {
+    ThreadBufferList* list = GetBufferList();
+    std::unique_lock<std::mutex> lock(list->mutex);
+    buffers = list->buffers;
+  }
+
+  std::string ret = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  bool is_first = true;
+  for (auto& buffer : buffers) {
+    ret.append(is_first ? "\n" : ",\n");
+    is_first = false;
+    ret.append("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":");
+    ret.append(std::to_string(buffer->id));
+    ret.append(",\"args\":{\"name\":");
+    AppendJsonString(buffer->name.c_str(), &ret);
+    ret.append("}}");
+
+    AppendEvents(*buffer, &is_first, &ret);
+  }
+  ret.append("\n]}\n");
+  return ret;
+}
+
+
+ScopedTrace::ScopedTrace(const char* name) : start_us_(0), active_(false) {
+  if (TraceRecorder::IsEnabled())
+    Start(name, strlen(name));
+}
+
+ScopedTrace::ScopedTrace(const std::string& name)
+    : start_us_(0), active_(false) {
+  if (TraceRecorder::IsEnabled())
+    Start(name.c_str(), name.size());
+}
+
+ScopedTrace::~ScopedTrace() {
+  // Record the event even if recording was disabled while this was running so
+  // the span isn't lost.
+  if (active_) {
+    AddEvent(name_, strlen(name_), start_us_,
+             TraceRecorder::NowMicros() - start_us_, 'X');
+  }
+}
+
+void ScopedTrace::Start(const char* name, size_t size) {
+  size = std::min(size, TraceRecorder::kMaxNameSize);
+  memcpy(name_, name, size);
+  name_[size] = '\0';
+  start_us_ = TraceRecorder::NowMicros();
+  active_ = true;
+}
+
+}  // namespace shaka
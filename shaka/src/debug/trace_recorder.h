@@ -0,0 +1,107 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SHAKA_EMBEDDED_DEBUG_TRACE_RECORDER_H_
+#define SHAKA_EMBEDDED_DEBUG_TRACE_RECORDER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <string>
+
+#include "src/util/macros.h"
+
+namespace shaka {
+
+/**
+ * Records timed events from any thread so they can be viewed using Chrome's
+ * about:tracing (or Perfetto).  Each thread writes to its own fixed-size ring
+ * buffer, so recording an event never takes a lock; once a buffer is full, the
+ * oldest events for that thread are overwritten.
+ *
+ * Recording is disabled by default.  While disabled, a ScopedTrace only costs
+ * an atomic load, so spans can be left in hot paths.
+ */
+class TraceRecorder final {
+ public:
+  /** The maximum number of characters kept for an event name. */
+  static constexpr const size_t kMaxNameSize = 47;
+  /** The number of events kept per thread. */
+  static constexpr const size_t kEventsPerThread = 4096;
+
+  static bool IsEnabled() {
+    return enabled_.load(std::memory_order_relaxed);
+  }
+
+  /** Starts or stops recording events.  This doesn't clear recorded events. */
+  static void SetEnabled(bool enabled);
+
+  /** Removes all the recorded events. */
+  static void Clear();
+
+  /**
+   * Sets the name of the current thread, which is used to label the thread in
+   * the exported trace.  This is called automatically for Thread objects.
+   */
+  static void SetThreadName(const std::string& name);
+
+  /** @return The current time, in microseconds, as used by the events. */
+  static uint64_t NowMicros();
+
+  /**
+   * Records an event that started at |start_us| and ends now.  This does
+   * nothing if recording is disabled.
+   */
+  static void AddCompleteEvent(const char* name, uint64_t start_us);
+
+  /**
+   * Records an event that has no duration (e.g. a state change).  This does
+   * nothing if recording is disabled.
+   */
+  static void AddInstantEvent(const char* name);
+
+  /**
+   * @return The recorded events in the Chrome trace-event JSON format.  This
+   *   can be called while other threads are recording events.
+   */
+  static std::string ExportJson();
+
+ private:
+  static std::atomic<bool> enabled_;
+};
+
+/**
+ * Records a span from when this object is created until it is destroyed.  The
+ * name is copied (and truncated), so it doesn't need to outlive this object.
+ */
+class ScopedTrace final {
+ public:
+  explicit ScopedTrace(const char* name);
+  explicit ScopedTrace(const std::string& name);
+  ~ScopedTrace();
+
+  NON_COPYABLE_OR_MOVABLE_TYPE(ScopedTrace);
+
+ private:
+  void Start(const char* name, size_t size);
+
+  char name_[TraceRecorder::kMaxNameSize + 1];
+  uint64_t start_us_;
+  bool active_;
+};
+
+}  // namespace shaka
+
+#endif  // SHAKA_EMBEDDED_DEBUG_TRACE_RECORDER_H_
@@ -128,7 +128,19 @@ bool ParsePssh(const Data& data, std::vector<std::string>* base64_keyids) {
   return false;
 }
 
-bool ParseAndGenerateRequest(MediaKeyInitDataType type, const Data& data,
+std::string KeyIdsToJson(const std::vector<std::string>& key_ids) {
+  std::string ids_json;
+  for (const std::string& id : key_ids) {
+    if (ids_json.empty())
+      ids_json = '"' + id + '"';
+    else
+      ids_json += R"(,")" + id + '"';
+  }
+  return '[' + ids_json + ']';
+}
+
+bool ParseAndGenerateRequest(MediaKeySessionType session_type,
+                             MediaKeyInitDataType type, const Data& data,
                              std::string* message) {
   std::vector<std::string> key_ids;
   switch (type) {
@@ -146,14 +158,12 @@ bool ParseAndGenerateRequest(MediaKeyInitDataType type, const Data& data,
       return false;
   }
 
-  std::string ids_json;
-  for (const std::string& id : key_ids) {
-    if (ids_json.empty())
-      ids_json = '"' + id + '"';
-    else
-      ids_json += R"(,")" + id + '"';
-  }
-  *message = R"({"kids":[)" + ids_json + R"(],"type":"temporary"})";
+  const char* type_str =
+      session_type == MediaKeySessionType::PersistentLicense
+          ? "persistent-license"
+          : "temporary";
+  *message = R"({"kids":)" + KeyIdsToJson(key_ids) + R"(,"type":")" +
+             type_str + R"("})";
   return true;
 }
 
@@ -247,17 +257,24 @@ void ClearKeyImplementation::CreateSessionAndGenerateRequest(
     EmePromise promise, std::function<void(const std::string&)> set_session_id,
     MediaKeySessionType session_type, MediaKeyInitDataType init_data_type,
     Data data) {
-  DCHECK(session_type == MediaKeySessionType::Temporary);
+  DCHECK(session_type == MediaKeySessionType::Temporary ||
+         session_type == MediaKeySessionType::PersistentLicense);
 
   std::unique_lock<std::mutex> lock(mutex_);
 
-  const std::string session_id = std::to_string(++cur_session_id_);
+  // Persistent sessions can be loaded in later runs, so they need IDs that
+  // won't be reused.
+  const std::string session_id =
+      session_type == MediaKeySessionType::PersistentLicense
+          ? ClearKeyLicenseStore::CreateSessionId()
+          : std::to_string(++cur_session_id_);
   // The indexer will create a new object since it doesn't exist.
   Session* session = &sessions_[session_id];
   DCHECK(!session->callable);
+  session->type = session_type;
 
   std::string message;
-  if (!ParseAndGenerateRequest(init_data_type, data, &message)) {
+  if (!ParseAndGenerateRequest(session_type, init_data_type, data, &message)) {
     promise.Reject(ExceptionType::TypeError,
                    "Invalid initialization data given.");
     return;
@@ -271,31 +288,118 @@ void ClearKeyImplementation::CreateSessionAndGenerateRequest(
   promise.Resolve();
 }
 
-void ClearKeyImplementation::Load(const std::string& /* session_id */,
+void ClearKeyImplementation::Load(const std::string& session_id,
                                   EmePromise promise) {
-  promise.Reject(ExceptionType::NotSupported,
-                 "Clear-key doesn't support persistent licences.");
+  if (!ClearKeyLicenseStore::IsValidSessionId(session_id)) {
+    promise.Reject(ExceptionType::TypeError, "Invalid session ID given.");
+    return;
+  }
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (sessions_.count(session_id) != 0) {
+      promise.Reject(ExceptionType::QuotaExceeded,
+                     "The given session is already loaded.");
+      return;
+    }
+  }
+
+  std::vector<ClearKeyLicenseStore::Key> keys;
+  {
+    std::unique_lock<std::mutex> store_lock(store_mutex_);
+    ClearKeyLicenseStore* store = GetStore();
+    if (!store->Contains(session_id)) {
+      promise.ResolveWith(false);
+      return;
+    }
+    if (!store->Load(session_id, &keys)) {
+      promise.Reject(ExceptionType::InvalidState,
+                     "Unable to load the stored license.");
+      return;
+    }
+  }
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  // Check again since the lock wasn't held while loading.
+  if (sessions_.count(session_id) != 0) {
+    promise.Reject(ExceptionType::QuotaExceeded,
+                   "The given session is already loaded.");
+    return;
+  }
+  Session* session = &sessions_[session_id];
+  session->type = MediaKeySessionType::PersistentLicense;
+  for (auto& key : keys)
+    session->keys.emplace_back(std::move(key.key_id), std::move(key.key));
+  helper_->OnKeyStatusChange(session_id);
+  promise.ResolveWith(true);
 }
 
 void ClearKeyImplementation::Update(const std::string& session_id,
                                     EmePromise promise, Data data) {
-  std::unique_lock<std::mutex> lock(mutex_);
+  bool releasing;
+  bool persistent;
+  std::vector<ClearKeyLicenseStore::Key> stored_keys;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (sessions_.count(session_id) == 0) {
+      promise.Reject(ExceptionType::InvalidState,
+                     "Unable to find given session ID.");
+      return;
+    }
+    const Session& session = sessions_.at(session_id);
+    if (!session.callable) {
+      promise.Reject(ExceptionType::InvalidState, "Not expecting an update.");
+      return;
+    }
 
+    releasing = session.releasing;
+    persistent = session.type == MediaKeySessionType::PersistentLicense;
+    if (persistent && !releasing) {
+      for (const Session::Key& key : session.keys)
+        stored_keys.push_back({key.key_id, key.key});
+    }
+  }
+
+  // The lock isn't held while using the store, so Decrypt() isn't blocked.
+  std::list<Session::Key> keys;
+  if (releasing) {
+    // This is the acknowledgement of the license-release message, so the
+    // stored license can be deleted now.
+    std::unique_lock<std::mutex> store_lock(store_mutex_);
+    if (!GetStore()->Remove(session_id)) {
+      promise.Reject(ExceptionType::InvalidState,
+                     "Unable to delete the stored license.");
+      return;
+    }
+  } else {
+    if (!ParseResponse(data, &keys)) {
+      promise.Reject(ExceptionType::InvalidState, "Invalid response data.");
+      return;
+    }
+
+    if (persistent) {
+      for (const Session::Key& key : keys)
+        stored_keys.push_back({key.key_id, key.key});
+      std::unique_lock<std::mutex> store_lock(store_mutex_);
+      if (!GetStore()->Save(session_id, stored_keys)) {
+        promise.Reject(ExceptionType::QuotaExceeded,
+                       "Unable to store the license.");
+        return;
+      }
+    }
+  }
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  // The session may have been closed while the lock wasn't held.
   if (sessions_.count(session_id) == 0) {
     promise.Reject(ExceptionType::InvalidState,
                    "Unable to find given session ID.");
     return;
   }
   Session* session = &sessions_.at(session_id);
-
-  if (!session->callable) {
-    promise.Reject(ExceptionType::InvalidState, "Not expecting an update.");
-    return;
-  }
-
-  std::list<Session::Key> keys;
-  if (!ParseResponse(data, &keys)) {
-    promise.Reject(ExceptionType::InvalidState, "Invalid response data.");
+  if (releasing) {
+    session->callable = false;
+    session->releasing = false;
+    promise.Resolve();
     return;
   }
 
@@ -313,10 +417,35 @@ void ClearKeyImplementation::Close(const std::string& session_id,
   promise.Resolve();
 }
 
-void ClearKeyImplementation::Remove(const std::string& /* session_id */,
+void ClearKeyImplementation::Remove(const std::string& session_id,
                                     EmePromise promise) {
-  promise.Reject(ExceptionType::NotSupported,
-                 "Clear-key doesn't support persistent licences.");
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  if (sessions_.count(session_id) == 0) {
+    promise.Reject(ExceptionType::InvalidState,
+                   "Unable to find given session ID.");
+    return;
+  }
+  Session* session = &sessions_.at(session_id);
+
+  std::vector<std::string> key_ids;
+  for (const Session::Key& key : session->keys) {
+    key_ids.emplace_back(js::Base64::EncodeUrl(
+        ByteString(key.key_id.begin(), key.key_id.end())));
+  }
+  session->keys.clear();
+  helper_->OnKeyStatusChange(session_id);
+
+  if (session->type == MediaKeySessionType::PersistentLicense) {
+    // The stored license is deleted once the release is acknowledged.
+    session->callable = true;
+    session->releasing = true;
+    const std::string message = R"({"kids":)" + KeyIdsToJson(key_ids) + "}";
+    helper_->OnMessage(session_id, MediaKeyMessageType::LicenseRelease,
+                       reinterpret_cast<const uint8_t*>(message.c_str()),
+                       message.size());
+  }
+  promise.Resolve();
 }
 
 DecryptStatus ClearKeyImplementation::Decrypt(
@@ -401,6 +530,13 @@ DecryptStatus ClearKeyImplementation::Decrypt(
   return DecryptStatus::Success;
 }
 
+ClearKeyLicenseStore* ClearKeyImplementation::GetStore() {
+  if (!store_)
+    store_.reset(new ClearKeyLicenseStore(helper_->DataPathPrefix(),
+                                          helper_->StorageKey()));
+  return store_.get();
+}
+
 void ClearKeyImplementation::LoadKeyForTesting(std::vector<uint8_t> key_id,
                                                std::vector<uint8_t> key) {
   std::unique_lock<std::mutex> lock(mutex_);
@@ -16,6 +16,7 @@
 #define SHAKA_EMBEDDED_EME_CLEARKEY_FACTORY_H_
 
 #include <list>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <unordered_map>
@@ -23,6 +24,7 @@
 
 #include "shaka/eme/implementation.h"
 #include "shaka/eme/implementation_helper.h"
+#include "src/eme/clearkey_license_store.h"
 
 #define AES_BLOCK_SIZE 16u
 
@@ -31,6 +33,7 @@ namespace shaka {
 namespace media {
 class MediaProcessorIntegration;
 class MediaProcessorDecryptIntegration;
+class MediaProcessorBenchmark;
 }  // namespace media
 
 namespace eme {
@@ -91,17 +94,32 @@ class ClearKeyImplementation final : public Implementation {
     Session& operator=(const Session&) = delete;
 
     std::list<Key> keys;
+    MediaKeySessionType type = MediaKeySessionType::Temporary;
     bool callable = false;
+    // Whether a license-release message was sent and we are waiting for the
+    // acknowledgement before deleting the stored license.
+    bool releasing = false;
   };
 
   friend class ClearKeyImplementationTest;
   friend class media::MediaProcessorIntegration;
   friend class media::MediaProcessorDecryptIntegration;
+  friend class media::MediaProcessorBenchmark;
 
   void LoadKeyForTesting(std::vector<uint8_t> key_id, std::vector<uint8_t> key);
 
+  /**
+   * Creates the license store the first time it is used.  This must be called
+   * with |store_mutex_| held.
+   */
+  ClearKeyLicenseStore* GetStore();
+
   mutable std::mutex mutex_;
   std::unordered_map<std::string, Session> sessions_;
+  // The store does file I/O and AES, so it has its own lock and is used
+  // without holding |mutex_|, which Decrypt() needs on the media thread.
+  std::mutex store_mutex_;
+  std::unique_ptr<ClearKeyLicenseStore> store_;
   ImplementationHelper* helper_;
   uint32_t cur_session_id_;
 };
@@ -21,7 +21,8 @@ namespace eme {
 
 bool ClearKeyImplementationFactory::SupportsSessionType(
     MediaKeySessionType type) const {
-  return type == MediaKeySessionType::Temporary;
+  return type == MediaKeySessionType::Temporary ||
+         type == MediaKeySessionType::PersistentLicense;
 }
 
 bool ClearKeyImplementationFactory::SupportsInitDataType(
@@ -46,7 +47,7 @@ MediaKeysRequirement ClearKeyImplementationFactory::DistinctiveIdentifier()
 }
 
 MediaKeysRequirement ClearKeyImplementationFactory::PersistentState() const {
-  return MediaKeysRequirement::NotAllowed;
+  return MediaKeysRequirement::Optional;
 }
 
 Implementation* ClearKeyImplementationFactory::CreateImplementation(
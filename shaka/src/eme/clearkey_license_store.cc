@@ -0,0 +1,284 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/eme/clearkey_license_store.h"
+
+#include <glog/logging.h>
+#include <string.h>
+
+#include <random>
+#include <utility>
+
+#include "src/util/buffer_reader.h"
+#include "src/util/crypto.h"
+#include "src/util/decryptor.h"
+#include "src/util/utils.h"
+
+namespace shaka {
+namespace eme {
+
+namespace {
+
+// A license file contains:
+//   4 magic ('CKLS')
+//   1 version
+//   16 IV
+//   The rest is encrypted:
+//     16 MD5 hash of the remaining data
+//     4 key count
+//     for (key count)
+//       16 key ID
+//       16 key
+constexpr const uint8_t kMagic[] = {'C', 'K', 'L', 'S'};
+constexpr const uint8_t kVersion = 1;
+constexpr const size_t kKeySize = 16;
+constexpr const size_t kHashSize = 16;
+constexpr const size_t kHeaderSize = sizeof(kMagic) + 1 + AES_BLOCK_SIZE;
+
+constexpr const char kStorageKeyFile[] = "storage.key";
+constexpr const char kLicenseFileSuffix[] = ".license";
+constexpr const size_t kSessionIdSize = 16;
+
+std::vector<uint8_t> RandomBytes(size_t size) {
+  std::random_device random;
+  std::vector<uint8_t> ret(size);
+  for (uint8_t& byte : ret)
+    byte = static_cast<uint8_t>(random());
+  return ret;
+}
+
+/** Encrypts or decrypts the given data in-place; these are the same in CTR. */
+bool ApplyCipher(const std::vector<uint8_t>& key,
+                 const std::vector<uint8_t>& iv, uint8_t* data, size_t size) {
+  util::Decryptor cipher(EncryptionScheme::AesCtr, key, iv);
+  return cipher.Decrypt(data, size, data);
+}
+
+void AppendUint32(uint32_t value, std::vector<uint8_t>* out) {
+  out->push_back(static_cast<uint8_t>(value >> 24));
+  out->push_back(static_cast<uint8_t>(value >> 16));
+  out->push_back(static_cast<uint8_t>(value >> 8));
+  out->push_back(static_cast<uint8_t>(value));
+}
+
+}  // namespace
+
+ClearKeyLicenseStore::ClearKeyLicenseStore(
+    const std::string& directory, const std::vector<uint8_t>& storage_key)
+    : directory_(directory), storage_key_(storage_key) {}
+
+ClearKeyLicenseStore::~ClearKeyLicenseStore() {}
+
+// static
+std::string ClearKeyLicenseStore::CreateSessionId() {
+  const std::vector<uint8_t> id = RandomBytes(kSessionIdSize);
+  return util::ToHexString(id.data(), id.size());
+}
+
+// static
+bool ClearKeyLicenseStore::IsValidSessionId(const std::string& session_id) {
+  // This is also used as a file name, so this needs to be strict.
+  if (session_id.size() != kSessionIdSize * 2)
+    return false;
+  for (char c : session_id) {
+    if (!(c >= '0' && c <= '9') && !(c >= 'A' && c <= 'F'))
+      return false;
+  }
+  return true;
+}
+
+bool ClearKeyLicenseStore::Contains(const std::string& session_id) const {
+  return IsValidSessionId(session_id) &&
+         file_system_.FileExists(GetPath(session_id));
+}
+
+bool ClearKeyLicenseStore::Save(const std::string& session_id,
+                                const std::vector<Key>& keys) {
+  DCHECK(IsValidSessionId(session_id));
+  std::vector<uint8_t> storage_key;
+  if (!GetStorageKey(/* create */ true, &storage_key))
+    return false;
+
+  std::vector<uint8_t> payload;
+  payload.reserve(4 + keys.size() * kKeySize * 2);
+  AppendUint32(static_cast<uint32_t>(keys.size()), &payload);
+  for (const Key& key : keys) {
+    DCHECK_EQ(kKeySize, key.key_id.size());
+    DCHECK_EQ(kKeySize, key.key.size());
+    payload.insert(payload.end(), key.key_id.begin(), key.key_id.end());
+    payload.insert(payload.end(), key.key.begin(), key.key.end());
+  }
+
+  const std::vector<uint8_t> iv = RandomBytes(AES_BLOCK_SIZE);
+  const std::vector<uint8_t> hash =
+      util::HashData(payload.data(), payload.size());
+  std::vector<uint8_t> file(kMagic, kMagic + sizeof(kMagic));
+  file.push_back(kVersion);
+  file.insert(file.end(), iv.begin(), iv.end());
+  file.insert(file.end(), hash.begin(), hash.end());
+  file.insert(file.end(), payload.begin(), payload.end());
+  if (!ApplyCipher(storage_key, iv, file.data() + kHeaderSize,
+                   file.size() - kHeaderSize)) {
+    return false;
+  }
+
+  // Write to a temporary file and rename it into place so a crash while
+  // writing doesn't leave a corrupt license in place of the old one.
+  const std::string path = GetPath(session_id);
+  const std::string temp_path = path + "." + CreateSessionId() + ".tmp";
+  if (!file_system_.CreateDirectory(directory_) ||
+      !file_system_.WriteFile(temp_path, file)) {
+    LOG(ERROR) << "Unable to write license file for session " << session_id;
+    if (file_system_.FileExists(temp_path) &&
+        !file_system_.DeleteFile(temp_path)) {
+      LOG(WARNING) << "Unable to delete temporary file " << temp_path;
+    }
+    return false;
+  }
+  if (!file_system_.RenameFile(temp_path, path)) {
+    LOG(ERROR) << "Unable to write license file for session " << session_id;
+    if (!file_system_.DeleteFile(temp_path))
+      LOG(WARNING) << "Unable to delete temporary file " << temp_path;
+    return false;
+  }
+  return true;
+}
+
+bool ClearKeyLicenseStore::Load(const std::string& session_id,
+                                std::vector<Key>* keys) {
+  if (!IsValidSessionId(session_id))
+    return false;
+
+  std::vector<uint8_t> file;
+  if (!file_system_.ReadFile(GetPath(session_id), &file))
+    return false;
+  if (file.size() < kHeaderSize + kHashSize ||
+      memcmp(file.data(), kMagic, sizeof(kMagic)) != 0 ||
+      file[sizeof(kMagic)] != kVersion) {
+    LOG(ERROR) << "Invalid license file for session " << session_id;
+    return false;
+  }
+
+  std::vector<uint8_t> storage_key;
+  if (!GetStorageKey(/* create */ false, &storage_key))
+    return false;
+  const std::vector<uint8_t> iv(file.begin() + sizeof(kMagic) + 1,
+                                file.begin() + kHeaderSize);
+  if (!ApplyCipher(storage_key, iv, file.data() + kHeaderSize,
+                   file.size() - kHeaderSize)) {
+    return false;
+  }
+
+  const uint8_t* hash = file.data() + kHeaderSize;
+  const uint8_t* payload = hash + kHashSize;
+  const size_t payload_size = file.size() - kHeaderSize - kHashSize;
+  if (util::HashData(payload, payload_size) !=
+      std::vector<uint8_t>(hash, hash + kHashSize)) {
+    LOG(ERROR) << "Corrupt license file for session " << session_id;
+    return false;
+  }
+
+  util::BufferReader reader(payload, payload_size);
+  const uint32_t key_count = reader.ReadUint32();
+  if (reader.BytesRemaining() != key_count * kKeySize * 2) {
+    LOG(ERROR) << "Corrupt license file for session " << session_id;
+    return false;
+  }
+  keys->clear();
+  keys->reserve(key_count);
+  for (uint32_t i = 0; i < key_count; i++) {
+    Key key;
+    key.key_id.resize(kKeySize);
+    key.key.resize(kKeySize);
+    reader.Read(key.key_id.data(), kKeySize);
+    reader.Read(key.key.data(), kKeySize);
+    keys->emplace_back(std::move(key));
+  }
+  return true;
+}
+
+bool ClearKeyLicenseStore::Remove(const std::string& session_id) {
+  if (!Contains(session_id))
+    return true;
+  if (!file_system_.DeleteFile(GetPath(session_id))) {
+    LOG(ERROR) << "Unable to delete license file for session " << session_id;
+    return false;
+  }
+  return true;
+}
+
+std::string ClearKeyLicenseStore::GetPath(
+    const std::string& session_id) const {
+  return util::FileSystem::PathJoin(directory_,
+                                    session_id + kLicenseFileSuffix);
+}
+
+bool ClearKeyLicenseStore::GetStorageKey(bool create,
+                                         std::vector<uint8_t>* key) {
+  if (!storage_key_.empty() && storage_key_.size() != AES_BLOCK_SIZE) {
+    LOG(ERROR) << "License storage key must be " << AES_BLOCK_SIZE << " bytes";
+    return false;
+  }
+
+  if (storage_key_.empty()) {
+    const std::string path =
+        util::FileSystem::PathJoin(directory_, kStorageKeyFile);
+    if (!file_system_.FileExists(path)) {
+      if (!create) {
+        LOG(ERROR) << "License storage key doesn't exist";
+        return false;
+      }
+      if (!CreateStorageKey(path))
+        return false;
+    }
+
+    // Read the file even if we created it, since another store may have
+    // created it first.
+    std::vector<uint8_t> contents;
+    if (!file_system_.ReadFile(path, &contents) ||
+        contents.size() != AES_BLOCK_SIZE) {
+      LOG(ERROR) << "Unable to read license storage key";
+      return false;
+    }
+    storage_key_ = std::move(contents);
+  }
+
+  *key = storage_key_;
+  return true;
+}
+
+bool ClearKeyLicenseStore::CreateStorageKey(const std::string& path) {
+  // Another store (e.g. in another process) may be creating the key at the
+  // same time.  So write the key to a temporary file, then link it into place
+  // only if there isn't already a key; this way everyone uses the same key and
+  // no one reads a partially written file.
+  const std::string temp_path = path + "." + CreateSessionId() + ".tmp";
+  if (!file_system_.CreateDirectory(directory_) ||
+      !file_system_.WriteFile(temp_path, RandomBytes(AES_BLOCK_SIZE))) {
+    LOG(ERROR) << "Unable to write license storage key";
+    return false;
+  }
+
+  const bool linked = file_system_.LinkFile(temp_path, path);
+  if (!file_system_.DeleteFile(temp_path))
+    LOG(WARNING) << "Unable to delete temporary file " << temp_path;
+  if (!linked && !file_system_.FileExists(path)) {
+    LOG(ERROR) << "Unable to write license storage key";
+    return false;
+  }
+  return true;
+}
+
+}  // namespace eme
+}  // namespace shaka
@@ -0,0 +1,107 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SHAKA_EMBEDDED_EME_CLEARKEY_LICENSE_STORE_H_
+#define SHAKA_EMBEDDED_EME_CLEARKEY_LICENSE_STORE_H_
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "src/util/file_system.h"
+#include "src/util/macros.h"
+
+namespace shaka {
+namespace eme {
+
+/**
+ * Stores the keys of persistent-license clear-key sessions so they can be
+ * loaded again without a license request.  Each session is stored in its own
+ * file, encrypted with AES-CTR using a storage key.  The app can give a
+ * storage key it keeps in secure storage.  Otherwise a key is generated the
+ * first time a session is saved and kept in the same directory, which only
+ * keeps the keys from being read directly out of the license files; it isn't
+ * meant to protect them from someone with access to the directory.
+ *
+ * Each file also contains an MD5 hash of its contents.  This is only used to
+ * detect corrupt files; it isn't a MAC, so it doesn't stop someone who can
+ * write to the directory from changing the stored keys.
+ *
+ * This type is not thread-safe.
+ */
+class ClearKeyLicenseStore final {
+ public:
+  struct Key {
+    std::vector<uint8_t> key_id;
+    std::vector<uint8_t> key;
+  };
+
+  /**
+   * Creates a store that keeps its files in the given directory.
+   * @param storage_key The key to encrypt the files with.  If this is empty,
+   *   a key is generated and stored in the directory.
+   */
+  explicit ClearKeyLicenseStore(
+      const std::string& directory,
+      const std::vector<uint8_t>& storage_key = std::vector<uint8_t>());
+  ~ClearKeyLicenseStore();
+
+  NON_COPYABLE_OR_MOVABLE_TYPE(ClearKeyLicenseStore);
+
+  /**
+   * @return A new random session ID.  These are unique across runs, unlike the
+   *   IDs of temporary sessions.
+   */
+  static std::string CreateSessionId();
+
+  /** @return Whether the given string could be a persistent session ID. */
+  static bool IsValidSessionId(const std::string& session_id);
+
+  /** @return Whether a session with the given ID has been stored. */
+  bool Contains(const std::string& session_id) const;
+
+  /** Stores the given keys for the given session, replacing any old keys. */
+  MUST_USE_RESULT bool Save(const std::string& session_id,
+                            const std::vector<Key>& keys);
+
+  /**
+   * Loads the keys for the given session.  This fails if the session wasn't
+   * stored or if the file is corrupt.
+   */
+  MUST_USE_RESULT bool Load(const std::string& session_id,
+                            std::vector<Key>* keys);
+
+  /** Deletes the given session; this succeeds if it doesn't exist. */
+  MUST_USE_RESULT bool Remove(const std::string& session_id);
+
+ private:
+  std::string GetPath(const std::string& session_id) const;
+  /**
+   * Gets the key given to the constructor, or the key from the storage key
+   * file.  If |create| is true, this creates the file if it doesn't exist.
+   */
+  bool GetStorageKey(bool create, std::vector<uint8_t>* key);
+  /** Creates the storage key file unless another store already has. */
+  bool CreateStorageKey(const std::string& path);
+
+  const std::string directory_;
+  util::FileSystem file_system_;
+  std::vector<uint8_t> storage_key_;
+};
+
+}  // namespace eme
+}  // namespace shaka
+
+#endif  // SHAKA_EMBEDDED_EME_CLEARKEY_LICENSE_STORE_H_
@@ -15,9 +15,11 @@
 #include "src/js/console.h"
 
 #include <algorithm>  // std::min and std::sort
-#include <cstdio>
+#include <memory>
+#include <utility>
 #include <vector>
 
+#include "src/debug/async_log.h"
 #include "src/js/js_error.h"
 
 namespace shaka {
@@ -32,7 +34,7 @@ constexpr const size_t kMaxChildren = 20;
 
 std::string ConvertToPrettyString(Handle<JsValue> value, bool allow_long);
 
-std::string to_string(Console::LogLevel level) {
+const char* to_string(Console::LogLevel level) {
   switch (level) {
     case Console::kError:
       return "Error";
@@ -49,53 +51,7 @@ std::string to_string(Console::LogLevel level) {
 
 std::string ConvertStringToPrettyString(const std::string& string) {
   std::string buffer;
-  buffer.push_back('"');
-  for (const char c : string) {
-    // Using https://en.wikipedia.org/wiki/Escape_sequences_in_C to determine
-    // characters need to be escaped.
-    switch (c) {
-      // Alert
-      case '\a':
-        buffer += R"(\a)";
-        break;
-      // Backspace
-      case '\b':
-        buffer += R"(\b)";
-        break;
-      // Newline
-      case '\n':
-        buffer += R"(\n)";
-        break;
-      // Carriage Return
-      case '\r':
-        buffer += R"(\r)";
-        break;
-      // Horizontal Tab
-      case '\t':
-        buffer += R"(\t)";
-        break;
-      // Backslash
-      case '\\':
-        buffer += R"(\\)";
-        break;
-      // Single Quotation Mark
-      case '\'':
-        buffer += R"(\')";
-        break;
-      // Double Quotation Mark
-      case '"':
-        buffer += R"(\")";
-        break;
-      // Question Mark
-      case '\?':
-        buffer += R"(\?)";
-        break;
-      default:
-        buffer.push_back(c);
-        break;
-    }
-  }
-  buffer.push_back('"');
+  AsyncLog::AppendQuotedString(string, &buffer);
   return buffer;
 }
 
@@ -207,8 +163,8 @@ Console::~Console() {}
 
 void Console::Assert(Any cond, const CallbackArguments& arguments) const {
   if (!cond.IsTruthy()) {
-    LogReal(kError, arguments, "Assertion failed: ", 1);
-    std::printf("%s\n", JsError::GetJsStack().c_str());
+    LogReal(kError, arguments, "Assertion failed: ", 1,
+            JsError::GetJsStack());
   }
 }
 
@@ -237,18 +193,51 @@ std::string Console::ConvertToPrettyString(Handle<JsValue> value) {
 }
 
 void Console::LogReal(LogLevel level, const CallbackArguments& arguments,
-                      const char* prefix, size_t skip_count) const {
-  // TODO: Consider using glog for logging.
-  std::printf("[%s]: ", to_string(level).c_str());
+                      const char* prefix, size_t skip_count,
+                      std::string suffix) const {
+  // Only objects need to be converted here; strings and numbers are copied and
+  // formatted on the log thread.
+  std::unique_ptr<AsyncLog::Entry> entry(new AsyncLog::Entry);
+  entry->level = to_string(level);
   if (prefix)
-    std::printf("%s", prefix);
+    entry->prefix = prefix;
+  entry->suffix = std::move(suffix);
+
   const size_t length = ArgumentCount(arguments);
+  if (length > skip_count)
+    entry->arguments.reserve(length - skip_count);
   for (size_t i = skip_count; i < length; ++i) {
-    if (i > skip_count)
-      std::printf("\t");
-    std::printf("%s", ConvertToPrettyString(arguments[i]).c_str());
+    LocalVar<JsValue> value = arguments[i];
+    switch (GetValueType(value)) {
+      case JSValueType::Undefined:
+      case JSValueType::Null:
+      case JSValueType::Boolean:
+        entry->arguments.emplace_back(AsyncLog::Argument::kText,
+                                      ConvertToString(value));
+        break;
+      case JSValueType::Number:
+        entry->arguments.emplace_back(NumberFromValue(value));
+        break;
+      case JSValueType::String:
+        entry->arguments.emplace_back(AsyncLog::Argument::kString,
+                                      ConvertToString(value));
+        break;
+      default:
+        entry->arguments.emplace_back(AsyncLog::Argument::kText,
+                                      ConvertToPrettyString(value));
+        break;
+    }
+  }
+
+  // Lines are rate-limited based on the message, which is usually the first
+  // argument (e.g. the Shaka Player log prefix and message).
+  const std::string* site = &entry->prefix;
+  if (!entry->arguments.empty() &&
+      entry->arguments[0].type != AsyncLog::Argument::kNumber) {
+    site = &entry->arguments[0].text;
   }
-  std::printf("\n");
+  entry->site = AsyncLog::HashSite(entry->level, *site);
+  AsyncLog::Write(std::move(entry));
 }
 
 ConsoleFactory::ConsoleFactory() {
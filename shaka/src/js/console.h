@@ -57,9 +57,11 @@ class Console : public BackingObject {
    * @param arguments The arguments to log.
    * @param prefix An optional prefix to prepend to the log.
    * @param skip_count The number of arguments to skip.
+   * @param suffix Optional lines to print after the log.
    */
   void LogReal(LogLevel level, const CallbackArguments& arguments,
-               const char* prefix = nullptr, size_t skip_count = 0) const;
+               const char* prefix = nullptr, size_t skip_count = 0,
+               std::string suffix = "") const;
 };
 
 class ConsoleFactory : public BackingObjectFactory<Console> {
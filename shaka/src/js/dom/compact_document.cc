@@ -0,0 +1,223 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/js/dom/compact_document.h"
+
+#include <glog/logging.h>
+
+namespace shaka {
+namespace js {
+namespace dom {
+
+constexpr CompactDocument::Index CompactDocument::kNone;
+
+CompactDocument::CompactDocument() {
+  AddNode(kNone, Node::DOCUMENT_NODE);
+}
+
+CompactDocument::~CompactDocument() {}
+
+CompactDocument::Index CompactDocument::AddElement(
+    Index parent, const char* local_name, const char* namespace_uri,
+    const char* namespace_prefix) {
+  const Index ret = AddNode(parent, Node::ELEMENT_NODE);
+  NodeData& node = nodes_[ret];
+  node.local_name = Intern(local_name);
+  node.qualified_name = InternQualified(namespace_prefix, local_name);
+  node.namespace_uri = Intern(namespace_uri);
+  node.namespace_prefix = Intern(namespace_prefix);
+  node.first_attribute = static_cast<Index>(attributes_.size());
+  return ret;
+}
+
+void CompactDocument::AddAttribute(Index element, const char* local_name,
+                                   const char* namespace_uri,
+                                   const char* namespace_prefix,
+                                   const char* value, size_t value_length) {
+  NodeData& node = nodes_[element];
+  DCHECK_EQ(node.type, Node::ELEMENT_NODE);
+  DCHECK_EQ(element + 1, nodes_.size());
+  DCHECK_EQ(node.first_attribute + node.attribute_count, attributes_.size());
+
+  // The prefix of an attribute is only used if it has a namespace.
+  if (!namespace_uri)
+    namespace_prefix = nullptr;
+
+  AttributeData attribute;
+  attribute.local_name = Intern(local_name);
+  attribute.qualified_name = InternQualified(namespace_prefix, local_name);
+  attribute.namespace_uri = Intern(namespace_uri);
+  attribute.namespace_prefix = Intern(namespace_prefix);
+  attribute.value_begin = text_.size();
+  attribute.value_length = value_length;
+  text_.append(value, value_length);
+  attributes_.push_back(attribute);
+  node.attribute_count++;
+}
+
+CompactDocument::Index CompactDocument::AddCharacterData(Index parent,
+                                                         Node::NodeType type,
+                                                         const char* data,
+                                                         size_t length) {
+  DCHECK(type == Node::TEXT_NODE || type == Node::COMMENT_NODE);
+  const Index ret = AddNode(parent, type);
+  nodes_[ret].text_begin = text_.size();
+  nodes_[ret].text_length = length;
+  text_.append(data, length);
+  return ret;
+}
+
+void CompactDocument::AppendCharacterData(Index node, const char* data,
+                                          size_t length) {
+  DCHECK_EQ(node + 1, nodes_.size());
+  DCHECK_EQ(nodes_[node].text_begin + nodes_[node].text_length, text_.size());
+  nodes_[node].text_length += length;
+  text_.append(data, length);
+}
+
+void CompactDocument::EndNode(Index node) {
+  nodes_[node].subtree_end = static_cast<Index>(nodes_.size());
+}
+
+optional<std::string> CompactDocument::OptionalName(Index index) const {
+  if (index == kNone)
+    return nullopt;
+  return names_[index];
+}
+
+CompactDocument::Index CompactDocument::FirstChild(Index index) const {
+  return index + 1 < nodes_[index].subtree_end ? index + 1 : kNone;
+}
+
+CompactDocument::Index CompactDocument::NextSibling(Index index) const {
+  const Index parent = nodes_[index].parent;
+  const Index next = nodes_[index].subtree_end;
+  if (parent == kNone || next >= nodes_[parent].subtree_end)
+    return kNone;
+  return next;
+}
+
+std::string CompactDocument::TextData(Index index) const {
+  const NodeData& node = nodes_[index];
+  return text_.substr(node.text_begin, node.text_length);
+}
+
+void CompactDocument::AppendTextContent(Index index,
+                                        std::string* result) const {
+  const Index end = nodes_[index].subtree_end;
+  for (Index i = index + 1; i < end; i++) {
+    const NodeData& node = nodes_[i];
+    if (node.type == Node::TEXT_NODE)
+      result->append(text_, node.text_begin, node.text_length);
+  }
+}
+
+CompactDocument::Index CompactDocument::FindName(
+    const std::string& name) const {
+  auto it = name_indices_.find(name);
+  return it == name_indices_.end() ? kNone : it->second;
+}
+
+CompactDocument::Index CompactDocument::FindAttribute(
+    Index element, const std::string& qualified_name) const {
+  const Index name = FindName(qualified_name);
+  if (name == kNone)
+    return kNone;
+
+  const NodeData& node = nodes_[element];
+  const Index end = node.first_attribute + node.attribute_count;
+  for (Index i = node.first_attribute; i < end; i++) {
+    if (attributes_[i].qualified_name == name)
+      return i;
+  }
+  return kNone;
+}
+
+CompactDocument::Index CompactDocument::FindAttributeNS(
+    Index element, const std::string& namespace_uri,
+    const std::string& local_name) const {
+  const Index ns = FindName(namespace_uri);
+  const Index name = FindName(local_name);
+  if (ns == kNone || name == kNone)
+    return kNone;
+
+  const NodeData& node = nodes_[element];
+  const Index end = node.first_attribute + node.attribute_count;
+  for (Index i = node.first_attribute; i < end; i++) {
+    if (attributes_[i].namespace_uri == ns && attributes_[i].local_name == name)
+      return i;
+  }
+  return kNone;
+}
+
+std::string CompactDocument::AttributeValue(Index index) const {
+  const AttributeData& attribute = attributes_[index];
+  return text_.substr(attribute.value_begin, attribute.value_length);
+}
+
+void CompactDocument::FindElements(Index index, Index qualified_name,
+                                   std::vector<Index>* result) const {
+  const Index end = nodes_[index].subtree_end;
+  for (Index i = index + 1; i < end; i++) {
+    if (nodes_[i].type == Node::ELEMENT_NODE &&
+        nodes_[i].qualified_name == qualified_name) {
+      result->push_back(i);
+    }
+  }
+}
+
+CompactDocument::Index CompactDocument::AddNode(Index parent,
+                                                Node::NodeType type) {
+  CHECK_LT(nodes_.size(), kNone) << "Too many nodes in the document";
+  DCHECK(parent == kNone || parent < nodes_.size());
+
+  NodeData node;
+  node.type = type;
+  node.parent = parent;
+  node.subtree_end = static_cast<Index>(nodes_.size() + 1);
+  node.local_name = node.qualified_name = kNone;
+  node.namespace_uri = node.namespace_prefix = kNone;
+  node.first_attribute = node.attribute_count = 0;
+  node.text_begin = node.text_length = 0;
+  nodes_.push_back(node);
+  return static_cast<Index>(nodes_.size() - 1);
+}
+
+CompactDocument::Index CompactDocument::Intern(const char* name) {
+  if (!name)
+    return kNone;
+  return Intern(std::string(name));
+}
+
+CompactDocument::Index CompactDocument::Intern(const std::string& name) {
+  auto it = name_indices_.find(name);
+  if (it != name_indices_.end())
+    return it->second;
+
+  const Index ret = static_cast<Index>(names_.size());
+  names_.push_back(name);
+  name_indices_.emplace(name, ret);
+  return ret;
+}
+
+CompactDocument::Index CompactDocument::InternQualified(
+    const char* prefix, const char* local_name) {
+  if (!prefix)
+    return Intern(local_name);
+  return Intern(std::string(prefix) + ":" + local_name);
+}
+
+}  // namespace dom
+}  // namespace js
+}  // namespace shaka
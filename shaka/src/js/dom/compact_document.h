@@ -0,0 +1,167 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SHAKA_EMBEDDED_JS_DOM_COMPACT_DOCUMENT_H_
+#define SHAKA_EMBEDDED_JS_DOM_COMPACT_DOCUMENT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "shaka/optional.h"
+#include "src/js/dom/node.h"
+#include "src/util/macros.h"
+
+namespace shaka {
+namespace js {
+namespace dom {
+
+/**
+ * An immutable, compact representation of a parsed XML document.  Parsing a
+ * large manifest used to create a BackingObject for every element, attribute,
+ * and text node; instead, XMLDocumentParser fills one of these and the Node
+ * objects are only created when JavaScript walks to them (see
+ * Node::children()).
+ *
+ * All nodes are stored in one array in document order, so the descendants of
+ * a node are the nodes between it and its |subtree_end|.  Tag, attribute, and
+ * namespace names are interned, so each distinct name is stored once and can
+ * be compared by index.  Text and attribute values are stored in a single
+ * buffer.
+ */
+class CompactDocument {
+ public:
+  using Index = uint32_t;
+
+  /** Used for missing indices, e.g. an element without a namespace. */
+  static constexpr Index kNone = 0xffffffff;
+
+  struct NodeData {
+    Node::NodeType type;
+    Index parent;
+    /** The index after the last descendant of this node. */
+    Index subtree_end;
+
+    // These are only used by elements.
+    Index local_name;
+    Index qualified_name;
+    Index namespace_uri;
+    Index namespace_prefix;
+    Index first_attribute;
+    Index attribute_count;
+
+    // These are only used by text and comment nodes.
+    size_t text_begin;
+    size_t text_length;
+  };
+
+  struct AttributeData {
+    Index local_name;
+    Index qualified_name;
+    Index namespace_uri;
+    Index namespace_prefix;
+    size_t value_begin;
+    size_t value_length;
+  };
+
+  /** Creates a new document containing only the document node (index 0). */
+  CompactDocument();
+  ~CompactDocument();
+
+  NON_COPYABLE_OR_MOVABLE_TYPE(CompactDocument);
+
+  /** @name Building */
+  //@{
+  /**
+   * Adds a new element as the last child of the given node.  The element's
+   * attributes must be added before any children are.
+   */
+  Index AddElement(Index parent, const char* local_name,
+                   const char* namespace_uri, const char* namespace_prefix);
+  void AddAttribute(Index element, const char* local_name,
+                    const char* namespace_uri, const char* namespace_prefix,
+                    const char* value, size_t value_length);
+  /** Adds a new text or comment node as the last child of the given node. */
+  Index AddCharacterData(Index parent, Node::NodeType type, const char* data,
+                         size_t length);
+  /** Appends to the data of the given node, which must be the last one. */
+  void AppendCharacterData(Index node, const char* data, size_t length);
+  /** Called once all the children of the given node have been added. */
+  void EndNode(Index node);
+  //@}
+
+  size_t node_count() const {
+    return nodes_.size();
+  }
+  const NodeData& node(Index index) const {
+    return nodes_[index];
+  }
+  const std::string& name(Index index) const {
+    return names_[index];
+  }
+  optional<std::string> OptionalName(Index index) const;
+
+  /** @return The first child of the given node, or kNone. */
+  Index FirstChild(Index index) const;
+  /** @return The next sibling of the given node, or kNone. */
+  Index NextSibling(Index index) const;
+
+  /** @return The data of the given text or comment node. */
+  std::string TextData(Index index) const;
+  /** Appends the data of every text node under the given node to |result|. */
+  void AppendTextContent(Index index, std::string* result) const;
+
+  /**
+   * @return The index of the given interned name, or kNone if no node in the
+   *   document uses it.
+   */
+  Index FindName(const std::string& name) const;
+
+  /** @return The attribute of the given element, or kNone if not found. */
+  Index FindAttribute(Index element, const std::string& qualified_name) const;
+  Index FindAttributeNS(Index element, const std::string& namespace_uri,
+                        const std::string& local_name) const;
+  const AttributeData& attribute(Index index) const {
+    return attributes_[index];
+  }
+  std::string AttributeValue(Index index) const;
+
+  /**
+   * Adds the indices of the elements below the given node with the given
+   * qualified name to |result|, in document order.
+   */
+  void FindElements(Index index, Index qualified_name,
+                    std::vector<Index>* result) const;
+
+ private:
+  Index AddNode(Index parent, Node::NodeType type);
+  Index Intern(const char* name);
+  Index Intern(const std::string& name);
+  Index InternQualified(const char* prefix, const char* local_name);
+
+  std::vector<NodeData> nodes_;
+  std::vector<AttributeData> attributes_;
+  std::vector<std::string> names_;
+  std::unordered_map<std::string, Index> name_indices_;
+  std::string text_;
+};
+
+}  // namespace dom
+}  // namespace js
+}  // namespace shaka
+
+#endif  // SHAKA_EMBEDDED_JS_DOM_COMPACT_DOCUMENT_H_
@@ -14,6 +14,9 @@
 
 #include "src/js/dom/container_node.h"
 
+#include <algorithm>
+
+#include "src/js/dom/compact_document.h"
 #include "src/js/dom/document.h"
 #include "src/js/dom/element.h"
 #include "src/js/js_error.h"
@@ -25,10 +28,75 @@ namespace dom {
 
 namespace {
 
-RefPtr<Element> ToElement(RefPtr<Node> node) {
-  if (!node->is_element())
-    return nullptr;
-  return static_cast<Element*>(node.get());
+using IndexIterator = std::vector<CompactDocument::Index>::const_iterator;
+
+bool HasTagName(const Element* elem, const std::string& name) {
+  if (!elem->namespace_prefix.has_value())
+    return elem->local_name == name;
+
+  // Compare against "prefix:local_name" without building the string.
+  const std::string& prefix = elem->namespace_prefix.value();
+  return name.size() == prefix.size() + 1 + elem->local_name.size() &&
+         name.compare(0, prefix.size(), prefix) == 0 &&
+         name[prefix.size()] == ':' &&
+         name.compare(prefix.size() + 1, std::string::npos,
+                      elem->local_name) == 0;
+}
+
+/**
+ * Adds the elements below |node| that are given in [begin, end) to |result|.
+ * The subtree of |node| must be unchanged from the document's tree, and
+ * |begin| to |end| must be sorted indices of elements in that subtree.  This
+ * only creates the objects for the nodes on the paths to the matches.
+ */
+void AddElementsFromTree(const Node* node, const CompactDocument& tree,
+                         IndexIterator begin, IndexIterator end,
+                         std::vector<RefPtr<Element>>* result) {
+  for (auto& child : node->children()) {
+    if (begin == end)
+      return;
+
+    const CompactDocument::Index index = child->tree_index();
+    const CompactDocument::Index subtree_end = tree.node(index).subtree_end;
+    if (*begin >= subtree_end)
+      continue;
+
+    DCHECK(child->is_element());
+    if (*begin == index) {
+      result->emplace_back(static_cast<Element*>(child.get()));
+      ++begin;
+    }
+    auto child_end = std::lower_bound(begin, end, subtree_end);
+    if (begin != child_end)
+      AddElementsFromTree(child.get(), tree, begin, child_end, result);
+    begin = child_end;
+  }
+}
+
+void AddElementsByTagName(const Node* node, const std::string& name,
+                          std::vector<RefPtr<Element>>* result) {
+  if (!node->children_loaded()) {
+    // Search the tree first so we only create objects for the matches.
+    const CompactDocument& tree = *node->tree();
+    const CompactDocument::Index name_index = tree.FindName(name);
+    if (name_index == CompactDocument::kNone)
+      return;
+
+    std::vector<CompactDocument::Index> matches;
+    tree.FindElements(node->tree_index(), name_index, &matches);
+    AddElementsFromTree(node, tree, matches.begin(), matches.end(), result);
+    return;
+  }
+
+  for (auto& child : node->children()) {
+    if (child->is_element()) {
+      Element* elem = static_cast<Element*>(child.get());
+      if (HasTagName(elem, name))
+        result->emplace_back(elem);
+
+      AddElementsByTagName(elem, name, result);
+    }
+  }
 }
 
 }  // namespace
@@ -43,18 +111,7 @@ ContainerNode::~ContainerNode() {}
 std::vector<RefPtr<Element>> ContainerNode::GetElementsByTagName(
     const std::string& name) const {
   std::vector<RefPtr<Element>> ret;
-  for (auto& child : child_nodes()) {
-    RefPtr<Element> elem = ToElement(child);
-    if (elem) {
-      if (elem->tag_name() == name) {
-        ret.push_back(elem);
-      }
-
-      auto temp = elem->GetElementsByTagName(name);
-      ret.insert(ret.end(), temp.begin(), temp.end());
-    }
-  }
-
+  AddElementsByTagName(this, name, &ret);
   return ret;
 }
 
@@ -14,6 +14,9 @@
 
 #include "src/js/dom/document.h"
 
+#include <utility>
+
+#include "src/core/js_manager_impl.h"
 #include "src/js/dom/comment.h"
 #include "src/js/dom/element.h"
 #include "src/js/dom/text.h"
@@ -25,23 +28,32 @@ namespace shaka {
 namespace js {
 namespace dom {
 
-std::atomic<Document*> Document::instance_{nullptr};
-
 Document::Document()
     : ContainerNode(DOCUMENT_NODE, nullptr),
       created_at_(util::Clock::Instance.GetMonotonicTime()) {}
 
 // \cond Doxygen_Skip
 Document::~Document() {
-  if (instance_ == this)
-    instance_ = nullptr;
+  JsManagerImpl* manager = JsManagerImpl::InstanceOrNull();
+  if (manager && manager->global_document() == this)
+    manager->set_global_document(nullptr);
 }
 // \endcond Doxygen_Skip
 
+// static
+Document* Document::GetGlobalDocument() {
+  Document* ret = JsManagerImpl::Instance()->global_document();
+  CHECK(ret);
+  return ret;
+}
+
 // static
 Document* Document::CreateGlobalDocument() {
-  DCHECK(instance_ == nullptr);
-  return (instance_ = new Document());
+  JsManagerImpl* manager = JsManagerImpl::Instance();
+  DCHECK(manager->global_document() == nullptr);
+  Document* ret = new Document();
+  manager->set_global_document(ret);
+  return ret;
 }
 
 std::string Document::node_name() const {
@@ -57,13 +69,34 @@ optional<std::string> Document::TextContent() const {
 }
 
 RefPtr<Element> Document::DocumentElement() const {
-  for (auto& child : child_nodes()) {
+  for (auto& child : children()) {
     if (child->is_element())
       return static_cast<Element*>(child.get());
   }
   return nullptr;
 }
 
+void Document::SetCompactDocument(std::unique_ptr<CompactDocument> tree) {
+  DCHECK(!compact_document_);
+  DCHECK(children().empty());
+  compact_document_ = std::move(tree);
+  SetTreeIndex(0);
+}
+
+RefPtr<Node> Document::CreateNodeFromTree(CompactDocument::Index index) {
+  const CompactDocument::NodeData& node = compact_document_->node(index);
+  switch (node.type) {
+    case ELEMENT_NODE:
+      return new Element(this, *compact_document_, index);
+    case TEXT_NODE:
+      return new Text(this, compact_document_->TextData(index));
+    case COMMENT_NODE:
+      return new Comment(this, compact_document_->TextData(index));
+    default:
+      LOG(FATAL) << "Unexpected node type " << node.type;
+  }
+}
+
 RefPtr<Element> Document::CreateElement(const std::string& name) {
   if (name == "video") {
     // This should only be used in Shaka Player integration tests.
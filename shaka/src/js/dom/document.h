@@ -15,10 +15,11 @@
 #ifndef SHAKA_EMBEDDED_JS_DOM_DOCUMENT_H_
 #define SHAKA_EMBEDDED_JS_DOM_DOCUMENT_H_
 
-#include <atomic>
+#include <memory>
 #include <string>
 
 #include "shaka/optional.h"
+#include "src/js/dom/compact_document.h"
 #include "src/js/dom/container_node.h"
 
 namespace shaka {
@@ -41,11 +42,8 @@ class Document : public ContainerNode {
   static Document* Create() {
     return new Document();
   }
-  static Document* GetGlobalDocument() {
-    Document* ret = instance_;
-    CHECK(ret);
-    return ret;
-  }
+  /** @return The global document of the current JsManager. */
+  static Document* GetGlobalDocument();
   static Document* CreateGlobalDocument();
 
   /**
@@ -60,13 +58,24 @@ class Document : public ContainerNode {
 
   RefPtr<Element> DocumentElement() const;
 
+  /**
+   * Makes the given parsed document the contents of this document.  This must
+   * only be called on a new, empty document.
+   */
+  void SetCompactDocument(std::unique_ptr<CompactDocument> tree);
+  const CompactDocument* compact_document() const {
+    return compact_document_.get();
+  }
+  /** Creates the object for the given node of this document's tree. */
+  RefPtr<Node> CreateNodeFromTree(CompactDocument::Index index);
+
   RefPtr<Element> CreateElement(const std::string& name);
   RefPtr<Comment> CreateComment(const std::string& data);
   RefPtr<Text> CreateTextNode(const std::string& data);
 
  private:
-  static std::atomic<Document*> instance_;
   const uint64_t created_at_;
+  std::unique_ptr<CompactDocument> compact_document_;
 };
 
 class DocumentFactory : public BackingObjectFactory<Document, ContainerNode> {
@@ -39,6 +39,7 @@ struct ExceptionInfo {
     DEFINE_MAPPING(NotSupportedError, "The operation is not supported.", 9),
     DEFINE_MAPPING(InvalidStateError, "The object is in an invalid state.", 11),
     DEFINE_MAPPING(QuotaExceededError, "The quota has been exceeded.", 22),
+    DEFINE_MAPPING(NetworkError, "A network error occurred.", 19),
 
     DEFINE_MAPPING(IndexSizeError, "The index is not in the allowed range.", 1),
     DEFINE_MAPPING(HierarchyRequestError,
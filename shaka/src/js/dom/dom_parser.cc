@@ -14,15 +14,30 @@
 
 #include "src/js/dom/dom_parser.h"
 
+#include <functional>
+#include <utility>
+
+#include "src/core/js_manager_impl.h"
 #include "src/js/dom/document.h"
 #include "src/js/dom/xml_document_parser.h"
 #include "src/js/js_error.h"
+#include "src/mapping/convert_js.h"
+#include "src/memory/heap_tracer.h"
 #include "src/util/utils.h"
 
 namespace shaka {
 namespace js {
 namespace dom {
 
+namespace {
+
+bool IsXmlType(const std::string& type) {
+  const std::string type_lower = util::ToAsciiLower(type);
+  return type_lower == "text/xml" || type_lower == "application/xml";
+}
+
+}  // namespace
+
 DOMParser::DOMParser() {}
 // \cond Doxygen_Skip
 DOMParser::~DOMParser() {}
@@ -30,19 +45,69 @@ DOMParser::~DOMParser() {}
 
 ExceptionOr<RefPtr<Document>> DOMParser::ParseFromString(
     const std::string& source, const std::string& type) const {
-  const std::string type_lower = util::ToAsciiLower(type);
-  if (type_lower == "text/xml" || type_lower == "application/xml") {
-    RefPtr<Document> ret = new Document();
-    XMLDocumentParser parser(ret);
-    return parser.Parse(source);
+  if (!IsXmlType(type))
+    return JsError::TypeError("Unsupported parse type " + type);
+
+  XMLDocumentParser parser;
+  parser.Parse(source);
+  return parser.CreateDocument();
+}
+
+Promise DOMParser::ParseFromStringAsync(const std::string& source,
+                                        const std::string& type) {
+  if (!IsXmlType(type)) {
+    return Promise::Rejected(
+        JsError::TypeError("Unsupported parse type " + type));
   }
 
-  return JsError::TypeError("Unsupported parse type " + type);
+  const int id = ++next_id_;
+  Promise ret;
+  pending_.emplace(id, ret);
+
+  // |this| is kept alive by IsRootedAlive until the parse is done.
+  JsManagerImpl* manager = JsManagerImpl::Instance();
+  std::shared_ptr<XMLDocumentParser> parser(new XMLDocumentParser);
+  auto parse = [=]() {
+    parser->Parse(source);
+    manager->MainThread()->AddInternalTask(
+        TaskPriority::Internal, "DOMParser.parseFromStringAsync",
+        PlainCallbackTask(
+            std::bind(&DOMParser::OnParseDone, this, id, parser)));
+  };
+  manager->BackgroundThread()->AddInternalTask(
+      TaskPriority::Internal, "Parse XML", PlainCallbackTask(std::move(parse)));
+  return ret;
+}
+
+bool DOMParser::IsRootedAlive() const {
+  return !pending_.empty() || BackingObject::IsRootedAlive();
+}
+
+void DOMParser::Trace(memory::HeapTracer* tracer) const {
+  BackingObject::Trace(tracer);
+  for (auto& pair : pending_)
+    tracer->Trace(&pair.second);
+}
+
+void DOMParser::OnParseDone(int id, std::shared_ptr<XMLDocumentParser> parser) {
+  auto it = pending_.find(id);
+  DCHECK(it != pending_.end());
+  Promise promise = std::move(it->second);
+  pending_.erase(it);
+
+  ExceptionOr<RefPtr<Document>> result = parser->CreateDocument();
+  if (holds_alternative<JsError>(result)) {
+    promise.RejectWith(get<JsError>(result));
+  } else {
+    LocalVar<JsValue> value = ToJsValue(get<RefPtr<Document>>(result));
+    promise.ResolveWith(value);
+  }
 }
 
 
 DOMParserFactory::DOMParserFactory() {
   AddMemberFunction("parseFromString", &DOMParser::ParseFromString);
+  AddMemberFunction("parseFromStringAsync", &DOMParser::ParseFromStringAsync);
 }
 
 }  // namespace dom
@@ -15,17 +15,21 @@
 #ifndef SHAKA_EMBEDDED_JS_DOM_DOM_PARSER_H_
 #define SHAKA_EMBEDDED_JS_DOM_DOM_PARSER_H_
 
+#include <memory>
 #include <string>
+#include <unordered_map>
 
 #include "src/core/ref_ptr.h"
 #include "src/mapping/backing_object.h"
 #include "src/mapping/backing_object_factory.h"
 #include "src/mapping/exception_or.h"
+#include "src/mapping/promise.h"
 
 namespace shaka {
 namespace js {
 namespace dom {
 class Document;
+class XMLDocumentParser;
 
 /**
  * Implements the DOMParser interface for DOM.
@@ -49,6 +53,27 @@ class DOMParser : public BackingObject {
    */
   ExceptionOr<RefPtr<Document>> ParseFromString(const std::string& source,
                                                 const std::string& type) const;
+
+  /**
+   * Parses the given string into a document on a background thread, so large
+   * documents don't block the event thread.  Only the final Document is
+   * created on the event thread.  This is not part of the spec.
+   *
+   * @return A Promise that resolves to the document, or is rejected with the
+   *   same errors ParseFromString throws.
+   */
+  Promise ParseFromStringAsync(const std::string& source,
+                               const std::string& type);
+
+  /** A parser with pending parses is kept alive until they complete. */
+  bool IsRootedAlive() const override;
+  void Trace(memory::HeapTracer* tracer) const override;
+
+ private:
+  void OnParseDone(int id, std::shared_ptr<XMLDocumentParser> parser);
+
+  std::unordered_map<int, Promise> pending_;
+  int next_id_ = 0;
 };
 
 class DOMParserFactory : public BackingObjectFactory<DOMParser> {
@@ -29,7 +29,18 @@ Element::Element(RefPtr<Document> document, const std::string& local_name,
     : ContainerNode(ELEMENT_NODE, document),
       namespace_uri(namespace_uri),
       namespace_prefix(namespace_prefix),
-      local_name(local_name) {}
+      local_name(local_name),
+      attributes_loaded_(true) {}
+
+Element::Element(RefPtr<Document> document, const CompactDocument& tree,
+                 CompactDocument::Index index)
+    : ContainerNode(ELEMENT_NODE, document),
+      namespace_uri(tree.OptionalName(tree.node(index).namespace_uri)),
+      namespace_prefix(tree.OptionalName(tree.node(index).namespace_prefix)),
+      local_name(tree.name(tree.node(index).local_name)),
+      attributes_loaded_(tree.node(index).attribute_count == 0) {
+  SetTreeIndex(index);
+}
 
 // \cond Doxygen_Skip
 Element::~Element() {}
@@ -56,7 +67,12 @@ optional<std::string> Element::NodeValue() const {
 
 optional<std::string> Element::TextContent() const {
   std::string ret;
-  for (auto& child : child_nodes()) {
+  if (!children_loaded()) {
+    tree()->AppendTextContent(tree_index(), &ret);
+    return ret;
+  }
+
+  for (auto& child : children()) {
     if (child->node_type() == TEXT_NODE) {
       ret.append(static_cast<Text*>(child.get())->data());
     } else if (child->is_element()) {
@@ -69,6 +85,13 @@ optional<std::string> Element::TextContent() const {
 }
 
 optional<std::string> Element::GetAttribute(const std::string& name) const {
+  if (!attributes_loaded_) {
+    const auto index = tree()->FindAttribute(tree_index(), name);
+    if (index == CompactDocument::kNone)
+      return nullopt;
+    return tree()->AttributeValue(index);
+  }
+
   auto it = FindAttribute(name);
   if (it == attributes_.end())
     return nullopt;
@@ -77,6 +100,13 @@ optional<std::string> Element::GetAttribute(const std::string& name) const {
 
 optional<std::string> Element::GetAttributeNS(const std::string& ns,
                                               const std::string& name) const {
+  if (!attributes_loaded_) {
+    const auto index = tree()->FindAttributeNS(tree_index(), ns, name);
+    if (index == CompactDocument::kNone)
+      return nullopt;
+    return tree()->AttributeValue(index);
+  }
+
   auto it = FindAttributeNS(ns, name);
   if (it == attributes_.end())
     return nullopt;
@@ -84,15 +114,22 @@ optional<std::string> Element::GetAttributeNS(const std::string& ns,
 }
 
 bool Element::HasAttribute(const std::string& name) const {
+  if (!attributes_loaded_)
+    return tree()->FindAttribute(tree_index(), name) != CompactDocument::kNone;
   return FindAttribute(name) != attributes_.end();
 }
 
 bool Element::HasAttributeNS(const std::string& ns,
                              const std::string& name) const {
+  if (!attributes_loaded_) {
+    return tree()->FindAttributeNS(tree_index(), ns, name) !=
+           CompactDocument::kNone;
+  }
   return FindAttributeNS(ns, name) != attributes_.end();
 }
 
 void Element::SetAttribute(const std::string& key, const std::string& value) {
+  LoadAttributes();
   auto it = FindAttribute(key);
   if (it != attributes_.end())
     (*it)->value = value;
@@ -109,6 +146,7 @@ void Element::SetAttributeNS(const std::string& ns, const std::string& key,
   const std::string local_name = key.substr(split_at + 1);
   const std::string prefix = key.substr(0, split_at);
 
+  LoadAttributes();
   auto it = FindAttributeNS(ns, local_name);
   if (it != attributes_.end())
     (*it)->value = value;
@@ -117,6 +155,7 @@ void Element::SetAttributeNS(const std::string& ns, const std::string& key,
 }
 
 void Element::RemoveAttribute(const std::string& attr) {
+  LoadAttributes();
   auto it = FindAttribute(attr);
   if (it != attributes_.end())
     attributes_.erase(it);
@@ -124,6 +163,7 @@ void Element::RemoveAttribute(const std::string& attr) {
 
 void Element::RemoveAttributeNS(const std::string& ns,
                                 const std::string& attr) {
+  LoadAttributes();
   auto it = FindAttributeNS(ns, attr);
   if (it != attributes_.end())
     attributes_.erase(it);
@@ -149,9 +189,29 @@ Element::attr_iter Element::FindAttributeNS(const std::string& ns,
 }
 
 std::vector<RefPtr<Attr>> Element::attributes() const {
+  LoadAttributes();
   return std::vector<RefPtr<Attr>>(attributes_.begin(), attributes_.end());
 }
 
+void Element::LoadAttributes() const {
+  if (attributes_loaded_)
+    return;
+  attributes_loaded_ = true;
+
+  // This doesn't change the attributes, so this is logically const.
+  Element* self = const_cast<Element*>(this);
+  const CompactDocument* tree = this->tree();
+  const CompactDocument::NodeData& node = tree->node(tree_index());
+  for (CompactDocument::Index i = 0; i < node.attribute_count; i++) {
+    const CompactDocument::Index index = node.first_attribute + i;
+    const CompactDocument::AttributeData& attr = tree->attribute(index);
+    attributes_.emplace_back(new Attr(self, tree->name(attr.local_name),
+                                      tree->OptionalName(attr.namespace_uri),
+                                      tree->OptionalName(attr.namespace_prefix),
+                                      tree->AttributeValue(index)));
+  }
+}
+
 ElementFactory::ElementFactory() {
   AddReadOnlyProperty("namespaceURI", &Element::namespace_uri);
   AddReadOnlyProperty("prefix", &Element::namespace_prefix);
@@ -20,6 +20,7 @@
 #include <vector>
 
 #include "shaka/optional.h"
+#include "src/js/dom/compact_document.h"
 #include "src/js/dom/container_node.h"
 
 namespace shaka {
@@ -38,6 +39,13 @@ class Element : public ContainerNode {
   Element(RefPtr<Document> document, const std::string& local_name,
           optional<std::string> namespace_uri,
           optional<std::string> namespace_prefix);
+  /**
+   * Creates an element for the given node of the document's tree.  The
+   * attribute objects are only created once they are used; until then the
+   * attributes are read from the tree.
+   */
+  Element(RefPtr<Document> document, const CompactDocument& tree,
+          CompactDocument::Index index);
 
   void Trace(memory::HeapTracer* tracer) const override;
 
@@ -53,7 +61,7 @@ class Element : public ContainerNode {
   optional<std::string> TextContent() const override;
 
   bool has_attributes() const {
-    return !attributes_.empty();
+    return !attributes_loaded_ || !attributes_.empty();
   }
   optional<std::string> GetAttribute(const std::string& name) const;
   optional<std::string> GetAttributeNS(const std::string& ns,
@@ -83,7 +91,11 @@ class Element : public ContainerNode {
     return const_cast<Element*>(this)->FindAttributeNS(ns, name);
   }
 
-  std::vector<Member<Attr>> attributes_;
+  /** Creates the attribute objects from the tree if they don't exist yet. */
+  void LoadAttributes() const;
+
+  mutable std::vector<Member<Attr>> attributes_;
+  mutable bool attributes_loaded_;
 };
 
 class ElementFactory : public BackingObjectFactory<Element, ContainerNode> {
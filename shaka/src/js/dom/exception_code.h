@@ -25,6 +25,7 @@ enum ExceptionCode {
   NotSupportedError,
   InvalidStateError,
   QuotaExceededError,
+  NetworkError,
 
   // DOM/XML
   IndexSizeError,
@@ -14,6 +14,7 @@
 
 #include "src/js/dom/node.h"
 
+#include "src/js/dom/compact_document.h"
 #include "src/js/dom/document.h"
 #include "src/js/dom/element.h"
 #include "src/js/js_error.h"
@@ -24,7 +25,10 @@ namespace js {
 namespace dom {
 
 Node::Node(NodeType type, RefPtr<Document> document)
-    : owner_document_(document), node_type_(type) {
+    : owner_document_(document),
+      node_type_(type),
+      tree_index_(CompactDocument::kNone),
+      children_loaded_(true) {
   DCHECK(!document.empty() || type == DOCUMENT_NODE);
 }
 
@@ -53,15 +57,18 @@ RefPtr<Node> Node::parent_node() const {
 }
 
 std::vector<RefPtr<Node>> Node::child_nodes() const {
-  return std::vector<RefPtr<Node>>(children_.begin(), children_.end());
+  const std::vector<Member<Node>>& children = this->children();
+  return std::vector<RefPtr<Node>>(children.begin(), children.end());
 }
 
 RefPtr<Node> Node::first_child() const {
-  return children_.empty() ? nullptr : children_.front();
+  const std::vector<Member<Node>>& children = this->children();
+  return children.empty() ? nullptr : children.front();
 }
 
 RefPtr<Node> Node::last_child() const {
-  return children_.empty() ? nullptr : children_.back();
+  const std::vector<Member<Node>>& children = this->children();
+  return children.empty() ? nullptr : children.back();
 }
 
 RefPtr<Node> Node::AppendChild(RefPtr<Node> new_child) {
@@ -69,6 +76,8 @@ RefPtr<Node> Node::AppendChild(RefPtr<Node> new_child) {
   CHECK(new_child);
   CHECK(!new_child->parent_node());
 
+  if (!children_loaded_)
+    LoadChildren();
   new_child->parent_ = this;
   children_.emplace_back(new_child);
   return new_child;
@@ -79,11 +88,49 @@ RefPtr<Node> Node::RemoveChild(RefPtr<Node> to_remove) {
   CHECK(to_remove);
   CHECK_EQ(to_remove->parent_node(), this);
 
+  // |to_remove| has a parent, so the children have already been loaded.
+  DCHECK(children_loaded_);
   to_remove->parent_ = nullptr;
   util::RemoveElement(&children_, to_remove);
   return to_remove;
 }
 
+const std::vector<Member<Node>>& Node::children() const {
+  if (!children_loaded_)
+    LoadChildren();
+  return children_;
+}
+
+const CompactDocument* Node::tree() const {
+  if (is_document())
+    return static_cast<const Document*>(this)->compact_document();
+  return owner_document_->compact_document();
+}
+
+void Node::SetTreeIndex(uint32_t index) {
+  DCHECK(tree());
+  DCHECK(children_.empty());
+  tree_index_ = index;
+  children_loaded_ = false;
+}
+
+void Node::LoadChildren() const {
+  DCHECK(!children_loaded_);
+  children_loaded_ = true;
+
+  // Loading the children doesn't change the DOM, so this is logically const.
+  Node* self = const_cast<Node*>(this);
+  Document* document =
+      is_document() ? static_cast<Document*>(self) : owner_document_.get();
+  const CompactDocument* tree = document->compact_document();
+  for (uint32_t child = tree->FirstChild(tree_index_);
+       child != CompactDocument::kNone; child = tree->NextSibling(child)) {
+    RefPtr<Node> node = document->CreateNodeFromTree(child);
+    node->parent_ = self;
+    children_.emplace_back(node);
+  }
+}
+
 
 NodeFactory::NodeFactory() {
   AddConstant("ELEMENT_NODE", Node::ELEMENT_NODE);
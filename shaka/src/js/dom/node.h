@@ -15,6 +15,8 @@
 #ifndef SHAKA_EMBEDDED_JS_DOM_NODE_H_
 #define SHAKA_EMBEDDED_JS_DOM_NODE_H_
 
+#include <stdint.h>
+
 #include <string>
 #include <vector>
 
@@ -28,6 +30,7 @@
 namespace shaka {
 namespace js {
 namespace dom {
+class CompactDocument;
 class Document;
 class Element;
 
@@ -119,11 +122,47 @@ class Node : public events::EventTarget {
            node_type_ == COMMENT_NODE;
   }
 
+  /**
+   * @return The children of this node.  Unlike child_nodes(), this doesn't
+   *   copy the list.
+   */
+  const std::vector<Member<Node>>& children() const;
+
+  /**
+   * @return Whether the objects for the children of this node exist.  If not,
+   *   this node and everything below it are unchanged from the document's
+   *   CompactDocument.
+   */
+  bool children_loaded() const {
+    return children_loaded_;
+  }
+  /** @return The index of this node in its document's CompactDocument. */
+  uint32_t tree_index() const {
+    return tree_index_;
+  }
+  /**
+   * @return The CompactDocument of the document, or nullptr if it wasn't
+   *   parsed.
+   */
+  const CompactDocument* tree() const;
+
+ protected:
+  /**
+   * Marks this node as being created from the given node of the document's
+   * CompactDocument.  The objects for the children will be created once they
+   * are used.
+   */
+  void SetTreeIndex(uint32_t index);
+
  private:
-  std::vector<Member<Node>> children_;
+  void LoadChildren() const;
+
+  mutable std::vector<Member<Node>> children_;
   Member<Node> parent_;
   const Member<Document> owner_document_;
   const NodeType node_type_;
+  uint32_t tree_index_;
+  mutable bool children_loaded_;
 };
 
 class NodeFactory : public BackingObjectFactory<Node, events::EventTarget> {
@@ -15,13 +15,12 @@
 #include "src/js/dom/xml_document_parser.h"
 
 #include <libxml/parser.h>
+#include <string.h>
 
+#include <mutex>
 #include <utility>
 
-#include "src/js/dom/comment.h"
 #include "src/js/dom/document.h"
-#include "src/js/dom/element.h"
-#include "src/js/dom/text.h"
 #include "src/js/js_error.h"
 #include "src/util/utils.h"
 
@@ -42,15 +41,10 @@ XMLDocumentParser* GetParser(void* context) {
   return reinterpret_cast<XMLDocumentParser*>(context);
 }
 
-std::string ToString(const xmlChar* data) {
+const char* ToChars(const xmlChar* data) {
   return reinterpret_cast<const char*>(data);
 }
 
-std::string ToString(const xmlChar* data, int length) {
-  auto* text = reinterpret_cast<const char*>(data);
-  return std::string(text, text + length);
-}
-
 
 void SaxEndDocument(void* context) {
   GetParser(context)->EndDocument();
@@ -61,11 +55,9 @@ void SaxStartElementNS(void* context, const xmlChar* local_name,
                        int /* nb_namespaces */,
                        const xmlChar** /* namespaces */, int nb_attributes,
                        int /* nb_defaulted */, const xmlChar** attributes) {
-  GetParser(context)->StartElement(
-      ToString(local_name),
-      namespace_uri ? optional<std::string>(ToString(namespace_uri)) : nullopt,
-      prefix ? optional<std::string>(ToString(prefix)) : nullopt, nb_attributes,
-      reinterpret_cast<const char**>(attributes));
+  GetParser(context)->StartElement(ToChars(local_name), ToChars(namespace_uri),
+                                   ToChars(prefix), nb_attributes,
+                                   reinterpret_cast<const char**>(attributes));
 }
 
 void SaxEndElementNS(void* context, const xmlChar* /* localname */,
@@ -74,16 +66,16 @@ void SaxEndElementNS(void* context, const xmlChar* /* localname */,
 }
 
 void SaxCharacters(void* context, const xmlChar* raw_data, int size) {
-  GetParser(context)->Text(ToString(raw_data, size));
+  GetParser(context)->Text(ToChars(raw_data), size);
 }
 
 void SaxProcessingInstruction(void* context, const xmlChar* /* target */,
                               const xmlChar* /* data */) {
-  GetParser(context)->SetException(JsError::DOMException(NotSupportedError));
+  GetParser(context)->SetError(NotSupportedError, "");
 }
 
 void SaxComment(void* context, const xmlChar* raw_data) {
-  GetParser(context)->Comment(ToString(raw_data));
+  GetParser(context)->Comment(ToChars(raw_data));
 }
 
 PRINTF_FORMAT(2, 3)
@@ -104,27 +96,29 @@ void SaxError(  // NOLINT(cert-dcl50-cpp)
   std::string message = util::StringPrintfV(format, args);
   va_end(args);
 
-  GetParser(context)->SetException(
-      JsError::DOMException(UnknownError, message));
+  GetParser(context)->SetError(UnknownError, message);
 }
 
 void SaxCdata(void* context, const xmlChar* value, int len) {
   // We do not have a separate CDATA type, so treat as text.
-  GetParser(context)->Text(ToString(value, len));
+  GetParser(context)->Text(ToChars(value), len);
 }
 
 }  // namespace
 
-XMLDocumentParser::XMLDocumentParser(RefPtr<Document> document)
-    : document_(document), current_node_(document) {}
+XMLDocumentParser::XMLDocumentParser()
+    : tree_(new CompactDocument),
+      current_node_(0),
+      current_text_(CompactDocument::kNone),
+      has_error_(false),
+      error_code_(UnknownError) {}
 
 XMLDocumentParser::~XMLDocumentParser() {}
 
-ExceptionOr<RefPtr<Document>> XMLDocumentParser::Parse(
-    const std::string& source) {
-  // TODO: libxml says we should call xmlInitParser in case of multithreaded
-  // programs; however it works without it.  We may not want to change global
-  // state of libxml so embedders can use it without us changing it.
+void XMLDocumentParser::Parse(const std::string& source) {
+  // libxml needs to be initialized before it is used on several threads.
+  static std::once_flag init_flag;
+  std::call_once(init_flag, &xmlInitParser);
 
   xmlSAXHandler sax;
   memset(&sax, 0, sizeof(sax));
@@ -143,27 +137,38 @@ ExceptionOr<RefPtr<Document>> XMLDocumentParser::Parse(
   int code = xmlSAXUserParseMemory(&sax, this, source.c_str(), source.size());
   if (code < 0) {
     LOG(ERROR) << "Error parsing XML document, code=" << code;
-    return error_ ? std::move(*error_) : JsError::DOMException(UnknownError);
+    has_error_ = true;
+  }
+}
+
+ExceptionOr<RefPtr<Document>> XMLDocumentParser::CreateDocument() {
+  CHECK(tree_) << "Can only create the document once";
+  if (has_error_) {
+    if (error_message_.empty())
+      return JsError::DOMException(error_code_);
+    return JsError::DOMException(error_code_, error_message_);
   }
-  if (error_)
-    return std::move(*error_);
 
-  return document_;
+  DCHECK_EQ(current_node_, 0u);
+  RefPtr<Document> ret = new Document();
+  ret->SetCompactDocument(std::move(tree_));
+  return ret;
 }
 
 void XMLDocumentParser::EndDocument() {
   FinishTextNode();
+  tree_->EndNode(current_node_);
 }
 
-void XMLDocumentParser::StartElement(const std::string& local_name,
-                                     optional<std::string> namespace_uri,
-                                     optional<std::string> namespace_prefix,
+void XMLDocumentParser::StartElement(const char* local_name,
+                                     const char* namespace_uri,
+                                     const char* namespace_prefix,
                                      size_t attribute_count,
                                      const char** attributes) {
   FinishTextNode();
 
-  RefPtr<Element> child =
-      new Element(document_, local_name, namespace_uri, namespace_prefix);
+  const CompactDocument::Index child = tree_->AddElement(
+      current_node_, local_name, namespace_uri, namespace_prefix);
   for (size_t i = 0; i < attribute_count; i++) {
     // Each attribute has the following values in |attributes|.
     const char* local_name = attributes[i * 5];
@@ -172,48 +177,48 @@ void XMLDocumentParser::StartElement(const std::string& local_name,
     const char* value_begin = attributes[i * 5 + 3];
     const char* value_end = attributes[i * 5 + 4];
 
-    if (namespace_uri) {
-      std::string qualified_name;
-      if (namespace_prefix)
-        qualified_name = std::string(namespace_prefix) + ":" + local_name;
-      else
-        qualified_name = local_name;
-
-      child->SetAttributeNS(namespace_uri, qualified_name,
-                            std::string(value_begin, value_end));
-    } else {
-      child->SetAttribute(local_name, std::string(value_begin, value_end));
-    }
+    tree_->AddAttribute(child, local_name, namespace_uri, namespace_prefix,
+                        value_begin, value_end - value_begin);
   }
 
-  current_node_->AppendChild(child);
   current_node_ = child;
 }
 
 void XMLDocumentParser::EndElement() {
   FinishTextNode();
-  current_node_ = current_node_->parent_node();
-  DCHECK(!current_node_.empty());
+  tree_->EndNode(current_node_);
+  current_node_ = tree_->node(current_node_).parent;
+  DCHECK_NE(current_node_, CompactDocument::kNone);
 }
 
-void XMLDocumentParser::Text(const std::string& text) {
-  current_text_.append(text);
+void XMLDocumentParser::Text(const char* text, size_t length) {
+  if (length == 0)
+    return;
+
+  // SAX can split the text of a node into several calls.
+  if (current_text_ != CompactDocument::kNone) {
+    tree_->AppendCharacterData(current_text_, text, length);
+  } else {
+    current_text_ = tree_->AddCharacterData(current_node_, Node::TEXT_NODE,
+                                            text, length);
+  }
 }
 
-void XMLDocumentParser::Comment(const std::string& text) {
+void XMLDocumentParser::Comment(const char* text) {
   FinishTextNode();
-  current_node_->AppendChild(document_->CreateComment(text));
+  tree_->AddCharacterData(current_node_, Node::COMMENT_NODE, text,
+                          strlen(text));
 }
 
-void XMLDocumentParser::SetException(JsError error) {
-  error_.reset(new JsError(std::move(error)));
+void XMLDocumentParser::SetError(ExceptionCode code,
+                                 const std::string& message) {
+  has_error_ = true;
+  error_code_ = code;
+  error_message_ = message;
 }
 
 void XMLDocumentParser::FinishTextNode() {
-  if (!current_text_.empty()) {
-    current_node_->AppendChild(document_->CreateTextNode(current_text_));
-    current_text_.clear();
-  }
+  current_text_ = CompactDocument::kNone;
 }
 
 }  // namespace dom
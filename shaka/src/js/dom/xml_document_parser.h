@@ -17,26 +17,28 @@
 
 #include <memory>
 #include <string>
-#include <tuple>
-#include <vector>
 
-#include "shaka/optional.h"
-#include "src/core/member.h"
 #include "src/core/ref_ptr.h"
+#include "src/js/dom/compact_document.h"
+#include "src/js/dom/exception_code.h"
 #include "src/mapping/exception_or.h"
+#include "src/util/macros.h"
 
 namespace shaka {
 namespace js {
 namespace dom {
-class Node;
 class Document;
-class Text;
 
 /**
  * Parses XML text data into a DOM tree.  All work is synchronous and no events
  * are fired.  This also is a strict parser, so it will reject documents that
  * some browsers may accept.
  *
+ * This is done in two steps.  Parse() fills a CompactDocument instead of
+ * creating the Node objects; it doesn't use any JavaScript objects, so it can
+ * be called on a background thread.  Then CreateDocument() wraps the result
+ * in a Document on the event thread.
+ *
  * The following features are not supported:
  * - Namespaces
  * - Events/mutators
@@ -45,31 +47,45 @@ class Text;
  */
 class XMLDocumentParser {
  public:
-  explicit XMLDocumentParser(RefPtr<Document> document);
+  XMLDocumentParser();
   ~XMLDocumentParser();
 
-  ExceptionOr<RefPtr<Document>> Parse(const std::string& source);
+  NON_COPYABLE_OR_MOVABLE_TYPE(XMLDocumentParser);
+
+  /** Parses the given XML.  This can be called on any thread. */
+  void Parse(const std::string& source);
+
+  /**
+   * Creates a document holding the results of Parse().  This must be called
+   * on the event thread, and can only be called once.
+   *
+   * @return The new document, or the parse error.
+   */
+  ExceptionOr<RefPtr<Document>> CreateDocument();
 
   // Callbacks from SAX
   void EndDocument();
-  void StartElement(const std::string& local_name,
-                    optional<std::string> namespace_uri,
-                    optional<std::string> namespace_prefix,
-                    size_t attribute_count,
+  void StartElement(const char* local_name, const char* namespace_uri,
+                    const char* namespace_prefix, size_t attribute_count,
                     const char** attributes);
   void EndElement();
-  void Text(const std::string& text);
-  void Comment(const std::string& text);
-  void SetException(JsError error);
+  void Text(const char* text, size_t length);
+  void Comment(const char* text);
+  void SetError(ExceptionCode code, const std::string& message);
 
  private:
-  /** If there is any cached text, create a new Text node for it. */
+  /** Ends the current Text node so the next text starts a new one. */
   void FinishTextNode();
 
-  const Member<Document> document_;
-  Member<Node> current_node_;
-  std::string current_text_;
-  std::unique_ptr<JsError> error_;
+  std::unique_ptr<CompactDocument> tree_;
+  CompactDocument::Index current_node_;
+  CompactDocument::Index current_text_;
+
+  // JsError objects can only be created on the event thread, so store the
+  // error until the document is created.
+  bool has_error_;
+  ExceptionCode error_code_;
+  std::string error_message_;
 };
 
 }  // namespace dom
@@ -32,7 +32,8 @@ namespace eme {
 
 ImplementationHelperImpl::ImplementationHelperImpl(
     const std::string& key_system, MediaKeys* media_keys)
-    : mutex_("ImplementationHelper"),
+    : manager_(JsManagerImpl::Instance()),
+      mutex_("ImplementationHelper"),
       key_system_(key_system),
       media_keys_(media_keys) {}
 
@@ -45,13 +46,14 @@ std::string ImplementationHelperImpl::DataPathPrefix() const {
       reinterpret_cast<const uint8_t*>(key_system_.data()), key_system_.size());
   const std::string dir = util::ToHexString(hash.data(), hash.size());
   return util::FileSystem::PathJoin(
-      JsManagerImpl::Instance()->GetPathForDynamicFile("eme"), dir);
+      manager_->GetPathForDynamicFile("eme"), dir);
 }
 
 void ImplementationHelperImpl::OnMessage(const std::string& session_id,
                                          MediaKeyMessageType message_type,
                                          const uint8_t* data,
                                          size_t data_size) const {
+  JsManagerImpl::ThreadScope scope(manager_);
   std::unique_lock<Mutex> lock(mutex_);
   RefPtr<MediaKeySession> session = media_keys_->GetSession(session_id);
   if (session) {
@@ -62,6 +64,7 @@ void ImplementationHelperImpl::OnMessage(const std::string& session_id,
 
 void ImplementationHelperImpl::OnKeyStatusChange(
     const std::string& session_id) const {
+  JsManagerImpl::ThreadScope scope(manager_);
   std::unique_lock<Mutex> lock(mutex_);
   RefPtr<MediaKeySession> session = media_keys_->GetSession(session_id);
   if (session) {
@@ -69,6 +72,10 @@ void ImplementationHelperImpl::OnKeyStatusChange(
   }
 }
 
+std::vector<uint8_t> ImplementationHelperImpl::StorageKey() const {
+  return manager_->GetEmeStorageKey();
+}
+
 }  // namespace eme
 }  // namespace js
 }  // namespace shaka
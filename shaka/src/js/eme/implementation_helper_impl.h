@@ -17,12 +17,16 @@
 
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "shaka/eme/implementation_helper.h"
 #include "src/debug/mutex.h"
 #include "src/js/eme/media_key_system_configuration.h"
 
 namespace shaka {
+
+class JsManagerImpl;
+
 namespace js {
 namespace eme {
 
@@ -43,8 +47,12 @@ class ImplementationHelperImpl final : public ImplementationHelper {
                  MediaKeyMessageType message_type, const uint8_t* data,
                  size_t data_size) const override;
   void OnKeyStatusChange(const std::string& session_id) const override;
+  std::vector<uint8_t> StorageKey() const override;
 
  private:
+  // The implementation can call this on any thread, so this binds the manager
+  // that created it.
+  JsManagerImpl* const manager_;
   mutable Mutex mutex_;
   const std::string key_system_;
   MediaKeys* media_keys_;
@@ -122,10 +122,14 @@ Promise MediaKeySession::Load(const std::string& session_id) {
         "Cannot load a persistent license in a temporary session"));
   }
 
+  // This is set first so events raised while loading reach this session.
+  // TODO: This shouldn't be changed if the Promise is rejected.
+  {
+    std::unique_lock<Mutex> lock(mutex_);
+    session_id_ = session_id;
+  }
   Promise ret;
   implementation_->Load(session_id, EmePromise(ret, /* has_value */ true));
-  // TODO: This shouldn't be changed if the Promise is rejected.
-  session_id_ = session_id;
   return ret;
 }
 
@@ -23,12 +23,31 @@ namespace shaka {
 namespace js {
 namespace events {
 
-Event::Event(EventType type) : Event(to_string(type)) {}
+namespace {
+
+double CurrentTimeStamp() {
+  return util::Clock::Instance.GetMonotonicTime() -
+         dom::Document::GetGlobalDocument()->created_at();
+}
+
+optional<EventType> FindEventType(const std::string& name) {
+  EventType type;
+  if (ParseEventType(name, &type))
+    return type;
+  return nullopt;
+}
+
+}  // namespace
+
+Event::Event(EventType type)
+    : type(to_string(type)),
+      time_stamp(CurrentTimeStamp()),
+      event_type_(type) {}
 
 Event::Event(const std::string& type)
     : type(type),
-      time_stamp(util::Clock::Instance.GetMonotonicTime() -
-                 dom::Document::GetGlobalDocument()->created_at()) {}
+      time_stamp(CurrentTimeStamp()),
+      event_type_(FindEventType(type)) {}
 
 // \cond Doxygen_Skip
 Event::~Event() {}
@@ -17,6 +17,7 @@
 
 #include <string>
 
+#include "shaka/optional.h"
 #include "src/core/member.h"
 #include "src/js/events/event_names.h"
 #include "src/mapping/backing_object.h"
@@ -57,6 +58,14 @@ class Event : public BackingObject {
   bool is_immediate_stopped() const {
     return stop_immediate_propagation_;
   }
+  /**
+   * @return The EventType of this event, or nullopt if the type isn't one that
+   *   the library raises.  This allows listeners to be matched without string
+   *   compares.
+   */
+  const optional<EventType>& event_type() const {
+    return event_type_;
+  }
 
   // Exposed methods.
   void PreventDefault();
@@ -75,6 +84,7 @@ class Event : public BackingObject {
   bool default_prevented = false;
 
  private:
+  const optional<EventType> event_type_;
   bool stop_propagation_ = false;
   bool stop_immediate_propagation_ = false;
 };
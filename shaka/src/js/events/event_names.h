@@ -15,6 +15,8 @@
 #ifndef SHAKA_EMBEDDED_JS_EVENTS_EVENT_NAMES_H_
 #define SHAKA_EMBEDDED_JS_EVENTS_EVENT_NAMES_H_
 
+#include <string>
+
 #include "src/util/macros.h"
 
 namespace shaka {
@@ -36,6 +38,8 @@ namespace js {
   DEFINE_EVENT(Seeked, "seeked")                       \
   DEFINE_EVENT(Seeking, "seeking")                     \
   DEFINE_EVENT(Ended, "ended")                         \
+  DEFINE_EVENT(DurationChange, "durationchange")       \
+  DEFINE_EVENT(RateChange, "ratechange")               \
   DEFINE_EVENT(CueChange, "cuechange")                 \
   /* EME events. */                                    \
   DEFINE_EVENT(KeyStatusesChange, "keystatuseschange") \
@@ -60,6 +64,23 @@ namespace js {
   DEFINE_EVENT(RemoveSourceBuffer, "removesourcebuffer")
 
 DEFINE_ENUM_AND_TO_STRING_2(EventType, DEFINE_EVENTS_);
+
+/**
+ * Finds the EventType with the given name.  This is used for events and
+ * listeners created from JavaScript so they can be matched by value.
+ * @return True if the name is a known event type, false otherwise.
+ */
+inline bool ParseEventType(const std::string& name, EventType* type) {
+#define PARSE_EVENT_TYPE_(id, str) \
+  if (name == str) {               \
+    *type = EventType::id;         \
+    return true;                   \
+  }
+  DEFINE_EVENTS_(PARSE_EVENT_TYPE_)
+#undef PARSE_EVENT_TYPE_
+  return false;
+}
+
 #undef DEFINE_EVENTS_
 
 }  // namespace js
@@ -23,7 +23,17 @@ namespace shaka {
 namespace js {
 namespace events {
 
-EventTarget::EventTarget() : is_dispatching_(false) {}
+namespace {
+
+uint64_t PendingBit(EventType type) {
+  const size_t index = static_cast<size_t>(type);
+  DCHECK_LT(index, 64u) << "Too many event types for the pending mask";
+  return uint64_t{1} << index;
+}
+
+}  // namespace
+
+EventTarget::EventTarget() : pending_events_(0), is_dispatching_(false) {}
 // \cond Doxygen_Skip
 EventTarget::~EventTarget() {}
 // \endcond Doxygen_Skip
@@ -46,7 +56,7 @@ void EventTarget::AddEventListener(const std::string& type, Listener callback) {
 
 void EventTarget::SetCppEventListener(EventType type,
                                       std::function<void()> callback) {
-  cpp_listeners_.emplace(to_string(type), callback);
+  cpp_listeners_.emplace(type, callback);
 }
 
 void EventTarget::RemoveEventListener(const std::string& type,
@@ -62,7 +72,7 @@ void EventTarget::RemoveEventListener(const std::string& type,
 }
 
 void EventTarget::UnsetCppEventListener(EventType type) {
-  cpp_listeners_.erase(to_string(type));
+  cpp_listeners_.erase(type);
 }
 
 ExceptionOr<bool> EventTarget::DispatchEvent(RefPtr<Event> event) {
@@ -98,10 +108,64 @@ ExceptionOr<bool> EventTarget::DispatchEvent(RefPtr<Event> event) {
 
 EventTarget::ListenerInfo::ListenerInfo(Listener listener,
                                         const std::string& type)
-    : callback_(listener), type_(type), should_remove_(false) {}
+    : callback_(listener), type_(type), should_remove_(false) {
+  EventType event_type;
+  if (ParseEventType(type, &event_type))
+    event_type_ = event_type;
+}
 
 EventTarget::ListenerInfo::~ListenerInfo() {}
 
+bool EventTarget::ListenerInfo::Matches(const optional<EventType>& event_type,
+                                        const std::string& type) const {
+  // Known types are compared by value; only custom events need to compare
+  // the names.
+  if (event_type.has_value() || event_type_.has_value())
+    return event_type_ == event_type;
+  return type_ == type;
+}
+
+// static
+bool EventTarget::IsCoalesced(EventType type) {
+  switch (type) {
+    case EventType::ReadyStateChange:
+    case EventType::CueChange:
+    case EventType::KeyStatusesChange:
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool EventTarget::MarkPending(EventType type) {
+  const uint64_t bit = PendingBit(type);
+  return (pending_events_.fetch_or(bit) & bit) == 0;
+}
+
+void EventTarget::ClearPending(EventType type) {
+  pending_events_.fetch_and(~PendingBit(type));
+}
+
+bool EventTarget::HasJsListeners(EventType type) const {
+  auto on_iter = on_listeners_.find(type);
+  if (on_iter != on_listeners_.end() && on_iter->second->has_value())
+    return true;
+
+  for (auto& listener : listeners_) {
+    if (!listener.should_remove_ && listener.event_type_ == type &&
+        listener.callback_.has_value()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void EventTarget::InvokeCppListener(EventType type) {
+  auto it = cpp_listeners_.find(type);
+  if (it != cpp_listeners_.end())
+    it->second();
+}
+
 void EventTarget::InvokeListeners(RefPtr<Event> event) {
   if (event->is_stopped())
     return;
@@ -110,13 +174,15 @@ void EventTarget::InvokeListeners(RefPtr<Event> event) {
 
   // First, evoke the cpp callbacks.  They have priority, due to being internal.
   // It is assumed that they will not change during this process.
-  if (cpp_listeners_.count(event->type) > 0)
-    cpp_listeners_.at(event->type)();
+  const optional<EventType>& event_type = event->event_type();
+  if (event_type.has_value())
+    InvokeCppListener(event_type.value());
 
   // Invoke the on-event listeners second.  This is slightly different from
   // Chrome which will invoke it in the order it was set (i.e. calling
   // addEventListener then setting onerror will call callbacks in that order).
-  auto on_iter = on_listeners_.find(event->type);
+  auto on_iter = event_type.has_value() ? on_listeners_.find(event_type.value())
+                                        : on_listeners_.end();
   if (on_iter != on_listeners_.end()) {
     // Note that even though it exists in the map does not mean the field is
     // set.
@@ -145,7 +211,7 @@ void EventTarget::InvokeListeners(RefPtr<Event> event) {
     if (it->should_remove_)
       continue;
 
-    if (it->type_ == event->type && it->callback_.has_value()) {
+    if (it->Matches(event_type, event->type) && it->callback_.has_value()) {
       it->callback_->CallWithThis(this, event);
     }
 
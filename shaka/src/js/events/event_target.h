@@ -15,9 +15,15 @@
 #ifndef SHAKA_EMBEDDED_JS_EVENTS_EVENT_TARGET_H_
 #define SHAKA_EMBEDDED_JS_EVENTS_EVENT_TARGET_H_
 
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
 #include <list>
 #include <memory>
 #include <string>
+#include <tuple>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
 
@@ -25,13 +31,13 @@
 #include "src/core/js_manager_impl.h"
 #include "src/core/member.h"
 #include "src/core/ref_ptr.h"
-#include "src/debug/thread_event.h"
 #include "src/js/events/event.h"
 #include "src/js/events/event_names.h"
 #include "src/mapping/backing_object.h"
 #include "src/mapping/backing_object_factory.h"
 #include "src/mapping/callback.h"
 #include "src/mapping/exception_or.h"
+#include "src/util/templates.h"
 
 namespace shaka {
 namespace js {
@@ -88,49 +94,76 @@ class EventTarget : public BackingObject {
   /**
    * Asynchronously raises the given event on this.  It is safe to call this
    * from any thread.  There needs to be an explicit type parameter for the type
-   * of event to raise, the remaining types should be arguments to its
-   * constructor.  The constructor used does not need to be the one used from
-   * JavaScript.
+   * of event to raise, the remaining arguments are given to its constructor
+   * after the event type.  The constructor used does not need to be the one
+   * used from JavaScript.
+   *
+   * The event object is only created on the event thread, and only if there
+   * are JavaScript listeners for it.  Events that only report that the state of
+   * the target changed (see IsCoalesced) are dropped if the same event is
+   * already pending on this target.
    */
-  template <typename EventType, typename... Args>
-  std::shared_ptr<ThreadEvent<bool>> ScheduleEvent(Args&&... args) {
-    RefPtr<EventType> event = new EventType(std::forward<Args>(args)...);
-    return JsManagerImpl::Instance()->MainThread()->AddInternalTask(
-        TaskPriority::Events, std::string("Schedule ") + EventType::name(),
-        ScheduleEventTask<EventType>(this, event));
+  template <typename E, typename... Args>
+  void ScheduleEvent(EventType type, Args&&... args) {
+    DCHECK(sizeof...(Args) == 0 || !IsCoalesced(type))
+        << "Coalesced events can't have arguments";
+    if (IsCoalesced(type) && !MarkPending(type))
+      return;
+
+    JsManagerImpl::Instance()->MainThread()->PostInternalTask(
+        TaskPriority::Events, "Schedule event",
+        ScheduleEventTask<E, typename std::decay<Args>::type...>(
+            this, type, std::forward<Args>(args)...));
   }
 
   /**
    * Synchronously raises the given event on this.  This must only be called
-   * from the event thread.
+   * from the event thread.  Like ScheduleEvent, this doesn't create the event
+   * object if there are no JavaScript listeners for it.
    */
-  template <typename EventType, typename... Args>
-  ExceptionOr<bool> RaiseEvent(Args... args) {
-    RefPtr<EventType> backing = new EventType(args...);
+  template <typename E, typename... Args>
+  ExceptionOr<bool> RaiseEvent(EventType type, Args... args) {
+    if (!HasJsListeners(type)) {
+      InvokeCppListener(type);
+      return true;
+    }
+
+    RefPtr<E> backing = new E(type, args...);
     return this->DispatchEvent(backing);
   }
 
  protected:
   /** Registers an event on the target. */
   void AddListenerField(EventType type, Listener* on_field) {
-    on_listeners_[to_string(type)] = on_field;
+    on_listeners_[type] = on_field;
   }
 
  private:
-  template <typename E>
+  template <typename E, typename... Args>
   class ScheduleEventTask : public memory::Traceable {
    public:
-    ScheduleEventTask(EventTarget* target, RefPtr<E> event)
-        : target_(target), event_(event) {}
-    ~ScheduleEventTask() override {}
+    template <typename... Params>
+    ScheduleEventTask(EventTarget* target, EventType type, Params&&... params)
+        : target_(target),
+          type_(type),
+          args_(std::forward<Params>(params)...) {}
 
     void Trace(memory::HeapTracer* tracer) const override {
       tracer->Trace(&target_);
-      tracer->Trace(&event_);
+      TraceArgs(tracer, util::make_index_sequence<sizeof...(Args)>());
     }
 
     bool operator()() {
-      ExceptionOr<bool> val = target_->DispatchEvent(event_);
+      if (IsCoalesced(type_))
+        target_->ClearPending(type_);
+      if (!target_->HasJsListeners(type_)) {
+        target_->InvokeCppListener(type_);
+        return true;
+      }
+
+      RefPtr<E> event =
+          CreateEvent(util::make_index_sequence<sizeof...(Args)>());
+      ExceptionOr<bool> val = target_->DispatchEvent(event);
       if (holds_alternative<bool>(val)) {
         return get<bool>(val);
       } else {
@@ -142,19 +175,58 @@ class EventTarget : public BackingObject {
     }
 
    private:
+    template <size_t... I>
+    void TraceArgs(memory::HeapTracer* tracer,
+                   util::index_sequence<I...>) const {
+      // C++11 doesn't have fold expressions, so expand in an initializer list.
+      int unused[] = {0, (tracer->Trace(&std::get<I>(args_)), 0)...};
+      (void)unused;
+    }
+
+    template <size_t... I>
+    RefPtr<E> CreateEvent(util::index_sequence<I...>) {
+      return new E(type_, std::move(std::get<I>(args_))...);
+    }
+
     Member<EventTarget> target_;
-    Member<E> event_;
+    const EventType type_;
+    std::tuple<Args...> args_;
   };
 
   struct ListenerInfo {
     ListenerInfo(Listener listener, const std::string& type);
     ~ListenerInfo();
 
+    /** @return Whether this listens for events with the given type. */
+    bool Matches(const optional<EventType>& event_type,
+                 const std::string& type) const;
+
     Listener callback_;
     std::string type_;
+    optional<EventType> event_type_;
     bool should_remove_;
   };
 
+  /**
+   * @return Whether the given event type is only used to signal that the state
+   *   of the target changed, so raising it once is the same as raising it
+   *   several times in a row.
+   */
+  static bool IsCoalesced(EventType type);
+
+  /**
+   * Marks the given coalesced event as pending.
+   * @return True if the event wasn't already pending.
+   */
+  bool MarkPending(EventType type);
+  void ClearPending(EventType type);
+
+  /** @return Whether there are any JavaScript listeners for the given type. */
+  bool HasJsListeners(EventType type) const;
+
+  /** Invokes the C++ listener for the given event type, if any. */
+  void InvokeCppListener(EventType type);
+
   /** Invokes all the listeners for the given event */
   void InvokeListeners(RefPtr<Event> event);
 
@@ -162,14 +234,17 @@ class EventTarget : public BackingObject {
   std::list<ListenerInfo>::iterator FindListener(const Listener& callback,
                                                  const std::string& type);
 
-  std::unordered_map<std::string, std::function<void()>> cpp_listeners_;
+  std::unordered_map<EventType, std::function<void()>> cpp_listeners_;
 
   // Elements are stored in insert order. Use a list since we store an iterator
   // while invoking and it needs to remain valid with concurrent inserts.  This
   // will also have faster removals since we only use iterators.
   std::list<ListenerInfo> listeners_;
   // A map of the on-event listeners (e.g. onerror).
-  std::unordered_map<std::string, Listener*> on_listeners_;
+  std::unordered_map<EventType, Listener*> on_listeners_;
+  // A bit for each coalesced EventType that has a pending event.  This is
+  // set from any thread when scheduling and cleared on the event thread.
+  std::atomic<uint64_t> pending_events_;
   bool is_dispatching_;
 };
 
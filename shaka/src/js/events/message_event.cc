@@ -0,0 +1,45 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/js/events/message_event.h"
+
+#include <utility>
+
+namespace shaka {
+namespace js {
+namespace events {
+
+MessageEvent::MessageEvent(EventType type, Any data)
+    : MessageEvent(to_string(type), std::move(data)) {}
+
+MessageEvent::MessageEvent(const std::string& type, Any data)
+    : Event(type), data(std::move(data)) {}
+
+// \cond Doxygen_Skip
+MessageEvent::~MessageEvent() {}
+// \endcond Doxygen_Skip
+
+void MessageEvent::Trace(memory::HeapTracer* tracer) const {
+  Event::Trace(tracer);
+  tracer->Trace(&data);
+}
+
+
+MessageEventFactory::MessageEventFactory() {
+  AddReadOnlyProperty("data", &MessageEvent::data);
+}
+
+}  // namespace events
+}  // namespace js
+}  // namespace shaka
@@ -0,0 +1,59 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SHAKA_EMBEDDED_JS_EVENTS_MESSAGE_EVENT_H_
+#define SHAKA_EMBEDDED_JS_EVENTS_MESSAGE_EVENT_H_
+
+#include <string>
+
+#include "src/js/events/event.h"
+#include "src/mapping/any.h"
+#include "src/mapping/backing_object_factory.h"
+
+namespace shaka {
+namespace js {
+namespace events {
+
+/**
+ * See: https://html.spec.whatwg.org/multipage/comms.html#messageevent
+ */
+class MessageEvent final : public Event {
+  DECLARE_TYPE_INFO(MessageEvent);
+
+ public:
+  MessageEvent(EventType type, Any data);
+
+  static MessageEvent* Create(const std::string& type) {
+    return new MessageEvent(type, Any(nullptr));
+  }
+
+  void Trace(memory::HeapTracer* tracer) const override;
+
+  const Any data;
+
+ private:
+  MessageEvent(const std::string& type, Any data);
+};
+
+class MessageEventFactory final
+    : public BackingObjectFactory<MessageEvent, Event> {
+ public:
+  MessageEventFactory();
+};
+
+}  // namespace events
+}  // namespace js
+}  // namespace shaka
+
+#endif  // SHAKA_EMBEDDED_JS_EVENTS_MESSAGE_EVENT_H_
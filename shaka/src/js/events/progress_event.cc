@@ -20,7 +20,10 @@ namespace events {
 
 ProgressEvent::ProgressEvent(EventType type, bool length_computable,
                              double loaded, double total)
-    : ProgressEvent(to_string(type), length_computable, loaded, total) {}
+    : Event(type),
+      length_computable(length_computable),
+      loaded(loaded),
+      total(total) {}
 
 ProgressEvent::ProgressEvent(const std::string& type, bool length_computable,
                              double loaded, double total)
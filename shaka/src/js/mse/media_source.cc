@@ -150,7 +150,9 @@ ExceptionOr<void> MediaSource::EndOfStream(optional<std::string> error) {
 
   ready_state = MediaSourceReadyState::ENDED;
   ScheduleEvent<events::Event>(EventType::SourceEnded);
+  const double old_duration = GetDuration();
   controller_.EndOfStream();
+  OnDurationChanged(old_duration);
   return {};
 }
 
@@ -174,7 +176,9 @@ ExceptionOr<void> MediaSource::SetDuration(double duration) {
     }
   }
 
+  const double old_duration = GetDuration();
   controller_.GetPipelineManager()->SetDuration(duration);
+  OnDurationChanged(old_duration);
   return {};
 }
 
@@ -202,6 +206,14 @@ void MediaSource::CloseMediaSource() {
   ScheduleEvent<events::Event>(EventType::SourceClose);
 }
 
+void MediaSource::OnDurationChanged(double old_duration) {
+  const double duration = GetDuration();
+  if (video_element_ && duration != old_duration &&
+      !(std::isnan(duration) && std::isnan(old_duration))) {
+    video_element_->ScheduleEvent<events::Event>(EventType::DurationChange);
+  }
+}
+
 void MediaSource::OnReadyStateChanged(media::MediaReadyState ready_state) {
   if (video_element_)
     video_element_->OnReadyStateChanged(ready_state);
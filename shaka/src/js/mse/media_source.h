@@ -86,6 +86,11 @@ class MediaSource : public events::EventTarget {
   void OnReadyStateChanged(media::MediaReadyState ready_state);
   /** Called when the media pipeline status changes. */
   void OnPipelineStatusChanged(media::PipelineStatus status);
+  /**
+   * Called after a call that can change the duration; this fires a
+   * "durationchange" event on the video if it changed.
+   */
+  void OnDurationChanged(double old_duration);
   /** Called when a media error occurs. */
   void OnMediaError(media::SourceType source, media::Status error);
   /** Called when the media pipeline is waiting for an EME key. */
@@ -280,9 +280,12 @@ double HTMLVideoElement::PlaybackRate() const {
 
 void HTMLVideoElement::SetPlaybackRate(double rate) {
   if (media_source_) {
-    return media_source_->GetController()
-        ->GetPipelineManager()
-        ->SetPlaybackRate(rate);
+    media::PipelineManager* pipeline =
+        media_source_->GetController()->GetPipelineManager();
+    if (pipeline->GetPlaybackRate() != rate) {
+      pipeline->SetPlaybackRate(rate);
+      ScheduleEvent<events::Event>(EventType::RateChange);
+    }
   }
 }
 
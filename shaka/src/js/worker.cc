@@ -0,0 +1,316 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/js/worker.h"
+
+#include <glog/logging.h>
+
+#include <functional>
+#include <utility>
+
+#include "src/core/js_manager_impl.h"
+#include "src/js/events/event.h"
+#include "src/js/events/event_names.h"
+#include "src/js/events/message_event.h"
+#include "src/js/js_error.h"
+#include "src/mapping/callback.h"
+#include "src/mapping/js_engine.h"
+#include "src/mapping/register_member.h"
+
+namespace shaka {
+namespace js {
+
+namespace {
+
+/**
+ * Clones the given message and schedules |deliver| to be called with it on the
+ * given event thread.
+ */
+ExceptionOr<void> SendMessage(
+    TaskRunner* target, std::shared_ptr<WorkerConnection> connection,
+    void (*deliver)(std::shared_ptr<WorkerConnection>,
+                    std::shared_ptr<StructuredClone>),
+    Any message, optional<std::vector<Any>> transfer) {
+  std::shared_ptr<StructuredClone> clone(new StructuredClone);
+  LocalVar<JsValue> value = message.ToJsValue();
+  ExceptionOr<void> result =
+      clone->Serialize(value, transfer.value_or(std::vector<Any>()));
+  if (holds_alternative<JsError>(result))
+    return result;
+
+  // Messages to a terminated worker are silently dropped.
+  if (target) {
+    target->AddInternalTask(
+        TaskPriority::Events, "postMessage",
+        PlainCallbackTask(std::bind(deliver, connection, clone)));
+  }
+  return {};
+}
+
+/** @return A value holding the deserialized message. */
+Any DeserializeMessage(StructuredClone* message) {
+  LocalVar<JsValue> value = message->Deserialize();
+  Any ret;
+  ret.TryConvert(value);
+  return ret;
+}
+
+}  // namespace
+
+WorkerConnection::WorkerConnection(JsManagerImpl* parent,
+                                   const std::string& script_path)
+    : parent(parent), script_path(script_path) {}
+
+WorkerConnection::~WorkerConnection() {}
+
+
+Worker::Worker(const std::string& url) {
+  AddListenerField(EventType::Message, &on_message);
+  AddListenerField(EventType::Error, &on_error);
+
+  JsManagerImpl* parent = JsManagerImpl::Instance();
+  connection_.reset(
+      new WorkerConnection(parent, parent->GetPathForStaticFile(url)));
+  connection_->worker = this;
+  // This starts the worker's event thread, which will run the script.
+  manager_.reset(new JsManagerImpl(parent->startup_options(), connection_));
+}
+
+// \cond Doxygen_Skip
+Worker::~Worker() {
+  Terminate();
+}
+// \endcond Doxygen_Skip
+
+bool Worker::IsRootedAlive() const {
+  return manager_ || EventTarget::IsRootedAlive();
+}
+
+ExceptionOr<void> Worker::PostMessage(Any message,
+                                      optional<std::vector<Any>> transfer) {
+  return SendMessage(manager_ ? manager_->MainThread() : nullptr, connection_,
+                     &WorkerGlobalScope::DeliverMessage, std::move(message),
+                     std::move(transfer));
+}
+
+void Worker::Terminate() {
+  if (!manager_)
+    return;
+
+  VLOG(1) << "Terminating worker " << connection_->script_path;
+  connection_->worker = nullptr;
+  // This is also called when this object is collected, so interrupt the
+  // worker's script rather than waiting for it to return.  This blocks until
+  // the worker's event thread has stopped and its objects have been destroyed.
+  manager_->Terminate();
+  manager_.reset();
+}
+
+// static
+void Worker::DeliverMessage(std::shared_ptr<WorkerConnection> connection,
+                            std::shared_ptr<StructuredClone> message) {
+  Worker* worker = connection->worker;
+  if (!worker)
+    return;
+
+  worker->RaiseEvent<events::MessageEvent>(EventType::Message,
+                                           DeserializeMessage(message.get()));
+}
+
+// static
+void Worker::DeliverError(std::shared_ptr<WorkerConnection> connection) {
+  Worker* worker = connection->worker;
+  if (worker)
+    worker->RaiseEvent<events::Event>(EventType::Error);
+}
+
+// static
+void Worker::OnClosed(std::shared_ptr<WorkerConnection> connection) {
+  Worker* worker = connection->worker;
+  if (worker)
+    worker->Terminate();
+}
+
+
+WorkerFactory::WorkerFactory() {
+  AddListenerField(EventType::Message, &Worker::on_message);
+  AddListenerField(EventType::Error, &Worker::on_error);
+
+  AddMemberFunction("postMessage", &Worker::PostMessage);
+  AddMemberFunction("terminate", &Worker::Terminate);
+}
+
+
+WorkerGlobalScope::WorkerGlobalScope(
+    std::shared_ptr<WorkerConnection> connection)
+    : connection_(std::move(connection)) {
+  AddListenerField(EventType::Message, &on_message);
+  AddListenerField(EventType::Error, &on_error);
+
+  DCHECK(!connection_->scope);
+  connection_->scope = this;
+}
+
+// \cond Doxygen_Skip
+WorkerGlobalScope::~WorkerGlobalScope() {
+  connection_->scope = nullptr;
+}
+// \endcond Doxygen_Skip
+
+// static
+void WorkerGlobalScope::Install() {
+  JsManagerImpl* manager = JsManagerImpl::Instance();
+  std::shared_ptr<WorkerConnection> connection = manager->worker_connection();
+  CHECK(connection);
+
+  JsEngine* engine = JsEngine::Instance();
+  WorkerGlobalScope* scope = new WorkerGlobalScope(connection);
+  LocalVar<JsValue> self = scope->JsThis();
+  SetMemberRaw(engine->global_handle(), "self", self);
+
+  RegisterGlobalFunction("postMessage", &WorkerGlobalScope::GlobalPostMessage);
+  RegisterGlobalFunction("close", &WorkerGlobalScope::GlobalClose);
+  RegisterGlobalFunction("importScripts",
+                         &WorkerGlobalScope::GlobalImportScripts);
+  RegisterGlobalFunction("addEventListener",
+                         &WorkerGlobalScope::GlobalAddEventListener);
+  RegisterGlobalFunction("removeEventListener",
+                         &WorkerGlobalScope::GlobalRemoveEventListener);
+
+  // Scripts commonly assign "onmessage" on the global object, so make that an
+  // accessor for the scope's field.
+  LocalVar<JsFunction> get_on_message = CreateStaticFunction(
+      "window", "get_onmessage",
+      std::function<Listener()>(&WorkerGlobalScope::GlobalGetOnMessage));
+  LocalVar<JsFunction> set_on_message = CreateStaticFunction(
+      "window", "set_onmessage",
+      std::function<void(Listener)>(&WorkerGlobalScope::GlobalSetOnMessage));
+  SetGenericPropertyRaw(engine->global_handle(), "onmessage", get_on_message,
+                        set_on_message);
+
+  if (!RunScript(connection->script_path)) {
+    LOG(ERROR) << "Error running worker script " << connection->script_path;
+    connection->parent->MainThread()->AddInternalTask(
+        TaskPriority::Events, "Worker error",
+        PlainCallbackTask(std::bind(&Worker::DeliverError, connection)));
+  }
+}
+
+bool WorkerGlobalScope::IsRootedAlive() const {
+  return true;
+}
+
+ExceptionOr<void> WorkerGlobalScope::PostMessage(
+    Any message, optional<std::vector<Any>> transfer) {
+  return SendMessage(connection_->parent->MainThread(), connection_,
+                     &Worker::DeliverMessage, std::move(message),
+                     std::move(transfer));
+}
+
+void WorkerGlobalScope::Close() {
+  if (closing_)
+    return;
+
+  // Drop any pending messages; the parent will stop this thread.
+  closing_ = true;
+  connection_->parent->MainThread()->AddInternalTask(
+      TaskPriority::Internal, "Worker close",
+      PlainCallbackTask(std::bind(&Worker::OnClosed, connection_)));
+}
+
+ExceptionOr<void> WorkerGlobalScope::ImportScripts(
+    const CallbackArguments& arguments) {
+  JsManagerImpl* manager = JsManagerImpl::Instance();
+  for (size_t i = 0; i < ArgumentCount(arguments); i++) {
+    LocalVar<JsValue> url_value = arguments[i];
+    const std::string url = ConvertToString(url_value);
+    if (!RunScript(manager->GetPathForStaticFile(url))) {
+      return JsError::DOMException(NetworkError,
+                                   "Failed to load script '" + url + "'.");
+    }
+  }
+  return {};
+}
+
+// static
+WorkerGlobalScope* WorkerGlobalScope::Current() {
+  const std::shared_ptr<WorkerConnection>& connection =
+      JsManagerImpl::Instance()->worker_connection();
+  CHECK(connection && connection->scope);
+  return connection->scope;
+}
+
+// static
+void WorkerGlobalScope::DeliverMessage(
+    std::shared_ptr<WorkerConnection> connection,
+    std::shared_ptr<StructuredClone> message) {
+  WorkerGlobalScope* scope = connection->scope;
+  if (!scope || scope->closing_)
+    return;
+
+  scope->RaiseEvent<events::MessageEvent>(EventType::Message,
+                                          DeserializeMessage(message.get()));
+}
+
+// static
+ExceptionOr<void> WorkerGlobalScope::GlobalPostMessage(
+    Any message, optional<std::vector<Any>> transfer) {
+  return Current()->PostMessage(std::move(message), std::move(transfer));
+}
+
+// static
+void WorkerGlobalScope::GlobalClose() {
+  Current()->Close();
+}
+
+// static
+ExceptionOr<void> WorkerGlobalScope::GlobalImportScripts(
+    const CallbackArguments& arguments) {
+  return Current()->ImportScripts(arguments);
+}
+
+// static
+WorkerGlobalScope::Listener WorkerGlobalScope::GlobalGetOnMessage() {
+  return Current()->on_message;
+}
+
+// static
+void WorkerGlobalScope::GlobalSetOnMessage(Listener callback) {
+  Current()->on_message = callback;
+}
+
+// static
+void WorkerGlobalScope::GlobalAddEventListener(const std::string& type,
+                                               Listener callback) {
+  Current()->AddEventListener(type, callback);
+}
+
+// static
+void WorkerGlobalScope::GlobalRemoveEventListener(const std::string& type,
+                                                  Listener callback) {
+  Current()->RemoveEventListener(type, callback);
+}
+
+
+WorkerGlobalScopeFactory::WorkerGlobalScopeFactory() {
+  AddListenerField(EventType::Message, &WorkerGlobalScope::on_message);
+  AddListenerField(EventType::Error, &WorkerGlobalScope::on_error);
+
+  AddMemberFunction("postMessage", &WorkerGlobalScope::PostMessage);
+  AddMemberFunction("close", &WorkerGlobalScope::Close);
+  AddMemberFunction("importScripts", &WorkerGlobalScope::ImportScripts);
+}
+
+}  // namespace js
+}  // namespace shaka
@@ -0,0 +1,176 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SHAKA_EMBEDDED_JS_WORKER_H_
+#define SHAKA_EMBEDDED_JS_WORKER_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "shaka/optional.h"
+#include "src/js/events/event_target.h"
+#include "src/mapping/any.h"
+#include "src/mapping/backing_object_factory.h"
+#include "src/mapping/exception_or.h"
+#include "src/mapping/js_wrappers.h"
+#include "src/mapping/structured_clone.h"
+
+namespace shaka {
+
+class JsManagerImpl;
+
+namespace js {
+
+class Worker;
+class WorkerGlobalScope;
+
+/**
+ * The state shared by a Worker object and the thread that runs the worker.
+ * |worker| is only used on the parent's event thread and |scope| is only used
+ * on the worker's event thread, so this doesn't need a lock.
+ */
+struct WorkerConnection {
+  WorkerConnection(JsManagerImpl* parent, const std::string& script_path);
+  ~WorkerConnection();
+
+  /** The manager whose event thread owns the Worker object. */
+  JsManagerImpl* const parent;
+  /** The path to the script the worker runs. */
+  const std::string script_path;
+
+  /** The Worker object, or null once it is terminated. */
+  Worker* worker = nullptr;
+  /** The worker's global scope, or null if it hasn't been created yet. */
+  WorkerGlobalScope* scope = nullptr;
+};
+
+
+/**
+ * A dedicated Web Worker.  Each worker runs its script using its own
+ * JavaScript engine on its own event thread (see JsManagerImpl), so apps can
+ * move heavy work like manifest parsing off the main thread.  Messages are
+ * passed using StructuredClone, so transferred ArrayBuffers aren't copied.
+ *
+ * The script URL is relative to the static data directory.
+ *
+ * See: https://html.spec.whatwg.org/multipage/workers.html#dedicated-workers-and-the-worker-interface
+ */
+class Worker : public events::EventTarget {
+  DECLARE_TYPE_INFO(Worker);
+
+ public:
+  explicit Worker(const std::string& url);
+
+  static Worker* Create(const std::string& url) {
+    return new Worker(url);
+  }
+
+  /** A running worker keeps this object alive until it is terminated. */
+  bool IsRootedAlive() const override;
+
+  ExceptionOr<void> PostMessage(Any message,
+                                optional<std::vector<Any>> transfer);
+  void Terminate();
+
+  Listener on_message;
+  Listener on_error;
+
+ private:
+  friend class WorkerGlobalScope;
+
+  /** Called on the parent's event thread when the worker posts a message. */
+  static void DeliverMessage(std::shared_ptr<WorkerConnection> connection,
+                             std::shared_ptr<StructuredClone> message);
+  /** Called on the parent's event thread when the worker's script fails. */
+  static void DeliverError(std::shared_ptr<WorkerConnection> connection);
+  /** Called on the parent's event thread when the worker calls close(). */
+  static void OnClosed(std::shared_ptr<WorkerConnection> connection);
+
+  std::shared_ptr<WorkerConnection> connection_;
+  std::unique_ptr<JsManagerImpl> manager_;
+};
+
+class WorkerFactory : public BackingObjectFactory<Worker, events::EventTarget> {
+ public:
+  WorkerFactory();
+};
+
+
+/**
+ * The global scope of a dedicated worker, exposed as "self".  The engine's
+ * global object isn't this object, so the messaging functions and "onmessage"
+ * are also defined as globals and forward here.
+ *
+ * See: https://html.spec.whatwg.org/multipage/workers.html#dedicatedworkerglobalscope
+ */
+class WorkerGlobalScope : public events::EventTarget {
+  DECLARE_TYPE_INFO(WorkerGlobalScope);
+
+ public:
+  explicit WorkerGlobalScope(std::shared_ptr<WorkerConnection> connection);
+
+  /**
+   * Defines the worker globals in the current engine, then runs the worker's
+   * script.  This must be called on the worker's event thread.
+   */
+  static void Install();
+
+  /** The scope lives as long as the worker's engine. */
+  bool IsRootedAlive() const override;
+
+  ExceptionOr<void> PostMessage(Any message,
+                                optional<std::vector<Any>> transfer);
+  void Close();
+  ExceptionOr<void> ImportScripts(const CallbackArguments& arguments);
+
+  Listener on_message;
+  Listener on_error;
+
+ private:
+  friend class Worker;
+
+  /** @return The scope of the worker running on the current thread. */
+  static WorkerGlobalScope* Current();
+
+  /** Called on the worker's event thread when the parent posts a message. */
+  static void DeliverMessage(std::shared_ptr<WorkerConnection> connection,
+                             std::shared_ptr<StructuredClone> message);
+
+  static ExceptionOr<void> GlobalPostMessage(
+      Any message, optional<std::vector<Any>> transfer);
+  static void GlobalClose();
+  static ExceptionOr<void> GlobalImportScripts(
+      const CallbackArguments& arguments);
+  static Listener GlobalGetOnMessage();
+  static void GlobalSetOnMessage(Listener callback);
+  static void GlobalAddEventListener(const std::string& type,
+                                     Listener callback);
+  static void GlobalRemoveEventListener(const std::string& type,
+                                        Listener callback);
+
+  std::shared_ptr<WorkerConnection> connection_;
+  bool closing_ = false;
+};
+
+class WorkerGlobalScopeFactory
+    : public BackingObjectFactory<WorkerGlobalScope, events::EventTarget> {
+ public:
+  WorkerGlobalScopeFactory();
+};
+
+}  // namespace js
+}  // namespace shaka
+
+#endif  // SHAKA_EMBEDDED_JS_WORKER_H_
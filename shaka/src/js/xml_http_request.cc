@@ -23,6 +23,7 @@
 
 #include "src/core/environment.h"
 #include "src/core/js_manager_impl.h"
+#include "src/debug/trace_recorder.h"
 #include "src/js/events/event.h"
 #include "src/js/events/event_names.h"
 #include "src/js/events/progress_event.h"
@@ -127,9 +128,11 @@ bool ParseStatusLine(const char* buffer, size_t length, int* code,
 
 XMLHttpRequest::XMLHttpRequest()
     : ready_state(UNSENT),
+      manager_(JsManagerImpl::Instance()),
       mutex_("XMLHttpRequest"),
       curl_(curl_easy_init()),
-      request_headers_(nullptr) {
+      request_headers_(nullptr),
+      progress_pending_(false) {
   AddListenerField(EventType::Abort, &on_abort);
   AddListenerField(EventType::Error, &on_error);
   AddListenerField(EventType::Load, &on_load);
@@ -146,7 +149,7 @@ XMLHttpRequest::XMLHttpRequest()
 XMLHttpRequest::~XMLHttpRequest() {
   // Don't call Abort() since we can't raise events.
   abort_pending_ = true;
-  JsManagerImpl::Instance()->NetworkThread()->AbortRequest(this);
+  manager_->NetworkThread()->AbortRequest(this);
 
   curl_easy_cleanup(curl_);
   if (request_headers_)
@@ -168,11 +171,12 @@ bool XMLHttpRequest::IsShortLived() const {
 }
 
 void XMLHttpRequest::Abort() {
-  if (!JsManagerImpl::Instance()->NetworkThread()->ContainsRequest(this))
+  if (!manager_->NetworkThread()->ContainsRequest(this))
     return;
 
+  TraceRecorder::AddInstantEvent("XMLHttpRequest abort");
   abort_pending_ = true;
-  JsManagerImpl::Instance()->NetworkThread()->AbortRequest(this);
+  manager_->NetworkThread()->AbortRequest(this);
 
   std::unique_lock<Mutex> lock(mutex_);
   if (ready_state != DONE) {
@@ -246,7 +250,7 @@ ExceptionOr<void> XMLHttpRequest::Send(
     optional<variant<ByteBuffer, ByteString>> maybe_data) {
   // Don't query while locked to avoid a deadlock.
   const bool contains_request =
-      JsManagerImpl::Instance()->NetworkThread()->ContainsRequest(this);
+      manager_->NetworkThread()->ContainsRequest(this);
 
   {
     std::unique_lock<Mutex> lock(mutex_);
@@ -285,7 +289,8 @@ ExceptionOr<void> XMLHttpRequest::Send(
   }
 
   // Don't add while locked to avoid a deadlock.
-  JsManagerImpl::Instance()->NetworkThread()->AddRequest(this);
+  TraceRecorder::AddInstantEvent("XMLHttpRequest send");
+  manager_->NetworkThread()->AddRequest(this);
   return {};
 }
 
@@ -302,7 +307,9 @@ ExceptionOr<void> XMLHttpRequest::SetRequestHeader(const std::string& key,
 }
 
 void XMLHttpRequest::RaiseProgressEvents() {
+  ScopedTrace trace("XMLHttpRequest progress");
   std::unique_lock<Mutex> lock(mutex_);
+  progress_pending_ = false;
   if (abort_pending_)
     return;
 
@@ -321,15 +328,21 @@ void XMLHttpRequest::RaiseProgressEvents() {
 }
 
 void XMLHttpRequest::OnDataReceived(uint8_t* buffer, size_t length) {
+  JsManagerImpl::ThreadScope scope(manager_);
+  manager_->AddNetworkBytesReceived(length);
   std::unique_lock<Mutex> lock(mutex_);
 
   // We need to schedule these events from this callback since we don't know
-  // when the last header will be received.
+  // when the last header will be received.  If the event thread hasn't handled
+  // the last progress task yet, don't queue another; it reads the current
+  // size when it runs.
   const uint64_t now = util::Clock::Instance.GetMonotonicTime();
-  if (!abort_pending_ && now - last_progress_time_ >= kProgressInterval) {
+  if (!abort_pending_ && !progress_pending_ &&
+      now - last_progress_time_ >= kProgressInterval) {
     last_progress_time_ = now;
-    JsManagerImpl::Instance()->MainThread()->AddInternalTask(
-        TaskPriority::Internal, "Schedule XHR events",
+    progress_pending_ = true;
+    manager_->MainThread()->AddInternalTask(
+        TaskPriority::Internal, "XHR progress",
         MemberCallbackTask(this, &XMLHttpRequest::RaiseProgressEvents));
   }
 
@@ -433,7 +446,7 @@ void XMLHttpRequest::Reset() {
   curl_easy_setopt(curl_, CURLOPT_USERAGENT, USER_AGENT);
 
   const std::string cookie_file =
-      JsManagerImpl::Instance()->GetPathForDynamicFile(kCookieFileName);
+      manager_->GetPathForDynamicFile(kCookieFileName);
   curl_easy_setopt(curl_, CURLOPT_COOKIEFILE, cookie_file.c_str());
   curl_easy_setopt(curl_, CURLOPT_COOKIEJAR, cookie_file.c_str());
 
@@ -449,6 +462,8 @@ void XMLHttpRequest::Reset() {
 
 void XMLHttpRequest::OnRequestComplete(CURLcode code) {
   // Careful, this is called from the worker thread, so we cannot call into V8.
+  JsManagerImpl::ThreadScope scope(manager_);
+  ScopedTrace trace("XMLHttpRequest complete");
   std::unique_lock<Mutex> lock(mutex_);
   if (code == CURLE_OK) {
     response_text = temp_data_.CreateString();
@@ -32,6 +32,7 @@
 #include "src/util/dynamic_buffer.h"
 
 namespace shaka {
+class JsManagerImpl;
 class NetworkThread;
 
 namespace js {
@@ -128,6 +129,9 @@ class XMLHttpRequest : public events::EventTarget {
 
   void Reset();
 
+  // The manager that created this request.  The network thread is shared by
+  // all the managers, so this is bound while handling the request there.
+  JsManagerImpl* const manager_;
   mutable Mutex mutex_;
   std::map<std::string, std::string> response_headers_;
   util::DynamicBuffer temp_data_;
@@ -139,6 +143,8 @@ class XMLHttpRequest : public events::EventTarget {
   uint64_t last_progress_time_;
   double estimated_size_;
   bool parsing_headers_;
+  // Whether a RaiseProgressEvents task is queued on the event thread.
+  bool progress_pending_;
   std::atomic<bool> abort_pending_;
 };
 
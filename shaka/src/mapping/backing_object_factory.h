@@ -215,7 +215,7 @@ class BackingObjectFactoryBase {
   template <typename Callback>
   void AddMemberFunction(const std::string& name, Callback callback) {
     LocalVar<JsFunction> js_function =
-        CreateMemberFunction(type_name_, name, MakeMemFn<void>(callback));
+        CreateMemFn<void>(type_name_, name, callback);
     LocalVar<JsValue> value(RawToJsValue(js_function));
     SetMemberRaw(prototype_, name, value);
   }
@@ -279,8 +279,8 @@ class BackingObjectFactoryBase {
             typename GetProp = void>
   void AddGenericProperty(const std::string& name,
                           GetProp (This::*get)() const) {
-    LocalVar<JsFunction> getter = CreateMemberFunction(
-        type_name_, "get_" + name, MakeMemFn<Derived>(get));
+    LocalVar<JsFunction> getter =
+        CreateMemFn<Derived>(type_name_, "get_" + name, get);
     LocalVar<JsFunction> setter;
     SetGenericPropertyRaw(prototype_, name, getter, setter);
   }
@@ -296,10 +296,10 @@ class BackingObjectFactoryBase {
     static_assert(std::is_same<void, SetPropRet>::value ||
                       std::is_same<ExceptionOr<void>, SetPropRet>::value,
                   "Setter can only return void.");
-    LocalVar<JsFunction> getter = CreateMemberFunction(
-        type_name_, "get_" + name, MakeMemFn<Derived>(get));
-    LocalVar<JsFunction> setter = CreateMemberFunction(
-        type_name_, "set_" + name, MakeMemFn<Derived>(set));
+    LocalVar<JsFunction> getter =
+        CreateMemFn<Derived>(type_name_, "get_" + name, get);
+    LocalVar<JsFunction> setter =
+        CreateMemFn<Derived>(type_name_, "set_" + name, set);
     SetGenericPropertyRaw(prototype_, name, getter, setter);
   }
 
@@ -324,33 +324,55 @@ class BackingObjectFactoryBase {
   using get_this = typename std::conditional<std::is_same<Derived, void>::value,
                                              This, Derived>::type;
 
+  /**
+   * Calls a member function pointer on the |this| object.  This is stored
+   * directly in the function data, so calling it doesn't need to go through a
+   * std::function and the arguments are only moved once.
+   */
+  template <typename ArgThis, typename Ret, typename Callback>
+  struct MemFnCallback {
+    template <typename... Args>
+    Ret operator()(const RefPtr<ArgThis>& that, Args&&... args) const {
+      return ((that.get())->*(callback))(std::forward<Args>(args)...);
+    }
+
+    Callback callback;
+  };
+
   template <typename Derived, typename Callback>
-  struct MakeMemFnImpl;
+  struct MemFnImpl;
   template <typename Derived, typename This, typename Ret, typename... Args>
-  struct MakeMemFnImpl<Derived, Ret (This::*)(Args...)> {
+  struct MemFnImpl<Derived, Ret (This::*)(Args...)> {
     using ArgThis = get_this<Derived, This>;
-    using type = std::function<Ret(RefPtr<ArgThis>, Args...)>;
-    static type Make(Ret (This::*callback)(Args...)) {
-      return [=](RefPtr<ArgThis> that, Args... args) -> Ret {
-        return ((that.get())->*(callback))(std::move(args)...);
-      };
+    using Callback = Ret (This::*)(Args...);
+    static ReturnVal<JsFunction> Create(const std::string& target,
+                                        const std::string& name,
+                                        Callback callback) {
+      MemFnCallback<ArgThis, Ret, Callback> func;
+      func.callback = callback;
+      return impl::CreateJsFunctionFromCallback<Ret, RefPtr<ArgThis>, Args...>(
+          target, name, func, /* is_member_func */ true);
     }
   };
   template <typename Derived, typename This, typename Ret, typename... Args>
-  struct MakeMemFnImpl<Derived, Ret (This::*)(Args...) const> {
+  struct MemFnImpl<Derived, Ret (This::*)(Args...) const> {
     using ArgThis = get_this<Derived, This>;
-    using type = std::function<Ret(RefPtr<ArgThis>, Args...)>;
-    static type Make(Ret (This::*callback)(Args...) const) {
-      return [=](RefPtr<ArgThis> that, Args... args) -> Ret {
-        return ((that.get())->*(callback))(std::move(args)...);
-      };
+    using Callback = Ret (This::*)(Args...) const;
+    static ReturnVal<JsFunction> Create(const std::string& target,
+                                        const std::string& name,
+                                        Callback callback) {
+      MemFnCallback<ArgThis, Ret, Callback> func;
+      func.callback = callback;
+      return impl::CreateJsFunctionFromCallback<Ret, RefPtr<ArgThis>, Args...>(
+          target, name, func, /* is_member_func */ true);
     }
   };
 
   template <typename Derived, typename Callback>
-  static typename MakeMemFnImpl<Derived, Callback>::type MakeMemFn(
-      Callback callback) {
-    return MakeMemFnImpl<Derived, Callback>::Make(callback);
+  static ReturnVal<JsFunction> CreateMemFn(const std::string& target,
+                                           const std::string& name,
+                                           Callback callback) {
+    return MemFnImpl<Derived, Callback>::Create(target, name, callback);
   }
 
   const std::string type_name_;
@@ -373,6 +395,9 @@ class BackingObjectFactoryBase {
  * since doing so would require knowing the base type.  To be able to be used
  * in this way, it is valid to use the Instance() method when T is void, but it
  * is invalid to create an instance when T is void.
+ *
+ * Factories are bound to the thread that creates them (the event thread), so
+ * each JavaScript engine has its own set.
  */
 template <typename T>
 class BackingObjectFactoryRegistry
@@ -395,6 +420,9 @@ class BackingObjectFactoryRegistry
 
  private:
   friend class PseudoSingleton<BackingObjectFactoryRegistry<T>>;
+  using Singleton = PseudoSingleton<BackingObjectFactoryRegistry<T>>;
+
+  typename Singleton::ScopedThreadInstance thread_instance_{this};
 };
 template <>
 inline BackingObjectFactoryBase*
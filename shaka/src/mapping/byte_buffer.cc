@@ -79,6 +79,53 @@ void ByteBuffer::SetFromBuffer(const void* buffer, size_t size) {
   std::memcpy(ptr_, buffer, size_);
 }
 
+bool ByteBuffer::TryTransfer(Handle<JsValue> value) {
+#if defined(USING_V8)
+  if (value.IsEmpty() || !value->IsArrayBuffer())
+    return false;
+
+  v8::Local<v8::ArrayBuffer> buffer = value.As<v8::ArrayBuffer>();
+  if (!buffer->IsNeuterable())
+    return false;
+
+  if (buffer->IsExternal()) {
+    // Someone else owns the memory, so we can't take it.
+    v8::ArrayBuffer::Contents contents = buffer->GetContents();
+    SetFromBuffer(contents.Data(), contents.ByteLength());
+  } else {
+    // The memory was allocated by JsEngine::ArrayBufferAllocator using malloc,
+    // so we can take ownership of it and free it like our own buffers.
+    Clear();
+    v8::ArrayBuffer::Contents contents = buffer->Externalize();
+    ptr_ = reinterpret_cast<uint8_t*>(contents.Data());
+    size_ = contents.ByteLength();
+    own_ptr_ = true;
+  }
+  buffer->Neuter();
+#elif defined(USING_JSC)
+  JSContextRef cx = GetContext();
+  if (JSValueGetTypedArrayType(cx, value, nullptr) !=
+      kJSTypedArrayTypeArrayBuffer) {
+    return false;
+  }
+
+  LocalVar<JsObject> object = UnsafeJsCast<JsObject>(value);
+  SetFromBuffer(JSObjectGetArrayBufferBytesPtr(cx, object, nullptr),
+                JSObjectGetArrayBufferByteLength(cx, object, nullptr));
+
+  // JSC has no API to detach a buffer, but ArrayBuffer.prototype.transfer
+  // detaches it when the engine supports it.  The bytes were already copied,
+  // so the new buffer is dropped.
+  LocalVar<JsValue> transfer = GetMemberRaw(object, "transfer");
+  if (GetValueType(transfer) == JSValueType::Function) {
+    LocalVar<JsValue> ignored;
+    InvokeMethod(UnsafeJsCast<JsFunction>(transfer), object, 0, nullptr,
+                 &ignored);
+  }
+#endif
+  return true;
+}
+
 bool ByteBuffer::TryConvert(Handle<JsValue> value) {
 #if defined(USING_V8)
   if (value.IsEmpty())
@@ -73,6 +73,21 @@ class ByteBuffer : public GenericConverter, public memory::Traceable {
   /** Similar to SetFromDynamicBuffer, except accepts a single buffer source. */
   void SetFromBuffer(const void* buffer, size_t size);
 
+  /**
+   * Clears the buffer and moves the contents of the given ArrayBuffer into
+   * this object, detaching the ArrayBuffer so JavaScript can't use it anymore.
+   * When possible, this takes ownership of the memory instead of copying it.
+   * Like SetFromBuffer, the data can then be passed to a JavaScript engine on
+   * another thread using ToJsValue.
+   *
+   * JSC doesn't allow detaching an ArrayBuffer, so this copies the data and
+   * leaves the ArrayBuffer usable.
+   *
+   * @return True on success, false if the value isn't an ArrayBuffer that can
+   *   be detached.
+   */
+  bool TryTransfer(Handle<JsValue> value);
+
 
   bool TryConvert(Handle<JsValue> value) override;
   ReturnVal<JsValue> ToJsValue() const override;
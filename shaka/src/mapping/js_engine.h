@@ -32,8 +32,11 @@ namespace shaka {
  * Manages the global JavaScript engine.  This involves initializing any global
  * state and creating a new context that this manages.  This should be the first
  * member of JsManager::Impl to ensure the JavaScript engine is setup before
- * anything else.  This does not free the global state, only the context,
- * allowing multiple to exist, so long as there is only one at a time.
+ * anything else.  This does not free the global state, only the context.
+ *
+ * Several engines can exist at once, each used by a single thread.  The engine
+ * is bound to the thread that creates it, so Instance() on that thread returns
+ * this engine.
  */
 class JsEngine : public PseudoSingleton<JsEngine> {
  public:
@@ -43,6 +46,20 @@ class JsEngine : public PseudoSingleton<JsEngine> {
   Handle<JsObject> global_handle();
   ReturnVal<JsValue> global_value();
 
+  /**
+   * @return The internalized string for the given property name.  The string
+   *   is created the first time the name is used and is cached by the pointer
+   *   (see PropertyName), so property accesses don't create new strings.
+   */
+  ReturnVal<JsString> GetPropertyName(const char* name);
+
+  /**
+   * Interrupts the JavaScript that is running on the engine's thread, if any.
+   * Unlike the other methods, this can be called from any thread.  JSC has no
+   * API for this, so it does nothing there.
+   */
+  void TerminateExecution();
+
 #if defined(USING_V8)
   void OnPromiseReject(v8::PromiseRejectMessage message);
   void AddDestructor(void* object, std::function<void(void*)> destruct);
@@ -70,6 +87,10 @@ class JsEngine : public PseudoSingleton<JsEngine> {
   };
 
  private:
+  // This is first so the engine is bound to the thread until all the members
+  // are destroyed.
+  ScopedThreadInstance thread_instance_{this};
+
 #if defined(USING_V8)
   class ArrayBufferAllocator : public v8::ArrayBuffer::Allocator {
    public:
@@ -85,9 +106,11 @@ class JsEngine : public PseudoSingleton<JsEngine> {
   std::unordered_map<void*, std::function<void(void*)>> destructors_;
   v8::Isolate* isolate_;
   v8::Global<v8::Context> context_;
+  std::unordered_map<const char*, v8::Global<v8::String>> property_names_;
 #elif defined(USING_JSC)
   JSGlobalContextRef context_;
   std::thread::id thread_id_;
+  std::unordered_map<const char*, util::CFRef<JSStringRef>> property_names_;
 #endif
 
   RejectedPromiseHandler promise_handler_;
@@ -16,6 +16,7 @@
 #define SHAKA_EMBEDDED_MAPPING_JS_WRAPPERS_H_
 
 #include <glog/logging.h>
+#include <stddef.h>
 
 #include <string>
 #include <vector>
@@ -259,9 +260,41 @@ inline size_t ArgumentCount(const CallbackArguments& arguments) {
  */
 std::vector<std::string> GetMemberNames(Handle<JsObject> object);
 
+/**
+ * The name of a property that is known at compile time.  Accessing a member by
+ * a std::string creates a new JavaScript string for each access.  A
+ * PropertyName is instead converted once per JsEngine to an internalized
+ * string, which is cached by pointer and reused (see
+ * JsEngine::GetPropertyName).  So this must only hold string literals or other
+ * strings that live as long as the engine.
+ *
+ * String literals passed to GetMemberRaw/SetMemberRaw use this automatically.
+ */
+class PropertyName {
+ public:
+  template <size_t N>
+  constexpr PropertyName(const char (&name)[N])  // NOLINT(runtime/explicit)
+      : name_(name) {}
+  /** Wraps a name from a static table; it must never be freed. */
+  explicit constexpr PropertyName(const char* name) : name_(name) {}
+
+  const char* name() const {
+    return name_;
+  }
+
+ private:
+  const char* name_;
+};
+
 /** @return The given member of the given object. */
 ReturnVal<JsValue> GetMemberRaw(Handle<JsObject> object,
                                 const std::string& name);
+ReturnVal<JsValue> GetMemberRaw(Handle<JsObject> object, PropertyName name);
+template <size_t N>
+ReturnVal<JsValue> GetMemberRaw(Handle<JsObject> object,
+                                const char (&name)[N]) {
+  return GetMemberRaw(object, PropertyName(name));
+}
 
 /** @return The member at the given index of the given object. */
 ReturnVal<JsValue> GetArrayIndexRaw(Handle<JsObject> object, size_t index);
@@ -269,6 +302,13 @@ ReturnVal<JsValue> GetArrayIndexRaw(Handle<JsObject> object, size_t index);
 /** Sets the given member on the given object. */
 void SetMemberRaw(Handle<JsObject> object, const std::string& name,
                   Handle<JsValue> value);
+void SetMemberRaw(Handle<JsObject> object, PropertyName name,
+                  Handle<JsValue> value);
+template <size_t N>
+void SetMemberRaw(Handle<JsObject> object, const char (&name)[N],
+                  Handle<JsValue> value) {
+  SetMemberRaw(object, PropertyName(name), value);
+}
 
 /** Sets the member at the given index of the given object. */
 void SetArrayIndexRaw(Handle<JsObject> object, size_t i, Handle<JsValue> value);
@@ -339,6 +379,8 @@ bool IsDerivedFrom(BackingObject* ptr, const std::string& name);
  * isolate.
  *
  * @param path The file path to the JavaScript file.
+ * @return True on success, false if the file couldn't be read or the script
+ *   threw an exception.
  */
 bool RunScript(const std::string& path);
 
@@ -364,6 +406,12 @@ ReturnVal<JsValue> ParseJsonString(const std::string& json);
 /** @return A new string object containing the given UTF-8 string. */
 ReturnVal<JsString> JsStringFromUtf8(const std::string& str);
 
+/**
+ * @return The internalized string for the given property name.  This is only
+ *   created once for each engine.
+ */
+ReturnVal<JsString> JsStringFromPropertyName(PropertyName name);
+
 /** @return The JavaScript value |undefined|. */
 ReturnVal<JsValue> JsUndefined();
 
@@ -404,6 +452,9 @@ bool IsBuiltInObject(Handle<JsObject> object);
 /** @return The type of value contained. */
 JSValueType GetValueType(Handle<JsValue> value);
 
+/** @return Whether the two values are strictly equal (i.e. |a === b|). */
+bool StrictEquals(Handle<JsValue> a, Handle<JsValue> b);
+
 
 ///@{
 /**
@@ -65,6 +65,24 @@ ReturnVal<JsValue> JsEngine::global_value() {
   return JSContextGetGlobalObject(context());
 }
 
+ReturnVal<JsString> JsEngine::GetPropertyName(const char* name) {
+  auto it = property_names_.find(name);
+  if (it != property_names_.end())
+    return it->second;
+
+  // CFRef retains the string, so release the reference from creating it.
+  JSStringRef str = JSStringCreateWithUTF8CString(name);
+  util::CFRef<JSStringRef> ret(str);
+  JSStringRelease(str);
+  property_names_.emplace(name, ret);
+  return ret;
+}
+
+void JsEngine::TerminateExecution() {
+  // JSC only supports interrupting scripts using a private API, so a script
+  // that never returns will block the thread.
+}
+
 JSContextRef JsEngine::context() const {
   // TODO: Consider asserting we are on the correct thread.  Unlike other
   // JavaScript engines, JSC allows access from any thread and will just
@@ -18,6 +18,7 @@
 
 #include "src/mapping/backing_object.h"
 #include "src/mapping/convert_js.h"
+#include "src/mapping/js_engine.h"
 #include "src/mapping/js_utils.h"
 #include "src/util/file_system.h"
 
@@ -31,12 +32,10 @@ JSClassDefinition wrapper_class_def = {
 };
 
 JSClassRef GetWrapperClass() {
-  static JSClassRef class_ = nullptr;
-  if (!class_) {
-    class_ = JSClassCreate(&wrapper_class_def);
-    CHECK(class_);
-  }
-
+  // This is shared by every context; static initialization is thread-safe so
+  // it can be created on any event thread.
+  static JSClassRef class_ = JSClassCreate(&wrapper_class_def);
+  CHECK(class_);
   return class_;
 }
 
@@ -120,6 +119,11 @@ ReturnVal<JsValue> GetMemberRaw(Handle<JsObject> object,
                              nullptr);
 }
 
+ReturnVal<JsValue> GetMemberRaw(Handle<JsObject> object, PropertyName name) {
+  return JSObjectGetProperty(GetContext(), object,
+                             JsStringFromPropertyName(name), nullptr);
+}
+
 ReturnVal<JsValue> GetArrayIndexRaw(Handle<JsObject> object, size_t index) {
   return JSObjectGetPropertyAtIndex(GetContext(), object, index, nullptr);
 }
@@ -130,6 +134,12 @@ void SetMemberRaw(Handle<JsObject> object, const std::string& name,
                       kJSPropertyAttributeNone, nullptr);
 }
 
+void SetMemberRaw(Handle<JsObject> object, PropertyName name,
+                  Handle<JsValue> value) {
+  JSObjectSetProperty(GetContext(), object, JsStringFromPropertyName(name),
+                      value, kJSPropertyAttributeNone, nullptr);
+}
+
 void SetArrayIndexRaw(Handle<JsObject> object, size_t i,
                       Handle<JsValue> value) {
   JSObjectSetPropertyAtIndex(GetContext(), object, i, value, nullptr);
@@ -226,10 +236,15 @@ bool IsDerivedFrom(BackingObject* ptr, const std::string& name) {
 }
 
 bool RunScript(const std::string& path) {
+  // JSC doesn't support external 8-bit strings, so this still needs to copy
+  // into the string, but this avoids reading the file into another buffer.
   util::FileSystem fs;
-  std::vector<uint8_t> code;
-  CHECK(fs.ReadFile(path, &code));
-  return RunScript(path, code.data(), code.size());
+  std::shared_ptr<util::MappedFile> file;
+  if (!fs.MapFile(path, &file)) {
+    LOG(ERROR) << "Unable to read script " << path;
+    return false;
+  }
+  return RunScript(path, file->data(), file->size());
 }
 
 bool RunScript(const std::string& path, const uint8_t* data, size_t size) {
@@ -260,6 +275,10 @@ ReturnVal<JsString> JsStringFromUtf8(const std::string& str) {
   return JSStringCreateWithCFString(cf_str);
 }
 
+ReturnVal<JsString> JsStringFromPropertyName(PropertyName name) {
+  return JsEngine::Instance()->GetPropertyName(name.name());
+}
+
 ReturnVal<JsValue> JsUndefined() {
   return JSValueMakeUndefined(GetContext());
 }
@@ -388,6 +407,10 @@ JSValueType GetValueType(Handle<JsValue> value) {
   return JSValueType::OtherObject;
 }
 
+bool StrictEquals(Handle<JsValue> a, Handle<JsValue> b) {
+  return JSValueIsStrictEqual(GetContext(), a, b);
+}
+
 double NumberFromValue(Handle<JsValue> value) {
   JSContextRef cx = GetContext();
   DCHECK(JSValueIsNumber(cx, value) ||
@@ -15,6 +15,7 @@
 #ifndef SHAKA_EMBEDDED_MAPPING_REGISTER_MEMBER_H_
 #define SHAKA_EMBEDDED_MAPPING_REGISTER_MEMBER_H_
 
+#include <functional>
 #include <string>
 #include <type_traits>
 #include <utility>
@@ -190,7 +191,7 @@ struct HandleSetReturn<ExceptionOr<T>> {
 template <typename Ret>
 struct CallAndSetReturn {
   template <typename Func, typename... Args>
-  static bool Call(const CallbackArguments& arguments, Func callback,
+  static bool Call(const CallbackArguments& arguments, const Func& callback,
                    Args&&... args) {
     static_assert(!std::is_rvalue_reference<Ret>::value,
                   "Cannot return an rvalue reference.");
@@ -201,7 +202,7 @@ struct CallAndSetReturn {
 template <>
 struct CallAndSetReturn<void> {
   template <typename Func, typename... Args>
-  static bool Call(const CallbackArguments& arguments, Func callback,
+  static bool Call(const CallbackArguments& arguments, const Func& callback,
                    Args&&... args) {
     callback(std::forward<Args>(args)...);
     return true;
@@ -220,7 +221,8 @@ struct CallHelper<Ret> {
                                      const std::string& target_name,
                                      bool is_member_func,
                                      const CallbackArguments& arguments,
-                                     Func callback, GivenArgs&&... args) {
+                                     const Func& callback,
+                                     GivenArgs&&... args) {
     return CallAndSetReturn<Ret>::Call(arguments, callback,
                                        std::forward<GivenArgs>(args)...);
   }
@@ -237,7 +239,8 @@ struct CallHelper<Ret, const CallbackArguments&, RemainingArgs...> {
                                      const std::string& target_name,
                                      bool is_member_func,
                                      const CallbackArguments& arguments,
-                                     Func callback, GivenArgs&&... args) {
+                                     const Func& callback,
+                                     GivenArgs&&... args) {
     return CallHelper<Ret, RemainingArgs...>::ConvertAndCallFunction(
         func_name, target_name, is_member_func, arguments, callback,
         std::forward<GivenArgs>(args)..., arguments);
@@ -245,6 +248,8 @@ struct CallHelper<Ret, const CallbackArguments&, RemainingArgs...> {
 };
 
 // Iterative case.
+// Each converted argument is a local in its own stack frame; they are only
+// passed down by reference, so nothing is copied until the final call.
 template <typename Ret, typename Cur, typename... RemainingArgs>
 struct CallHelper<Ret, Cur, RemainingArgs...> {
   template <typename Func, typename... GivenArgs>
@@ -252,7 +257,8 @@ struct CallHelper<Ret, Cur, RemainingArgs...> {
                                      const std::string& target_name,
                                      bool is_member_func,
                                      const CallbackArguments& arguments,
-                                     Func callback, GivenArgs&&... args) {
+                                     const Func& callback,
+                                     GivenArgs&&... args) {
     const size_t index = sizeof...(GivenArgs);
     RawType<Cur> arg;
     if (ArgumentCount(arguments) + is_member_func <= index) {
@@ -289,11 +295,16 @@ struct InternalCallbackDataBase {
   virtual ~InternalCallbackDataBase() {}
 };
 
-template <typename Ret, typename... Args>
+/**
+ * |Func| is the type of the callback to call.  This is usually a
+ * std::function, but member functions store a small functor here so the call
+ * doesn't go through the type-erased std::function.
+ */
+template <typename Func, typename Ret, typename... Args>
 struct InternalCallbackData : InternalCallbackDataBase {
   std::string name;
   std::string target;
-  std::function<Ret(Args...)> callback;
+  Func callback;
   bool is_member_func;
 };
 
@@ -394,7 +405,7 @@ T* GetInternalData(const CallbackArguments& arguments) {
 #endif
 
 
-template <typename Ret, typename... Args>
+template <typename Func, typename Ret, typename... Args>
 class JsCallback {
  public:
 #if defined(USING_V8)
@@ -418,7 +429,8 @@ class JsCallback {
 
  private:
   static bool CallRaw(const CallbackArguments& arguments) {
-    auto data = GetInternalData<InternalCallbackData<Ret, Args...>>(arguments);
+    auto data =
+        GetInternalData<InternalCallbackData<Func, Ret, Args...>>(arguments);
     if (!data)
       return false;
 
@@ -532,27 +544,31 @@ class JsConstructor {
   }
 };
 
-template <typename Ret, typename... Args>
-ReturnVal<JsFunction> CreateJsFunctionFromCallback(
-    const std::string& target, const std::string& name,
-    std::function<Ret(Args...)> callback, bool is_member_func) {
-  impl::InternalCallbackData<Ret, Args...>* data;
+/**
+ * Creates a JavaScript function that calls the given callback.  |Func| needs to
+ * be default-constructible and callable with |Args|, returning |Ret|.
+ */
+template <typename Ret, typename... Args, typename Func>
+ReturnVal<JsFunction> CreateJsFunctionFromCallback(const std::string& target,
+                                                   const std::string& name,
+                                                   Func callback,
+                                                   bool is_member_func) {
+  impl::InternalCallbackData<Func, Ret, Args...>* data;
   LocalVar<JsValue> js_value = impl::CreateInternalData(&data);
   data->name = name;
   data->target = target;
-  data->callback = callback;
+  data->callback = std::move(callback);
   data->is_member_func = is_member_func;
 
 #ifdef USING_V8
   return v8::Function::New(GetIsolate()->GetCurrentContext(),
-                           &impl::JsCallback<Ret, Args...>::Call,
+                           &impl::JsCallback<Func, Ret, Args...>::Call,
                            js_value, sizeof...(Args),
                            v8::ConstructorBehavior::kThrow).ToLocalChecked();
 #elif defined(USING_JSC)
   JSContextRef cx = GetContext();
-  LocalVar<JsObject> ret =
-      JSObjectMakeFunctionWithCallback(cx, JsStringFromUtf8(name),
-                                       &impl::JsCallback<Ret, Args...>::Call);
+  LocalVar<JsObject> ret = JSObjectMakeFunctionWithCallback(
+      cx, JsStringFromUtf8(name), &impl::JsCallback<Func, Ret, Args...>::Call);
 
   const int attributes = kJSPropertyAttributeReadOnly |
                          kJSPropertyAttributeDontEnum |
@@ -581,7 +597,8 @@ template <typename Ret, typename... Args>
 ReturnVal<JsFunction> CreateStaticFunction(
     const std::string& target, const std::string& name,
     std::function<Ret(Args...)> callback) {
-  return impl::CreateJsFunctionFromCallback(target, name, callback, false);
+  return impl::CreateJsFunctionFromCallback<Ret, Args...>(
+      target, name, std::move(callback), false);
 }
 
 /**
@@ -593,7 +610,8 @@ template <typename Ret, typename... Args>
 ReturnVal<JsFunction> CreateMemberFunction(
     const std::string& target, const std::string& name,
     std::function<Ret(Args...)> callback) {
-  return impl::CreateJsFunctionFromCallback(target, name, callback, true);
+  return impl::CreateJsFunctionFromCallback<Ret, Args...>(
+      target, name, std::move(callback), true);
 }
 
 /**
@@ -18,7 +18,39 @@
 
 namespace shaka {
 
-Struct::Struct() {}
+namespace impl {
+
+namespace {
+
+// The table that is currently being built on this thread and the key of the
+// type it is for.
+thread_local StructFields* building_fields_ = nullptr;
+thread_local const void* building_key_ = nullptr;
+
+}  // namespace
+
+StructFields::StructFields() {}
+StructFields::~StructFields() {}
+
+// static
+StructFields* StructFields::Building(const void* key) {
+  return building_key_ == key ? building_fields_ : nullptr;
+}
+
+StructFields::BuildScope::BuildScope(StructFields* fields, const void* key)
+    : previous_fields_(building_fields_), previous_key_(building_key_) {
+  building_fields_ = fields;
+  building_key_ = key;
+}
+
+StructFields::BuildScope::~BuildScope() {
+  building_fields_ = previous_fields_;
+  building_key_ = previous_key_;
+}
+
+}  // namespace impl
+
+Struct::Struct() : fields_(nullptr) {}
 Struct::~Struct() {}
 
 Struct::Struct(const Struct&) = default;
@@ -30,20 +62,26 @@ bool Struct::TryConvert(Handle<JsValue> value) {
   if (!IsObject(value))
     return false;
   LocalVar<JsObject> obj = UnsafeJsCast<JsObject>(value);
-  for (auto& converter : converters_)
-    converter->SearchAndStore(this, obj);
+  if (fields_) {
+    for (auto& converter : fields_->fields())
+      converter->SearchAndStore(this, obj);
+  }
   return true;
 }
 
 ReturnVal<JsValue> Struct::ToJsValue() const {
   WeakJsPtr<JsObject> obj(CreateObject());
-  for (auto& converter : converters_)
-    converter->AddToObject(this, obj.handle());
+  if (fields_) {
+    for (auto& converter : fields_->fields())
+      converter->AddToObject(this, obj.handle());
+  }
   return obj.value();
 }
 
 void Struct::Trace(memory::HeapTracer* tracer) const {
-  for (auto& converter : converters_)
+  if (!fields_)
+    return;
+  for (auto& converter : fields_->fields())
     converter->Trace(this, tracer);
 }
 
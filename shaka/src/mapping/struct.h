@@ -24,6 +24,7 @@
 #include "src/mapping/generic_converter.h"
 #include "src/mapping/js_wrappers.h"
 #include "src/memory/heap_tracer.h"
+#include "src/util/macros.h"
 #include "src/util/templates.h"
 
 namespace shaka {
@@ -46,9 +47,9 @@ namespace impl {
  * a struct and will convert the JavaScript object member to the respective
  * C++ object member, and vice versa.
  *
- * There needs to be a non-templated base class because we store a vector of
- * them in Struct and they have different (and only known in
- * CreateFieldMember) types.
+ * There needs to be a non-templated base class because we store a list of
+ * them in StructFields and they have different (and only known in
+ * CreateFieldConverter) types.
  */
 class FieldConverterBase {
  public:
@@ -58,7 +59,7 @@ class FieldConverterBase {
    * Search the given object for a property with the name of the field this
    * is converting.  If found, try to convert it and store in the field.
    */
-  virtual void SearchAndStore(Struct* dict, Handle<JsObject> object) = 0;
+  virtual void SearchAndStore(Struct* dict, Handle<JsObject> object) const = 0;
   /** Stores the value of the field in the given object. */
   virtual void AddToObject(const Struct* dict,
                            Handle<JsObject> object) const = 0;
@@ -73,11 +74,11 @@ class FieldConverterBase {
 template <typename Parent, typename Field>
 class FieldConverter : public FieldConverterBase {
  public:
-  FieldConverter(const std::string& name, Field Parent::*member)
+  FieldConverter(const char* name, Field Parent::*member)
       : name_(name), member_(member) {}
 
 
-  void SearchAndStore(Struct* dict, Handle<JsObject> object) override {
+  void SearchAndStore(Struct* dict, Handle<JsObject> object) const override {
     auto parent = static_cast<Parent*>(dict);
     LocalVar<JsValue> member(GetMemberRaw(object, name_));
     (void)FromJsValue(member, &(parent->*member_));
@@ -95,12 +96,92 @@ class FieldConverter : public FieldConverterBase {
   }
 
  private:
-  std::string name_;
-  // Store as a pointer to member so if we are copied, we don't need to update
-  // the pointers (or make the type non-copyable).
+  // The names come from string literals in ADD_DICT_FIELD, so the JavaScript
+  // strings for them are only created once.
+  const PropertyName name_;
+  // Store as a pointer to member so the same converter can be used for every
+  // instance of the type.
   Field Parent::*member_;
 };
 
+/**
+ * The fields of a Struct type, in declaration order.  There is one of these
+ * for each type and it is shared by all instances of that type.
+ */
+class StructFields {
+ public:
+  StructFields();
+  ~StructFields();
+
+  NON_COPYABLE_OR_MOVABLE_TYPE(StructFields);
+
+  const std::vector<std::unique_ptr<FieldConverterBase>>& fields() const {
+    return fields_;
+  }
+
+  /**
+   * @return The table that is being built for the type with the given key on
+   *   this thread, or nullptr if that type isn't being built.
+   */
+  static StructFields* Building(const void* key);
+
+  /**
+   * Builds the table for the type T.  This creates a single instance of T;
+   * while it is being constructed, the field initializers from
+   * ADD_DICT_FIELD add themselves to the new table.
+   */
+  template <typename T>
+  static const StructFields* Build(const void* key) {
+    StructFields* ret = new StructFields;
+    BuildScope scope(ret, key);
+    T prototype;
+    (void)prototype;
+    return ret;
+  }
+
+ private:
+  friend class ::shaka::Struct;
+
+  /** Marks a table as being built on this thread; these can be nested. */
+  class BuildScope {
+   public:
+    BuildScope(StructFields* fields, const void* key);
+    ~BuildScope();
+
+    NON_COPYABLE_OR_MOVABLE_TYPE(BuildScope);
+
+   private:
+    StructFields* const previous_fields_;
+    const void* const previous_key_;
+  };
+
+  std::vector<std::unique_ptr<FieldConverterBase>> fields_;
+};
+
+/** Holds the StructFields for the type T. */
+template <typename T>
+class StructFieldsFor {
+ public:
+  /** @return A value that uniquely identifies the type T. */
+  static const void* key() {
+    return &key_;
+  }
+
+  /** @return The fields of T, building the table if needed. */
+  static const StructFields* Get() {
+    // Function statics are initialized once, even with multiple threads.  The
+    // table is intentionally leaked since it is used until the process exits.
+    static const StructFields* fields = StructFields::Build<T>(key());
+    return fields;
+  }
+
+ private:
+  static const char key_;
+};
+
+template <typename T>
+const char StructFieldsFor<T>::key_ = 0;
+
 }  // namespace impl
 
 
@@ -121,7 +202,12 @@ class FieldConverter : public FieldConverterBase {
  * constructor which can be implicit or user defined.  If it is defined you
  * CANNOT have member initialization (field assignments before the '{'), you
  * MUST use assignment within the constructor body, otherwise the field will
- * not be registered (see the macro above).
+ * not be registered (see the macro above).  A Struct must derive directly from
+ * this type.
+ *
+ * The list of fields is built once for each type, the first time an instance
+ * is created, and is shared by all instances.  So creating or copying a
+ * Struct doesn't allocate anything beyond its members.
  */
 class Struct : public GenericConverter, public memory::Traceable {
  public:
@@ -141,16 +227,24 @@ class Struct : public GenericConverter, public memory::Traceable {
 
  protected:
   template <typename Parent, typename Field>
-  Field CreateFieldConverter(const std::string& name, Field Parent::*field) {
+  Field CreateFieldConverter(const char* name, Field Parent::*field) {
     static_assert(std::is_base_of<Struct, Parent>::value,
                   "Must be derived from Struct");
-    auto convert = new impl::FieldConverter<Parent, Field>(name, field);
-    converters_.emplace_back(convert);
+    using Fields = impl::StructFieldsFor<Parent>;
+    impl::StructFields* building = impl::StructFields::Building(Fields::key());
+    if (building) {
+      building->fields_.emplace_back(
+          new impl::FieldConverter<Parent, Field>(name, field));
+    } else if (!fields_) {
+      fields_ = Fields::Get();
+    }
     return Field();
   }
 
  private:
-  std::vector<std::shared_ptr<impl::FieldConverterBase>> converters_;
+  // The fields of the derived type; this is null for the instance that is used
+  // to build the table.
+  const impl::StructFields* fields_;
 };
 
 }  // namespace shaka
@@ -0,0 +1,285 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/mapping/structured_clone.h"
+
+#include <glog/logging.h>
+
+#include <unordered_map>
+#include <utility>
+
+#include "src/mapping/convert_js.h"
+#include "src/mapping/js_engine.h"
+#include "src/util/utils.h"
+
+namespace shaka {
+
+struct StructuredClone::SerializeState {
+  /** The objects currently being cloned, used to detect cycles. */
+  std::vector<LocalVar<JsObject>> ancestors;
+  /** The ArrayBuffers to transfer; these are the first buffers. */
+  std::vector<LocalVar<JsValue>> transfer;
+  /** The indices of the copied buffers, keyed by their data pointer. */
+  std::unordered_map<const uint8_t*, size_t> copied;
+};
+
+
+StructuredClone::StructuredClone() {}
+StructuredClone::~StructuredClone() {}
+
+StructuredClone::StructuredClone(StructuredClone&&) = default;
+StructuredClone& StructuredClone::operator=(StructuredClone&&) = default;
+
+ExceptionOr<void> StructuredClone::Serialize(Handle<JsValue> value,
+                                             const std::vector<Any>& transfer) {
+  entries_.clear();
+  buffers_.clear();
+
+  SerializeState state;
+  for (size_t i = 0; i < transfer.size(); i++) {
+    LocalVar<JsValue> item = transfer[i].ToJsValue();
+    if (GetValueType(item) != JSValueType::ArrayBuffer) {
+      return js::JsError::DOMException(
+          DataCloneError,
+          util::StringPrintf(
+              "Value at index %zu does not have a transferable type.", i));
+    }
+    for (auto& other : state.transfer) {
+      if (StrictEquals(item, other)) {
+        return js::JsError::DOMException(
+            DataCloneError,
+            util::StringPrintf("ArrayBuffer at index %zu is a duplicate of an "
+                               "earlier ArrayBuffer.",
+                               i));
+      }
+    }
+    state.transfer.emplace_back(item);
+  }
+  buffers_.resize(state.transfer.size());
+
+  std::string error;
+  if (!SerializeValue(value, "", &state, &error)) {
+    entries_.clear();
+    buffers_.clear();
+    return js::JsError::DOMException(DataCloneError, error);
+  }
+
+  // Only detach the buffers once the whole value has been cloned so they are
+  // still usable if cloning fails.
+  for (size_t i = 0; i < state.transfer.size(); i++) {
+    if (!buffers_[i].TryTransfer(state.transfer[i])) {
+      entries_.clear();
+      buffers_.clear();
+      return js::JsError::DOMException(
+          DataCloneError,
+          util::StringPrintf("ArrayBuffer at index %zu could not be "
+                             "transferred.",
+                             i));
+    }
+  }
+  return {};
+}
+
+ReturnVal<JsValue> StructuredClone::Deserialize() {
+  if (entries_.empty())
+    return JsUndefined();
+
+  size_t index = 0;
+  LocalVar<JsValue> ret = DeserializeEntry(&index);
+  DCHECK_EQ(index, entries_.size());
+  return ret;
+}
+
+bool StructuredClone::SerializeValue(Handle<JsValue> value,
+                                     const std::string& key,
+                                     SerializeState* state,
+                                     std::string* error) {
+  const JSValueType type = GetValueType(value);
+  // Store the index since |entries_| can be reallocated by the members.
+  const size_t index = entries_.size();
+  entries_.emplace_back(type);
+  entries_[index].key = key;
+
+  switch (type) {
+    case JSValueType::Undefined:
+    case JSValueType::Null:
+      return true;
+
+    case JSValueType::Boolean:
+    case JSValueType::BooleanObject:
+      entries_[index].type = JSValueType::Boolean;
+      entries_[index].number = BooleanFromValue(value) ? 1 : 0;
+      return true;
+    case JSValueType::Number:
+    case JSValueType::NumberObject:
+      entries_[index].type = JSValueType::Number;
+      entries_[index].number = NumberFromValue(value);
+      return true;
+    case JSValueType::String:
+    case JSValueType::StringObject:
+      entries_[index].type = JSValueType::String;
+      entries_[index].str = ConvertToString(value);
+      return true;
+
+    case JSValueType::ArrayBuffer:
+      entries_[index].buffer = AddBuffer(value, state);
+      return true;
+    case JSValueType::Int8Array:
+    case JSValueType::Uint8Array:
+    case JSValueType::Uint8ClampedArray:
+    case JSValueType::Int16Array:
+    case JSValueType::Uint16Array:
+    case JSValueType::Int32Array:
+    case JSValueType::Uint32Array:
+    case JSValueType::Float32Array:
+    case JSValueType::Float64Array:
+    case JSValueType::DataView: {
+      LocalVar<JsObject> view = UnsafeJsCast<JsObject>(value);
+      LocalVar<JsValue> buffer = GetMemberRaw(view, "buffer");
+      LocalVar<JsValue> offset = GetMemberRaw(view, "byteOffset");
+      LocalVar<JsValue> length = GetMemberRaw(
+          view, type == JSValueType::DataView ? "byteLength" : "length");
+      entries_[index].buffer = AddBuffer(buffer, state);
+      entries_[index].number = NumberFromValue(offset);
+      entries_[index].length = static_cast<size_t>(NumberFromValue(length));
+      return true;
+    }
+
+    case JSValueType::Array:
+    case JSValueType::OtherObject: {
+      LocalVar<JsObject> object = UnsafeJsCast<JsObject>(value);
+      if (type == JSValueType::OtherObject && IsBuiltInObject(object)) {
+        *error = ConvertToString(value) + " could not be cloned.";
+        return false;
+      }
+      for (auto& ancestor : state->ancestors) {
+        if (StrictEquals(RawToJsValue(ancestor), value)) {
+          *error = "Cyclic objects could not be cloned.";
+          return false;
+        }
+      }
+
+      state->ancestors.emplace_back(object);
+      size_t length;
+      if (type == JSValueType::Array) {
+        length = ArrayLength(object);
+        for (size_t i = 0; i < length; i++) {
+          LocalVar<JsValue> item = GetArrayIndexRaw(object, i);
+          if (!SerializeValue(item, "", state, error))
+            return false;
+        }
+      } else {
+        const std::vector<std::string> names = GetMemberNames(object);
+        length = names.size();
+        for (const std::string& name : names) {
+          LocalVar<JsValue> member = GetMemberRaw(object, name);
+          if (!SerializeValue(member, name, state, error))
+            return false;
+        }
+      }
+      state->ancestors.pop_back();
+      entries_[index].length = length;
+      return true;
+    }
+
+    default:
+      *error = ConvertToString(value) + " could not be cloned.";
+      return false;
+  }
+}
+
+size_t StructuredClone::AddBuffer(Handle<JsValue> buffer,
+                                  SerializeState* state) {
+  for (size_t i = 0; i < state->transfer.size(); i++) {
+    if (StrictEquals(buffer, state->transfer[i]))
+      return i;
+  }
+
+  ByteBuffer source;
+  CHECK(source.TryConvert(buffer));
+  // Empty buffers may not have a unique pointer, but it doesn't matter if
+  // they are shared in the clone.
+  auto it = state->copied.find(source.data());
+  if (it != state->copied.end())
+    return it->second;
+
+  buffers_.emplace_back(source.data(), source.size());
+  state->copied.emplace(source.data(), buffers_.size() - 1);
+  return buffers_.size() - 1;
+}
+
+ReturnVal<JsValue> StructuredClone::DeserializeEntry(size_t* index) {
+  const Entry& entry = entries_[(*index)++];
+  switch (entry.type) {
+    case JSValueType::Undefined:
+      return JsUndefined();
+    case JSValueType::Null:
+      return JsNull();
+    case JSValueType::Boolean:
+      return ToJsValue(entry.number != 0);
+    case JSValueType::Number:
+      return ToJsValue(entry.number);
+    case JSValueType::String:
+      return ToJsValue(entry.str);
+
+    case JSValueType::ArrayBuffer:
+      return buffers_[entry.buffer].ToJsValue();
+    case JSValueType::Int8Array:
+    case JSValueType::Uint8Array:
+    case JSValueType::Uint8ClampedArray:
+    case JSValueType::Int16Array:
+    case JSValueType::Uint16Array:
+    case JSValueType::Int32Array:
+    case JSValueType::Uint32Array:
+    case JSValueType::Float32Array:
+    case JSValueType::Float64Array:
+    case JSValueType::DataView: {
+      // The enum names are the same as the global constructors.
+      LocalVar<JsValue> ctor_value = GetMemberRaw(
+          JsEngine::Instance()->global_handle(), to_string(entry.type));
+      LocalVar<JsFunction> ctor = UnsafeJsCast<JsFunction>(ctor_value);
+      LocalVar<JsValue> args[] = {
+          buffers_[entry.buffer].ToJsValue(),
+          ToJsValue(entry.number),
+          ToJsValue(static_cast<double>(entry.length)),
+      };
+      LocalVar<JsValue> ret;
+      CHECK(InvokeConstructor(ctor, 3, args, &ret));
+      return ret;
+    }
+
+    case JSValueType::Array: {
+      LocalVar<JsObject> array = CreateArray(entry.length);
+      for (size_t i = 0; i < entry.length; i++) {
+        LocalVar<JsValue> item = DeserializeEntry(index);
+        SetArrayIndexRaw(array, i, item);
+      }
+      return RawToJsValue(array);
+    }
+    case JSValueType::OtherObject: {
+      LocalVar<JsObject> object = CreateObject();
+      for (size_t i = 0; i < entry.length; i++) {
+        const std::string& key = entries_[*index].key;
+        LocalVar<JsValue> member = DeserializeEntry(index);
+        SetMemberRaw(object, key, member);
+      }
+      return RawToJsValue(object);
+    }
+
+    default:
+      LOG(FATAL) << "Unexpected cloned type " << entry.type;
+  }
+}
+
+}  // namespace shaka
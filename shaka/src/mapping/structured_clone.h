@@ -0,0 +1,110 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SHAKA_EMBEDDED_MAPPING_STRUCTURED_CLONE_H_
+#define SHAKA_EMBEDDED_MAPPING_STRUCTURED_CLONE_H_
+
+#include <string>
+#include <vector>
+
+#include "src/mapping/any.h"
+#include "src/mapping/byte_buffer.h"
+#include "src/mapping/exception_or.h"
+#include "src/mapping/js_wrappers.h"
+#include "src/util/macros.h"
+
+namespace shaka {
+
+/**
+ * Holds a copy of a JavaScript value that doesn't depend on any JavaScript
+ * engine, so it can be passed to another thread and recreated in that thread's
+ * engine.  This implements the parts of the HTML structured clone algorithm
+ * that are needed to pass messages to and from Web Workers:
+ *
+ * - Primitives and primitive wrapper objects (which are unwrapped).
+ * - Arrays and plain objects (only their own properties).
+ * - ArrayBuffers, typed arrays, and DataViews.  Views that share an
+ *   ArrayBuffer will still share it in the clone.
+ *
+ * Other types (e.g. functions, Promises, and objects implemented in C++) and
+ * cyclic objects can't be cloned.  Unlike browsers, an object that appears
+ * more than once is cloned once per appearance.
+ *
+ * ArrayBuffers in the transfer list are moved into the clone instead of being
+ * copied; see ByteBuffer::TryTransfer.
+ */
+class StructuredClone {
+ public:
+  StructuredClone();
+  ~StructuredClone();
+
+  StructuredClone(StructuredClone&&);
+  StructuredClone& operator=(StructuredClone&&);
+  NON_COPYABLE_TYPE(StructuredClone);
+
+  /**
+   * Clones the given value, replacing any existing contents.  This must be
+   * called on the event thread that owns |value|.
+   *
+   * @param value The value to clone.
+   * @param transfer The ArrayBuffers to move into the clone.  These are
+   *   detached once the value has been cloned.
+   * @return A DataCloneError if the value can't be cloned.
+   */
+  ExceptionOr<void> Serialize(Handle<JsValue> value,
+                              const std::vector<Any>& transfer);
+
+  /**
+   * Creates the cloned value in the JavaScript engine of the current thread.
+   * This moves the cloned buffers into the engine, so this should only be
+   * called once.
+   */
+  ReturnVal<JsValue> Deserialize();
+
+ private:
+  struct Entry {
+    explicit Entry(JSValueType type) : type(type) {}
+
+    JSValueType type;
+    /** The member name, if this is the member of an object. */
+    std::string key;
+    /** The value of a string. */
+    std::string str;
+    /** The value of a number or boolean, or the byte offset of a view. */
+    double number = 0;
+    /** The index of the buffer of an ArrayBuffer or a view. */
+    size_t buffer = 0;
+    /**
+     * The number of members of an array or object, or the length of a view
+     * (in elements; in bytes for a DataView).
+     */
+    size_t length = 0;
+  };
+  struct SerializeState;
+
+  bool SerializeValue(Handle<JsValue> value, const std::string& key,
+                      SerializeState* state, std::string* error);
+  size_t AddBuffer(Handle<JsValue> buffer, SerializeState* state);
+  ReturnVal<JsValue> DeserializeEntry(size_t* index);
+
+  // The cloned values in depth-first order.  Arrays and objects are followed
+  // by the entries of their members.
+  std::vector<Entry> entries_;
+  // The contents of the ArrayBuffers; the transferred ones are first.
+  std::vector<ByteBuffer> buffers_;
+};
+
+}  // namespace shaka
+
+#endif  // SHAKA_EMBEDDED_MAPPING_STRUCTURED_CLONE_H_
@@ -21,6 +21,10 @@
 
 #include <cstring>
 
+#ifdef V8_PLAYER_SNAPSHOT
+#  include "src/mapping/v8/v8_snapshot.h"
+#endif
+
 namespace shaka {
 
 #ifdef V8_EMBEDDED_SNAPSHOT
@@ -34,20 +38,25 @@ void OnPromiseReject(v8::PromiseRejectMessage message) {
   JsEngine::Instance()->OnPromiseReject(message);
 }
 
-void InitializeV8IfNeeded() {
-  static v8::Platform* platform = nullptr;
-  if (platform)
-    return;
-
+v8::Platform* InitializeV8() {
   v8::V8::InitializeICU();
 
 #ifdef V8_EMBEDDED_SNAPSHOT
   SetupV8Snapshots();
 #endif
 
-  platform = v8::platform::CreateDefaultPlatform();
+  v8::Platform* platform = v8::platform::CreateDefaultPlatform();
   v8::V8::InitializePlatform(platform);
   v8::V8::Initialize();
+  return platform;
+}
+
+void InitializeV8IfNeeded() {
+  // The platform is shared by every engine in the process.  Engines can be
+  // created on several event threads at once, so this relies on static
+  // initialization being thread-safe.
+  static v8::Platform* platform = InitializeV8();
+  (void)platform;
 }
 
 }  // namespace
@@ -57,6 +66,8 @@ void InitializeV8IfNeeded() {
 JsEngine::JsEngine() : isolate_(CreateIsolate()), context_(CreateContext()) {}
 
 JsEngine::~JsEngine() {
+  // The handles need to be freed before the isolate is.
+  property_names_.clear();
   context_.Reset();
   isolate_->Dispose();
 }
@@ -69,6 +80,29 @@ v8::Local<v8::Value> JsEngine::global_value() {
   return context_.Get(isolate_)->Global();
 }
 
+v8::Local<v8::String> JsEngine::GetPropertyName(const char* name) {
+  // Don't use emplace since moving a v8::Global is problematic; the map
+  // doesn't move its elements once they are inserted.
+  v8::Global<v8::String>& entry = property_names_[name];
+  if (entry.IsEmpty()) {
+    // Internalized strings are deduplicated by V8 and have their hash
+    // computed, so property lookups can compare them by pointer.
+    v8::Local<v8::String> str =
+        v8::String::NewFromUtf8(isolate_, name,
+                                v8::NewStringType::kInternalized)
+            .ToLocalChecked();
+    entry.Reset(isolate_, str);
+    return str;
+  }
+  return entry.Get(isolate_);
+}
+
+void JsEngine::TerminateExecution() {
+  // This is one of the few isolate methods that can be called without a
+  // Locker, so this doesn't use isolate().
+  isolate_->TerminateExecution();
+}
+
 void JsEngine::OnPromiseReject(v8::PromiseRejectMessage message) {
   // When a Promise gets rejected, we immediately get a
   // kPromiseRejectWithNoHandler event.  Then, once JavaScript adds a rejection
@@ -115,6 +149,9 @@ v8::Isolate* JsEngine::CreateIsolate() {
 
   v8::Isolate::CreateParams create_params;
   create_params.array_buffer_allocator = &allocator_;
+#ifdef V8_PLAYER_SNAPSHOT
+  create_params.external_references = GetV8SnapshotExternalReferences();
+#endif
 
   v8::Isolate* isolate = v8::Isolate::New(create_params);
   CHECK(isolate);
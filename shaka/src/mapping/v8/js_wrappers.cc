@@ -14,8 +14,13 @@
 
 #include "src/mapping/js_wrappers.h"
 
+#include <chrono>
+#include <memory>
+
 #include "src/mapping/backing_object.h"
 #include "src/mapping/convert_js.h"
+#include "src/mapping/js_engine.h"
+#include "src/mapping/v8/v8_code_cache.h"
 #include "src/util/file_system.h"
 
 namespace shaka {
@@ -50,6 +55,43 @@ class StaticExternalResource
   size_t data_size_;
 };
 
+/**
+ * An external string resource that holds a mapped file.  This keeps the file
+ * mapped until V8 is done with the string.
+ */
+class MappedFileResource : public v8::String::ExternalOneByteStringResource {
+ public:
+  explicit MappedFileResource(std::shared_ptr<util::MappedFile> file)
+      : file_(std::move(file)) {}
+
+  NON_COPYABLE_OR_MOVABLE_TYPE(MappedFileResource);
+
+  const char* data() const override {
+    return reinterpret_cast<const char*>(file_->data());
+  }
+
+  size_t length() const override {
+    return file_->size();
+  }
+
+ protected:
+  void Dispose() override {
+    delete this;
+  }
+
+ private:
+  ~MappedFileResource() override {}
+
+  const std::shared_ptr<util::MappedFile> file_;
+};
+
+bool IsAscii(const uint8_t* data, size_t data_size) {
+  uint8_t bits = 0;
+  for (size_t i = 0; i < data_size; i++)
+    bits |= data[i];
+  return bits < 0x80;
+}
+
 v8::Local<v8::String> MakeExternalString(const uint8_t* data,
                                          size_t data_size) {
 #ifndef NDEBUG
@@ -81,28 +123,49 @@ void SetMemberImpl(Handle<JsObject> object, T ind, Handle<JsValue> value) {
   CHECK(object->Set(context, ind, value).IsJust());
 }
 
-bool RunScriptImpl(const std::string& path, Handle<JsString> source) {
+bool RunScriptImpl(const std::string& path, Handle<JsString> source,
+                   const uint8_t* data, size_t data_size) {
   v8::Isolate* isolate = v8::Isolate::GetCurrent();
   auto context = isolate->GetCurrentContext();
   v8::HandleScope handle_scope(GetIsolate());
   v8::ScriptOrigin origin(ToJsValue(path));
 
-  // Compile the script.
+  // Compile the script, using the code cache from a previous run if there is
+  // one.  |script_source| takes ownership of |cached_data|.
+  const auto start = std::chrono::steady_clock::now();
+  std::unique_ptr<V8CodeCache> cache = V8CodeCache::ForCurrentManager();
+  v8::ScriptCompiler::CachedData* cached_data = cache->Load(data, data_size);
+  v8::ScriptCompiler::Source script_source(source, origin, cached_data);
   v8::TryCatch trycatch(isolate);
-  v8::MaybeLocal<v8::Script> maybe_script =
-      v8::Script::Compile(context, source, &origin);
+  v8::MaybeLocal<v8::Script> maybe_script = v8::ScriptCompiler::Compile(
+      context, &script_source,
+      cached_data ? v8::ScriptCompiler::kConsumeCodeCache
+                  : v8::ScriptCompiler::kNoCompileOptions);
   v8::Local<v8::Script> script;
   if (!maybe_script.ToLocal(&script) || script.IsEmpty()) {
     LOG(ERROR) << "Error loading script " << path;
     return false;
   }
 
+  const bool cache_hit = cached_data && !cached_data->rejected;
+  const std::chrono::duration<double, std::milli> compile_time =
+      std::chrono::steady_clock::now() - start;
+  VLOG(1) << "Compiled " << path << " in " << compile_time.count() << "ms, "
+          << (cache_hit ? "code cache hit"
+                        : cached_data ? "code cache rejected"
+                                      : "code cache miss");
+
   // Run the script.  Run() returns the return value from the script, which
   // will be empty if the script failed to execute.
   if (script->Run(context).IsEmpty()) {
     OnUncaughtException(trycatch.Exception(), false);
     return false;
   }
+
+  // Create the cache after running the script so it includes the functions
+  // that were compiled lazily while running.
+  if (!cache_hit)
+    cache->Store(data, data_size, script->GetUnboundScript());
   return true;
 }
 
@@ -131,6 +194,10 @@ ReturnVal<JsValue> GetMemberRaw(Handle<JsObject> object,
   return GetMemberImpl(object, JsStringFromUtf8(name));
 }
 
+ReturnVal<JsValue> GetMemberRaw(Handle<JsObject> object, PropertyName name) {
+  return GetMemberImpl(object, JsStringFromPropertyName(name));
+}
+
 ReturnVal<JsValue> GetArrayIndexRaw(Handle<JsObject> object, size_t index) {
   return GetMemberImpl(object, index);
 }
@@ -140,6 +207,11 @@ void SetMemberRaw(Handle<JsObject> object, const std::string& name,
   SetMemberImpl(object, JsStringFromUtf8(name), value);
 }
 
+void SetMemberRaw(Handle<JsObject> object, PropertyName name,
+                  Handle<JsValue> value) {
+  SetMemberImpl(object, JsStringFromPropertyName(name), value);
+}
+
 void SetArrayIndexRaw(Handle<JsObject> object, size_t i,
                       Handle<JsValue> value) {
   SetMemberImpl(object, i, value);
@@ -197,6 +269,19 @@ std::string ConvertToString(Handle<JsValue> value) {
     return name.IsEmpty() || name->IsUndefined() ? "" : ConvertToString(name);
   }
 
+  if (!value.IsEmpty() && value->IsString()) {
+    // This is the common case when converting arguments, so write directly
+    // into the result instead of going through the temporary buffer that
+    // Utf8Value allocates.  Short strings then don't allocate at all.
+    v8::Local<v8::String> str = value.As<v8::String>();
+    std::string ret(str->Utf8Length(), '\0');
+    if (!ret.empty()) {
+      str->WriteUtf8(&ret[0], static_cast<int>(ret.size()), nullptr,
+                     v8::String::NO_NULL_TERMINATION);
+    }
+    return ret;
+  }
+
   v8::String::Utf8Value str(value);
   return std::string(*str, str.length());
 }
@@ -229,19 +314,31 @@ bool IsDerivedFrom(BackingObject* ptr, const std::string& name) {
 
 bool RunScript(const std::string& path) {
   util::FileSystem fs;
-  std::vector<uint8_t> source;
-  CHECK(fs.ReadFile(path, &source));
-  v8::Local<v8::String> code =
-      v8::String::NewFromUtf8(GetIsolate(),
-                              reinterpret_cast<const char*>(source.data()),
-                              v8::NewStringType::kNormal, source.size())
-          .ToLocalChecked();
-  return RunScriptImpl(path, code);
+  std::shared_ptr<util::MappedFile> file;
+  if (!fs.MapFile(path, &file)) {
+    LOG(ERROR) << "Unable to read script " << path;
+    return false;
+  }
+
+  // Scripts are usually ASCII, so V8 can use the mapped file directly as the
+  // string contents.  Otherwise the UTF-8 needs to be decoded into a copy.
+  v8::Local<v8::String> code;
+  if (IsAscii(file->data(), file->size())) {
+    auto* res = new MappedFileResource(file);
+    code = v8::String::NewExternalOneByte(GetIsolate(), res)  // NOLINT
+               .ToLocalChecked();
+  } else {
+    code = v8::String::NewFromUtf8(GetIsolate(),
+                                   reinterpret_cast<const char*>(file->data()),
+                                   v8::NewStringType::kNormal, file->size())
+               .ToLocalChecked();
+  }
+  return RunScriptImpl(path, code, file->data(), file->size());
 }
 
 bool RunScript(const std::string& path, const uint8_t* data, size_t data_size) {
   v8::Local<v8::String> source = MakeExternalString(data, data_size);
-  return RunScriptImpl(path, source);
+  return RunScriptImpl(path, source, data, data_size);
 }
 
 ReturnVal<JsValue> ParseJsonString(const std::string& json) {
@@ -258,13 +355,16 @@ ReturnVal<JsString> JsStringFromUtf8(const std::string& str) {
   // NewStringType determines where to put the string.
   // - kNormal is for "normal", short-lived strings.
   // - kInternalized is for common strings and are cached (taking up more space)
-  // TODO: Investigate using kInternalized for property names which are static
-  // and may be common, Chromium has a v8AtomicString method for this.
+  // Static property names use kInternalized; see JsStringFromPropertyName.
   return v8::String::NewFromUtf8(GetIsolate(), str.c_str(),
                                  v8::NewStringType::kNormal, str.size())
       .ToLocalChecked();
 }
 
+ReturnVal<JsString> JsStringFromPropertyName(PropertyName name) {
+  return JsEngine::Instance()->GetPropertyName(name.name());
+}
+
 ReturnVal<JsValue> JsUndefined() {
   return v8::Undefined(GetIsolate());
 }
@@ -368,6 +468,10 @@ JSValueType GetValueType(Handle<JsValue> value) {
   return JSValueType::Unknown;
 }
 
+bool StrictEquals(Handle<JsValue> a, Handle<JsValue> b) {
+  return !a.IsEmpty() && !b.IsEmpty() && a->StrictEquals(b);
+}
+
 double NumberFromValue(Handle<JsValue> value) {
   DCHECK(!value.IsEmpty());
   if (value->IsNumber()) {
@@ -0,0 +1,264 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/mapping/v8/v8_code_cache.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <random>
+
+#include "src/core/js_manager_impl.h"
+#include "src/debug/mutex.h"
+#include "src/util/crypto.h"
+#include "src/util/file_system.h"
+#include "src/util/utils.h"
+
+namespace shaka {
+
+namespace {
+
+constexpr const char* kCacheDirName = "v8_code_cache";
+constexpr const char kMagic[4] = {'S', 'C', 'C', '2'};
+constexpr const char* kEntryExtension = ".bin";
+constexpr const char* kTempExtension = ".tmp";
+// Entries that haven't been written in this long are removed.
+constexpr std::chrono::hours kMaxEntryAge(24 * 30);
+
+/** The header at the start of each cache file. */
+struct CacheHeader {
+  char magic[4];
+  // The value of v8::ScriptCompiler::CachedDataVersionTag(), which depends on
+  // the V8 version and flags.
+  uint32_t version_tag;
+  uint64_t source_size;
+  // The time the entry was written, in seconds since the epoch.
+  uint64_t store_time;
+};
+
+/** An existing cache entry, used when pruning the cache. */
+struct CacheEntry {
+  std::string path;
+  uint64_t store_time;
+  size_t size;
+};
+
+uint64_t CurrentTime() {
+  return std::chrono::duration_cast<std::chrono::seconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+bool IsValidHeader(const uint8_t* data, size_t size, CacheHeader* header) {
+  if (size <= sizeof(*header))
+    return false;
+  std::memcpy(header, data, sizeof(*header));
+  return std::memcmp(header->magic, kMagic, sizeof(kMagic)) == 0 &&
+         header->version_tag == v8::ScriptCompiler::CachedDataVersionTag();
+}
+
+bool EndsWith(const std::string& str, const std::string& suffix) {
+  return str.size() >= suffix.size() &&
+         str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+/**
+ * Returns the mutex that guards changes to the cache directories.  Workers
+ * store entries from their own threads, and listing a directory while another
+ * thread deletes from it isn't safe.
+ */
+Mutex* GetCacheMutex() {
+  // Leak the mutex so it outlives any worker threads during shutdown.
+  static Mutex* mutex = new Mutex("V8CodeCache");
+  return mutex;
+}
+
+std::string RandomSuffix() {
+  std::random_device random;
+  const uint32_t value = random();
+  return util::ToHexString(reinterpret_cast<const uint8_t*>(&value),
+                           sizeof(value));
+}
+
+}  // namespace
+
+constexpr size_t V8CodeCache::kDefaultMaxSize;
+
+V8CodeCache::V8CodeCache(const std::string& dir, size_t max_size)
+    : dir_(dir), max_size_(max_size) {}
+
+V8CodeCache::~V8CodeCache() {}
+
+// static
+std::unique_ptr<V8CodeCache> V8CodeCache::ForCurrentManager() {
+  JsManagerImpl* manager = JsManagerImpl::InstanceOrNull();
+  const std::string dir =
+      manager ? manager->GetPathForDynamicFile(kCacheDirName) : "";
+  return std::unique_ptr<V8CodeCache>(new V8CodeCache(dir));
+}
+
+v8::ScriptCompiler::CachedData* V8CodeCache::Load(const uint8_t* source,
+                                                  size_t size) {
+  if (dir_.empty())
+    return nullptr;
+
+  util::FileSystem fs;
+  const std::string path = GetPath(source, size);
+  if (!fs.FileExists(path) || !fs.ReadFile(path, &buffer_))
+    return nullptr;
+
+  CacheHeader header;
+  if (!IsValidHeader(buffer_.data(), buffer_.size(), &header) ||
+      header.source_size != size) {
+    VLOG(1) << "Ignoring V8 code cache from a different build: " << path;
+    Remove(source, size);
+    return nullptr;
+  }
+
+  return new v8::ScriptCompiler::CachedData(
+      buffer_.data() + sizeof(header),
+      static_cast<int>(buffer_.size() - sizeof(header)),
+      v8::ScriptCompiler::CachedData::BufferNotOwned);
+}
+
+void V8CodeCache::Store(const uint8_t* source, size_t size,
+                        v8::Local<v8::UnboundScript> script) {
+  if (dir_.empty())
+    return;
+
+  std::unique_ptr<v8::ScriptCompiler::CachedData> data(
+      v8::ScriptCompiler::CreateCodeCache(script));
+  if (!data || data->length <= 0)
+    return;
+
+  CacheHeader header;
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version_tag = v8::ScriptCompiler::CachedDataVersionTag();
+  header.source_size = size;
+  header.store_time = CurrentTime();
+
+  std::vector<uint8_t> contents(sizeof(header) + data->length);
+  if (contents.size() > max_size_) {
+    VLOG(1) << "V8 code cache of " << contents.size()
+            << " bytes is larger than the maximum cache size";
+    return;
+  }
+  std::memcpy(contents.data(), &header, sizeof(header));
+  std::memcpy(contents.data() + sizeof(header), data->data, data->length);
+
+  // Write to a temporary file and rename it into place so another thread or
+  // process loading this entry never sees a partial file.  The name needs to
+  // be unique since workers can compile the same script at the same time.
+  std::unique_lock<Mutex> lock(*GetCacheMutex());
+  util::FileSystem fs;
+  const std::string path = GetPath(source, size);
+  const std::string temp_path = path + "." + RandomSuffix() + kTempExtension;
+  if (!fs.CreateDirectory(dir_))
+    return;
+  Prune(contents.size(), path);
+  if (!fs.WriteFile(temp_path, contents)) {
+    LOG(WARNING) << "Unable to write V8 code cache to " << temp_path;
+    if (fs.FileExists(temp_path) && !fs.DeleteFile(temp_path))
+      LOG(WARNING) << "Unable to delete V8 code cache " << temp_path;
+    return;
+  }
+  if (!fs.RenameFile(temp_path, path)) {
+    PLOG(WARNING) << "Unable to move V8 code cache to " << path;
+    if (!fs.DeleteFile(temp_path))
+      LOG(WARNING) << "Unable to delete V8 code cache " << temp_path;
+    return;
+  }
+  VLOG(1) << "Wrote " << contents.size() << " byte V8 code cache to " << path;
+}
+
+void V8CodeCache::Remove(const uint8_t* source, size_t size) {
+  if (dir_.empty())
+    return;
+
+  std::unique_lock<Mutex> lock(*GetCacheMutex());
+  util::FileSystem fs;
+  const std::string path = GetPath(source, size);
+  if (fs.FileExists(path) && !fs.DeleteFile(path))
+    LOG(WARNING) << "Unable to delete V8 code cache " << path;
+}
+
+std::string V8CodeCache::GetPath(const uint8_t* source, size_t size) const {
+  const std::vector<uint8_t> hash = util::HashData(source, size);
+  return util::FileSystem::PathJoin(
+      dir_, util::ToHexString(hash.data(), hash.size()) + kEntryExtension);
+}
+
+void V8CodeCache::Prune(size_t new_size, const std::string& replacing) {
+  util::FileSystem fs;
+  std::vector<std::string> names;
+  if (!fs.ListFiles(dir_, &names))
+    return;
+
+  const uint64_t now = CurrentTime();
+  const uint64_t max_age =
+      std::chrono::duration_cast<std::chrono::seconds>(kMaxEntryAge).count();
+  std::vector<CacheEntry> entries;
+  size_t total_size = 0;
+  for (const std::string& name : names) {
+    const std::string path = util::FileSystem::PathJoin(dir_, name);
+    if (path == replacing)
+      continue;
+
+    bool remove;
+    if (EndsWith(name, kTempExtension)) {
+      // Temporary files are renamed while holding the lock, so any left over
+      // are from a write that didn't finish.
+      remove = true;
+    } else if (EndsWith(name, kEntryExtension)) {
+      std::shared_ptr<util::MappedFile> file;
+      if (!fs.MapFile(path, &file))
+        continue;
+      CacheHeader header;
+      remove = !IsValidHeader(file->data(), file->size(), &header) ||
+               header.store_time + max_age < now;
+      if (!remove) {
+        entries.push_back({path, header.store_time, file->size()});
+        total_size += file->size();
+      }
+    } else {
+      continue;
+    }
+
+    if (remove) {
+      VLOG(1) << "Removing stale V8 code cache " << path;
+      if (!fs.DeleteFile(path))
+        LOG(WARNING) << "Unable to delete V8 code cache " << path;
+    }
+  }
+
+  std::sort(entries.begin(), entries.end(),
+            [](const CacheEntry& a, const CacheEntry& b) {
+              return a.store_time < b.store_time;
+            });
+  for (const CacheEntry& entry : entries) {
+    if (total_size + new_size <= max_size_)
+      break;
+    VLOG(1) << "Removing V8 code cache " << entry.path << " to make room";
+    if (!fs.DeleteFile(entry.path)) {
+      LOG(WARNING) << "Unable to delete V8 code cache " << entry.path;
+      continue;
+    }
+    total_size -= entry.size;
+  }
+}
+
+}  // namespace shaka
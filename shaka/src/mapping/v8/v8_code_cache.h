@@ -0,0 +1,95 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SHAKA_EMBEDDED_MAPPING_V8_V8_CODE_CACHE_H_
+#define SHAKA_EMBEDDED_MAPPING_V8_V8_CODE_CACHE_H_
+
+#include <v8.h>
+
+#include <stddef.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/util/macros.h"
+
+namespace shaka {
+
+/**
+ * Stores V8 code caches for scripts on disk so they don't need to be fully
+ * parsed and compiled on every startup.
+ *
+ * Entries are keyed by a hash of the script source.  Each entry stores the
+ * V8 cache version tag, which changes with the V8 version and flags, so an
+ * entry from a different build is ignored and replaced.  Entries that V8
+ * rejects are also replaced.
+ *
+ * The total size of the directory is capped; entries older than a month are
+ * removed, then the oldest entries are removed until a new entry fits.
+ */
+class V8CodeCache {
+ public:
+  /** The default maximum total size of the cache entries, in bytes. */
+  static constexpr size_t kDefaultMaxSize = 32 * 1024 * 1024;
+
+  /**
+   * @param dir The directory to store the cache entries in.  If this is
+   *   empty, the cache is disabled.
+   * @param max_size The maximum total size of the cache entries, in bytes.
+   */
+  explicit V8CodeCache(const std::string& dir,
+                       size_t max_size = kDefaultMaxSize);
+  ~V8CodeCache();
+
+  NON_COPYABLE_OR_MOVABLE_TYPE(V8CodeCache);
+
+  /** @return A V8CodeCache in the JsManager's dynamic data directory. */
+  static std::unique_ptr<V8CodeCache> ForCurrentManager();
+
+  /**
+   * Loads the cache entry for the given script.  The returned object points
+   * into a buffer owned by this object, which remains valid until the next
+   * call to Load.
+   *
+   * @return The cached data for the given source, or nullptr if there isn't a
+   *   valid entry.
+   */
+  v8::ScriptCompiler::CachedData* Load(const uint8_t* source, size_t size);
+
+  /** Creates a new cache entry for the given script. */
+  void Store(const uint8_t* source, size_t size,
+             v8::Local<v8::UnboundScript> script);
+
+  /** Removes the cache entry for the given script, if it exists. */
+  void Remove(const uint8_t* source, size_t size);
+
+ private:
+  std::string GetPath(const uint8_t* source, size_t size) const;
+
+  /**
+   * Removes stale entries and then the oldest entries until an entry of the
+   * given size fits in the cache.  The entry at |replacing| isn't counted
+   * since it will be overwritten.
+   */
+  void Prune(size_t new_size, const std::string& replacing);
+
+  const std::string dir_;
+  const size_t max_size_;
+  std::vector<uint8_t> buffer_;
+};
+
+}  // namespace shaka
+
+#endif  // SHAKA_EMBEDDED_MAPPING_V8_V8_CODE_CACHE_H_
@@ -0,0 +1,63 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/mapping/v8/v8_snapshot.h"
+
+namespace shaka {
+
+namespace {
+
+// This file is also linked into the snapshot creator, so it can't use
+// anything other than V8 (e.g. glog or the mapping helpers).
+
+void DummyMethod(const v8::FunctionCallbackInfo<v8::Value>& /* args */) {}
+
+void SetFunction(v8::Local<v8::Context> context, const char* name,
+                 v8::FunctionCallback callback) {
+  v8::Isolate* isolate = context->GetIsolate();
+  v8::Local<v8::Function> func =
+      v8::Function::New(context, callback).ToLocalChecked();
+  v8::Local<v8::String> key =
+      v8::String::NewFromUtf8(isolate, name, v8::NewStringType::kInternalized)
+          .ToLocalChecked();
+  context->Global()->Set(context, key, func).FromJust();
+}
+
+}  // namespace
+
+intptr_t* GetV8SnapshotExternalReferences() {
+  static intptr_t references[] = {
+      reinterpret_cast<intptr_t>(&DummyMethod),
+      0,
+  };
+  return references;
+}
+
+void SetupV8SnapshotGlobals(v8::Local<v8::Context> context) {
+  v8::Isolate* isolate = context->GetIsolate();
+  v8::Local<v8::Object> global = context->Global();
+
+  // Shaka Player exports itself on |window|, which is the global object.
+  v8::Local<v8::String> window =
+      v8::String::NewFromUtf8(isolate, "window",
+                              v8::NewStringType::kInternalized)
+          .ToLocalChecked();
+  global->Set(context, window, global).FromJust();
+
+  // These match the dummy methods in Environment::Install.
+  SetFunction(context, "addEventListener", &DummyMethod);
+  SetFunction(context, "removeEventListener", &DummyMethod);
+}
+
+}  // namespace shaka
@@ -0,0 +1,43 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SHAKA_EMBEDDED_MAPPING_V8_V8_SNAPSHOT_H_
+#define SHAKA_EMBEDDED_MAPPING_V8_V8_SNAPSHOT_H_
+
+#include <v8.h>
+
+#include <stdint.h>
+
+namespace shaka {
+
+/**
+ * @return The addresses of the native callbacks that the V8 startup snapshot
+ *   refers to, terminated by a 0 entry.  This is given to V8 both when
+ *   creating the snapshot and when creating an isolate from it, so V8 can map
+ *   the callbacks in the snapshot to the addresses in this process.
+ */
+intptr_t* GetV8SnapshotExternalReferences();
+
+/**
+ * Sets up the globals that Shaka Player uses while it is being evaluated.  This
+ * is used when creating the startup snapshot, where the Environment can't be
+ * installed.  The Environment replaces these with the real objects when it is
+ * installed; every callback used here must be in
+ * GetV8SnapshotExternalReferences().
+ */
+void SetupV8SnapshotGlobals(v8::Local<v8::Context> context);
+
+}  // namespace shaka
+
+#endif  // SHAKA_EMBEDDED_MAPPING_V8_V8_SNAPSHOT_H_
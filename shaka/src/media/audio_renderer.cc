@@ -24,6 +24,7 @@ extern "C" {
 #include <utility>
 
 #include "src/media/ffmpeg_decoded_frame.h"
+#include "src/media/types.h"
 #include "src/util/clock.h"
 #include "src/util/utils.h"
 
@@ -32,12 +33,6 @@ namespace media {
 
 namespace {
 
-/**
- * The maximum playback rate we will adjust audio for.  If the playback rate
- * is more than this, we will mute the audio.
- */
-constexpr const double kMaxPlaybackRate = 4;
-
 /**
  * The maximum delay, in seconds, between the frame time and the real time it
  * will be played before a seek happens.  This can happen when muted or if the
@@ -158,6 +153,8 @@ AudioRenderer::AudioRenderer(std::function<double()> get_time,
       shutdown_(false),
       need_reset_(true),
       is_seeking_(false),
+      in_underrun_(false),
+      underruns_(0),
       thread_("AudioRenderer", std::bind(&AudioRenderer::ThreadMain, this)) {}
 
 AudioRenderer::~AudioRenderer() {
@@ -304,8 +301,10 @@ void AudioRenderer::AudioCallback(uint8_t* data, int size) {
     stream_->GetDecodedFrames()->Remove(0, cur_time_ - 0.2);
 
   const double playback_rate = get_playback_rate_();
-  // TODO: Support playback rate by using atemp filter.
-  DCHECK(playback_rate == 0 || playback_rate == 1)
+  // TODO: Support playback rate by using atemp filter.  Rates above
+  // kMaxPlaybackRate or below 0 are used for trick play, which is muted.
+  DCHECK(playback_rate <= 0 || playback_rate == 1 ||
+         playback_rate > kMaxPlaybackRate)
       << "Only playbackRate of 0 and 1 are supported.";
   if (need_reset_ || is_seeking_ || volume_ == 0 || playback_rate <= 0 ||
       playback_rate > kMaxPlaybackRate) {
@@ -350,10 +349,13 @@ void AudioRenderer::AudioCallback(uint8_t* data, int size) {
   size_in_samples -= initial_sample_count;
   data += initial_sample_count * sample_size;
 
+  bool ran_out = false;
   while (size_in_samples > 0) {
     auto base_frame = stream_->GetDecodedFrames()->GetFrameAfter(cur_time_);
-    if (!base_frame)
+    if (!base_frame) {
+      ran_out = true;
       break;
+    }
 
     CHECK(base_frame->frame_type() == FrameType::FFmpegDecodedFrame);
     auto* frame = static_cast<const FFmpegDecodedFrame*>(base_frame.get());
@@ -406,6 +408,11 @@ void AudioRenderer::AudioCallback(uint8_t* data, int size) {
     cur_time_ = frame->pts;
   }
 
+  // Only count the start of an underrun, not every callback during it.
+  if (ran_out && size_in_samples > 0 && !in_underrun_)
+    underruns_.fetch_add(1, std::memory_order_relaxed);
+  in_underrun_ = ran_out && size_in_samples > 0;
+
   // Set any remaining data to silence in the event of errors.
   memset(data, obtained_audio_spec_.silence, size_in_samples * sample_size);
 }
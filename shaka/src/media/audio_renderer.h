@@ -17,6 +17,7 @@
 
 #include <SDL2/SDL.h>
 
+#include <atomic>
 #include <functional>
 
 #include "src/debug/mutex.h"
@@ -52,6 +53,14 @@ class AudioRenderer : public Renderer {
   /** Sets the volume of the audio. */
   void SetVolume(double volume);
 
+  /**
+   * @return The number of times the audio device ran out of decoded audio
+   *   while playing.  This doesn't lock, so it can be called from any thread.
+   */
+  uint64_t GetUnderrunCount() const {
+    return underruns_.load(std::memory_order_relaxed);
+  }
+
  private:
   void ThreadMain();
   bool InitDevice(const FFmpegDecodedFrame* frame);
@@ -74,6 +83,8 @@ class AudioRenderer : public Renderer {
   bool shutdown_ : 1;
   bool need_reset_ : 1;
   bool is_seeking_ : 1;
+  bool in_underrun_ : 1;
+  std::atomic<uint64_t> underruns_;
 
   Thread thread_;
 };
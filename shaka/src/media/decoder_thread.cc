@@ -14,13 +14,13 @@
 
 #include "src/media/decoder_thread.h"
 
+#include <algorithm>
 #include <chrono>
 #include <cmath>
 #include <memory>
 #include <utility>
 #include <vector>
 
-#include "src/media/media_processor.h"
 #include "src/media/pipeline_manager.h"
 #include "src/media/stream.h"
 
@@ -33,7 +33,32 @@ constexpr const double kDecodeBufferSize = 1;
 /** The number of seconds gap before we assume we are at the end. */
 constexpr const double kEndDelta = 0.1;
 
+/**
+ * The number of seconds, in wall-clock time, to decode ahead of the playhead
+ * during trick play.
+ */
+constexpr const double kTrickPlayLead = 0.25;
+
+/**
+ * The number of seconds a frame can be behind the playhead before we skip to
+ * the next key frame.
+ */
+constexpr const double kHopelesslyLate = 1;
+
+/**
+ * The number of seconds a frame needs to be decoded ahead of the playhead to
+ * count as on-time for recovering from decode degradation.
+ */
+constexpr const double kRecoverLead = 0.5;
+
+/** The number of consecutive late frames before degrading the decode. */
+constexpr const int kLateFramesToDegrade = 5;
+
+/** The number of consecutive on-time frames before reducing degradation. */
+constexpr const int kOnTimeFramesToRecover = 30;
+
 DecoderThread::DecoderThread(std::function<double()> get_time,
+                             std::function<double()> get_playback_rate,
                              std::function<void()> seek_done,
                              std::function<void()> on_waiting_for_key,
                              std::function<void(Status)> on_error,
@@ -43,6 +68,7 @@ DecoderThread::DecoderThread(std::function<double()> get_time,
       pipeline_(pipeline),
       stream_(stream),
       get_time_(std::move(get_time)),
+      get_playback_rate_(std::move(get_playback_rate)),
       seek_done_(std::move(seek_done)),
       on_waiting_for_key_(std::move(on_waiting_for_key)),
       on_error_(std::move(on_error)),
@@ -52,6 +78,20 @@ DecoderThread::DecoderThread(std::function<double()> get_time,
       did_flush_(false),
       last_frame_time_(NAN),
       raised_waiting_event_(false),
+      allow_trick_play_(false),
+      in_trick_play_(false),
+      last_trick_play_time_(NAN),
+      late_frame_count_(0),
+      on_time_frame_count_(0),
+      allow_degradation_(false),
+      degradation_(DecodeDegradation::None),
+      skip_loop_filter_frames_(0),
+      skip_non_reference_frames_(0),
+      key_frame_skips_(0),
+      key_frame_skipped_frames_(0),
+      decoder_restarts_(0),
+      demuxed_ahead_(0),
+      decoded_ahead_(0),
       thread_(processor->codec() + " decoder",
               std::bind(&DecoderThread::ThreadMain, this)) {}
 
@@ -74,20 +114,90 @@ void DecoderThread::SetCdm(eme::Implementation* cdm) {
   cdm_.store(cdm, std::memory_order_release);
 }
 
+void DecoderThread::SetAllowTrickPlay(bool allow) {
+  allow_trick_play_.store(allow, std::memory_order_release);
+}
+
+void DecoderThread::SetAllowDegradation(bool allow) {
+  allow_degradation_.store(allow, std::memory_order_release);
+}
+
+void DecoderThread::GetDegradationStats(VideoPlaybackQuality* quality) const {
+  quality->decodeDegradationLevel = static_cast<uint64_t>(
+      degradation_.load(std::memory_order_acquire));
+  quality->skipLoopFilterFrames =
+      skip_loop_filter_frames_.load(std::memory_order_acquire);
+  quality->skipNonReferenceFrames =
+      skip_non_reference_frames_.load(std::memory_order_acquire);
+  quality->keyFrameSkips = key_frame_skips_.load(std::memory_order_acquire);
+  quality->keyFrameSkippedFrames =
+      key_frame_skipped_frames_.load(std::memory_order_acquire);
+}
+
+void DecoderThread::GetMetrics(StreamPipelineMetrics* metrics) const {
+  decode_times_.CopyTo(&metrics->decode);
+  processor_->GetDecryptTimes(&metrics->decrypt);
+  metrics->demuxed_buffer_seconds =
+      demuxed_ahead_.load(std::memory_order_relaxed);
+  metrics->demuxed_buffer_bytes = stream_->GetDemuxedFrames()->EstimateSize();
+  metrics->decoded_buffer_seconds =
+      decoded_ahead_.load(std::memory_order_relaxed);
+  metrics->decoded_buffer_bytes = stream_->GetDecodedFrames()->EstimateSize();
+  metrics->decoder_restarts = decoder_restarts_.load(std::memory_order_relaxed);
+}
+
 void DecoderThread::ThreadMain() {
   while (!shutdown_.load(std::memory_order_acquire)) {
     const double cur_time = get_time_();
+    // This is 0 unless playing, so we leave trick play when paused or seeking.
+    const double playback_rate = get_playback_rate_();
+    if (allow_trick_play_.load(std::memory_order_acquire) &&
+        (playback_rate < 0 || playback_rate > kMaxPlaybackRate)) {
+      if (!in_trick_play_) {
+        VLOG(1) << "Entering trick play at rate " << playback_rate;
+        in_trick_play_ = true;
+        last_trick_play_time_ = NAN;
+      }
+
+      const Status trick_status =
+          DecodeTrickPlayFrame(cur_time, playback_rate);
+      if (trick_status == Status::KeyNotFound) {
+        WaitForKey();
+        continue;
+      }
+      if (trick_status != Status::Success) {
+        on_error_(trick_status);
+        break;
+      }
+      continue;
+    }
+    if (in_trick_play_) {
+      // Start decoding every frame from the playhead again.  The frames ahead
+      // of the playhead are only key frames, so drop them.
+      VLOG(1) << "Leaving trick play";
+      in_trick_play_ = false;
+      last_frame_time_.store(NAN, std::memory_order_release);
+      stream_->GetDecodedFrames()->Remove(cur_time, HUGE_VAL);
+    }
+
     double last_time = last_frame_time_.load(std::memory_order_acquire);
 
     LockedFrameList::Guard frame;
     if (std::isnan(last_time)) {
+      // Decode from the key frame before the seek time, but have the decoder
+      // drop the frames before the seek time since they will never be shown.
       processor_->ResetDecoder();
+      processor_->SetSeekTarget(cur_time);
       frame = stream_->GetDemuxedFrames()->GetKeyFrameBefore(cur_time);
     } else {
       frame = stream_->GetDemuxedFrames()->GetFrameAfter(last_time);
     }
 
-    if (stream_->DecodedAheadOf(cur_time) > kDecodeBufferSize) {
+    const double decoded_ahead = stream_->DecodedAheadOf(cur_time);
+    decoded_ahead_.store(decoded_ahead, std::memory_order_relaxed);
+    demuxed_ahead_.store(stream_->DemuxedAheadOf(cur_time),
+                         std::memory_order_relaxed);
+    if (decoded_ahead > kDecodeBufferSize) {
       std::this_thread::sleep_for(std::chrono::milliseconds(25));
       continue;
     }
@@ -104,17 +214,39 @@ void DecoderThread::ThreadMain() {
       }
     }
 
+    const bool can_degrade =
+        frame && allow_degradation_.load(std::memory_order_acquire) &&
+        !is_seeking_.load(std::memory_order_acquire);
+    // The number of frames skipped to get to a key frame.  These are only
+    // counted once the key frame decodes, since we retry the same frame while
+    // waiting for a key.
+    int skipped = 0;
+    if (can_degrade && cur_time - frame->pts > kHopelesslyLate) {
+      // We are too far behind to catch up by decoding faster, so skip to the
+      // next key frame.
+      LockedFrameList::Guard key_frame =
+          stream_->GetDemuxedFrames()->GetKeyFrameAfter(frame->dts);
+      if (key_frame) {
+        skipped = stream_->GetDemuxedFrames()->FramesBetween(frame->dts,
+                                                             key_frame->dts) +
+                  1;
+        VLOG(1) << "Decoder is " << (cur_time - frame->pts)
+                << "s behind, skipping " << skipped
+                << " frames to the next key frame";
+        processor_->ResetDecoder();
+        frame = std::move(key_frame);
+      }
+    }
+    const DecodeDegradation degradation =
+        degradation_.load(std::memory_order_acquire);
+
     std::vector<std::unique_ptr<BaseFrame>> decoded;
     eme::Implementation* cdm = cdm_.load(std::memory_order_acquire);
+    const auto decode_start = util::AtomicHistogram::Now();
     const Status decode_status =
         processor_->DecodeFrame(cur_time, frame.get(), cdm, &decoded);
     if (decode_status == Status::KeyNotFound) {
-      // If we don't have the required key, signal the <video> and wait.
-      if (!raised_waiting_event_) {
-        raised_waiting_event_ = true;
-        on_waiting_for_key_();
-      }
-      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      WaitForKey();
       continue;
     }
     if (decode_status != Status::Success) {
@@ -123,7 +255,27 @@ void DecoderThread::ThreadMain() {
     }
 
     raised_waiting_event_ = false;
-    const double last_pts = decoded.empty() ? -1 : decoded.back()->pts;
+    if (frame)
+      decode_times_.RecordSince(decode_start);
+    if (std::isnan(last_time))
+      decoder_restarts_.fetch_add(1, std::memory_order_relaxed);
+    if (skipped > 0) {
+      key_frame_skips_.fetch_add(1, std::memory_order_acq_rel);
+      key_frame_skipped_frames_.fetch_add(skipped, std::memory_order_acq_rel);
+      decoder_restarts_.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (can_degrade) {
+      if (degradation >= DecodeDegradation::SkipLoopFilter)
+        skip_loop_filter_frames_.fetch_add(1, std::memory_order_acq_rel);
+      if (degradation >= DecodeDegradation::SkipNonReference)
+        skip_non_reference_frames_.fetch_add(1, std::memory_order_acq_rel);
+      UpdateDegradation(frame->pts - cur_time);
+    }
+    // Frames before the seek target were dropped by the decoder, so the seek is
+    // done once we get a frame that covers the current time.
+    const double last_end =
+        decoded.empty() ? -1
+                        : decoded.back()->pts + decoded.back()->duration;
     for (auto& decoded_frame : decoded)
       stream_->GetDecodedFrames()->AppendFrame(std::move(decoded_frame));
 
@@ -132,7 +284,7 @@ void DecoderThread::ThreadMain() {
       // was running.
       const bool updated = last_frame_time_.compare_exchange_strong(
           last_time, frame->dts, std::memory_order_acq_rel);
-      if (updated && last_pts >= cur_time) {
+      if (updated && last_end >= cur_time) {
         bool expected = true;
         if (is_seeking_.compare_exchange_strong(expected, false,
                                                 std::memory_order_acq_rel)) {
@@ -143,5 +295,87 @@ void DecoderThread::ThreadMain() {
   }
 }
 
+Status DecoderThread::DecodeTrickPlayFrame(double cur_time,
+                                           double playback_rate) {
+  // Find the key frame the playhead will reach soon.  This works the same for
+  // reverse playback since the target is then behind the playhead.
+  const double target =
+      std::max(cur_time + playback_rate * kTrickPlayLead, 0.0);
+  LockedFrameList::Guard frame =
+      stream_->GetDemuxedFrames()->GetKeyFrameBefore(target);
+  if (!frame || frame->dts == last_trick_play_time_) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    return Status::Success;
+  }
+
+  // The renderer only discards frames behind the playhead, so when playing in
+  // reverse we need to discard the frames we have passed.
+  if (playback_rate < 0)
+    stream_->GetDecodedFrames()->Remove(cur_time + 1, HUGE_VAL);
+
+  // Each key frame is decoded on its own, so flush the decoder to get the
+  // frame out and start with a new decoder for the next one.
+  std::vector<std::unique_ptr<BaseFrame>> decoded;
+  std::vector<std::unique_ptr<BaseFrame>> flushed;
+  eme::Implementation* cdm = cdm_.load(std::memory_order_acquire);
+  Status status = processor_->DecodeFrame(cur_time, frame.get(), cdm, &decoded);
+  if (status == Status::Success)
+    status = processor_->DecodeFrame(cur_time, nullptr, cdm, &flushed);
+  processor_->ResetDecoder();
+  if (status != Status::Success)
+    return status;
+
+  raised_waiting_event_ = false;
+  last_trick_play_time_ = frame->dts;
+  for (auto& decoded_frame : decoded)
+    stream_->GetDecodedFrames()->AppendFrame(std::move(decoded_frame));
+  for (auto& decoded_frame : flushed)
+    stream_->GetDecodedFrames()->AppendFrame(std::move(decoded_frame));
+
+  bool expected = true;
+  if (is_seeking_.compare_exchange_strong(expected, false,
+                                          std::memory_order_acq_rel)) {
+    seek_done_();
+  }
+  return Status::Success;
+}
+
+void DecoderThread::UpdateDegradation(double lead) {
+  if (lead < 0) {
+    late_frame_count_++;
+    on_time_frame_count_ = 0;
+  } else if (lead > kRecoverLead) {
+    on_time_frame_count_++;
+    late_frame_count_ = 0;
+  }
+
+  const DecodeDegradation cur = degradation_.load(std::memory_order_acquire);
+  DecodeDegradation next = cur;
+  if (late_frame_count_ >= kLateFramesToDegrade &&
+      cur != DecodeDegradation::SkipNonReference) {
+    next = static_cast<DecodeDegradation>(static_cast<int>(cur) + 1);
+  } else if (on_time_frame_count_ >= kOnTimeFramesToRecover &&
+             cur != DecodeDegradation::None) {
+    next = static_cast<DecodeDegradation>(static_cast<int>(cur) - 1);
+  }
+
+  if (next != cur) {
+    VLOG(1) << "Changing decode degradation from " << static_cast<int>(cur)
+            << " to " << static_cast<int>(next);
+    late_frame_count_ = on_time_frame_count_ = 0;
+    degradation_.store(next, std::memory_order_release);
+    processor_->SetDecodeDegradation(next);
+  }
+}
+
+void DecoderThread::WaitForKey() {
+  // If we don't have the required key, signal the <video> and wait.
+  if (!raised_waiting_event_) {
+    raised_waiting_event_ = true;
+    on_waiting_for_key_();
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+}
+
 }  // namespace media
 }  // namespace shaka
@@ -19,7 +19,9 @@
 #include <functional>
 
 #include "src/debug/thread.h"
+#include "src/media/media_processor.h"
 #include "src/media/types.h"
+#include "src/util/atomic_histogram.h"
 #include "src/util/macros.h"
 
 namespace shaka {
@@ -30,7 +32,6 @@ class Implementation;
 
 namespace media {
 
-class MediaProcessor;
 class PipelineManager;
 class Stream;
 
@@ -44,6 +45,8 @@ class DecoderThread {
   /**
    * @param get_time A callback to get the current playhead time.  This will be
    *   called from the background thread.
+   * @param get_playback_rate A callback to get the current playback rate.  This
+   *   will be called from the background thread.
    * @param seek_done A callback for when a frame has been decoded after a seek.
    * @param on_waiting_for_key A callback for when the decoder is waiting for
    *   an encryption key.
@@ -53,6 +56,7 @@ class DecoderThread {
    * @param stream The stream to pull frames from.
    */
   DecoderThread(std::function<double()> get_time,
+                std::function<double()> get_playback_rate,
                 std::function<void()> seek_done,
                 std::function<void()> on_waiting_for_key,
                 std::function<void(Status)> on_error,
@@ -74,14 +78,53 @@ class DecoderThread {
 
   void SetCdm(eme::Implementation* cdm);
 
+  /**
+   * Sets whether the decoder only decodes key frames at high or negative
+   * playback rates.  This should only be used for video.
+   */
+  void SetAllowTrickPlay(bool allow);
+
+  /**
+   * Sets whether the decoder can degrade its output when it falls behind the
+   * playhead.  This should only be used for video.
+   */
+  void SetAllowDegradation(bool allow);
+
+  /** Fills in the decode degradation fields of the given quality info. */
+  void GetDegradationStats(VideoPlaybackQuality* quality) const;
+
+  /**
+   * Fills in the decoder fields of the given metrics.  This doesn't lock, so it
+   * can be called from any thread.
+   */
+  void GetMetrics(StreamPipelineMetrics* metrics) const;
+
  private:
   void ThreadMain();
 
+  /**
+   * Decodes the key frame nearest the playhead for trick play.  This is used
+   * for high or negative playback rates where decoding every frame can't keep
+   * up; the cost is proportional to the number of frames shown rather than the
+   * duration of the content.
+   */
+  Status DecodeTrickPlayFrame(double cur_time, double playback_rate);
+
+  /** Called when the decoder doesn't have the key for a frame. */
+  void WaitForKey();
+
+  /**
+   * Updates the decode degradation level based on how far ahead of the
+   * playhead the frame we just decoded was.
+   */
+  void UpdateDegradation(double lead);
+
   MediaProcessor* processor_;
   PipelineManager* pipeline_;
   Stream* stream_;
 
   std::function<double()> get_time_;
+  std::function<double()> get_playback_rate_;
   std::function<void()> seek_done_;
   std::function<void()> on_waiting_for_key_;
   std::function<void(Status)> on_error_;
@@ -91,6 +134,24 @@ class DecoderThread {
   std::atomic<bool> did_flush_;
   std::atomic<double> last_frame_time_;
   bool raised_waiting_event_ = false;
+  std::atomic<bool> allow_trick_play_;
+  // Only used on the background thread.
+  bool in_trick_play_ = false;
+  double last_trick_play_time_;
+  int late_frame_count_ = 0;
+  int on_time_frame_count_ = 0;
+
+  std::atomic<bool> allow_degradation_;
+  std::atomic<DecodeDegradation> degradation_;
+  std::atomic<uint64_t> skip_loop_filter_frames_;
+  std::atomic<uint64_t> skip_non_reference_frames_;
+  std::atomic<uint64_t> key_frame_skips_;
+  std::atomic<uint64_t> key_frame_skipped_frames_;
+
+  util::AtomicHistogram decode_times_;
+  std::atomic<uint64_t> decoder_restarts_;
+  std::atomic<double> demuxed_ahead_;
+  std::atomic<double> decoded_ahead_;
 
   Thread thread_;
 };
@@ -14,6 +14,7 @@
 
 #include "src/media/demuxer_thread.h"
 
+#include <chrono>
 #include <cmath>
 #include <memory>
 #include <string>
@@ -50,6 +51,7 @@ DemuxerThread::DemuxerThread(std::function<void()> on_load_meta,
       window_start_(0),
       window_end_(HUGE_VAL),
       need_key_frame_(true),
+      read_wait_us_(0),
       processor_(processor),
       stream_(stream),
       thread_(ShortContainerName(processor->container()) + " demux",
@@ -81,6 +83,7 @@ void DemuxerThread::AppendData(double timestamp_offset, double window_start,
   cur_data_ = data;
   cur_size_ = data_size;
   on_complete_ = std::move(on_complete);
+  append_start_ = util::AtomicHistogram::Now();
 
   new_data_.SignalAll();
 }
@@ -109,6 +112,8 @@ void DemuxerThread::ThreadMain() {
 
   while (!shutdown_) {
     std::unique_ptr<BaseFrame> frame;
+    const auto start = util::AtomicHistogram::Now();
+    read_wait_us_ = 0;
     const Status status = processor_->ReadDemuxedFrame(&frame);
     if (status != Status::Success) {
       std::unique_lock<Mutex> lock(mutex_);
@@ -116,6 +121,14 @@ void DemuxerThread::ThreadMain() {
       break;
     }
 
+    // Don't count the time spent waiting for the app to append more data.
+    const uint64_t elapsed_us =
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            util::AtomicHistogram::Now() - start)
+            .count();
+    demux_times_.Record(elapsed_us > read_wait_us_ ? elapsed_us - read_wait_us_
+                                                   : 0);
+
     {
       std::unique_lock<Mutex> lock(mutex_);
       if (frame->pts < window_start_ ||
@@ -146,7 +159,11 @@ size_t DemuxerThread::OnRead(uint8_t* data, size_t data_size) {
   if (input_.empty()) {
     CallOnComplete(Status::Success);
     if (!shutdown_) {
+      const auto wait_start = util::AtomicHistogram::Now();
       new_data_.ResetAndWaitWhileUnlocked(lock);
+      read_wait_us_ += std::chrono::duration_cast<std::chrono::microseconds>(
+                           util::AtomicHistogram::Now() - wait_start)
+                           .count();
     }
   }
 
@@ -163,8 +180,15 @@ void DemuxerThread::OnResetRead() {
   input_.SetBuffer(cur_data_, cur_size_);
 }
 
+void DemuxerThread::GetMetrics(StreamPipelineMetrics* metrics) const {
+  append_times_.CopyTo(&metrics->append_to_demux);
+  demux_times_.CopyTo(&metrics->demux);
+}
+
 void DemuxerThread::CallOnComplete(Status status) {
   if (on_complete_) {
+    if (status == Status::Success)
+      append_times_.RecordSince(append_start_);
     // on_complete must be invoked on the event thread.
     JsManagerImpl::Instance()->MainThread()->AddInternalTask(
         TaskPriority::Internal, "Append done",
@@ -15,13 +15,17 @@
 #ifndef SHAKA_EMBEDDED_MEDIA_DEMUXER_THREAD_H_
 #define SHAKA_EMBEDDED_MEDIA_DEMUXER_THREAD_H_
 
+#include <stdint.h>
+
 #include <atomic>
 #include <functional>
 
+#include "shaka/pipeline_metrics.h"
 #include "src/debug/mutex.h"
 #include "src/debug/thread.h"
 #include "src/debug/thread_event.h"
 #include "src/media/types.h"
+#include "src/util/atomic_histogram.h"
 #include "src/util/buffer_reader.h"
 #include "src/util/macros.h"
 
@@ -72,6 +76,9 @@ class DemuxerThread {
                   double window_end, const uint8_t* data, size_t data_size,
                   std::function<void(Status)> on_complete);
 
+  /** Fills in the demuxer fields of the given metrics. */
+  void GetMetrics(StreamPipelineMetrics* metrics) const;
+
  private:
   /**
    * Called by the MediaProcessor to read data.  This should fill |*data| with
@@ -96,6 +103,13 @@ class DemuxerThread {
   double window_start_;
   double window_end_;
   bool need_key_frame_;
+  util::AtomicHistogram::TimePoint append_start_;
+  // The time spent waiting for input during the current read; only used on the
+  // background thread.
+  uint64_t read_wait_us_;
+
+  util::AtomicHistogram append_times_;
+  util::AtomicHistogram demux_times_;
 
   MediaProcessor* processor_;
   Stream* stream_;
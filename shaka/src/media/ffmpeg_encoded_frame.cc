@@ -14,13 +14,10 @@
 
 #include "src/media/ffmpeg_encoded_frame.h"
 
-extern "C" {
-#include <libavutil/encryption_info.h>
-}
-
 #include <netinet/in.h>
 
 #include <limits>
+#include <utility>
 #include <vector>
 
 #include "shaka/eme/configuration.h"
@@ -53,18 +50,18 @@ void IncrementIv(uint32_t count, std::vector<uint8_t>* iv) {
 }  // namespace
 
 // static
-FFmpegEncodedFrame* FFmpegEncodedFrame::MakeFrame(AVPacket* pkt,
-                                                  AVStream* stream,
-                                                  size_t stream_id,
-                                                  double timestamp_offset) {
+FFmpegEncodedFrame* FFmpegEncodedFrame::MakeFrame(
+    AVPacket* pkt, AVStream* stream, size_t stream_id, double timestamp_offset,
+    std::shared_ptr<AVEncryptionInfo> encryption_info) {
   const double factor = av_q2d(stream->time_base);
   const double pts = pkt->pts * factor + timestamp_offset;
   const double dts = pkt->dts * factor + timestamp_offset;
   const double duration = pkt->duration * factor;
   const bool is_key_frame = pkt->flags & AV_PKT_FLAG_KEY;
 
-  return new (std::nothrow) FFmpegEncodedFrame(
-      pkt, stream_id, timestamp_offset, pts, dts, duration, is_key_frame);
+  return new (std::nothrow)
+      FFmpegEncodedFrame(pkt, stream_id, timestamp_offset, pts, dts, duration,
+                         is_key_frame, std::move(encryption_info));
 }
 
 FFmpegEncodedFrame::~FFmpegEncodedFrame() {
@@ -79,11 +76,18 @@ size_t FFmpegEncodedFrame::EstimateSize() const {
   size_t size = sizeof(*this) + packet_.size;
   for (int i = packet_.side_data_elems; i; i--)
     size += packet_.side_data[i - 1].size;
+  if (encryption_info_) {
+    size += sizeof(*encryption_info_) + encryption_info_->key_id_size +
+            encryption_info_->iv_size +
+            encryption_info_->subsample_count *
+                sizeof(*encryption_info_->subsamples);
+  }
   return size;
 }
 
 bool FFmpegEncodedFrame::is_encrypted() const {
-  return av_packet_get_side_data(&packet_, AV_PKT_DATA_ENCRYPTION_INFO,
+  return encryption_info_ ||
+         av_packet_get_side_data(&packet_, AV_PKT_DATA_ENCRYPTION_INFO,
                                  nullptr);
 }
 
@@ -94,20 +98,25 @@ Status FFmpegEncodedFrame::Decrypt(eme::Implementation* cdm,
   DCHECK_LE(packet_.size, dest_packet->size);
   DCHECK(is_encrypted()) << "This frame isn't encrypted";
 
-  int side_data_size;
-  uint8_t* side_data = av_packet_get_side_data(
-      &packet_, AV_PKT_DATA_ENCRYPTION_INFO, &side_data_size);
-  if (!side_data) {
-    LOG(ERROR) << "Unable to get side data from packet.";
-    return Status::UnknownError;
-  }
-
-  std::unique_ptr<AVEncryptionInfo, void (*)(AVEncryptionInfo*)> enc_info(
-      av_encryption_info_get_side_data(side_data, side_data_size),
-      &av_encryption_info_free);
+  std::unique_ptr<AVEncryptionInfo, void (*)(AVEncryptionInfo*)>
+      side_data_info(nullptr, &av_encryption_info_free);
+  const AVEncryptionInfo* enc_info = encryption_info_.get();
   if (!enc_info) {
-    LOG(ERROR) << "Could not allocate new encryption info structure.";
-    return Status::OutOfMemory;
+    int side_data_size;
+    uint8_t* side_data = av_packet_get_side_data(
+        &packet_, AV_PKT_DATA_ENCRYPTION_INFO, &side_data_size);
+    if (!side_data) {
+      LOG(ERROR) << "Unable to get side data from packet.";
+      return Status::UnknownError;
+    }
+
+    side_data_info.reset(
+        av_encryption_info_get_side_data(side_data, side_data_size));
+    if (!side_data_info) {
+      LOG(ERROR) << "Could not allocate new encryption info structure.";
+      return Status::OutOfMemory;
+    }
+    enc_info = side_data_info.get();
   }
 
   eme::EncryptionScheme scheme;
@@ -252,10 +261,12 @@ Status FFmpegEncodedFrame::Decrypt(eme::Implementation* cdm,
 
 FFmpegEncodedFrame::FFmpegEncodedFrame(AVPacket* pkt, size_t stream_id,
                                        double offset, double pts, double dts,
-                                       double duration, bool is_key_frame)
+                                       double duration, bool is_key_frame,
+                                       std::shared_ptr<AVEncryptionInfo> info)
     : BaseFrame(pts, dts, duration, is_key_frame),
       stream_id_(stream_id),
-      timestamp_offset_(offset) {
+      timestamp_offset_(offset),
+      encryption_info_(std::move(info)) {
   av_packet_move_ref(&packet_, pkt);
 }
 
@@ -17,6 +17,7 @@
 
 extern "C" {
 #include <libavformat/avformat.h>
+#include <libavutil/encryption_info.h>
 }
 
 #include <memory>
@@ -38,9 +39,17 @@ class FFmpegEncodedFrame final : public BaseFrame {
  public:
   ~FFmpegEncodedFrame() override;
 
-  static FFmpegEncodedFrame* MakeFrame(AVPacket* pkt, AVStream* stream,
-                                       size_t stream_id,
-                                       double timestamp_offset);
+  /**
+   * Creates a new frame that takes ownership of the given packet.
+   *
+   * @param encryption_info If given, the encryption info for the frame.  This
+   *   is used instead of the packet side data so demuxers that already have the
+   *   info parsed don't need to serialize it.
+   */
+  static FFmpegEncodedFrame* MakeFrame(
+      AVPacket* pkt, AVStream* stream, size_t stream_id,
+      double timestamp_offset,
+      std::shared_ptr<AVEncryptionInfo> encryption_info = nullptr);
 
   NON_COPYABLE_OR_MOVABLE_TYPE(FFmpegEncodedFrame);
 
@@ -69,11 +78,13 @@ class FFmpegEncodedFrame final : public BaseFrame {
 
  private:
   FFmpegEncodedFrame(AVPacket* pkt, size_t stream_id, double offset, double pts,
-                     double dts, double duration, bool is_key_frame);
+                     double dts, double duration, bool is_key_frame,
+                     std::shared_ptr<AVEncryptionInfo> encryption_info);
 
   AVPacket packet_;
   const size_t stream_id_;
   const double timestamp_offset_;
+  const std::shared_ptr<AVEncryptionInfo> encryption_info_;
 };
 
 }  // namespace media
@@ -22,6 +22,8 @@
 #include <unordered_set>
 #include <utility>
 
+#include "src/debug/trace_recorder.h"
+
 namespace shaka {
 namespace media {
 
@@ -116,24 +118,21 @@ std::list<std::unique_ptr<const BaseFrame>>::iterator FrameLowerBound(
 }  // namespace
 
 FrameBuffer::FrameBuffer(bool order_by_dts)
-    : mutex_("FrameBuffer"), order_by_dts_(order_by_dts) {}
+    : mutex_("FrameBuffer"),
+      estimated_size_(0),
+      order_by_dts_(order_by_dts) {}
 
 FrameBuffer::~FrameBuffer() {}
 
 size_t FrameBuffer::EstimateSize() const {
-  std::unique_lock<Mutex> lock(mutex_);
-
-  size_t size = 0;
-  for (auto& range : buffered_ranges_) {
-    for (auto& frame : range.frames)
-      size += frame->EstimateSize();
-  }
-  return size;
+  return estimated_size_.load(std::memory_order_relaxed);
 }
 
 void FrameBuffer::AppendFrame(std::unique_ptr<const BaseFrame> frame) {
+  ScopedTrace trace("FrameBuffer::AppendFrame");
   std::unique_lock<Mutex> lock(mutex_);
   DCHECK(frame);
+  estimated_size_.fetch_add(frame->EstimateSize(), std::memory_order_relaxed);
 
   auto extendsPast =
       order_by_dts_ ? &FrameExtendsPast<true> : &FrameExtendsPast<false>;
@@ -169,6 +168,8 @@ void FrameBuffer::AppendFrame(std::unique_ptr<const BaseFrame> frame) {
         getTime(*frame_it) == getTime(frame)) {
       used_frames_.WaitToDeleteFrames({frame_it->get()});
       swap(*frame_it, frame);
+      estimated_size_.fetch_sub(frame->EstimateSize(),
+                                std::memory_order_relaxed);
     } else {
       range_it->frames.insert(frame_it, std::move(frame));
     }
@@ -284,7 +285,31 @@ LockedFrameList::Guard FrameBuffer::GetKeyFrameBefore(double time) const {
   return LockedFrameList::Guard();
 }
 
+LockedFrameList::Guard FrameBuffer::GetKeyFrameAfter(double time) const {
+  std::unique_lock<Mutex> lock(mutex_);
+  AssertRangesSorted();
+
+  auto getTime = order_by_dts_ ? &GetTime<true> : &GetTime<false>;
+  auto lowerBound =
+      order_by_dts_ ? &FrameLowerBound<true> : &FrameLowerBound<false>;
+
+  for (const Range& range : buffered_ranges_) {
+    if (getTime(range.frames.back()) <= time)
+      continue;
+
+    // |it| points to the frame that starts at or greater than |time|.
+    for (auto it = lowerBound(range.frames, time); it != range.frames.end();
+         it++) {
+      if (getTime(*it) > time && (*it)->is_key_frame)
+        return used_frames_.GuardFrame(it->get());
+    }
+  }
+
+  return LockedFrameList::Guard();
+}
+
 void FrameBuffer::Remove(double start, double end) {
+  ScopedTrace trace("FrameBuffer::Remove");
   // Note that remove always uses PTS, even when sorting using DTS.  This is
   // intended to work like the MSE definition.
 
@@ -317,6 +342,10 @@ void FrameBuffer::Remove(double start, double end) {
     // We don't release |mutex_| while waiting.  Any threads using frames should
     // not make calls into this FrameBuffer (though they can to other buffers).
     used_frames_.WaitToDeleteFrames(frames_to_remove);
+    size_t removed_size = 0;
+    for (const BaseFrame* frame : frames_to_remove)
+      removed_size += frame->EstimateSize();
+    estimated_size_.fetch_sub(removed_size, std::memory_order_relaxed);
 
     if (frame_del_start != it->frames.begin() &&
         frame_del_start != it->frames.end() &&
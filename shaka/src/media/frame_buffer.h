@@ -15,6 +15,7 @@
 #ifndef SHAKA_EMBEDDED_MEDIA_FRAME_BUFFER_H_
 #define SHAKA_EMBEDDED_MEDIA_FRAME_BUFFER_H_
 
+#include <atomic>
 #include <list>
 #include <memory>
 #include <vector>
@@ -57,7 +58,10 @@ class FrameBuffer {
 
   NON_COPYABLE_OR_MOVABLE_TYPE(FrameBuffer);
 
-  /** @return An estimate of the number of bytes being used by these frames. */
+  /**
+   * @return An estimate of the number of bytes being used by these frames.
+   *   This doesn't lock, so it is cheap enough to poll for metrics.
+   */
   size_t EstimateSize() const;
 
   /** Adds a new frame to the buffer. */
@@ -102,6 +106,13 @@ class FrameBuffer {
    */
   LockedFrameList::Guard GetKeyFrameBefore(double time) const;
 
+  /**
+   * Searches forward from the given time to return the first key frame whose
+   * start time is strictly higher than the given time.
+   * @returns The frame that is found, or nullptr if none are found.
+   */
+  LockedFrameList::Guard GetKeyFrameAfter(double time) const;
+
   /**
    * Removes the frames that start in the given range.  This will remove frames
    * past @a end until the next keyframe to mirror MSE requirements.
@@ -133,6 +144,7 @@ class FrameBuffer {
   mutable LockedFrameList used_frames_;
   mutable Mutex mutex_;
   std::list<Range> buffered_ranges_;
+  std::atomic<size_t> estimated_size_;
   bool order_by_dts_;
 };
 
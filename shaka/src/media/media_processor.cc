@@ -24,15 +24,24 @@ extern "C" {
 #include <libavutil/opt.h>
 }
 
+#include <algorithm>
+#include <cmath>
 #include <cstring>
+#include <unordered_map>
 #include <utility>
 
 #include "src/core/js_manager_impl.h"
 #include "src/debug/mutex.h"
 #include "src/debug/thread_event.h"
+#include "src/debug/trace_recorder.h"
 #include "src/media/ffmpeg_decoded_frame.h"
 #include "src/media/ffmpeg_encoded_frame.h"
 #include "src/media/media_utils.h"
+#include "src/media/mp4_parser.h"
+#include "src/util/atomic_histogram.h"
+#include "src/util/buffer_reader.h"
+#include "src/util/clock.h"
+#include "src/util/crypto.h"
 #include "src/util/utils.h"
 
 // Special error code added by //third_party/ffmpeg/mov.patch
@@ -45,6 +54,25 @@ namespace {
 
 constexpr const size_t kInitialBufferSize = 2048;
 
+/**
+ * The maximum duration, in AV_TIME_BASE units, that avformat_find_stream_info
+ * will analyze when the init segment already describes the stream completely.
+ */
+constexpr const int64_t kAuthoritativeAnalyzeDuration = AV_TIME_BASE / 2;
+
+#ifdef ENABLE_NATIVE_MP4_DEMUXER
+constexpr const uint32_t kFtypBox = Mp4BoxType('f', 't', 'y', 'p');
+constexpr const uint32_t kMdatBox = Mp4BoxType('m', 'd', 'a', 't');
+constexpr const uint32_t kMoofBox = Mp4BoxType('m', 'o', 'o', 'f');
+constexpr const uint32_t kMoovBox = Mp4BoxType('m', 'o', 'o', 'v');
+
+/**
+ * The largest top-level box the native demuxer will buffer.  Anything bigger is
+ * handed to libavformat, which can stream it.
+ */
+constexpr const uint64_t kMaxNativeBoxSize = 64 * 1024 * 1024;
+#endif
+
 std::string ErrStr(int code) {
   if (code == 0)
     return "Success";
@@ -190,6 +218,79 @@ std::vector<uint8_t> CreatePssh(AVEncryptionInitInfo* info) {
   return pssh;
 }
 
+/**
+ * Returns whether the decoder for the given codec gets the pixel format from
+ * the bitstream.  mov/matroska don't set the format from the init segment, so
+ * for these the format being unknown doesn't mean the stream needs probing.
+ */
+bool DecoderReportsPixelFormat(const AVCodecParameters* params) {
+  switch (params->codec_id) {
+    case AV_CODEC_ID_H264:
+    case AV_CODEC_ID_HEVC:
+      // The decoder configuration (avcC/hvcC) is required to decode.
+      return params->extradata_size > 0;
+    case AV_CODEC_ID_VP8:
+    case AV_CODEC_ID_VP9:
+      return true;
+    default:
+      return false;
+  }
+}
+
+/**
+ * Returns whether the init segment parsed by the given demuxer fully describes
+ * the stream.  For fragmented MP4 and WebM, the codec configuration is stored
+ * in the init segment, so probing the media only needs to refine timing info.
+ */
+bool IsInitSegmentAuthoritative(const std::string& container,
+                                const AVFormatContext* demuxer) {
+  if (container != "mov" && container != "matroska")
+    return false;
+  if (demuxer->nb_streams != 1)
+    return false;
+
+  const AVCodecParameters* params = demuxer->streams[0]->codecpar;
+  if (params->codec_id == AV_CODEC_ID_NONE)
+    return false;
+  switch (params->codec_type) {
+    case AVMEDIA_TYPE_VIDEO:
+      return params->width > 0 && params->height > 0 &&
+             (params->format != AV_PIX_FMT_NONE ||
+              DecoderReportsPixelFormat(params));
+    case AVMEDIA_TYPE_AUDIO:
+      return params->sample_rate > 0 && params->channels > 0;
+    default:
+      return false;
+  }
+}
+
+/**
+ * Creates a hash of the stream info parsed from the init segment.  This only
+ * contains info that comes from the init segment (i.e. before probing the
+ * media), so the same init segment will always produce the same hash.
+ */
+std::string HashStreamHeader(const AVStream* stream) {
+  const AVCodecParameters* params = stream->codecpar;
+  const int64_t fields[] = {
+      params->codec_type,    params->codec_id,    params->codec_tag,
+      params->format,        params->profile,     params->level,
+      params->width,         params->height,      params->sample_rate,
+      params->channels,      stream->time_base.num, stream->time_base.den,
+      params->extradata_size,
+  };
+  std::vector<uint8_t> buffer(reinterpret_cast<const uint8_t*>(fields),
+                              reinterpret_cast<const uint8_t*>(fields) +
+                                  sizeof(fields));
+  if (params->extradata) {
+    buffer.insert(buffer.end(), params->extradata,
+                  params->extradata + params->extradata_size);
+  }
+
+  const std::vector<uint8_t> digest =
+      util::HashData(buffer.data(), buffer.size());
+  return util::ToHexString(digest.data(), digest.size());
+}
+
 }  // namespace
 
 class MediaProcessor::Impl {
@@ -212,7 +313,18 @@ class MediaProcessor::Impl {
 #endif
         timestamp_offset_(0),
         prev_timestamp_offset_(0),
-        decoder_stream_id_(0) {
+        decoder_stream_id_(0),
+        demuxer_stream_id_(0),
+        degradation_(DecodeDegradation::None),
+        seek_target_(NAN),
+        reinit_start_time_(0) {
+#ifdef ENABLE_NATIVE_MP4_DEMUXER
+    native_ = container_ == "mov";
+    has_native_header_ = false;
+    native_mdat_ = nullptr;
+    native_mdat_offset_ = 0;
+    next_native_sample_ = 0;
+#endif
   }
 
   ~Impl() {
@@ -234,6 +346,9 @@ class MediaProcessor::Impl {
     av_frame_free(&received_frame_);
 #ifdef ENABLE_HARDWARE_DECODE
     av_buffer_unref(&hw_device_ctx_);
+#endif
+#ifdef ENABLE_NATIVE_MP4_DEMUXER
+    av_buffer_unref(&native_mdat_);
 #endif
   }
 
@@ -254,19 +369,35 @@ class MediaProcessor::Impl {
   }
 
   Status ReinitDemuxer(std::unique_lock<Mutex>* lock) {
+    reinit_start_time_ = util::Clock::Instance.GetMonotonicTime();
     avformat_close_input(&demuxer_ctx_);
     avio_flush(io_);
+#ifdef ENABLE_NATIVE_MP4_DEMUXER
+    // In native mode, the previous demuxer will have read to the end of the
+    // init segment; clear the EOF so the new demuxer can read.
+    io_->eof_reached = 0;
+#endif
 
     AVFormatContext* new_ctx;
+    std::string init_hash;
     // Create the new demuxer without the lock held because the method will
     // block while waiting for the init segment.
     lock->unlock();
-    const Status status = CreateDemuxer(&new_ctx);
+    const Status status = CreateDemuxer(&new_ctx, &init_hash);
     if (status != Status::Success)
       return status;
     lock->lock();
     demuxer_ctx_ = new_ctx;
 
+    auto it = init_segment_cache_.find(init_hash);
+    if (it != init_segment_cache_.end()) {
+      // We have seen this init segment before, so reuse the same stream ID.
+      // This allows the decoder to be reused if it is already configured for
+      // this stream.
+      demuxer_stream_id_ = it->second;
+      return Status::Success;
+    }
+
     AVStream* stream = demuxer_ctx_->streams[0];
     auto* params = avcodec_parameters_alloc();
     if (!params) {
@@ -280,11 +411,14 @@ class MediaProcessor::Impl {
     }
     codec_params_.push_back(params);
     time_scales_.push_back(stream->time_base);
+    demuxer_stream_id_ = codec_params_.size() - 1;
+    if (!init_hash.empty())
+      init_segment_cache_.emplace(init_hash, demuxer_stream_id_);
 
     return Status::Success;
   }
 
-  Status CreateDemuxer(AVFormatContext** context) {
+  Status CreateDemuxer(AVFormatContext** context, std::string* init_hash) {
     // Allocate a demuxer context and set it to use the IO context.
     AVFormatContext* demuxer = avformat_alloc_context();
     if (!demuxer) {
@@ -293,15 +427,26 @@ class MediaProcessor::Impl {
     demuxer->pb = io_;
     // If we enable the probes, in encrypted content we'll get logs about being
     // unable to parse the content; however, if we disable the probes, we won't
-    // get accurate frame durations, which can cause problems.
-    // TODO: Find a way to conditionally disable parsing or to suppress the
-    // logs for encrypted content (since the errors there aren't fatal).
+    // get accurate frame durations, which can cause problems.  So we only skip
+    // the probes for init segments we have already probed, see below.
     // demuxer->probesize = 0;
     // demuxer->max_analyze_duration = 0;
 
     // To enable extremely verbose logging:
     // demuxer->debug = 1;
 
+#ifdef ENABLE_NATIVE_MP4_DEMUXER
+    if (native_) {
+      // Read the init segment ourselves; libavformat will only be given the
+      // init segment to parse the codec info.
+      const Status init_status = ReadNativeInitSegment();
+      if (init_status != Status::Success) {
+        avformat_free_context(demuxer);
+        return init_status;
+      }
+    }
+#endif
+
     // Parse encryption info for WebM; ignored for other demuxers.
     AVDictionary* dict = nullptr;
     CHECK_EQ(av_dict_set_int(&dict, "parse_encryption", 1, 0), 0);
@@ -323,16 +468,46 @@ class MediaProcessor::Impl {
       return Status::CannotOpenDemuxer;
     }
 
-    const int find_code = avformat_find_stream_info(demuxer, nullptr);
-    if (find_code < 0) {
-      avformat_close_input(&demuxer);
-      if (find_code == AVERROR(ENOMEM))
-        return Status::OutOfMemory;
-      if (find_code == AVERROR_INVALIDDATA)
-        return Status::InvalidContainerData;
+    if (demuxer->nb_streams == 1) {
+      *init_hash = HashStreamHeader(demuxer->streams[0]);
+    } else {
+      init_hash->clear();
+    }
 
-      HandleGenericFFmpegError(find_code);
-      return Status::CannotOpenDemuxer;
+    auto it = init_hash->empty() ? init_segment_cache_.end()
+                                 : init_segment_cache_.find(*init_hash);
+    if (it != init_segment_cache_.end()) {
+      // We have already probed this init segment; skip probing and use the
+      // parameters we found the first time.
+      VLOG(1) << "Reusing cached codec parameters for init segment";
+      const int copy_code = avcodec_parameters_copy(
+          demuxer->streams[0]->codecpar, codec_params_[it->second]);
+      if (copy_code < 0) {
+        avformat_close_input(&demuxer);
+        if (copy_code == AVERROR(ENOMEM))
+          return Status::OutOfMemory;
+
+        HandleGenericFFmpegError(copy_code);
+        return Status::CannotOpenDemuxer;
+      }
+    } else if (!IsNativeDemuxer()) {
+      if (IsInitSegmentAuthoritative(container_, demuxer)) {
+        // The init segment describes the codec, so only analyze enough frames
+        // to get the timing info.
+        demuxer->max_analyze_duration = kAuthoritativeAnalyzeDuration;
+      }
+
+      const int find_code = avformat_find_stream_info(demuxer, nullptr);
+      if (find_code < 0) {
+        avformat_close_input(&demuxer);
+        if (find_code == AVERROR(ENOMEM))
+          return Status::OutOfMemory;
+        if (find_code == AVERROR_INVALIDDATA)
+          return Status::InvalidContainerData;
+
+        HandleGenericFFmpegError(find_code);
+        return Status::CannotOpenDemuxer;
+      }
     }
 
     if (demuxer->nb_streams == 0) {
@@ -383,6 +558,11 @@ class MediaProcessor::Impl {
   }
 
   Status ReadDemuxedFrame(std::unique_ptr<BaseFrame>* frame) {
+#ifdef ENABLE_NATIVE_MP4_DEMUXER
+    if (native_)
+      return ReadNativeFrame(frame);
+#endif
+
     AVPacket pkt;
     int ret = av_read_frame(demuxer_ctx_, &pkt);
     if (ret == AVERROR_SHAKA_RESET_DEMUXER) {
@@ -409,7 +589,7 @@ class MediaProcessor::Impl {
       return Status::UnknownError;
     }
 
-    UpdateEncryptionInitInfo();
+    OnFrameRead();
 
     // Ignore discard flags.  The demuxer will set this when we try to read
     // content behind media we have already read.
@@ -419,7 +599,7 @@ class MediaProcessor::Impl {
     DCHECK_EQ(pkt.stream_index, 0);
     DCHECK_EQ(demuxer_ctx_->nb_streams, 1u);
     frame->reset(FFmpegEncodedFrame::MakeFrame(&pkt, demuxer_ctx_->streams[0],
-                                               codec_params_.size() - 1,
+                                               demuxer_stream_id_,
                                                timestamp_offset_));
     // No need to unref |pkt| since it was moved into the encoded frame.
     return *frame ? Status::Success : Status::OutOfMemory;
@@ -488,6 +668,7 @@ class MediaProcessor::Impl {
     decoder_ctx_->thread_count = 0;  // Default is 1; 0 means auto-detect.
     decoder_ctx_->opaque = this;
     decoder_ctx_->pkt_timebase = time_scales_[stream_id];
+    ApplyDecodeDegradation();
 
 #ifdef ENABLE_HARDWARE_DECODE
     // If using a hardware accelerator, initialize it now.
@@ -548,8 +729,20 @@ class MediaProcessor::Impl {
       const double time = frame && timestamp == AV_NOPTS_VALUE
                               ? frame->pts
                               : timestamp * timescale + offset;
-      auto* new_frame = FFmpegDecodedFrame::CreateFrame(
-          received_frame_, time, frame ? frame->duration : 0);
+      const double duration = frame ? frame->duration : 0;
+      if (!std::isnan(seek_target_)) {
+        if (time < seek_target_ && time + duration <= seek_target_) {
+          // This frame is only needed to decode the frames after it; drop it
+          // before we copy it into a new frame.
+          VLOG(3) << "Discarding decoded frame before seek target, pts="
+                  << time;
+          continue;
+        }
+        seek_target_ = NAN;
+      }
+
+      auto* new_frame =
+          FFmpegDecodedFrame::CreateFrame(received_frame_, time, duration);
       if (!new_frame) {
         return Status::OutOfMemory;
       }
@@ -625,9 +818,12 @@ class MediaProcessor::Impl {
         return Status::UnknownError;
       }
 
+      ScopedTrace trace("Decrypt");
+      const auto decrypt_start = util::AtomicHistogram::Now();
       Status decrypt_status = frame->Decrypt(cdm, &decrypted_packet);
       if (decrypt_status != Status::Success)
         return decrypt_status;
+      decrypt_times_.RecordSince(decrypt_start);
       frame_to_send = &decrypted_packet;
     }
 
@@ -667,16 +863,406 @@ class MediaProcessor::Impl {
 
   void ResetDecoder() {
     avcodec_free_context(&decoder_ctx_);
+    seek_target_ = NAN;
+  }
+
+  void SetSeekTarget(double time) {
+    seek_target_ = time;
+  }
+
+  void GetDecryptTimes(LatencyHistogram* histogram) const {
+    decrypt_times_.CopyTo(histogram);
+  }
+
+  void SetDecodeDegradation(DecodeDegradation degradation) {
+    degradation_ = degradation;
+    if (decoder_ctx_)
+      ApplyDecodeDegradation();
+  }
+
+  bool IsNativeDemuxer() const {
+#ifdef ENABLE_NATIVE_MP4_DEMUXER
+    return native_;
+#else
+    return false;
+#endif
   }
 
  private:
   static int ReadCallback(void* opaque, uint8_t* buffer, int size) {
     DCHECK_GE(size, 0);
-    const size_t count =
-        reinterpret_cast<Impl*>(opaque)->on_read_(buffer, size);
+    auto* impl = reinterpret_cast<Impl*>(opaque);
+#ifdef ENABLE_NATIVE_MP4_DEMUXER
+    // Bytes the native demuxer already read are given to libavformat first.
+    if (!impl->replay_.empty())
+      return impl->replay_.Read(buffer, size);
+    if (impl->native_)
+      return AVERROR_EOF;
+#endif
+    const size_t count = impl->on_read_(buffer, size);
     return count == 0 ? AVERROR_EOF : count;
   }
 
+  void ApplyDecodeDegradation() {
+    decoder_ctx_->skip_loop_filter =
+        degradation_ >= DecodeDegradation::SkipLoopFilter ? AVDISCARD_ALL
+                                                          : AVDISCARD_DEFAULT;
+    decoder_ctx_->skip_frame =
+        degradation_ >= DecodeDegradation::SkipNonReference ? AVDISCARD_NONREF
+                                                            : AVDISCARD_DEFAULT;
+  }
+
+  void OnFrameRead() {
+    UpdateEncryptionInitInfo();
+
+    if (reinit_start_time_ != 0) {
+      VLOG(1) << "Read first frame "
+              << util::Clock::Instance.GetMonotonicTime() - reinit_start_time_
+              << "ms after initializing the demuxer";
+      reinit_start_time_ = 0;
+    }
+  }
+
+#ifdef ENABLE_NATIVE_MP4_DEMUXER
+  /**
+   * Reads exactly |size| bytes from the source.  This returns false if the
+   * source was closed first.
+   */
+  bool ReadSource(uint8_t* dest, uint64_t size) {
+    while (size > 0) {
+      const size_t count = on_read_(dest, size);
+      if (count == 0)
+        return false;
+      dest += count;
+      size -= count;
+    }
+    return true;
+  }
+
+  /** Reads and discards |size| bytes from the source. */
+  bool SkipSource(uint64_t size) {
+    uint8_t buffer[4096];
+    while (size > 0) {
+      const size_t count =
+          on_read_(buffer, std::min<uint64_t>(size, sizeof(buffer)));
+      if (count == 0)
+        return false;
+      size -= count;
+    }
+    return true;
+  }
+
+  /** Sets the bytes that libavformat will read before reading the source. */
+  void SetReplay(std::vector<uint8_t> data) {
+    replay_data_ = std::move(data);
+    replay_.SetBuffer(replay_data_.data(), replay_data_.size());
+  }
+
+  /**
+   * Reads the header of the next top-level box into |native_header_|.  If the
+   * header was already read (e.g. when a new init segment was found while
+   * reading frames), this does nothing.
+   *
+   * A box with a size of 0 extends to the end of the input.  This leaves
+   * |box_size| as 0; since we can't know where the input ends while data is
+   * still being appended, the callers hand these boxes to libavformat.
+   */
+  Status ReadNativeBoxHeader() {
+    if (has_native_header_)
+      return Status::Success;
+
+    native_header_bytes_.resize(8);
+    if (!ReadSource(native_header_bytes_.data(), 8))
+      return Status::EndOfStream;
+    util::BufferReader reader(native_header_bytes_.data(), 8);
+    uint64_t size = reader.ReadUint32();
+    native_header_.type = reader.ReadUint32();
+    native_header_.header_size = 8;
+    if (size == 1) {
+      native_header_bytes_.resize(16);
+      if (!ReadSource(native_header_bytes_.data() + 8, 8))
+        return Status::EndOfStream;
+      reader.SetBuffer(native_header_bytes_.data() + 8, 8);
+      size = reader.ReadUint64();
+      native_header_.header_size = 16;
+    }
+    if (size != 0 && size < native_header_.header_size) {
+      LOG(ERROR) << "Invalid MP4 box size";
+      return Status::InvalidContainerData;
+    }
+
+    native_header_.box_size = size;
+    has_native_header_ = true;
+    return Status::Success;
+  }
+
+  /**
+   * Reads the rest of the box whose header is in |native_header_|.  |box| will
+   * contain the whole box, including the header.  If the box is too big or
+   * extends to the end of the input, this returns NotSupported and |box| only
+   * contains the header.
+   */
+  Status ReadNativeBoxBody(std::vector<uint8_t>* box) {
+    DCHECK(has_native_header_);
+    has_native_header_ = false;
+    *box = native_header_bytes_;
+    if (native_header_.box_size == 0 ||
+        native_header_.box_size > kMaxNativeBoxSize) {
+      return Status::NotSupported;
+    }
+
+    box->resize(native_header_.box_size);
+    if (!ReadSource(box->data() + native_header_.header_size,
+                    native_header_.box_size - native_header_.header_size)) {
+      return Status::EndOfStream;
+    }
+    return Status::Success;
+  }
+
+  /**
+   * Reads the init segment from the source and parses it.  The bytes read are
+   * stored so libavformat can read them to parse the codec info.  If the init
+   * segment can't be handled natively, this switches to libavformat.
+   */
+  Status ReadNativeInitSegment() {
+    std::vector<uint8_t> init;
+    while (true) {
+      const Status header_status = ReadNativeBoxHeader();
+      if (header_status != Status::Success)
+        return header_status;
+
+      if (native_header_.type == kMdatBox) {
+        // This isn't fragmented content.
+        init.insert(init.end(), native_header_bytes_.begin(),
+                    native_header_bytes_.end());
+        has_native_header_ = false;
+        break;
+      }
+
+      const uint32_t type = native_header_.type;
+      std::vector<uint8_t> box;
+      const Status body_status = ReadNativeBoxBody(&box);
+      init.insert(init.end(), box.begin(), box.end());
+      if (body_status == Status::NotSupported)
+        break;
+      if (body_status != Status::Success)
+        return body_status;
+
+      if (type == kMoovBox) {
+        if (mp4_parser_.ParseInitSegment(box.data(), box.size())) {
+          native_init_ = init;
+          SetReplay(std::move(init));
+          return Status::Success;
+        }
+        break;
+      }
+    }
+
+    VLOG(1) << "Unable to parse init segment natively, falling back to "
+               "libavformat";
+    native_ = false;
+    SetReplay(std::move(init));
+    return Status::Success;
+  }
+
+  /**
+   * Switches to demuxing with libavformat.  This is used when a fragment uses
+   * a feature we don't support.
+   *
+   * @param consumed The bytes read from the source since the last fragment.
+   */
+  Status FallBackToLibavformat(const std::vector<uint8_t>& consumed) {
+    VLOG(1) << "Unable to parse fragment natively, falling back to "
+               "libavformat";
+    native_ = false;
+    native_samples_.clear();
+    native_encryption_info_.clear();
+    next_native_sample_ = 0;
+
+    std::vector<uint8_t> replay = std::move(native_init_);
+    replay.insert(replay.end(), consumed.begin(), consumed.end());
+    SetReplay(std::move(replay));
+
+    std::unique_lock<Mutex> lock(mutex_);
+    return ReinitDemuxer(&lock);
+  }
+
+  /** Creates the encryption info for the given sample. */
+  std::shared_ptr<AVEncryptionInfo> MakeEncryptionInfo(
+      const Mp4Sample& sample) {
+    const std::vector<uint8_t>& key_id = mp4_parser_.key_id();
+    AVEncryptionInfo* info = av_encryption_info_alloc(
+        sample.subsamples.size(), key_id.size(), sample.iv.size());
+    if (!info)
+      return nullptr;
+
+    info->scheme = mp4_parser_.scheme();
+    info->crypt_byte_block = mp4_parser_.crypt_byte_block();
+    info->skip_byte_block = mp4_parser_.skip_byte_block();
+    std::memcpy(info->key_id, key_id.data(), key_id.size());
+    std::memcpy(info->iv, sample.iv.data(), sample.iv.size());
+    for (size_t i = 0; i < sample.subsamples.size(); i++) {
+      info->subsamples[i].bytes_of_clear_data =
+          sample.subsamples[i].clear_bytes;
+      info->subsamples[i].bytes_of_protected_data =
+          sample.subsamples[i].protected_bytes;
+    }
+    return std::shared_ptr<AVEncryptionInfo>(info, &av_encryption_info_free);
+  }
+
+  /**
+   * Reads the 'moof' box whose header is in |native_header_| and the 'mdat'
+   * box that follows it.  This stores the samples so they can be returned by
+   * ReadNativeFrame.
+   */
+  Status ReadNativeFragment() {
+    std::vector<uint8_t> consumed;
+    const Status moof_status = ReadNativeBoxBody(&consumed);
+    if (moof_status == Status::NotSupported)
+      return FallBackToLibavformat(consumed);
+    if (moof_status != Status::Success)
+      return moof_status;
+
+    std::vector<Mp4Sample> samples;
+    std::vector<uint8_t> pssh;
+    if (!mp4_parser_.ParseFragment(consumed.data(), consumed.size(), &samples,
+                                   &pssh)) {
+      return FallBackToLibavformat(consumed);
+    }
+    if (!pssh.empty()) {
+      on_encrypted_init_data_(eme::MediaKeyInitDataType::Cenc, pssh.data(),
+                              pssh.size());
+    }
+
+    const Status header_status = ReadNativeBoxHeader();
+    if (header_status != Status::Success)
+      return header_status;
+    consumed.insert(consumed.end(), native_header_bytes_.begin(),
+                    native_header_bytes_.end());
+    const uint64_t mdat_start = consumed.size();
+    // An 'mdat' that extends to the end of the input is read by libavformat.
+    bool fits_in_mdat = native_header_.type == kMdatBox &&
+                        native_header_.box_size != 0 &&
+                        native_header_.box_size <= kMaxNativeBoxSize;
+    const uint64_t mdat_size =
+        fits_in_mdat ? native_header_.box_size - native_header_.header_size
+                     : 0;
+    for (const Mp4Sample& sample : samples) {
+      if (sample.offset < mdat_start ||
+          sample.offset + sample.size > mdat_start + mdat_size) {
+        fits_in_mdat = false;
+      }
+    }
+    if (!fits_in_mdat) {
+      has_native_header_ = false;
+      return FallBackToLibavformat(consumed);
+    }
+    has_native_header_ = false;
+
+    // The sample data is copied once into a single buffer; each packet
+    // references a slice of it.
+    av_buffer_unref(&native_mdat_);
+    native_mdat_ = av_buffer_alloc(mdat_size + AV_INPUT_BUFFER_PADDING_SIZE);
+    if (!native_mdat_)
+      return Status::OutOfMemory;
+    std::memset(native_mdat_->data + mdat_size, 0,
+                AV_INPUT_BUFFER_PADDING_SIZE);
+    if (!ReadSource(native_mdat_->data, mdat_size))
+      return Status::EndOfStream;
+    native_mdat_offset_ = mdat_start;
+
+    native_encryption_info_.clear();
+    for (const Mp4Sample& sample : samples) {
+      if (sample.is_encrypted) {
+        native_encryption_info_.emplace_back(MakeEncryptionInfo(sample));
+        if (!native_encryption_info_.back())
+          return Status::OutOfMemory;
+      } else {
+        native_encryption_info_.emplace_back();
+      }
+    }
+    native_samples_.swap(samples);
+    next_native_sample_ = 0;
+    return Status::Success;
+  }
+
+  Status ReadNativeFrame(std::unique_ptr<BaseFrame>* frame) {
+    while (next_native_sample_ >= native_samples_.size()) {
+      const Status header_status = ReadNativeBoxHeader();
+      if (header_status != Status::Success)
+        return header_status;
+
+      switch (native_header_.type) {
+        case kFtypBox:
+        case kMoovBox: {
+          // The header is kept so the new demuxer can read the init segment.
+          VLOG(1) << "Reinitializing demuxer";
+          native_samples_.clear();
+          next_native_sample_ = 0;
+          std::unique_lock<Mutex> lock(mutex_);
+          const Status reinit_status = ReinitDemuxer(&lock);
+          if (reinit_status != Status::Success)
+            return reinit_status;
+          break;
+        }
+        case kMoofBox: {
+          const Status fragment_status = ReadNativeFragment();
+          if (fragment_status != Status::Success)
+            return fragment_status;
+          break;
+        }
+        default:
+          // Ignore other boxes (e.g. 'styp', 'sidx', 'emsg').
+          has_native_header_ = false;
+          if (native_header_.box_size == 0) {
+            // The box extends to the end of the input, so let libavformat
+            // read it.
+            const Status fallback_status =
+                FallBackToLibavformat(native_header_bytes_);
+            if (fallback_status != Status::Success)
+              return fallback_status;
+            break;
+          }
+          if (!SkipSource(native_header_.box_size - native_header_.header_size))
+            return Status::EndOfStream;
+          break;
+      }
+
+      if (!native_)
+        return ReadDemuxedFrame(frame);
+    }
+
+    const size_t index = next_native_sample_++;
+    const Mp4Sample& sample = native_samples_[index];
+    AVPacket pkt;
+    av_init_packet(&pkt);
+    pkt.buf = av_buffer_ref(native_mdat_);
+    if (!pkt.buf)
+      return Status::OutOfMemory;
+    pkt.data = native_mdat_->data + (sample.offset - native_mdat_offset_);
+    pkt.size = sample.size;
+    pkt.pts = sample.pts;
+    pkt.dts = sample.dts;
+    pkt.duration = sample.duration;
+    pkt.flags = sample.is_key_frame ? AV_PKT_FLAG_KEY : 0;
+    pkt.stream_index = 0;
+
+    OnFrameRead();
+
+    VLOG(3) << "Read frame at dts=" << pkt.dts;
+    AVStream* stream = demuxer_ctx_->streams[0];
+    DCHECK_EQ(stream->time_base.num, 1);
+    DCHECK_EQ(static_cast<uint32_t>(stream->time_base.den),
+              mp4_parser_.timescale());
+    frame->reset(FFmpegEncodedFrame::MakeFrame(
+        &pkt, stream, demuxer_stream_id_, timestamp_offset_,
+        std::move(native_encryption_info_[index])));
+    if (!*frame)
+      av_packet_unref(&pkt);
+    return *frame ? Status::Success : Status::OutOfMemory;
+  }
+#endif
+
 #ifdef ENABLE_HARDWARE_DECODE
   static AVPixelFormat GetPixelFormat(AVCodecContext* ctx,
                                       const AVPixelFormat* formats) {
@@ -740,6 +1326,8 @@ class MediaProcessor::Impl {
 
   std::vector<AVCodecParameters*> codec_params_;
   std::vector<AVRational> time_scales_;
+  // Maps the hash of an init segment to the stream ID it was parsed into.
+  std::unordered_map<std::string, size_t> init_segment_cache_;
   AVIOContext* io_;
   AVFormatContext* demuxer_ctx_;
   AVCodecContext* decoder_ctx_;
@@ -752,6 +1340,40 @@ class MediaProcessor::Impl {
   double prev_timestamp_offset_;
   // The stream ID the decoder is currently configured to use.
   size_t decoder_stream_id_;
+  // The stream ID of the init segment the demuxer is currently using.
+  size_t demuxer_stream_id_;
+  // Only used on the decoder thread.
+  DecodeDegradation degradation_;
+  double seek_target_;
+  // Written on the decoder thread, but can be read from any thread.
+  util::AtomicHistogram decrypt_times_;
+
+  // The time the demuxer was last (re)initialized; only used on the demuxer
+  // thread.
+  uint64_t reinit_start_time_;
+
+#ifdef ENABLE_NATIVE_MP4_DEMUXER
+  // The native demuxer state; these are only used on the demuxer thread.  When
+  // |native_| is true, libavformat is only used to parse the codec info from
+  // the init segment, and the fragments are parsed by |mp4_parser_|.
+  bool native_;
+  Mp4Parser mp4_parser_;
+  Mp4BoxHeader native_header_;
+  std::vector<uint8_t> native_header_bytes_;
+  bool has_native_header_;
+  // The bytes of the current init segment, used when falling back.
+  std::vector<uint8_t> native_init_;
+  // Bytes that libavformat will read before reading from |on_read_|.
+  std::vector<uint8_t> replay_data_;
+  util::BufferReader replay_;
+
+  AVBufferRef* native_mdat_;
+  // The offset of |native_mdat_| relative to the start of the 'moof'.
+  uint64_t native_mdat_offset_;
+  std::vector<Mp4Sample> native_samples_;
+  std::vector<std::shared_ptr<AVEncryptionInfo>> native_encryption_info_;
+  size_t next_native_sample_;
+#endif
 };
 
 MediaProcessor::MediaProcessor(
@@ -786,6 +1408,10 @@ double MediaProcessor::duration() const {
   return impl_->duration();
 }
 
+bool MediaProcessor::IsUsingNativeDemuxer() const {
+  return impl_->IsNativeDemuxer();
+}
+
 Status MediaProcessor::InitializeDemuxer(
     std::function<size_t(uint8_t*, size_t)> on_read,
     std::function<void()> on_reset_read) {
@@ -793,12 +1419,14 @@ Status MediaProcessor::InitializeDemuxer(
 }
 
 Status MediaProcessor::ReadDemuxedFrame(std::unique_ptr<BaseFrame>* frame) {
+  ScopedTrace trace("MediaProcessor::ReadDemuxedFrame");
   return impl_->ReadDemuxedFrame(frame);
 }
 
 Status MediaProcessor::DecodeFrame(
     double cur_time, const BaseFrame* frame, eme::Implementation* cdm,
     std::vector<std::unique_ptr<BaseFrame>>* decoded) {
+  ScopedTrace trace("MediaProcessor::DecodeFrame");
   return impl_->DecodeFrame(cur_time, frame, cdm, decoded);
 }
 
@@ -810,5 +1438,17 @@ void MediaProcessor::ResetDecoder() {
   impl_->ResetDecoder();
 }
 
+void MediaProcessor::SetDecodeDegradation(DecodeDegradation degradation) {
+  impl_->SetDecodeDegradation(degradation);
+}
+
+void MediaProcessor::SetSeekTarget(double time) {
+  impl_->SetSeekTarget(time);
+}
+
+void MediaProcessor::GetDecryptTimes(LatencyHistogram* histogram) const {
+  impl_->GetDecryptTimes(histogram);
+}
+
 }  // namespace media
 }  // namespace shaka
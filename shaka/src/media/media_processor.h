@@ -21,6 +21,7 @@
 #include <vector>
 
 #include "shaka/eme/configuration.h"
+#include "shaka/pipeline_metrics.h"
 #include "src/media/base_frame.h"
 #include "src/media/types.h"
 
@@ -32,6 +33,19 @@ class Implementation;
 
 namespace media {
 
+/**
+ * Defines how much the decoder may reduce its output quality to keep up with
+ * playback.  Each level includes the ones before it.
+ */
+enum class DecodeDegradation {
+  /** Decode every frame fully. */
+  None,
+  /** Skip the in-loop deblocking filter. */
+  SkipLoopFilter,
+  /** Skip decoding non-reference frames. */
+  SkipNonReference,
+};
+
 /**
  * Handles processing the media frames.  This includes demuxing media segments
  * and decoding frames.  This contains all the platform-specific code for
@@ -74,6 +88,13 @@ class MediaProcessor {
    */
   double duration() const;
 
+  /**
+   * @return Whether the demuxer is using the built-in fragmented MP4 parser
+   *   rather than libavformat.  This is only used for testing; it should only
+   *   be called from the thread that reads demuxed frames.
+   */
+  bool IsUsingNativeDemuxer() const;
+
   /**
    * Performs any global initialization that is required (e.g. registering
    * codecs).  This can be called multiple times, but it must be called before
@@ -137,6 +158,28 @@ class MediaProcessor {
    */
   virtual void ResetDecoder();
 
+  /**
+   * Sets how much the decoder may degrade its output to keep up with playback.
+   * This applies to the current decoder and any new decoders.  This should be
+   * called from the same thread that calls DecodeFrame.
+   */
+  virtual void SetDecodeDegradation(DecodeDegradation degradation);
+
+  /**
+   * Sets the target time of a seek.  Until a frame that reaches this time is
+   * decoded, DecodeFrame will discard decoded frames that end before it rather
+   * than returning them.  The target is cleared by ResetDecoder, so this
+   * should be called after it.  This should be called from the same thread
+   * that calls DecodeFrame.
+   */
+  virtual void SetSeekTarget(double time);
+
+  /**
+   * Copies the time spent decrypting frames to the given histogram.  This can
+   * be called from any thread.
+   */
+  void GetDecryptTimes(LatencyHistogram* histogram) const;
+
  private:
   class Impl;
   std::unique_ptr<Impl> impl_;
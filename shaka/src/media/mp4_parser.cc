@@ -0,0 +1,760 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/media/mp4_parser.h"
+
+#include <glog/logging.h>
+
+namespace shaka {
+namespace media {
+
+namespace {
+
+constexpr const uint32_t kEdts = Mp4BoxType('e', 'd', 't', 's');
+constexpr const uint32_t kElst = Mp4BoxType('e', 'l', 's', 't');
+constexpr const uint32_t kEnca = Mp4BoxType('e', 'n', 'c', 'a');
+constexpr const uint32_t kEncv = Mp4BoxType('e', 'n', 'c', 'v');
+constexpr const uint32_t kHdlr = Mp4BoxType('h', 'd', 'l', 'r');
+constexpr const uint32_t kMdhd = Mp4BoxType('m', 'd', 'h', 'd');
+constexpr const uint32_t kMdia = Mp4BoxType('m', 'd', 'i', 'a');
+constexpr const uint32_t kMinf = Mp4BoxType('m', 'i', 'n', 'f');
+constexpr const uint32_t kMoof = Mp4BoxType('m', 'o', 'o', 'f');
+constexpr const uint32_t kMoov = Mp4BoxType('m', 'o', 'o', 'v');
+constexpr const uint32_t kMvex = Mp4BoxType('m', 'v', 'e', 'x');
+constexpr const uint32_t kMvhd = Mp4BoxType('m', 'v', 'h', 'd');
+constexpr const uint32_t kPssh = Mp4BoxType('p', 's', 's', 'h');
+constexpr const uint32_t kSaio = Mp4BoxType('s', 'a', 'i', 'o');
+constexpr const uint32_t kSaiz = Mp4BoxType('s', 'a', 'i', 'z');
+constexpr const uint32_t kSbgp = Mp4BoxType('s', 'b', 'g', 'p');
+constexpr const uint32_t kSchi = Mp4BoxType('s', 'c', 'h', 'i');
+constexpr const uint32_t kSchm = Mp4BoxType('s', 'c', 'h', 'm');
+constexpr const uint32_t kSeig = Mp4BoxType('s', 'e', 'i', 'g');
+constexpr const uint32_t kSenc = Mp4BoxType('s', 'e', 'n', 'c');
+constexpr const uint32_t kSgpd = Mp4BoxType('s', 'g', 'p', 'd');
+constexpr const uint32_t kSinf = Mp4BoxType('s', 'i', 'n', 'f');
+constexpr const uint32_t kSoun = Mp4BoxType('s', 'o', 'u', 'n');
+constexpr const uint32_t kStbl = Mp4BoxType('s', 't', 'b', 'l');
+constexpr const uint32_t kStsd = Mp4BoxType('s', 't', 's', 'd');
+constexpr const uint32_t kTenc = Mp4BoxType('t', 'e', 'n', 'c');
+constexpr const uint32_t kTfdt = Mp4BoxType('t', 'f', 'd', 't');
+constexpr const uint32_t kTfhd = Mp4BoxType('t', 'f', 'h', 'd');
+constexpr const uint32_t kTkhd = Mp4BoxType('t', 'k', 'h', 'd');
+constexpr const uint32_t kTraf = Mp4BoxType('t', 'r', 'a', 'f');
+constexpr const uint32_t kTrak = Mp4BoxType('t', 'r', 'a', 'k');
+constexpr const uint32_t kTrex = Mp4BoxType('t', 'r', 'e', 'x');
+constexpr const uint32_t kTrun = Mp4BoxType('t', 'r', 'u', 'n');
+constexpr const uint32_t kUuid = Mp4BoxType('u', 'u', 'i', 'd');
+constexpr const uint32_t kVide = Mp4BoxType('v', 'i', 'd', 'e');
+
+constexpr const uint32_t kCencScheme = Mp4BoxType('c', 'e', 'n', 'c');
+constexpr const uint32_t kCensScheme = Mp4BoxType('c', 'e', 'n', 's');
+constexpr const uint32_t kCbc1Scheme = Mp4BoxType('c', 'b', 'c', '1');
+constexpr const uint32_t kCbcsScheme = Mp4BoxType('c', 'b', 'c', 's');
+
+// 'tfhd' flags.
+constexpr const uint32_t kTfhdBaseDataOffset = 0x1;
+constexpr const uint32_t kTfhdSampleDescriptionIndex = 0x2;
+constexpr const uint32_t kTfhdDefaultDuration = 0x8;
+constexpr const uint32_t kTfhdDefaultSize = 0x10;
+constexpr const uint32_t kTfhdDefaultFlags = 0x20;
+
+// 'trun' flags.
+constexpr const uint32_t kTrunDataOffset = 0x1;
+constexpr const uint32_t kTrunFirstSampleFlags = 0x4;
+constexpr const uint32_t kTrunDuration = 0x100;
+constexpr const uint32_t kTrunSize = 0x200;
+constexpr const uint32_t kTrunFlags = 0x400;
+constexpr const uint32_t kTrunCompositionOffset = 0x800;
+
+// Sample flags.
+constexpr const uint32_t kSampleDependsOnOthers = 0x01000000;
+constexpr const uint32_t kSampleIsNonSync = 0x00010000;
+
+constexpr const uint32_t kSencUseSubsamples = 0x2;
+constexpr const uint32_t kAuxInfoTypePresent = 0x1;
+
+/** The size of the fields of a VisualSampleEntry before the child boxes. */
+constexpr const size_t kVisualSampleEntrySize = 78;
+/** The size of the fields of a v0 AudioSampleEntry before the child boxes. */
+constexpr const size_t kAudioSampleEntrySize = 28;
+
+/** The maximum number of samples we accept in a single 'trun' box. */
+constexpr const uint32_t kMaxSampleCount = 1 << 20;
+
+void ReadFullBoxHeader(util::BufferReader* reader, uint8_t* version,
+                       uint32_t* flags) {
+  const uint32_t temp = reader->ReadUint32();
+  *version = static_cast<uint8_t>(temp >> 24);
+  *flags = temp & 0xffffff;
+}
+
+/**
+ * Reads the next child box from the given reader.  This sets |body| to read
+ * the body of the child box and moves |reader| past the box.
+ */
+bool ReadChildBox(util::BufferReader* reader, Mp4BoxHeader* header,
+                  util::BufferReader* body) {
+  if (!Mp4Parser::ReadBoxHeader(reader, header))
+    return false;
+  const uint64_t body_size = header->box_size - header->header_size;
+  if (body_size > reader->BytesRemaining())
+    return false;
+  body->SetBuffer(reader->data(), body_size);
+  reader->Skip(body_size);
+  return true;
+}
+
+/** Reads the IV and subsamples for a single sample. */
+bool ReadSampleEncryption(util::BufferReader* reader, size_t iv_size,
+                          const std::vector<uint8_t>& constant_iv,
+                          bool has_subsamples, Mp4Sample* sample) {
+  sample->is_encrypted = true;
+  if (iv_size > 0) {
+    if (reader->BytesRemaining() < iv_size)
+      return false;
+    sample->iv.resize(iv_size);
+    reader->Read(sample->iv.data(), iv_size);
+  } else {
+    sample->iv = constant_iv;
+  }
+
+  if (has_subsamples) {
+    if (reader->BytesRemaining() < 2)
+      return false;
+    const uint16_t count = reader->ReadUint16();
+    if (reader->BytesRemaining() < count * 6u)
+      return false;
+    sample->subsamples.resize(count);
+    for (auto& subsample : sample->subsamples) {
+      subsample.clear_bytes = reader->ReadUint16();
+      subsample.protected_bytes = reader->ReadUint32();
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+struct Mp4Parser::TrackFragment {
+  uint32_t default_duration = 0;
+  uint32_t default_size = 0;
+  uint32_t default_flags = 0;
+  bool has_tfhd = false;
+
+  int64_t decode_time = 0;
+  /** The offset, relative to the 'moof', of the data for the next 'trun'. */
+  uint64_t next_data_offset = 0;
+  std::vector<Mp4Sample> samples;
+
+  /** The body of the 'senc' box, if present. */
+  const uint8_t* senc = nullptr;
+  size_t senc_size = 0;
+
+  bool has_saiz = false;
+  uint8_t default_aux_size = 0;
+  uint32_t aux_count = 0;
+  std::vector<uint8_t> aux_sizes;
+  bool has_saio = false;
+  uint64_t aux_offset = 0;
+};
+
+Mp4Parser::Mp4Parser()
+    : has_mvex_(false),
+      track_id_(0),
+      track_count_(0),
+      handler_type_(0),
+      movie_timescale_(0),
+      timescale_(0),
+      empty_duration_(0),
+      edit_start_time_(0),
+      time_offset_(0),
+      next_decode_time_(0),
+      default_sample_duration_(0),
+      default_sample_size_(0),
+      default_sample_flags_(0),
+      is_protected_(false),
+      scheme_(0),
+      crypt_byte_block_(0),
+      skip_byte_block_(0),
+      per_sample_iv_size_(0) {}
+
+Mp4Parser::~Mp4Parser() {}
+
+// static
+bool Mp4Parser::ReadBoxHeader(util::BufferReader* reader,
+                              Mp4BoxHeader* header) {
+  if (reader->BytesRemaining() < 8)
+    return false;
+
+  uint64_t size = reader->ReadUint32();
+  header->type = reader->ReadUint32();
+  header->header_size = 8;
+  if (size == 1) {
+    if (reader->BytesRemaining() < 8)
+      return false;
+    size = reader->ReadUint64();
+    header->header_size += 8;
+  } else if (size == 0) {
+    // The box extends to the end of the data.
+    size = reader->BytesRemaining() + header->header_size;
+  }
+  if (header->type == kUuid) {
+    if (reader->BytesRemaining() < 16)
+      return false;
+    reader->Skip(16);
+    header->header_size += 16;
+  }
+
+  if (size < header->header_size)
+    return false;
+  header->box_size = size;
+  return true;
+}
+
+bool Mp4Parser::ParseInitSegment(const uint8_t* data, size_t size) {
+  has_mvex_ = false;
+  track_count_ = 0;
+  handler_type_ = 0;
+  timescale_ = 0;
+  empty_duration_ = 0;
+  edit_start_time_ = 0;
+  next_decode_time_ = 0;
+  default_sample_duration_ = default_sample_size_ = default_sample_flags_ = 0;
+  is_protected_ = false;
+  scheme_ = 0;
+  crypt_byte_block_ = skip_byte_block_ = per_sample_iv_size_ = 0;
+  key_id_.clear();
+  constant_iv_.clear();
+
+  util::BufferReader reader(data, size);
+  Mp4BoxHeader header;
+  util::BufferReader body;
+  if (!ReadChildBox(&reader, &header, &body) || header.type != kMoov)
+    return false;
+  if (!ParseMoov(&body))
+    return false;
+
+  if (!has_mvex_) {
+    VLOG(1) << "Content isn't fragmented";
+    return false;
+  }
+  if (track_count_ != 1) {
+    VLOG(1) << "Content contains " << track_count_ << " tracks";
+    return false;
+  }
+  if (timescale_ == 0)
+    return false;
+
+  // This mirrors how libavformat applies a single edit, so the timestamps match
+  // what it would produce.
+  time_offset_ = edit_start_time_;
+  if (empty_duration_ && movie_timescale_) {
+    time_offset_ -= static_cast<int64_t>(empty_duration_ * timescale_ /
+                                         movie_timescale_);
+  }
+  return true;
+}
+
+bool Mp4Parser::ParseFragment(const uint8_t* data, size_t size,
+                              std::vector<Mp4Sample>* samples,
+                              std::vector<uint8_t>* pssh) {
+  samples->clear();
+  pssh->clear();
+  DCHECK_NE(timescale_, 0u) << "Must parse an init segment first";
+
+  util::BufferReader reader(data, size);
+  Mp4BoxHeader header;
+  util::BufferReader moof;
+  if (!ReadChildBox(&reader, &header, &moof) || header.type != kMoof)
+    return false;
+
+  TrackFragment traf;
+  bool found_traf = false;
+  while (!moof.empty()) {
+    const uint8_t* box_start = moof.data();
+    util::BufferReader body;
+    if (!ReadChildBox(&moof, &header, &body))
+      return false;
+
+    if (header.type == kTraf) {
+      if (found_traf) {
+        VLOG(1) << "Multiple track fragments aren't supported";
+        return false;
+      }
+      found_traf = true;
+      traf.decode_time = next_decode_time_;
+      if (!ParseTraf(&body, &traf))
+        return false;
+    } else if (header.type == kPssh) {
+      pssh->insert(pssh->end(), box_start, box_start + header.box_size);
+    }
+  }
+  if (!found_traf)
+    return false;
+
+  if (is_protected_) {
+    if (traf.senc) {
+      util::BufferReader senc(traf.senc, traf.senc_size);
+      if (!ParseSampleEncryption(&senc, &traf.samples))
+        return false;
+    } else if (!ParseAuxInfo(data, size, traf, &traf.samples)) {
+      return false;
+    }
+  }
+
+  next_decode_time_ = traf.decode_time;
+  samples->swap(traf.samples);
+  return true;
+}
+
+bool Mp4Parser::ParseMoov(util::BufferReader* reader) {
+  while (!reader->empty()) {
+    Mp4BoxHeader header;
+    util::BufferReader body;
+    if (!ReadChildBox(reader, &header, &body))
+      return false;
+
+    uint8_t version;
+    uint32_t flags;
+    switch (header.type) {
+      case kMvhd:
+        ReadFullBoxHeader(&body, &version, &flags);
+        body.Skip(version == 1 ? 16 : 8);  // creation/modification time.
+        movie_timescale_ = body.ReadUint32();
+        break;
+      case kTrak:
+        track_count_++;
+        if (!ParseTrak(&body))
+          return false;
+        break;
+      case kMvex:
+        has_mvex_ = true;
+        while (!body.empty()) {
+          util::BufferReader child;
+          if (!ReadChildBox(&body, &header, &child))
+            return false;
+          if (header.type == kTrex) {
+            ReadFullBoxHeader(&child, &version, &flags);
+            child.Skip(8);  // track_ID, default_sample_description_index.
+            default_sample_duration_ = child.ReadUint32();
+            default_sample_size_ = child.ReadUint32();
+            default_sample_flags_ = child.ReadUint32();
+          }
+        }
+        break;
+    }
+  }
+  return true;
+}
+
+bool Mp4Parser::ParseTrak(util::BufferReader* reader) {
+  while (!reader->empty()) {
+    Mp4BoxHeader header;
+    util::BufferReader body;
+    if (!ReadChildBox(reader, &header, &body))
+      return false;
+
+    uint8_t version;
+    uint32_t flags;
+    switch (header.type) {
+      case kTkhd:
+        ReadFullBoxHeader(&body, &version, &flags);
+        body.Skip(version == 1 ? 16 : 8);  // creation/modification time.
+        track_id_ = body.ReadUint32();
+        break;
+      case kEdts:
+        while (!body.empty()) {
+          util::BufferReader child;
+          if (!ReadChildBox(&body, &header, &child))
+            return false;
+          if (header.type == kElst && !ParseElst(&child))
+            return false;
+        }
+        break;
+      case kMdia:
+        if (!ParseMdia(&body))
+          return false;
+        break;
+    }
+  }
+  return true;
+}
+
+bool Mp4Parser::ParseMdia(util::BufferReader* reader) {
+  while (!reader->empty()) {
+    Mp4BoxHeader header;
+    util::BufferReader body;
+    if (!ReadChildBox(reader, &header, &body))
+      return false;
+
+    uint8_t version;
+    uint32_t flags;
+    switch (header.type) {
+      case kMdhd:
+        ReadFullBoxHeader(&body, &version, &flags);
+        body.Skip(version == 1 ? 16 : 8);  // creation/modification time.
+        timescale_ = body.ReadUint32();
+        break;
+      case kHdlr:
+        ReadFullBoxHeader(&body, &version, &flags);
+        body.Skip(4);  // pre_defined
+        handler_type_ = body.ReadUint32();
+        break;
+      case kMinf:
+        while (!body.empty()) {
+          util::BufferReader child;
+          if (!ReadChildBox(&body, &header, &child))
+            return false;
+          if (header.type == kStbl && !ParseStbl(&child))
+            return false;
+        }
+        break;
+    }
+  }
+  return true;
+}
+
+bool Mp4Parser::ParseStbl(util::BufferReader* reader) {
+  while (!reader->empty()) {
+    Mp4BoxHeader header;
+    util::BufferReader body;
+    if (!ReadChildBox(reader, &header, &body))
+      return false;
+
+    if (header.type == kStsd) {
+      uint8_t version;
+      uint32_t flags;
+      ReadFullBoxHeader(&body, &version, &flags);
+      if (body.ReadUint32() != 1) {
+        VLOG(1) << "Multiple sample descriptions aren't supported";
+        return false;
+      }
+
+      util::BufferReader entry;
+      if (!ReadChildBox(&body, &header, &entry))
+        return false;
+      if (!ParseSampleEntry(&entry, header.type))
+        return false;
+    }
+  }
+  return true;
+}
+
+bool Mp4Parser::ParseSampleEntry(util::BufferReader* reader, uint32_t type) {
+  if (type != kEncv && type != kEnca)
+    return true;
+
+  if (handler_type_ == kVide) {
+    if (reader->Skip(kVisualSampleEntrySize) != kVisualSampleEntrySize)
+      return false;
+  } else if (handler_type_ == kSoun) {
+    // QuickTime sound descriptions have extra fields based on the version.
+    reader->Skip(8);  // reserved, data_reference_index
+    const uint16_t version = reader->ReadUint16();
+    size_t remaining = kAudioSampleEntrySize - 10;
+    if (version == 1)
+      remaining += 16;
+    else if (version == 2)
+      remaining += 36;
+    if (reader->Skip(remaining) != remaining)
+      return false;
+  } else {
+    return false;
+  }
+
+  while (!reader->empty()) {
+    Mp4BoxHeader header;
+    util::BufferReader body;
+    if (!ReadChildBox(reader, &header, &body))
+      return false;
+    if (header.type == kSinf)
+      return ParseSinf(&body);
+  }
+  return false;
+}
+
+bool Mp4Parser::ParseSinf(util::BufferReader* reader) {
+  while (!reader->empty()) {
+    Mp4BoxHeader header;
+    util::BufferReader body;
+    if (!ReadChildBox(reader, &header, &body))
+      return false;
+
+    uint8_t version;
+    uint32_t flags;
+    if (header.type == kSchm) {
+      ReadFullBoxHeader(&body, &version, &flags);
+      scheme_ = body.ReadUint32();
+    } else if (header.type == kSchi) {
+      while (!body.empty()) {
+        util::BufferReader tenc;
+        if (!ReadChildBox(&body, &header, &tenc))
+          return false;
+        if (header.type != kTenc)
+          continue;
+
+        ReadFullBoxHeader(&tenc, &version, &flags);
+        tenc.Skip(1);  // reserved
+        const uint8_t pattern = tenc.ReadUint8();
+        if (version > 0) {
+          crypt_byte_block_ = pattern >> 4;
+          skip_byte_block_ = pattern & 0xf;
+        }
+        is_protected_ = tenc.ReadUint8() != 0;
+        per_sample_iv_size_ = tenc.ReadUint8();
+        key_id_.resize(16);
+        if (tenc.Read(key_id_.data(), key_id_.size()) != key_id_.size())
+          return false;
+        if (is_protected_ && per_sample_iv_size_ == 0) {
+          constant_iv_.resize(tenc.ReadUint8());
+          if (tenc.Read(constant_iv_.data(), constant_iv_.size()) !=
+              constant_iv_.size()) {
+            return false;
+          }
+        }
+      }
+    }
+  }
+
+  switch (scheme_) {
+    case kCencScheme:
+    case kCensScheme:
+    case kCbc1Scheme:
+    case kCbcsScheme:
+      return true;
+    default:
+      VLOG(1) << "Unsupported encryption scheme 0x" << std::hex << scheme_;
+      return false;
+  }
+}
+
+bool Mp4Parser::ParseElst(util::BufferReader* reader) {
+  uint8_t version;
+  uint32_t flags;
+  ReadFullBoxHeader(reader, &version, &flags);
+  const uint32_t count = reader->ReadUint32();
+
+  size_t edit_start_index = 0;
+  for (uint32_t i = 0; i < count; i++) {
+    uint64_t duration;
+    int64_t media_time;
+    if (version == 1) {
+      duration = reader->ReadUint64();
+      media_time = static_cast<int64_t>(reader->ReadUint64());
+    } else {
+      duration = reader->ReadUint32();
+      media_time = static_cast<int32_t>(reader->ReadUint32());
+    }
+    reader->Skip(4);  // media_rate
+
+    if (i == 0 && media_time == -1) {
+      empty_duration_ = duration;
+      edit_start_index = 1;
+    } else if (i == edit_start_index && media_time >= 0) {
+      edit_start_time_ = media_time;
+    } else {
+      VLOG(1) << "Complex edit lists aren't supported";
+      return false;
+    }
+  }
+  return true;
+}
+
+bool Mp4Parser::ParseTraf(util::BufferReader* reader, TrackFragment* traf) {
+  while (!reader->empty()) {
+    Mp4BoxHeader header;
+    util::BufferReader body;
+    if (!ReadChildBox(reader, &header, &body))
+      return false;
+
+    uint8_t version;
+    uint32_t flags;
+    switch (header.type) {
+      case kTfhd:
+        ReadFullBoxHeader(&body, &version, &flags);
+        if (body.ReadUint32() != track_id_)
+          return false;
+        if (flags & kTfhdBaseDataOffset) {
+          // This is relative to the start of the file, which we don't track.
+          VLOG(1) << "Explicit base data offsets aren't supported";
+          return false;
+        }
+        if (flags & kTfhdSampleDescriptionIndex)
+          body.Skip(4);
+        traf->default_duration = flags & kTfhdDefaultDuration
+                                     ? body.ReadUint32()
+                                     : default_sample_duration_;
+        traf->default_size = flags & kTfhdDefaultSize ? body.ReadUint32()
+                                                      : default_sample_size_;
+        traf->default_flags = flags & kTfhdDefaultFlags
+                                  ? body.ReadUint32()
+                                  : default_sample_flags_;
+        traf->has_tfhd = true;
+        break;
+      case kTfdt:
+        ReadFullBoxHeader(&body, &version, &flags);
+        traf->decode_time = version == 1
+                                ? static_cast<int64_t>(body.ReadUint64())
+                                : body.ReadUint32();
+        break;
+      case kTrun:
+        if (!traf->has_tfhd || !ParseTrun(&body, traf))
+          return false;
+        break;
+      case kSenc:
+        traf->senc = body.data();
+        traf->senc_size = body.BytesRemaining();
+        break;
+      case kSaiz:
+        ReadFullBoxHeader(&body, &version, &flags);
+        if (flags & kAuxInfoTypePresent)
+          body.Skip(8);
+        traf->default_aux_size = body.ReadUint8();
+        traf->aux_count = body.ReadUint32();
+        if (traf->default_aux_size == 0) {
+          traf->aux_sizes.resize(traf->aux_count);
+          if (body.Read(traf->aux_sizes.data(), traf->aux_count) !=
+              traf->aux_count) {
+            return false;
+          }
+        }
+        traf->has_saiz = true;
+        break;
+      case kSaio:
+        ReadFullBoxHeader(&body, &version, &flags);
+        if (flags & kAuxInfoTypePresent)
+          body.Skip(8);
+        if (body.ReadUint32() != 1)
+          return false;
+        traf->aux_offset = version == 1 ? body.ReadUint64() : body.ReadUint32();
+        traf->has_saio = true;
+        break;
+      case kSbgp:
+      case kSgpd:
+        ReadFullBoxHeader(&body, &version, &flags);
+        if (body.ReadUint32() == kSeig) {
+          VLOG(1) << "Sample-group encryption info isn't supported";
+          return false;
+        }
+        break;
+    }
+  }
+  return true;
+}
+
+bool Mp4Parser::ParseTrun(util::BufferReader* reader, TrackFragment* traf) {
+  uint8_t version;
+  uint32_t flags;
+  ReadFullBoxHeader(reader, &version, &flags);
+  const uint32_t sample_count = reader->ReadUint32();
+  if (sample_count > kMaxSampleCount)
+    return false;
+
+  uint64_t data_offset = traf->next_data_offset;
+  if (flags & kTrunDataOffset) {
+    const int32_t offset = static_cast<int32_t>(reader->ReadUint32());
+    if (offset < 0)
+      return false;
+    data_offset = static_cast<uint64_t>(offset);
+  }
+  const bool has_first_flags = flags & kTrunFirstSampleFlags;
+  const uint32_t first_flags = has_first_flags ? reader->ReadUint32() : 0;
+
+  size_t field_size = 0;
+  for (uint32_t flag : {kTrunDuration, kTrunSize, kTrunFlags,
+                        kTrunCompositionOffset}) {
+    if (flags & flag)
+      field_size += 4;
+  }
+  if (reader->BytesRemaining() < field_size * sample_count)
+    return false;
+
+  for (uint32_t i = 0; i < sample_count; i++) {
+    Mp4Sample sample;
+    sample.duration =
+        flags & kTrunDuration ? reader->ReadUint32() : traf->default_duration;
+    sample.size = flags & kTrunSize ? reader->ReadUint32() : traf->default_size;
+    uint32_t sample_flags = traf->default_flags;
+    if (flags & kTrunFlags)
+      sample_flags = reader->ReadUint32();
+    else if (i == 0 && has_first_flags)
+      sample_flags = first_flags;
+    const int32_t composition_offset =
+        flags & kTrunCompositionOffset
+            ? static_cast<int32_t>(reader->ReadUint32())
+            : 0;
+
+    sample.offset = data_offset;
+    sample.dts = traf->decode_time - time_offset_;
+    sample.pts = sample.dts + composition_offset;
+    sample.is_key_frame =
+        handler_type_ == kSoun ||
+        !(sample_flags & (kSampleIsNonSync | kSampleDependsOnOthers));
+    traf->samples.push_back(std::move(sample));
+
+    traf->decode_time += traf->samples.back().duration;
+    data_offset += traf->samples.back().size;
+  }
+  traf->next_data_offset = data_offset;
+  return true;
+}
+
+bool Mp4Parser::ParseSampleEncryption(util::BufferReader* reader,
+                                      std::vector<Mp4Sample>* samples) const {
+  uint8_t version;
+  uint32_t flags;
+  ReadFullBoxHeader(reader, &version, &flags);
+  if (reader->ReadUint32() != samples->size())
+    return false;
+
+  for (Mp4Sample& sample : *samples) {
+    if (!ReadSampleEncryption(reader, per_sample_iv_size_, constant_iv_,
+                              flags & kSencUseSubsamples, &sample)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool Mp4Parser::ParseAuxInfo(const uint8_t* moof, size_t moof_size,
+                             const TrackFragment& traf,
+                             std::vector<Mp4Sample>* samples) const {
+  // The aux info can also be stored in the 'mdat', but that is rare; let
+  // libavformat handle that case.
+  if (!traf.has_saiz || !traf.has_saio || traf.aux_count != samples->size() ||
+      traf.aux_offset > moof_size) {
+    return false;
+  }
+
+  util::BufferReader reader(moof + traf.aux_offset,
+                            moof_size - traf.aux_offset);
+  for (size_t i = 0; i < samples->size(); i++) {
+    const size_t aux_size =
+        traf.default_aux_size ? traf.default_aux_size : traf.aux_sizes[i];
+    if (reader.BytesRemaining() < aux_size)
+      return false;
+
+    util::BufferReader sample_reader(reader.data(), aux_size);
+    reader.Skip(aux_size);
+    const bool has_subsamples = aux_size > per_sample_iv_size_;
+    if (!ReadSampleEncryption(&sample_reader, per_sample_iv_size_,
+                              constant_iv_, has_subsamples, &samples->at(i))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace media
+}  // namespace shaka
@@ -0,0 +1,186 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SHAKA_EMBEDDED_MEDIA_MP4_PARSER_H_
+#define SHAKA_EMBEDDED_MEDIA_MP4_PARSER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "src/util/buffer_reader.h"
+#include "src/util/macros.h"
+
+namespace shaka {
+namespace media {
+
+/** Creates a box type from the given four characters. */
+constexpr uint32_t Mp4BoxType(char a, char b, char c, char d) {
+  return (static_cast<uint32_t>(static_cast<uint8_t>(a)) << 24) |
+         (static_cast<uint32_t>(static_cast<uint8_t>(b)) << 16) |
+         (static_cast<uint32_t>(static_cast<uint8_t>(c)) << 8) |
+         static_cast<uint32_t>(static_cast<uint8_t>(d));
+}
+
+/** Defines the header of an MP4 box. */
+struct Mp4BoxHeader {
+  uint32_t type = 0;
+  /** The size of the header, in bytes. */
+  size_t header_size = 0;
+  /** The size of the whole box, including the header. */
+  uint64_t box_size = 0;
+};
+
+/** Defines a single subsample of an encrypted sample. */
+struct Mp4Subsample {
+  uint32_t clear_bytes;
+  uint32_t protected_bytes;
+};
+
+/** Defines a single sample parsed from a 'moof' box. */
+struct Mp4Sample {
+  /** The offset of the sample data, relative to the start of the 'moof' box. */
+  uint64_t offset = 0;
+  uint32_t size = 0;
+  /** The timestamps, in the track timescale. */
+  int64_t dts = 0;
+  int64_t pts = 0;
+  uint32_t duration = 0;
+  bool is_key_frame = false;
+
+  bool is_encrypted = false;
+  std::vector<uint8_t> iv;
+  std::vector<Mp4Subsample> subsamples;
+};
+
+/**
+ * A lightweight parser for fragmented MP4 (e.g. CMAF) content.  This only
+ * handles the common case of a single track with its fragments stored as
+ * 'moof'/'mdat' pairs; for anything else, the methods return false and the
+ * content should be handled by libavformat.
+ *
+ * This doesn't parse the codec configuration; this only handles the sample
+ * tables and the encryption info.  This type is not thread safe.
+ */
+class Mp4Parser {
+ public:
+  Mp4Parser();
+  ~Mp4Parser();
+
+  NON_COPYABLE_OR_MOVABLE_TYPE(Mp4Parser);
+
+  /**
+   * Reads a box header from the given reader.  On success, the reader is
+   * positioned at the start of the box body.
+   * @return True on success, false if there isn't enough data.
+   */
+  static bool ReadBoxHeader(util::BufferReader* reader, Mp4BoxHeader* header);
+
+  /**
+   * Parses the given 'moov' box (including the box header).  This replaces any
+   * track info from previous init segments.
+   *
+   * @return True on success; false if the content isn't fragmented or has a
+   *   feature this parser doesn't support.
+   */
+  bool ParseInitSegment(const uint8_t* data, size_t size);
+
+  /**
+   * Parses the given 'moof' box (including the box header).  This must be
+   * called after ParseInitSegment.
+   *
+   * @param data The bytes of the 'moof' box.
+   * @param size The number of bytes in |data|.
+   * @param samples [OUT] Will contain the samples in the fragment.
+   * @param pssh [OUT] Will contain any 'pssh' boxes in the fragment.
+   * @return True on success; false if there was an error or the fragment uses
+   *   a feature this parser doesn't support.
+   */
+  bool ParseFragment(const uint8_t* data, size_t size,
+                     std::vector<Mp4Sample>* samples,
+                     std::vector<uint8_t>* pssh);
+
+  uint32_t timescale() const {
+    return timescale_;
+  }
+  bool is_encrypted() const {
+    return is_protected_;
+  }
+  /** The encryption scheme (e.g. 'cenc') as a four-character code. */
+  uint32_t scheme() const {
+    return scheme_;
+  }
+  uint8_t crypt_byte_block() const {
+    return crypt_byte_block_;
+  }
+  uint8_t skip_byte_block() const {
+    return skip_byte_block_;
+  }
+  const std::vector<uint8_t>& key_id() const {
+    return key_id_;
+  }
+
+ private:
+  struct TrackFragment;
+
+  bool ParseMoov(util::BufferReader* reader);
+  bool ParseTrak(util::BufferReader* reader);
+  bool ParseMdia(util::BufferReader* reader);
+  bool ParseStbl(util::BufferReader* reader);
+  bool ParseSampleEntry(util::BufferReader* reader, uint32_t type);
+  bool ParseSinf(util::BufferReader* reader);
+  bool ParseElst(util::BufferReader* reader);
+
+  bool ParseTraf(util::BufferReader* reader, TrackFragment* traf);
+  bool ParseTrun(util::BufferReader* reader, TrackFragment* traf);
+  bool ParseSampleEncryption(util::BufferReader* reader,
+                             std::vector<Mp4Sample>* samples) const;
+  bool ParseAuxInfo(const uint8_t* moof, size_t moof_size,
+                    const TrackFragment& traf,
+                    std::vector<Mp4Sample>* samples) const;
+
+  // Init segment info.
+  bool has_mvex_;
+  uint32_t track_id_;
+  uint32_t track_count_;
+  uint32_t handler_type_;
+  uint32_t movie_timescale_;
+  uint32_t timescale_;
+  /** The empty edit duration, in the movie timescale. */
+  uint64_t empty_duration_;
+  /** The media time of the first non-empty edit, in the track timescale. */
+  int64_t edit_start_time_;
+  /** The offset, in the track timescale, applied by the edit list. */
+  int64_t time_offset_;
+  /** The decode time to use when a fragment doesn't have a 'tfdt' box. */
+  int64_t next_decode_time_;
+  uint32_t default_sample_duration_;
+  uint32_t default_sample_size_;
+  uint32_t default_sample_flags_;
+
+  // Encryption info.
+  bool is_protected_;
+  uint32_t scheme_;
+  uint8_t crypt_byte_block_;
+  uint8_t skip_byte_block_;
+  uint8_t per_sample_iv_size_;
+  std::vector<uint8_t> key_id_;
+  std::vector<uint8_t> constant_iv_;
+};
+
+}  // namespace media
+}  // namespace shaka
+
+#endif  // SHAKA_EMBEDDED_MEDIA_MP4_PARSER_H_
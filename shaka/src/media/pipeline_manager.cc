@@ -23,6 +23,15 @@
 namespace shaka {
 namespace media {
 
+double PipelineTimeline::GetTimeFor(uint64_t wall_time) const {
+  if (status != PipelineStatus::Playing)
+    return media_time;
+
+  const uint64_t wall_diff = wall_time - this->wall_time;
+  const double time = media_time + (wall_diff * playback_rate / 1000.0);
+  return std::isnan(duration) ? time : std::min(duration, time);
+}
+
 PipelineManager::PipelineManager(
     std::function<void(PipelineStatus)> on_status_changed,
     std::function<void()> on_seek, const util::Clock* clock)
@@ -35,7 +44,9 @@ PipelineManager::PipelineManager(
       prev_wall_time_(clock->GetMonotonicTime()),
       playback_rate_(1),
       duration_(NAN),
-      autoplay_(false) {}
+      autoplay_(false) {
+  PublishTimeline();
+}
 
 PipelineManager::~PipelineManager() {}
 
@@ -51,6 +62,7 @@ void PipelineManager::DoneInitializing() {
     } else {
       new_status = status_ = PipelineStatus::Paused;
     }
+    PublishTimeline();
   }
   on_status_changed_(new_status);
 }
@@ -89,6 +101,7 @@ void PipelineManager::SetDuration(double duration) {
         new_status = status_ = PipelineStatus::SeekingPause;
       }
     }
+    PublishTimeline();
   }
   if (new_status != PipelineStatus::Initializing)
     on_status_changed_(new_status);
@@ -127,6 +140,7 @@ void PipelineManager::SetCurrentTime(double time) {
         default:  // Ignore remaining enum values.
           break;
       }
+      PublishTimeline();
     }
   }
   if (new_status != PipelineStatus::Initializing)
@@ -142,6 +156,7 @@ void PipelineManager::SetPlaybackRate(double rate) {
   std::unique_lock<SharedMutex> lock(mutex_);
   SyncPoint();
   playback_rate_ = rate;
+  PublishTimeline();
 }
 
 void PipelineManager::Play() {
@@ -165,6 +180,7 @@ void PipelineManager::Play() {
     } else if (status_ == PipelineStatus::Initializing) {
       autoplay_ = true;
     }
+    PublishTimeline();
   }
   if (new_status != PipelineStatus::Initializing)
     on_status_changed_(new_status);
@@ -183,6 +199,7 @@ void PipelineManager::Pause() {
     } else if (status_ == PipelineStatus::Initializing) {
       autoplay_ = false;
     }
+    PublishTimeline();
   }
   if (new_status != PipelineStatus::Initializing)
     on_status_changed_(new_status);
@@ -196,6 +213,7 @@ void PipelineManager::Stalled() {
       SyncPoint();
       status_ = PipelineStatus::Stalled;
       status_changed = true;
+      PublishTimeline();
     }
   }
   if (status_changed)
@@ -213,6 +231,7 @@ void PipelineManager::CanPlay() {
     } else if (status_ == PipelineStatus::SeekingPause) {
       new_status = status_ = PipelineStatus::Paused;
     }
+    PublishTimeline();
   }
   if (new_status != PipelineStatus::Initializing)
     on_status_changed_(new_status);
@@ -229,6 +248,7 @@ void PipelineManager::OnEnded() {
       prev_wall_time_ = wall_time;
       prev_media_time_ = duration_;
       new_status = status_ = PipelineStatus::Ended;
+      PublishTimeline();
     }
   }
   if (new_status != PipelineStatus::Initializing)
@@ -243,19 +263,29 @@ void PipelineManager::OnError() {
       SyncPoint();
       status_ = PipelineStatus::Errored;
       fire_event = true;
+      PublishTimeline();
     }
   }
   if (fire_event)
     on_status_changed_(PipelineStatus::Errored);
 }
 
+PipelineTimeline PipelineManager::MakeTimeline() const {
+  PipelineTimeline ret;
+  ret.status = status_;
+  ret.media_time = prev_media_time_;
+  ret.wall_time = prev_wall_time_;
+  ret.playback_rate = playback_rate_;
+  ret.duration = duration_;
+  return ret;
+}
+
 double PipelineManager::GetTimeFor(uint64_t wall_time) const {
-  if (status_ != PipelineStatus::Playing)
-    return prev_media_time_;
+  return MakeTimeline().GetTimeFor(wall_time);
+}
 
-  const uint64_t wall_diff = wall_time - prev_wall_time_;
-  const double time = prev_media_time_ + (wall_diff * playback_rate_ / 1000.0);
-  return std::isnan(duration_) ? time : std::min(duration_, time);
+void PipelineManager::PublishTimeline() {
+  timeline_.Store(MakeTimeline());
 }
 
 void PipelineManager::SyncPoint() {
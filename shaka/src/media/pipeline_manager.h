@@ -21,10 +21,29 @@
 #include "src/debug/mutex.h"
 #include "src/media/types.h"
 #include "src/util/clock.h"
+#include "src/util/double_buffer.h"
 
 namespace shaka {
 namespace media {
 
+/**
+ * Holds the state used to calculate the current time.  A copy of this can be
+ * read from any thread without locking (see PipelineManager::GetTimeline), so
+ * the current time can be calculated without calling into the pipeline.
+ */
+struct PipelineTimeline {
+  PipelineStatus status;
+  /** The media time at the last sync point. */
+  double media_time;
+  /** The wall-clock time at the last sync point. */
+  uint64_t wall_time;
+  double playback_rate;
+  double duration;
+
+  /** @return The video time for the given wall-clock time. */
+  double GetTimeFor(uint64_t wall_time) const;
+};
+
 /**
  * Tracks the current playhead time and tracks the pipeline status.  This
  * handles playback rate, pause/play, and tracking current time.  The caller
@@ -90,10 +109,27 @@ class PipelineManager {
   /** Called when an error occurs and the pipeline should stop forever. */
   virtual void OnError();
 
+  /**
+   * @return A copy of the current timeline.  Unlike the other methods, this
+   *   doesn't lock, so it can be called often from any thread.
+   */
+  PipelineTimeline GetTimeline() const {
+    return timeline_.Load();
+  }
+
  private:
+  /** @return The current timeline; this must be called with the lock held. */
+  PipelineTimeline MakeTimeline() const;
+
   /** @return The video time for the given wall-clock time. */
   double GetTimeFor(uint64_t wall_time) const;
 
+  /**
+   * Stores the current timeline so it can be read by GetTimeline.  This must be
+   * called with the lock held after any changes.
+   */
+  void PublishTimeline();
+
   /**
    * Introduces a time sync point.  This avoids rounding errors by reducing the
    * number of times we change the stored current time.  What we do is store
@@ -118,6 +154,8 @@ class PipelineManager {
   double playback_rate_;
   double duration_;
   bool autoplay_;
+
+  util::DoubleBuffer<PipelineTimeline> timeline_;
 };
 
 }  // namespace media
@@ -19,14 +19,10 @@
 namespace shaka {
 namespace media {
 
-Stream::Stream()
-    : demuxed_frames_(/* order_by_dts */ true),
-      decoded_frames_(/* order_by_dts */ false) {}
-
-Stream::~Stream() {}
+namespace {
 
-double Stream::DecodedAheadOf(double time) const {
-  for (auto& range : decoded_frames_.GetBufferedRanges()) {
+double BufferedAheadOf(const BufferedRanges& ranges, double time) {
+  for (auto& range : ranges) {
     if (range.end > time) {
       if (range.start < time + FrameBuffer::kMaxGapSize) {
         return range.end - std::max(time, range.start);
@@ -39,5 +35,21 @@ double Stream::DecodedAheadOf(double time) const {
   return 0;
 }
 
+}  // namespace
+
+Stream::Stream()
+    : demuxed_frames_(/* order_by_dts */ true),
+      decoded_frames_(/* order_by_dts */ false) {}
+
+Stream::~Stream() {}
+
+double Stream::DecodedAheadOf(double time) const {
+  return BufferedAheadOf(decoded_frames_.GetBufferedRanges(), time);
+}
+
+double Stream::DemuxedAheadOf(double time) const {
+  return BufferedAheadOf(demuxed_frames_.GetBufferedRanges(), time);
+}
+
 }  // namespace media
 }  // namespace shaka
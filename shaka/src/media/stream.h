@@ -51,6 +51,9 @@ class Stream {
   /** @return The amount of time decoded ahead of the given time. */
   double DecodedAheadOf(double time) const;
 
+  /** @return The amount of time demuxed ahead of the given time. */
+  double DemuxedAheadOf(double time) const;
+
   /** @returns The buffered ranges for the Stream. */
   BufferedRanges GetBufferedRanges() const {
     return demuxed_frames_.GetBufferedRanges();
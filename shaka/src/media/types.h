@@ -139,6 +139,13 @@ DEFINE_ENUM_AND_TO_STRING(PipelineStatus, DEFINE_ENUM_);
 #undef DEFINE_ENUM_
 
 
+/**
+ * The maximum playback rate we play normally at.  Above this, audio is muted
+ * and video only shows key frames (trick play).
+ */
+constexpr const double kMaxPlaybackRate = 4;
+
+
 enum MediaReadyState {
   HAVE_NOTHING = 0,
   HAVE_METADATA = 1,
@@ -157,6 +164,14 @@ struct VideoPlaybackQuality : Struct {
   ADD_DICT_FIELD(uint64_t, totalVideoFrames);
   ADD_DICT_FIELD(uint64_t, droppedVideoFrames);
   ADD_DICT_FIELD(uint64_t, corruptedVideoFrames);
+
+  // Non-standard fields about how the decoder degraded to keep up with
+  // playback.  The level is a DecodeDegradation value.
+  ADD_DICT_FIELD(uint64_t, decodeDegradationLevel);
+  ADD_DICT_FIELD(uint64_t, skipLoopFilterFrames);
+  ADD_DICT_FIELD(uint64_t, skipNonReferenceFrames);
+  ADD_DICT_FIELD(uint64_t, keyFrameSkips);
+  ADD_DICT_FIELD(uint64_t, keyFrameSkippedFrames);
 };
 
 struct BufferedRange {
@@ -18,10 +18,12 @@
 
 #include <algorithm>
 #include <cmath>
+#include <thread>
 #include <utility>
 #include <vector>
 
 #include "src/core/js_manager_impl.h"
+#include "src/debug/trace_recorder.h"
 #include "src/media/audio_renderer.h"
 #include "src/media/media_utils.h"
 #include "src/media/video_renderer.h"
@@ -105,6 +107,9 @@ VideoController::VideoController(
     std::function<void(MediaReadyState)> on_ready_state_changed,
     std::function<void(PipelineStatus)> on_pipeline_changed)
     : mutex_("VideoController"),
+      metrics_audio_(nullptr),
+      metrics_video_(nullptr),
+      metrics_readers_(0),
       on_error_(std::move(on_error)),
       on_waiting_for_key_(std::move(on_waiting_for_key)),
       on_encrypted_init_data_(std::move(on_encrypted_init_data)),
@@ -121,6 +126,7 @@ VideoController::VideoController(
 }
 
 VideoController::~VideoController() {
+  UnpublishMetricsSources();
   util::shared_lock<SharedMutex> lock(mutex_);
   for (const auto& source : sources_) {
     source.second->demuxer.Stop();
@@ -138,6 +144,7 @@ void VideoController::SetVolume(double volume) {
 }
 
 Frame VideoController::DrawFrame(double* delay) {
+  ScopedTrace trace("VideoController::DrawFrame");
   std::unique_lock<SharedMutex> lock(mutex_);
   Source* source = GetSource(SourceType::Video);
   if (!source || !source->renderer)
@@ -151,6 +158,7 @@ Frame VideoController::DrawFrame(double* delay) {
   quality_info_.totalVideoFrames += dropped_frame_count;
   if (is_new_frame)
     quality_info_.totalVideoFrames++;
+  source->decoder.GetDegradationStats(&quality_info_);
 
 #ifndef NDEBUG
   static uint64_t last_print_time = 0;
@@ -169,6 +177,32 @@ Frame VideoController::DrawFrame(double* delay) {
   return ret;
 }
 
+void VideoController::GetPipelineMetrics(PipelineMetrics* metrics) const {
+  // This is polled by the app, so it doesn't take |mutex_|; Reset waits for
+  // |metrics_readers_| to drop to zero before destroying the sources.
+  metrics_readers_.fetch_add(1);
+  Source* audio = metrics_audio_.load();
+  if (audio) {
+    audio->demuxer.GetMetrics(&metrics->audio);
+    audio->decoder.GetMetrics(&metrics->audio);
+    if (audio->renderer) {
+      metrics->audio_underruns =
+          static_cast<AudioRenderer*>(audio->renderer.get())
+              ->GetUnderrunCount();
+    }
+  }
+  Source* video = metrics_video_.load();
+  if (video) {
+    video->demuxer.GetMetrics(&metrics->video);
+    video->decoder.GetMetrics(&metrics->video);
+    if (video->renderer) {
+      static_cast<VideoRenderer*>(video->renderer.get())
+          ->GetRenderLateness(&metrics->render_lateness);
+    }
+  }
+  metrics_readers_.fetch_sub(1);
+}
+
 void VideoController::SetCdm(eme::Implementation* cdm) {
   std::unique_lock<SharedMutex> lock(mutex_);
   cdm_ = cdm;
@@ -202,6 +236,12 @@ Status VideoController::AddSource(const std::string& mime_type,
       static_cast<AudioRenderer*>(source->renderer.get())->SetVolume(volume_);
   }
   source->decoder.SetCdm(cdm_);
+  source->decoder.SetAllowTrickPlay(*source_type == SourceType::Video);
+  source->decoder.SetAllowDegradation(*source_type == SourceType::Video);
+  if (*source_type == SourceType::Audio)
+    metrics_audio_.store(source.get());
+  else
+    metrics_video_.store(source.get());
   sources_.emplace(*source_type, std::move(source));
   return Status::Success;
 }
@@ -274,6 +314,7 @@ void VideoController::Reset() {
   }
 
   std::unique_lock<SharedMutex> unique(mutex_);
+  UnpublishMetricsSources();
   sources_.clear();
   cdm_ = nullptr;
 
@@ -281,6 +322,11 @@ void VideoController::Reset() {
   quality_info_.totalVideoFrames = 0;
   quality_info_.droppedVideoFrames = 0;
   quality_info_.corruptedVideoFrames = 0;
+  quality_info_.decodeDegradationLevel = 0;
+  quality_info_.skipLoopFilterFrames = 0;
+  quality_info_.skipNonReferenceFrames = 0;
+  quality_info_.keyFrameSkips = 0;
+  quality_info_.keyFrameSkippedFrames = 0;
 }
 
 void VideoController::DebugDumpStats() const {
@@ -368,6 +414,15 @@ double VideoController::GetPlaybackRate() const {
   return pipeline_.GetPlaybackRate();
 }
 
+void VideoController::UnpublishMetricsSources() {
+  // These are sequentially consistent so a reader either sees the null
+  // pointers or is counted before we check |metrics_readers_|.
+  metrics_audio_.store(nullptr);
+  metrics_video_.store(nullptr);
+  while (metrics_readers_.load() != 0)
+    std::this_thread::yield();
+}
+
 
 VideoController::Source::Source(
     SourceType source_type, PipelineManager* pipeline,
@@ -378,7 +433,8 @@ VideoController::Source::Source(
     std::function<double()> get_time, std::function<double()> get_playback_rate,
     std::function<void(Status)> on_error, std::function<void()> on_load_meta)
     : processor(container, codecs, std::move(on_encrypted_init_data)),
-      decoder(get_time, std::bind(&VideoController::Source::OnSeekDone, this),
+      decoder(get_time, get_playback_rate,
+              std::bind(&VideoController::Source::OnSeekDone, this),
               std::move(on_waiting_for_key), std::move(on_error), &processor,
               pipeline, &stream),
       demuxer(std::move(on_load_meta), &processor, &stream),
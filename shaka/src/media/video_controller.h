@@ -15,6 +15,7 @@
 #ifndef SHAKA_EMBEDDED_MEDIA_VIDEO_CONTROLLER_H_
 #define SHAKA_EMBEDDED_MEDIA_VIDEO_CONTROLLER_H_
 
+#include <atomic>
 #include <functional>
 #include <memory>
 #include <string>
@@ -23,6 +24,7 @@
 #include "shaka/eme/configuration.h"
 #include "shaka/eme/implementation.h"
 #include "shaka/frame.h"
+#include "shaka/pipeline_metrics.h"
 #include "src/debug/mutex.h"
 #include "src/mapping/byte_buffer.h"
 #include "src/mapping/struct.h"
@@ -107,6 +109,13 @@ class VideoController {
     return &quality_info_;
   }
 
+  /**
+   * Fills in the media fields of the given metrics.  This only reads counters
+   * that the pipeline threads update atomically and doesn't lock, so it won't
+   * block playback.
+   */
+  void GetPipelineMetrics(PipelineMetrics* metrics) const;
+
   /**
    * Gets the buffered ranges for the given type.  If the type is Unknown, this
    * returns the intersection of the ranges.
@@ -167,8 +176,20 @@ class VideoController {
   BufferedRanges GetDecodedRanges() const;
   double GetPlaybackRate() const;
 
+  /**
+   * Stops GetPipelineMetrics from reading the sources and waits for any current
+   * readers to finish.  This must be called before destroying the sources.
+   */
+  void UnpublishMetricsSources();
+
   mutable SharedMutex mutex_;
   std::unordered_map<SourceType, std::unique_ptr<Source>> sources_;
+  // The audio and video sources for GetPipelineMetrics, which reads these
+  // without locking |mutex_|.  The sources aren't destroyed while
+  // |metrics_readers_| is non-zero.
+  std::atomic<Source*> metrics_audio_;
+  std::atomic<Source*> metrics_video_;
+  mutable std::atomic<int> metrics_readers_;
   std::function<void(SourceType, Status)> on_error_;
   std::function<void()> on_waiting_for_key_;
   std::function<void(eme::MediaKeyInitDataType, ByteBuffer)>
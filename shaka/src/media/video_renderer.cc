@@ -74,6 +74,10 @@ Frame VideoRenderer::DrawFrame(int* dropped_frame_count, bool* is_new_frame,
 
   *is_new_frame = prev_time_ != ideal_frame->pts;
   if (!is_seeking_) {
+    if (*is_new_frame) {
+      const double lateness = std::max(time - ideal_frame->pts, 0.0);
+      lateness_.Record(static_cast<uint64_t>(lateness * 1000000));
+    }
     if (prev_time_ >= 0) {
       *dropped_frame_count = stream_->GetDecodedFrames()->FramesBetween(
           prev_time_, ideal_frame->pts);
@@ -101,6 +105,10 @@ void VideoRenderer::OnSeekDone() {
   stream_->GetDecodedFrames()->Remove(time + 1, HUGE_VAL);
 }
 
+void VideoRenderer::GetRenderLateness(LatencyHistogram* histogram) const {
+  lateness_.CopyTo(histogram);
+}
+
 void VideoRenderer::SetDrawerForTesting(std::unique_ptr<FrameDrawer> drawer) {
   std::unique_lock<Mutex> lock(mutex_);
   swap(drawer_, drawer);
@@ -18,9 +18,11 @@
 #include <functional>
 #include <memory>
 
+#include "shaka/pipeline_metrics.h"
 #include "src/debug/mutex.h"
 #include "src/media/frame_drawer.h"
 #include "src/media/renderer.h"
+#include "src/util/atomic_histogram.h"
 #include "src/util/macros.h"
 
 namespace shaka {
@@ -43,6 +45,12 @@ class VideoRenderer : public Renderer {
   void OnSeek() override;
   void OnSeekDone() override;
 
+  /**
+   * Copies how late each frame was first drawn to the given histogram.  This
+   * doesn't lock, so it can be called from any thread.
+   */
+  void GetRenderLateness(LatencyHistogram* histogram) const;
+
  private:
   void SetDrawerForTesting(std::unique_ptr<FrameDrawer> drawer);
   friend class VideoRendererTest;
@@ -53,6 +61,7 @@ class VideoRenderer : public Renderer {
   std::unique_ptr<FrameDrawer> drawer_;
   double prev_time_;
   bool is_seeking_;
+  util::AtomicHistogram lateness_;
 };
 
 }  // namespace media
@@ -15,6 +15,7 @@
 #include "src/memory/object_tracker.h"
 
 #include "src/core/js_manager_impl.h"
+#include "src/debug/trace_recorder.h"
 #include "src/mapping/backing_object.h"
 #include "src/memory/heap_tracer.h"
 #include "src/util/clock.h"
@@ -79,6 +80,7 @@ std::unordered_set<const Traceable*> ObjectTracker::GetAliveObjects() const {
 
 void ObjectTracker::FreeDeadObjects(
     const std::unordered_set<const Traceable*>& alive) {
+  ScopedTrace trace("ObjectTracker::FreeDeadObjects");
   std::unique_lock<Mutex> lock(mutex_);
   std::unordered_set<Traceable*> to_delete;
   to_delete.reserve(objects_.size());
@@ -16,6 +16,7 @@
 
 #include <glog/logging.h>
 
+#include "src/debug/trace_recorder.h"
 #include "src/mapping/backing_object.h"
 #include "src/memory/object_tracker.h"
 #include "src/util/clock.h"
@@ -37,12 +38,14 @@ void V8HeapTracer::AbortTracing() {
 
 void V8HeapTracer::TracePrologue() {
   VLOG(2) << "GC run started";
+  TraceRecorder::AddInstantEvent("GC run started");
   DCHECK(fields_.empty());
   heap_tracer_->BeginPass();
 }
 
 void V8HeapTracer::TraceEpilogue() {
   VLOG(2) << "GC run ended";
+  ScopedTrace trace("GC epilogue");
   CHECK(fields_.empty());
   object_tracker_->FreeDeadObjects(heap_tracer_->alive());
   heap_tracer_->ResetState();
@@ -59,6 +62,7 @@ void V8HeapTracer::RegisterV8References(
 bool V8HeapTracer::AdvanceTracing(double /* deadline_ms */,
                                   AdvanceTracingActions /* actions */) {
   VLOG(2) << "GC run step";
+  ScopedTrace trace("GC tracing");
   util::Clock clock;
   const uint64_t start = clock.GetMonotonicTime();
   heap_tracer_->TraceCommon(object_tracker_->GetAliveObjects());
@@ -16,6 +16,7 @@
 
 #include <glog/logging.h>
 
+#include "src/core/js_manager_impl.h"
 #include "src/core/ref_ptr.h"
 #include "src/js/eme/media_key_session.h"
 #include "src/mapping/byte_buffer.h"
@@ -27,16 +28,21 @@ namespace eme {
 
 class Data::Impl {
  public:
-  explicit Impl(ByteBuffer buffer) {
+  explicit Impl(ByteBuffer buffer) : manager(JsManagerImpl::Instance()) {
     // We need to register the object before we can store it in the RefPtr<T>.
     auto* temp = new ByteBuffer(std::move(buffer));
     memory::ObjectTracker::Instance()->RegisterObject(temp);
     this->buffer.reset(temp);
   }
-  ~Impl() {}
+  ~Impl() {
+    // This can be destroyed on any thread.
+    JsManagerImpl::ThreadScope scope(manager);
+    buffer.reset();
+  }
 
   NON_COPYABLE_OR_MOVABLE_TYPE(Impl);
 
+  JsManagerImpl* const manager;
   RefPtr<ByteBuffer> buffer;
 };
 
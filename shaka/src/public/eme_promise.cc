@@ -103,16 +103,24 @@ class DoRejectPromise : public memory::Traceable {
 }  // namespace
 
 EmePromise::Impl::Impl(const Promise& promise, bool has_value)
-    : is_pending_(false), has_value_(has_value) {
+    : manager_(JsManagerImpl::Instance()),
+      is_pending_(false),
+      has_value_(has_value) {
   // We need to register the object before we store in RefPtr<T>.
   auto* p = new Promise(promise);
   memory::ObjectTracker::Instance()->RegisterObject(p);
   promise_.reset(p);
 }
 
-EmePromise::Impl::Impl() : is_pending_(false), has_value_(false) {}
+EmePromise::Impl::Impl()
+    : manager_(JsManagerImpl::InstanceOrNull()),
+      is_pending_(false),
+      has_value_(false) {}
 
-EmePromise::Impl::~Impl() {}
+EmePromise::Impl::~Impl() {
+  JsManagerImpl::ThreadScope scope(manager_);
+  promise_.reset();
+}
 
 void EmePromise::Impl::Resolve() {
   bool expected = false;
@@ -122,7 +130,8 @@ void EmePromise::Impl::Resolve() {
                       "value, resolving with false.";
     }
 
-    JsManagerImpl::Instance()->MainThread()->AddInternalTask(
+    JsManagerImpl::ThreadScope scope(manager_);
+    manager_->MainThread()->AddInternalTask(
         TaskPriority::Internal, "DoResolvePromise",
         DoResolvePromise(*promise_, has_value_, false));
   }
@@ -136,7 +145,8 @@ void EmePromise::Impl::ResolveWith(bool value) {
                       "value, ignoring value.";
     }
 
-    JsManagerImpl::Instance()->MainThread()->AddInternalTask(
+    JsManagerImpl::ThreadScope scope(manager_);
+    manager_->MainThread()->AddInternalTask(
         TaskPriority::Internal, "DoResolvePromise",
         DoResolvePromise(*promise_, has_value_, value));
   }
@@ -146,7 +156,8 @@ void EmePromise::Impl::Reject(ExceptionType except_type,
                               const std::string& message) {
   bool expected = false;
   if (is_pending_.compare_exchange_strong(expected, true)) {
-    JsManagerImpl::Instance()->MainThread()->AddInternalTask(
+    JsManagerImpl::ThreadScope scope(manager_);
+    manager_->MainThread()->AddInternalTask(
         TaskPriority::Internal, "DoRejectPromise",
         DoRejectPromise(*promise_, except_type, message));
   }
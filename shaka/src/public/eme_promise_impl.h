@@ -24,6 +24,9 @@
 #include "src/mapping/promise.h"
 
 namespace shaka {
+
+class JsManagerImpl;
+
 namespace eme {
 
 class EmePromise::Impl {
@@ -44,6 +47,9 @@ class EmePromise::Impl {
   Impl();
 
  private:
+  // The manager that created the Promise.  This can be resolved on any thread,
+  // so this is bound while using |promise_|.
+  JsManagerImpl* const manager_;
   RefPtr<Promise> promise_;
   std::atomic<bool> is_pending_;
   bool has_value_;
@@ -15,6 +15,7 @@
 #include "shaka/js_manager.h"
 
 #include "src/core/js_manager_impl.h"
+#include "src/debug/trace_recorder.h"
 
 namespace shaka {
 
@@ -53,4 +54,19 @@ AsyncResults<void> JsManager::RunScript(const std::string& path) {
   return future.share();
 }
 
+bool JsManager::SetEmeStorageKey(const std::vector<uint8_t>& key) {
+  return impl_->SetEmeStorageKey(key);
+}
+
+void JsManager::SetTracingEnabled(bool enabled) {
+  TraceRecorder::SetEnabled(enabled);
+}
+
+std::string JsManager::ExportTrace(bool clear) {
+  std::string ret = TraceRecorder::ExportJson();
+  if (clear)
+    TraceRecorder::Clear();
+  return ret;
+}
+
 }  // namespace shaka
@@ -0,0 +1,62 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "shaka/pipeline_metrics.h"
+
+#include <algorithm>
+
+namespace shaka {
+
+constexpr const size_t LatencyHistogram::kBucketCount;
+
+LatencyHistogram::LatencyHistogram()
+    : count(0), total_us(0), max_us(0), buckets() {}
+
+double LatencyHistogram::MeanMs() const {
+  return count == 0 ? 0 : total_us / 1000.0 / count;
+}
+
+double LatencyHistogram::PercentileMs(double percentile) const {
+  if (count == 0)
+    return 0;
+
+  const double target =
+      std::min(std::max(percentile, 0.0), 100.0) / 100 * count;
+  uint64_t seen = 0;
+  for (size_t i = 0; i < kBucketCount; i++) {
+    seen += buckets[i];
+    if (seen > 0 && seen >= target) {
+      // The top of bucket |i| is 2^i microseconds; no sample is above |max_us|.
+      const uint64_t upper_us = i == 0 ? 1 : (uint64_t{1} << i);
+      return std::min(upper_us, max_us) / 1000.0;
+    }
+  }
+  return max_us / 1000.0;
+}
+
+
+StreamPipelineMetrics::StreamPipelineMetrics()
+    : demuxed_buffer_seconds(0),
+      demuxed_buffer_bytes(0),
+      decoded_buffer_seconds(0),
+      decoded_buffer_bytes(0),
+      decoder_restarts(0) {}
+
+
+PipelineMetrics::PipelineMetrics()
+    : audio_underruns(0),
+      network_bytes_received(0),
+      network_requests_in_flight(0) {}
+
+}  // namespace shaka
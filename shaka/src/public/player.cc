@@ -14,10 +14,13 @@
 
 #include "shaka/player.h"
 
+#include <algorithm>
+
 #include "shaka/version.h"
 #include "src/core/js_manager_impl.h"
 #include "src/debug/thread_event.h"
 #include "src/js/manifest.h"
+#include "src/js/mse/media_source.h"
 #include "src/js/mse/video_element.h"
 #include "src/js/player_externs.h"
 #include "src/js/stats.h"
@@ -28,6 +31,10 @@
 #include "src/mapping/js_utils.h"
 #include "src/mapping/js_wrappers.h"
 #include "src/mapping/struct.h"
+#include "src/media/pipeline_manager.h"
+#include "src/media/video_controller.h"
+#include "src/util/clock.h"
+#include "src/util/double_buffer.h"
 #include "src/util/utils.h"
 
 // Declared in version.h by generated code in //shaka/tools/version.py.
@@ -37,8 +44,32 @@ SHAKA_EXPORT extern "C" const char* GetShakaEmbeddedVersion() {
 
 namespace shaka {
 
+constexpr const size_t PlayerStateSnapshot::kMaxBufferedRanges;
+
 namespace {
 
+/**
+ * How often to refresh the parts of the state snapshot that don't have events,
+ * in milliseconds.
+ */
+constexpr const uint64_t kSnapshotRefreshDelayMs = 250;
+
+/** The video events that change the state snapshot. */
+constexpr const char* kVideoEvents[] = {
+    "durationchange", "emptied", "ended", "loadedmetadata", "pause", "play",
+    "playing", "ratechange", "seeked", "seeking", "waiting",
+};
+
+/**
+ * The state snapshot along with the pipeline timeline it was made from, which
+ * is used to calculate the current time when it is read.
+ */
+struct SnapshotData {
+  PlayerStateSnapshot state;
+  media::PipelineTimeline timeline;
+  bool has_timeline = false;
+};
+
 /**
  * A helper class that converts a number to the argument to load().  This
  * exists because we need to convert the C++ NaN into a JavaScript undefined.
@@ -131,15 +162,18 @@ Error ConvertError(Handle<JsValue> except) {
                static_cast<int>(NumberFromValue(code)), severity, message);
 }
 
+/**
+ * Calls the given member of the given object.  The name must be a string
+ * literal, since the JavaScript string for it is cached (see PropertyName).
+ */
 Converter<void>::variant_type CallMemberFunction(Handle<JsObject> that,
-                                                 const std::string& name,
-                                                 int argc,
+                                                 const char* name, int argc,
                                                  LocalVar<JsValue>* argv,
                                                  LocalVar<JsValue>* result) {
-  LocalVar<JsValue> member = GetMemberRaw(that, name);
+  LocalVar<JsValue> member = GetMemberRaw(that, PropertyName(name));
   if (GetValueType(member) != JSValueType::Function) {
     return Error(ErrorType::BadMember,
-                 "The member '" + name + "' is not a function.");
+                 std::string("The member '") + name + "' is not a function.");
   }
 
   LocalVar<JsValue> result_or_except;
@@ -153,8 +187,27 @@ Converter<void>::variant_type CallMemberFunction(Handle<JsObject> that,
   return monostate();
 }
 
-Converter<void>::variant_type AttachEventListener(
-    Handle<JsObject> player, const std::string& name, Player::Client* client,
+/**
+ * Passes the given results to the given callback.  If there is an executor,
+ * the callback is run by it; otherwise it is called on the current thread.
+ */
+template <typename Ret>
+void InvokeCallback(const Player::ResultsCallback<Ret>& callback,
+                    const Player::Executor& executor,
+                    typename Converter<Ret>::variant_type results) {
+  if (executor) {
+    executor([=]() { callback(results); });
+  } else {
+    callback(results);
+  }
+}
+
+/**
+ * Creates a JavaScript event listener that calls the given handler, reporting
+ * bad events to the given client.
+ */
+ReturnVal<JsFunction> CreateEventListener(
+    Player::Client* client,
     std::function<void(Handle<JsObject> event)> handler) {
   const std::function<void(optional<Any>)> callback = [=](optional<Any> event) {
     // We can't accept or use events::Event since Shaka player raises fake
@@ -169,9 +222,26 @@ Converter<void>::variant_type AttachEventListener(
     LocalVar<JsObject> event_obj = UnsafeJsCast<JsObject>(event_val);
     handler(event_obj);
   };
-  LocalVar<JsFunction> callback_js = CreateStaticFunction("", "", callback);
-  LocalVar<JsValue> arguments[] = {ToJsValue(name), RawToJsValue(callback_js)};
-  return CallMemberFunction(player, "addEventListener", 2, arguments, nullptr);
+  return CreateStaticFunction("", "", callback);
+}
+
+/**
+ * Calls addEventListener or removeEventListener (given as |method|) on the
+ * given target.
+ */
+Converter<void>::variant_type CallListenerMethod(Handle<JsObject> target,
+                                                 const char* method,
+                                                 const std::string& name,
+                                                 Handle<JsFunction> listener) {
+  LocalVar<JsValue> arguments[] = {ToJsValue(name), RawToJsValue(listener)};
+  return CallMemberFunction(target, method, 2, arguments, nullptr);
+}
+
+Converter<void>::variant_type AttachEventListener(
+    Handle<JsObject> player, const std::string& name, Player::Client* client,
+    std::function<void(Handle<JsObject> event)> handler) {
+  LocalVar<JsFunction> listener = CreateEventListener(client, handler);
+  return CallListenerMethod(player, "addEventListener", name, listener);
 }
 
 }  // namespace
@@ -187,16 +257,31 @@ struct impl::ConvertHelper<DefaultValueType> {
 
 class Player::Impl {
  public:
-  explicit Impl(JsManager* engine) {
-    CHECK(engine) << "Must pass a JsManager instance";
-  }
+  explicit Impl(JsManager* engine)
+      : manager_(JsManagerImpl::Get(engine)),
+        video_(nullptr),
+        refresh_timer_(-1) {}
   ~Impl() {
-    if (player_)
+    if (player_) {
+      // The video can outlive us, so its listeners need to be removed.  This
+      // task runs before the destroy() task we wait for, so neither the
+      // listeners nor the timer can use |this| once we are destroyed.
+      manager_->MainThread()->AddInternalTask(
+          TaskPriority::Internal, "Player detach",
+          PlainCallbackTask([this]() {
+            SetRefreshing(false);
+            DetachVideoListeners();
+          }));
       CallPlayerPromiseMethod<void>("destroy").wait();
+    }
   }
 
   NON_COPYABLE_OR_MOVABLE_TYPE(Impl);
 
+  JsManagerImpl* manager() const {
+    return manager_;
+  }
+
   Converter<void>::future_type Initialize(js::mse::HTMLVideoElement* video,
                                           Client* client) {
     // This function can be called immediately after the JsManager
@@ -221,36 +306,112 @@ class Player::Impl {
       }
 
       player_ = UnsafeJsCast<JsObject>(result_or_except);
-      return AttachListeners(player_, client);
+      video_ = video;
+      auto ret = AttachListeners(player_, client);
+      if (holds_alternative<Error>(ret))
+        return ret;
+
+      // The snapshot is refreshed periodically once something is loaded.
+      UpdatePlayerState();
+      UpdateVideoState();
+      return ret;
     };
-    return JsManagerImpl::Instance()
-        ->MainThread()
+    return manager_->MainThread()
         ->AddInternalTask(TaskPriority::Internal, "Player ctor",
                           PlainCallbackTask(callback))
         ->future();
   }
 
+  /**
+   * Calls the given Player method and returns the result as a Ret type.  This
+   * must be called on the JavaScript main thread.
+   */
+  template <typename Ret, typename... Args>
+  typename Converter<Ret>::variant_type InvokePlayerMethod(
+      const char* name, const Args&... args) const {
+    LocalVar<JsValue> result;
+    LocalVar<JsValue> js_args[] = {ToJsValue(args)..., JsUndefined()};
+    auto error =
+        CallMemberFunction(player_, name, sizeof...(args), js_args, &result);
+    if (holds_alternative<Error>(error))
+      return get<Error>(error);
+
+    return Converter<Ret>::Convert(name, result);
+  }
+
   /** Calls the given Player method and returns the result as a Ret type. */
   template <typename Ret, typename... Args>
   typename Converter<Ret>::future_type CallPlayerMethod(
-      const std::string& name, const Args&... args) const {
+      const char* name, const Args&... args) const {
     const auto callback = [=]() -> typename Converter<Ret>::variant_type {
-      LocalVar<JsValue> result;
-      LocalVar<JsValue> js_args[] = {ToJsValue(args)..., JsUndefined()};
-      auto error =
-          CallMemberFunction(player_, name, sizeof...(args), js_args, &result);
-      if (holds_alternative<Error>(error))
-        return get<Error>(error);
+      return InvokePlayerMethod<Ret>(name, args...);
+    };
+    return manager_->MainThread()
+        ->AddInternalTask(TaskPriority::Internal, name,
+                          PlainCallbackTask(callback))
+        ->future();
+  }
 
-      return Converter<Ret>::Convert(name, result);
+  /**
+   * Calls the given Player method without blocking and passes the results to
+   * the given callback.  The task is posted before the one that destroys the
+   * Player in our destructor, so |this| is still alive when it runs.
+   */
+  template <typename Ret>
+  void CallPlayerMethodAsync(const char* name,
+                             const ResultsCallback<Ret>& callback,
+                             const Executor& executor) const {
+    const auto task = [=]() {
+      InvokeCallback<Ret>(callback, executor, InvokePlayerMethod<Ret>(name));
     };
-    return JsManagerImpl::Instance()
-        ->MainThread()
-        ->AddInternalTask(TaskPriority::Internal, "Player." + name,
+    manager_->MainThread()->PostInternalTask(TaskPriority::Internal, name,
+                                             PlainCallbackTask(task));
+  }
+
+  /**
+   * Gathers the values in PlaybackStatus.  This must be called on the
+   * JavaScript main thread.
+   */
+  Converter<PlaybackStatus>::variant_type GetPlaybackStatus() const {
+    PlaybackStatus ret;
+#define GET_VALUE(type, name, member)             \
+  do {                                            \
+    auto result = InvokePlayerMethod<type>(name); \
+    if (holds_alternative<Error>(result))         \
+      return get<Error>(result);                  \
+    ret.member = std::move(get<type>(result));    \
+  } while (false)
+
+    GET_VALUE(bool, "isAudioOnly", is_audio_only);
+    GET_VALUE(bool, "isBuffering", is_buffering);
+    GET_VALUE(bool, "isLive", is_live);
+    GET_VALUE(BufferedInfo, "getBufferedInfo", buffered_info);
+    GET_VALUE(BufferedRange, "seekRange", seek_range);
+    GET_VALUE(Stats, "getStats", stats);
+
+#undef GET_VALUE
+    return ret;
+  }
+
+  Converter<PlaybackStatus>::future_type CallGetPlaybackStatus() const {
+    const auto callback = [this]() { return GetPlaybackStatus(); };
+    return manager_->MainThread()
+        ->AddInternalTask(TaskPriority::Internal, "Player.GetPlaybackStatus",
                           PlainCallbackTask(callback))
         ->future();
   }
 
+  void CallGetPlaybackStatusAsync(
+      const ResultsCallback<PlaybackStatus>& callback,
+      const Executor& executor) const {
+    const auto task = [=]() {
+      InvokeCallback<PlaybackStatus>(callback, executor, GetPlaybackStatus());
+    };
+    manager_->MainThread()->PostInternalTask(TaskPriority::Internal,
+                                             "Player.GetPlaybackStatus",
+                                             PlainCallbackTask(task));
+  }
+
   /**
    * Calls the given Player method that should return a Promise to the given
    * type.  The resulting async results will complete when the Promise is
@@ -258,7 +419,7 @@ class Player::Impl {
    */
   template <typename Ret, typename... Args>
   typename Converter<Ret>::future_type CallPlayerPromiseMethod(
-      const std::string& name, Args&&... args) {
+      const char* name, Args&&... args) {
     // TODO: Combine with CallPlayerMethod.  These are separate since this uses
     // a std::promise for the return value rather than the internal task future.
     auto promise =
@@ -290,9 +451,8 @@ class Player::Impl {
                 promise->set_value(ConvertError(val));
               });
     };
-    JsManagerImpl::Instance()
-        ->MainThread()
-        ->AddInternalTask(TaskPriority::Internal, "Player." + name,
+    manager_->MainThread()
+        ->AddInternalTask(TaskPriority::Internal, name,
                           PlainCallbackTask(callback))
         ->future();
     return promise->get_future().share();
@@ -317,19 +477,40 @@ class Player::Impl {
 
       return Converter<T>::Convert(name_path, result);
     };
-    return JsManagerImpl::Instance()
-        ->MainThread()
+    return manager_->MainThread()
         ->AddInternalTask(TaskPriority::Internal, "Player.getConfiguration",
                           PlainCallbackTask(callback))
         ->future();
   }
 
+  /**
+   * Starts or stops refreshing the state snapshot periodically.  This is only
+   * needed while content is loaded, since the snapshot doesn't change
+   * otherwise.  The task is posted before any task posted after this call.
+   */
+  void PostSetRefreshing(bool refreshing) {
+    manager_->MainThread()->PostInternalTask(
+        TaskPriority::Internal, "Player refresh",
+        PlainCallbackTask(
+            std::bind(&Impl::SetRefreshing, this, refreshing)));
+  }
+
+  /** Reads the current state snapshot.  This can be called on any thread. */
+  PlayerStateSnapshot GetStateSnapshot() const {
+    SnapshotData data = snapshot_.Load();
+    if (data.has_timeline) {
+      const uint64_t now = util::Clock::Instance.GetMonotonicTime();
+      data.state.current_time = data.timeline.GetTimeFor(now);
+    }
+    return data.state;
+  }
+
  private:
   Converter<void>::variant_type AttachListeners(Handle<JsObject> player,
                                                 Client* client) {
-#define ATTACH(name, call)                                            \
+#define ATTACH(target, name, call)                                    \
   do {                                                                \
-    const auto ret = AttachEventListener(player, name, client, call); \
+    const auto ret = AttachEventListener(target, name, client, call); \
     if (holds_alternative<Error>(ret))                                \
       return get<Error>(ret);                                         \
   } while (false)
@@ -338,25 +519,196 @@ class Player::Impl {
       LocalVar<JsValue> detail = GetMemberRaw(event, "detail");
       client->OnError(ConvertError(detail));
     };
-    ATTACH("error", on_error);
+    ATTACH(player, "error", on_error);
 
     const auto on_buffering = [=](Handle<JsObject> event) {
       LocalVar<JsValue> is_buffering = GetMemberRaw(event, "buffering");
       bool is_buffering_bool;
       if (FromJsValue(is_buffering, &is_buffering_bool)) {
+        pending_snapshot_.state.is_buffering = is_buffering_bool;
+        UpdateVideoState();
         client->OnBuffering(is_buffering_bool);
       } else {
         client->OnError(Error(ErrorType::NonShakaError,
                               "Bad 'buffering' event from JavaScript Player"));
       }
     };
-    ATTACH("buffering", on_buffering);
+    ATTACH(player, "buffering", on_buffering);
+
+    // Keep the state snapshot up to date as things change.
+    const auto on_player_changed = [=](Handle<JsObject> /* event */) {
+      UpdatePlayerState();
+      UpdateVideoState();
+    };
+    for (const char* name :
+         {"adaptation", "streaming", "trackschanged", "variantchanged"}) {
+      ATTACH(player, name, on_player_changed);
+    }
+
+    // The video can outlive us, so keep this listener to remove it later.
+    // This also updates the player state since the refresh timer is stopped
+    // when unloading, before the "emptied" event.
+    const auto on_video_changed = [=](Handle<JsObject> /* event */) {
+      UpdatePlayerState();
+      UpdateVideoState();
+    };
+    LocalVar<JsFunction> video_listener =
+        CreateEventListener(client, on_video_changed);
+    video_listener_ = video_listener;
+    LocalVar<JsObject> video = UnsafeJsCast<JsObject>(video_->JsThis());
+    for (const char* name : kVideoEvents) {
+      const auto ret =
+          CallListenerMethod(video, "addEventListener", name, video_listener);
+      if (holds_alternative<Error>(ret))
+        return get<Error>(ret);
+    }
 
 #undef ATTACH
     return {};
   }
 
+  /**
+   * Removes the listeners added to the video.  This must be called on the
+   * JavaScript main thread.
+   */
+  void DetachVideoListeners() {
+    if (!video_listener_)
+      return;
+
+    LocalVar<JsFunction> video_listener = video_listener_;
+    LocalVar<JsObject> video = UnsafeJsCast<JsObject>(video_->JsThis());
+    for (const char* name : kVideoEvents) {
+      // Errors are ignored since there is nothing else to do on shutdown.
+      CallListenerMethod(video, "removeEventListener", name, video_listener);
+    }
+    video_listener_ = nullptr;
+  }
+
+  /**
+   * Starts or stops the timer that refreshes the state snapshot.  This must be
+   * called on the JavaScript main thread.
+   */
+  void SetRefreshing(bool refreshing) {
+    if (refreshing == (refresh_timer_ >= 0))
+      return;
+
+    if (refreshing) {
+      refresh_timer_ = manager_->MainThread()->AddRepeatedTimer(
+          kSnapshotRefreshDelayMs, PlainCallbackTask([this]() {
+            UpdatePlayerState();
+            UpdateVideoState();
+          }));
+    } else {
+      manager_->MainThread()->CancelTimer(refresh_timer_);
+      refresh_timer_ = -1;
+    }
+  }
+
+  /**
+   * Updates the parts of the state snapshot that come from the JavaScript
+   * Player.  This must be called on the JavaScript main thread.
+   */
+  void UpdatePlayerState() {
+    PlayerStateSnapshot* state = &pending_snapshot_.state;
+    auto is_buffering = InvokePlayerMethod<bool>("isBuffering");
+    if (holds_alternative<bool>(is_buffering))
+      state->is_buffering = get<bool>(is_buffering);
+    auto is_live = InvokePlayerMethod<bool>("isLive");
+    if (holds_alternative<bool>(is_live))
+      state->is_live = get<bool>(is_live);
+
+    auto stats = InvokePlayerMethod<Stats>("getStats");
+    if (holds_alternative<Stats>(stats)) {
+      const Stats& value = get<Stats>(stats);
+      state->estimated_bandwidth = value.estimated_bandwidth();
+      state->stream_bandwidth = value.stream_bandwidth();
+      state->decoded_frames = value.decoded_frames();
+      state->dropped_frames = value.dropped_frames();
+      state->play_time = value.play_time();
+      state->buffering_time = value.buffering_time();
+    }
+
+    auto tracks = InvokePlayerMethod<std::vector<Track>>("getVariantTracks");
+    if (holds_alternative<std::vector<Track>>(tracks)) {
+      state->variant_id = state->variant_bandwidth = state->variant_width =
+          state->variant_height = NAN;
+      for (const Track& track : get<std::vector<Track>>(tracks)) {
+        if (track.active()) {
+          state->variant_id = track.id();
+          state->variant_bandwidth = track.bandwidth();
+          state->variant_width = track.width().value_or(NAN);
+          state->variant_height = track.height().value_or(NAN);
+          break;
+        }
+      }
+    }
+
+    snapshot_.Store(pending_snapshot_);
+  }
+
+  /**
+   * Updates the parts of the state snapshot that come from the video.  This
+   * must be called on the JavaScript main thread.
+   */
+  void UpdateVideoState() {
+    PlayerStateSnapshot* state = &pending_snapshot_.state;
+    RefPtr<js::mse::MediaSource> media_source;
+    if (video_)
+      media_source = video_->GetMediaSource();
+    if (!media_source) {
+      // Nothing is loaded, so use the defaults for the video state.
+      pending_snapshot_.has_timeline = false;
+      state->paused = true;
+      state->seeking = state->ended = false;
+      state->current_time = 0;
+      state->duration = NAN;
+      state->playback_rate = 1;
+      state->buffered_range_count = 0;
+      snapshot_.Store(pending_snapshot_);
+      return;
+    }
+
+    media::VideoController* controller = media_source->GetController();
+    const media::PipelineTimeline timeline =
+        controller->GetPipelineManager()->GetTimeline();
+    pending_snapshot_.timeline = timeline;
+    pending_snapshot_.has_timeline = true;
+    state->paused = timeline.status == media::PipelineStatus::Paused ||
+                    timeline.status == media::PipelineStatus::SeekingPause ||
+                    timeline.status == media::PipelineStatus::Ended;
+    state->seeking = timeline.status == media::PipelineStatus::SeekingPlay ||
+                     timeline.status == media::PipelineStatus::SeekingPause;
+    state->ended = timeline.status == media::PipelineStatus::Ended;
+    state->duration = timeline.duration;
+    state->playback_rate = timeline.playback_rate;
+
+    const media::BufferedRanges buffered =
+        controller->GetBufferedRanges(media::SourceType::Unknown);
+    const size_t count =
+        std::min(buffered.size(), PlayerStateSnapshot::kMaxBufferedRanges);
+    state->buffered_range_count = count;
+    for (size_t i = 0; i < count; i++) {
+      state->buffered_ranges[i].start = buffered[i].start;
+      state->buffered_ranges[i].end = buffered[i].end;
+    }
+    if (count > 0)
+      state->buffered_ranges[count - 1].end = buffered.back().end;
+
+    snapshot_.Store(pending_snapshot_);
+  }
+
+  JsManagerImpl* const manager_;
   Global<JsObject> player_;
+  js::mse::HTMLVideoElement* video_;
+  Global<JsFunction> video_listener_;
+  // The refresh timer ID, or -1 if it isn't running.  This is only used on the
+  // JavaScript main thread.
+  int refresh_timer_;
+
+  // The snapshot is only written on the JavaScript main thread; this is the
+  // copy that is changed before being stored in |snapshot_|.
+  SnapshotData pending_snapshot_;
+  util::DoubleBuffer<SnapshotData> snapshot_;
 };
 
 Player::Client::Client() {}
@@ -370,6 +722,17 @@ Player::Client& Player::Client::operator=(Client&&) = default;
 void Player::Client::OnError(const Error& /* error */) {}
 void Player::Client::OnBuffering(bool /* is_buffering */) {}
 
+Player::PlaybackStatus::PlaybackStatus()
+    : is_audio_only(false), is_buffering(false), is_live(false) {}
+Player::PlaybackStatus::PlaybackStatus(const PlaybackStatus&) = default;
+Player::PlaybackStatus::PlaybackStatus(PlaybackStatus&&) = default;
+Player::PlaybackStatus::~PlaybackStatus() {}
+
+Player::PlaybackStatus& Player::PlaybackStatus::operator=(
+    const PlaybackStatus&) = default;
+Player::PlaybackStatus& Player::PlaybackStatus::operator=(PlaybackStatus&&) =
+    default;
+
 
 Player::Player(JsManager* engine) : impl_(new Impl(engine)) {}
 
@@ -380,8 +743,8 @@ Player::~Player() {}
 Player& Player::operator=(Player&&) = default;
 
 AsyncResults<void> Player::SetLogLevel(JsManager* engine, LogLevel level) {
-  DCHECK(engine);
-  DCHECK(!JsManagerImpl::Instance()->MainThread()->BelongsToCurrentThread());
+  JsManagerImpl* manager = JsManagerImpl::Get(engine);
+  DCHECK(!manager->MainThread()->BelongsToCurrentThread());
   const auto callback = [level]() -> Converter<void>::variant_type {
     LocalVar<JsValue> set_level = GetDescendant(
         JsEngine::Instance()->global_handle(), {"shaka", "log", "setLevel"});
@@ -402,16 +765,15 @@ AsyncResults<void> Player::SetLogLevel(JsManager* engine, LogLevel level) {
 
     return monostate();
   };
-  return JsManagerImpl::Instance()
-      ->MainThread()
+  return manager->MainThread()
       ->AddInternalTask(TaskPriority::Internal, "SetLogLevel",
                         PlainCallbackTask(callback))
       ->future();
 }
 
 AsyncResults<Player::LogLevel> Player::GetLogLevel(JsManager* engine) {
-  DCHECK(engine);
-  DCHECK(!JsManagerImpl::Instance()->MainThread()->BelongsToCurrentThread());
+  JsManagerImpl* manager = JsManagerImpl::Get(engine);
+  DCHECK(!manager->MainThread()->BelongsToCurrentThread());
   const auto callback = []() -> Converter<Player::LogLevel>::variant_type {
     LocalVar<JsValue> current_level =
         GetDescendant(JsEngine::Instance()->global_handle(),
@@ -424,16 +786,15 @@ AsyncResults<Player::LogLevel> Player::GetLogLevel(JsManager* engine) {
     }
     return static_cast<LogLevel>(NumberFromValue(current_level));
   };
-  return JsManagerImpl::Instance()
-      ->MainThread()
+  return manager->MainThread()
       ->AddInternalTask(TaskPriority::Internal, "GetLogLevel",
                         PlainCallbackTask(callback))
       ->future();
 }
 
 AsyncResults<std::string> Player::GetPlayerVersion(JsManager* engine) {
-  DCHECK(engine);
-  DCHECK(!JsManagerImpl::Instance()->MainThread()->BelongsToCurrentThread());
+  JsManagerImpl* manager = JsManagerImpl::Get(engine);
+  DCHECK(!manager->MainThread()->BelongsToCurrentThread());
   const auto callback = []() -> Converter<std::string>::variant_type {
     LocalVar<JsValue> version = GetDescendant(
         JsEngine::Instance()->global_handle(), {"shaka", "Player", "version"});
@@ -444,8 +805,7 @@ AsyncResults<std::string> Player::GetPlayerVersion(JsManager* engine) {
     }
     return ret;
   };
-  return JsManagerImpl::Instance()
-      ->MainThread()
+  return manager->MainThread()
       ->AddInternalTask(TaskPriority::Internal, "GetVersion",
                         PlainCallbackTask(callback))
       ->future();
@@ -453,66 +813,67 @@ AsyncResults<std::string> Player::GetPlayerVersion(JsManager* engine) {
 
 
 AsyncResults<void> Player::Initialize(Video* video, Client* client) {
-  DCHECK(!JsManagerImpl::Instance()->MainThread()->BelongsToCurrentThread());
+  DCHECK(!impl_->manager()->MainThread()->BelongsToCurrentThread());
   return impl_->Initialize(video->GetJavaScriptObject(), client);
 }
 
 AsyncResults<void> Player::Destroy() {
-  DCHECK(!JsManagerImpl::Instance()->MainThread()->BelongsToCurrentThread());
+  DCHECK(!impl_->manager()->MainThread()->BelongsToCurrentThread());
+  impl_->PostSetRefreshing(false);
   return impl_->CallPlayerPromiseMethod<void>("destroy");
 }
 
 
 AsyncResults<bool> Player::IsAudioOnly() const {
-  DCHECK(!JsManagerImpl::Instance()->MainThread()->BelongsToCurrentThread());
+  DCHECK(!impl_->manager()->MainThread()->BelongsToCurrentThread());
   return impl_->CallPlayerMethod<bool>("isAudioOnly");
 }
 
 AsyncResults<bool> Player::IsBuffering() const {
-  DCHECK(!JsManagerImpl::Instance()->MainThread()->BelongsToCurrentThread());
+  DCHECK(!impl_->manager()->MainThread()->BelongsToCurrentThread());
   return impl_->CallPlayerMethod<bool>("isBuffering");
 }
 
 AsyncResults<bool> Player::IsInProgress() const {
-  DCHECK(!JsManagerImpl::Instance()->MainThread()->BelongsToCurrentThread());
+  DCHECK(!impl_->manager()->MainThread()->BelongsToCurrentThread());
   return impl_->CallPlayerMethod<bool>("isInProgress");
 }
 
 AsyncResults<bool> Player::IsLive() const {
-  DCHECK(!JsManagerImpl::Instance()->MainThread()->BelongsToCurrentThread());
+  DCHECK(!impl_->manager()->MainThread()->BelongsToCurrentThread());
   return impl_->CallPlayerMethod<bool>("isLive");
 }
 
 AsyncResults<bool> Player::IsTextTrackVisible() const {
-  DCHECK(!JsManagerImpl::Instance()->MainThread()->BelongsToCurrentThread());
+  DCHECK(!impl_->manager()->MainThread()->BelongsToCurrentThread());
   return impl_->CallPlayerMethod<bool>("isTextTrackVisible");
 }
 
 AsyncResults<bool> Player::UsingEmbeddedTextTrack() const {
-  DCHECK(!JsManagerImpl::Instance()->MainThread()->BelongsToCurrentThread());
+  DCHECK(!impl_->manager()->MainThread()->BelongsToCurrentThread());
   return impl_->CallPlayerMethod<bool>("usingEmbeddedTextTrack");
 }
 
 
 AsyncResults<optional<std::string>> Player::AssetUri() const {
-  DCHECK(!JsManagerImpl::Instance()->MainThread()->BelongsToCurrentThread());
+  DCHECK(!impl_->manager()->MainThread()->BelongsToCurrentThread());
   return impl_->CallPlayerMethod<optional<std::string>>("assetUri");
 }
 
 AsyncResults<optional<DrmInfo>> Player::DrmInfo() const {
-  DCHECK(!JsManagerImpl::Instance()->MainThread()->BelongsToCurrentThread());
+  DCHECK(!impl_->manager()->MainThread()->BelongsToCurrentThread());
   return impl_->CallPlayerMethod<optional<shaka::DrmInfo>>("drmInfo");
 }
 
 AsyncResults<std::vector<LanguageRole>> Player::GetAudioLanguagesAndRoles()
     const {
-  DCHECK(!JsManagerImpl::Instance()->MainThread()->BelongsToCurrentThread());
+  DCHECK(!impl_->manager()->MainThread()->BelongsToCurrentThread());
   return impl_->CallPlayerMethod<std::vector<LanguageRole>>(
       "getAudioLanguagesAndRoles");
 }
 
 AsyncResults<BufferedInfo> Player::GetBufferedInfo() const {
-  DCHECK(!JsManagerImpl::Instance()->MainThread()->BelongsToCurrentThread());
+  DCHECK(!impl_->manager()->MainThread()->BelongsToCurrentThread());
   return impl_->CallPlayerMethod<BufferedInfo>("getBufferedInfo");
 }
 
@@ -525,18 +886,18 @@ AsyncResults<Stats> Player::GetStats() const {
 }
 
 AsyncResults<std::vector<Track>> Player::GetTextTracks() const {
-  DCHECK(!JsManagerImpl::Instance()->MainThread()->BelongsToCurrentThread());
+  DCHECK(!impl_->manager()->MainThread()->BelongsToCurrentThread());
   return impl_->CallPlayerMethod<std::vector<Track>>("getTextTracks");
 }
 
 AsyncResults<std::vector<Track>> Player::GetVariantTracks() const {
-  DCHECK(!JsManagerImpl::Instance()->MainThread()->BelongsToCurrentThread());
+  DCHECK(!impl_->manager()->MainThread()->BelongsToCurrentThread());
   return impl_->CallPlayerMethod<std::vector<Track>>("getVariantTracks");
 }
 
 AsyncResults<std::vector<LanguageRole>> Player::GetTextLanguagesAndRoles()
     const {
-  DCHECK(!JsManagerImpl::Instance()->MainThread()->BelongsToCurrentThread());
+  DCHECK(!impl_->manager()->MainThread()->BelongsToCurrentThread());
   return impl_->CallPlayerMethod<std::vector<LanguageRole>>(
       "getTextLanguagesAndRoles");
 }
@@ -549,101 +910,192 @@ AsyncResults<BufferedRange> Player::SeekRange() const {
   return impl_->CallPlayerMethod<BufferedRange>("seekRange");
 }
 
+AsyncResults<Player::PlaybackStatus> Player::GetPlaybackStatus() const {
+  DCHECK(!impl_->manager()->MainThread()->BelongsToCurrentThread());
+  return impl_->CallGetPlaybackStatus();
+}
+
+PlayerStateSnapshot Player::GetStateSnapshot() const {
+  return impl_->GetStateSnapshot();
+}
+
+
+void Player::IsAudioOnly(ResultsCallback<bool> callback,
+                         Executor executor) const {
+  impl_->CallPlayerMethodAsync<bool>("isAudioOnly", callback, executor);
+}
+
+void Player::IsBuffering(ResultsCallback<bool> callback,
+                         Executor executor) const {
+  impl_->CallPlayerMethodAsync<bool>("isBuffering", callback, executor);
+}
+
+void Player::IsInProgress(ResultsCallback<bool> callback,
+                          Executor executor) const {
+  impl_->CallPlayerMethodAsync<bool>("isInProgress", callback, executor);
+}
+
+void Player::IsLive(ResultsCallback<bool> callback, Executor executor) const {
+  impl_->CallPlayerMethodAsync<bool>("isLive", callback, executor);
+}
+
+void Player::IsTextTrackVisible(ResultsCallback<bool> callback,
+                                Executor executor) const {
+  impl_->CallPlayerMethodAsync<bool>("isTextTrackVisible", callback, executor);
+}
+
+void Player::UsingEmbeddedTextTrack(ResultsCallback<bool> callback,
+                                    Executor executor) const {
+  impl_->CallPlayerMethodAsync<bool>("usingEmbeddedTextTrack", callback,
+                                     executor);
+}
+
+void Player::AssetUri(ResultsCallback<optional<std::string>> callback,
+                      Executor executor) const {
+  impl_->CallPlayerMethodAsync<optional<std::string>>("assetUri", callback,
+                                                      executor);
+}
+
+void Player::GetBufferedInfo(ResultsCallback<BufferedInfo> callback,
+                             Executor executor) const {
+  impl_->CallPlayerMethodAsync<BufferedInfo>("getBufferedInfo", callback,
+                                             executor);
+}
+
+void Player::GetExpiration(ResultsCallback<double> callback,
+                           Executor executor) const {
+  impl_->CallPlayerMethodAsync<double>("getExpiration", callback, executor);
+}
+
+void Player::GetStats(ResultsCallback<Stats> callback,
+                      Executor executor) const {
+  impl_->CallPlayerMethodAsync<Stats>("getStats", callback, executor);
+}
+
+void Player::GetTextTracks(ResultsCallback<std::vector<Track>> callback,
+                           Executor executor) const {
+  impl_->CallPlayerMethodAsync<std::vector<Track>>("getTextTracks", callback,
+                                                   executor);
+}
+
+void Player::GetVariantTracks(ResultsCallback<std::vector<Track>> callback,
+                              Executor executor) const {
+  impl_->CallPlayerMethodAsync<std::vector<Track>>("getVariantTracks",
+                                                   callback, executor);
+}
+
+void Player::KeySystem(ResultsCallback<std::string> callback,
+                       Executor executor) const {
+  impl_->CallPlayerMethodAsync<std::string>("keySystem", callback, executor);
+}
+
+void Player::SeekRange(ResultsCallback<BufferedRange> callback,
+                       Executor executor) const {
+  impl_->CallPlayerMethodAsync<BufferedRange>("seekRange", callback, executor);
+}
+
+void Player::GetPlaybackStatus(ResultsCallback<PlaybackStatus> callback,
+                               Executor executor) const {
+  impl_->CallGetPlaybackStatusAsync(callback, executor);
+}
+
 
 AsyncResults<void> Player::Load(const std::string& manifest_uri,
                                 double start_time) {
-  DCHECK(!JsManagerImpl::Instance()->MainThread()->BelongsToCurrentThread());
+  DCHECK(!impl_->manager()->MainThread()->BelongsToCurrentThread());
+  impl_->PostSetRefreshing(true);
   return impl_->CallPlayerPromiseMethod<void>("load", manifest_uri,
                                               LoadHelper(start_time));
 }
 
 AsyncResults<void> Player::Unload() {
-  DCHECK(!JsManagerImpl::Instance()->MainThread()->BelongsToCurrentThread());
+  DCHECK(!impl_->manager()->MainThread()->BelongsToCurrentThread());
+  impl_->PostSetRefreshing(false);
   return impl_->CallPlayerPromiseMethod<void>("unload");
 }
 
 AsyncResults<bool> Player::Configure(const std::string& name_path,
                                      DefaultValueType value) {
-  DCHECK(!JsManagerImpl::Instance()->MainThread()->BelongsToCurrentThread());
+  DCHECK(!impl_->manager()->MainThread()->BelongsToCurrentThread());
   return impl_->CallPlayerMethod<bool>("configure", name_path, value);
 }
 
 AsyncResults<bool> Player::Configure(const std::string& name_path, bool value) {
-  DCHECK(!JsManagerImpl::Instance()->MainThread()->BelongsToCurrentThread());
+  DCHECK(!impl_->manager()->MainThread()->BelongsToCurrentThread());
   return impl_->CallPlayerMethod<bool>("configure", name_path, value);
 }
 
 AsyncResults<bool> Player::Configure(const std::string& name_path,
                                      double value) {
-  DCHECK(!JsManagerImpl::Instance()->MainThread()->BelongsToCurrentThread());
+  DCHECK(!impl_->manager()->MainThread()->BelongsToCurrentThread());
   return impl_->CallPlayerMethod<bool>("configure", name_path, value);
 }
 
 AsyncResults<bool> Player::Configure(const std::string& name_path,
                                      const std::string& value) {
-  DCHECK(!JsManagerImpl::Instance()->MainThread()->BelongsToCurrentThread());
+  DCHECK(!impl_->manager()->MainThread()->BelongsToCurrentThread());
   return impl_->CallPlayerMethod<bool>("configure", name_path, value);
 }
 
 AsyncResults<bool> Player::GetConfigurationBool(const std::string& name_path) {
-  DCHECK(!JsManagerImpl::Instance()->MainThread()->BelongsToCurrentThread());
+  DCHECK(!impl_->manager()->MainThread()->BelongsToCurrentThread());
   return impl_->GetConfigValue<bool>(name_path);
 }
 
 AsyncResults<double> Player::GetConfigurationDouble(
     const std::string& name_path) {
-  DCHECK(!JsManagerImpl::Instance()->MainThread()->BelongsToCurrentThread());
+  DCHECK(!impl_->manager()->MainThread()->BelongsToCurrentThread());
   return impl_->GetConfigValue<double>(name_path);
 }
 
 AsyncResults<std::string> Player::GetConfigurationString(
     const std::string& name_path) {
-  DCHECK(!JsManagerImpl::Instance()->MainThread()->BelongsToCurrentThread());
+  DCHECK(!impl_->manager()->MainThread()->BelongsToCurrentThread());
   return impl_->GetConfigValue<std::string>(name_path);
 }
 
 
 AsyncResults<void> Player::ResetConfiguration() {
-  DCHECK(!JsManagerImpl::Instance()->MainThread()->BelongsToCurrentThread());
+  DCHECK(!impl_->manager()->MainThread()->BelongsToCurrentThread());
   return impl_->CallPlayerMethod<void>("resetConfiguration");
 }
 
 AsyncResults<void> Player::RetryStreaming() {
-  DCHECK(!JsManagerImpl::Instance()->MainThread()->BelongsToCurrentThread());
+  DCHECK(!impl_->manager()->MainThread()->BelongsToCurrentThread());
   return impl_->CallPlayerMethod<void>("retryStreaming");
 }
 
 AsyncResults<void> Player::SelectAudioLanguage(const std::string& language,
                                                optional<std::string> role) {
-  DCHECK(!JsManagerImpl::Instance()->MainThread()->BelongsToCurrentThread());
+  DCHECK(!impl_->manager()->MainThread()->BelongsToCurrentThread());
   return impl_->CallPlayerMethod<void>("selectAudioLanguage", language, role);
 }
 
 AsyncResults<void> Player::SelectEmbeddedTextTrack() {
-  DCHECK(!JsManagerImpl::Instance()->MainThread()->BelongsToCurrentThread());
+  DCHECK(!impl_->manager()->MainThread()->BelongsToCurrentThread());
   return impl_->CallPlayerMethod<void>("selectEmbeddedTextTrack");
 }
 
 AsyncResults<void> Player::SelectTextLanguage(const std::string& language,
                                               optional<std::string> role) {
-  DCHECK(!JsManagerImpl::Instance()->MainThread()->BelongsToCurrentThread());
+  DCHECK(!impl_->manager()->MainThread()->BelongsToCurrentThread());
   return impl_->CallPlayerMethod<void>("selectTextLanguage", language, role);
 }
 
 AsyncResults<void> Player::SelectTextTrack(const Track& track) {
-  DCHECK(!JsManagerImpl::Instance()->MainThread()->BelongsToCurrentThread());
+  DCHECK(!impl_->manager()->MainThread()->BelongsToCurrentThread());
   return impl_->CallPlayerMethod<void>("selectTextTrack", track.GetInternal());
 }
 
 AsyncResults<void> Player::SelectVariantTrack(const Track& track,
                                               bool clear_buffer) {
-  DCHECK(!JsManagerImpl::Instance()->MainThread()->BelongsToCurrentThread());
+  DCHECK(!impl_->manager()->MainThread()->BelongsToCurrentThread());
   return impl_->CallPlayerMethod<void>("selectVariantTrack",
                                        track.GetInternal(), clear_buffer);
 }
 
 AsyncResults<void> Player::SetTextTrackVisibility(bool visibility) {
-  DCHECK(!JsManagerImpl::Instance()->MainThread()->BelongsToCurrentThread());
+  DCHECK(!impl_->manager()->MainThread()->BelongsToCurrentThread());
   return impl_->CallPlayerMethod<void>("setTextTrackVisibility", visibility);
 }
 
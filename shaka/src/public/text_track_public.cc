@@ -24,7 +24,7 @@ using JSTextTrack = js::mse::TextTrack;
 
 class TextTrack::Impl : public util::JSWrapper<JSTextTrack> {
  public:
-  explicit Impl(JSTextTrack* inner) {
+  explicit Impl(JSTextTrack* inner) : JSWrapper(JsManagerImpl::Instance()) {
     this->inner = inner;
   }
 };
@@ -46,20 +46,18 @@ void TextTrack::SetCueChangeEventListener(std::function<void()> callback) {
   auto task = PlainCallbackTask([=]() {
     impl_->inner->SetCppEventListener(js::EventType::CueChange, callback);
   });
-  const std::string task_name = "TextTrack SetCueChangeEventListener";
-  JsManagerImpl::Instance()
-      ->MainThread()
-      ->AddInternalTask(TaskPriority::Internal, task_name, task)
+  impl_->manager->MainThread()
+      ->AddInternalTask(TaskPriority::Internal,
+                        "TextTrack SetCueChangeEventListener", task)
       ->GetValue();
 }
 
 void TextTrack::UnsetCueChangeEventListener() {
   auto task = PlainCallbackTask(
       [=]() { impl_->inner->UnsetCppEventListener(js::EventType::CueChange); });
-  const std::string task_name = "TextTrack UnsetCueChangeEventListener";
-  JsManagerImpl::Instance()
-      ->MainThread()
-      ->AddInternalTask(TaskPriority::Internal, task_name, task)
+  impl_->manager->MainThread()
+      ->AddInternalTask(TaskPriority::Internal,
+                        "TextTrack UnsetCueChangeEventListener", task)
       ->GetValue();
 }
 
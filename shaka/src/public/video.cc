@@ -24,11 +24,13 @@ namespace shaka {
 
 using JSVideo = js::mse::HTMLVideoElement;
 
-class Video::Impl : public util::JSWrapper<JSVideo> {};
+class Video::Impl : public util::JSWrapper<JSVideo> {
+ public:
+  explicit Impl(JsManagerImpl* manager) : JSWrapper(manager) {}
+};
 
-Video::Video(JsManager* engine) : impl_(new Impl) {
-  CHECK(engine) << "Must pass a JsManager instance";
-}
+Video::Video(JsManager* engine)
+    : impl_(new Impl(JsManagerImpl::Get(engine))) {}
 
 Video::Video(Video&&) = default;
 
@@ -44,8 +46,7 @@ void Video::Initialize() {
     impl_->inner =
         new js::mse::HTMLVideoElement(js::dom::Document::GetGlobalDocument());
   };
-  JsManagerImpl::Instance()
-      ->MainThread()
+  impl_->manager->MainThread()
       ->AddInternalTask(TaskPriority::Internal, "Video init",
                         PlainCallbackTask(callback))
       ->GetValue();
@@ -53,6 +54,7 @@ void Video::Initialize() {
 
 Frame Video::DrawFrame(double* delay) {
   DCHECK(impl_->inner) << "Must call Initialize.";
+  JsManagerImpl::ThreadScope scope(impl_->manager);
   RefPtr<js::mse::MediaSource> source = impl_->inner->GetMediaSource();
   if (!source)
     return Frame();
@@ -85,6 +87,7 @@ void Video::SetMuted(bool muted) {
 }
 
 std::vector<TextTrack> Video::TextTracks() {
+  JsManagerImpl::ThreadScope scope(impl_->manager);
   std::vector<Member<js::mse::TextTrack>> original =
       impl_->GetMemberVariable(&JSVideo::text_tracks);
 
@@ -131,6 +134,19 @@ void Video::Pause() {
   impl_->CallInnerMethod(&JSVideo::Pause);
 }
 
+PipelineMetrics Video::GetPipelineMetrics() const {
+  DCHECK(impl_->inner) << "Must call Initialize.";
+  JsManagerImpl::ThreadScope scope(impl_->manager);
+  PipelineMetrics ret;
+  ret.network_bytes_received = impl_->manager->network_bytes_received();
+  ret.network_requests_in_flight = impl_->manager->network_requests_in_flight();
+
+  RefPtr<js::mse::MediaSource> source = impl_->inner->GetMediaSource();
+  if (source)
+    source->GetController()->GetPipelineMetrics(&ret);
+  return ret;
+}
+
 js::mse::HTMLVideoElement* Video::GetJavaScriptObject() {
   DCHECK(impl_->inner) << "Must call Initialize.";
   return impl_->inner;
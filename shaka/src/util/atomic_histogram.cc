@@ -0,0 +1,62 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/util/atomic_histogram.h"
+
+namespace shaka {
+namespace util {
+
+namespace {
+
+size_t GetBucket(uint64_t micros) {
+  // Bucket i holds [2^(i-1), 2^i), so the bucket is the number of bits needed
+  // to store the value.
+  size_t bucket = 0;
+  while (micros != 0 && bucket < LatencyHistogram::kBucketCount - 1) {
+    micros >>= 1;
+    bucket++;
+  }
+  return bucket;
+}
+
+}  // namespace
+
+AtomicHistogram::AtomicHistogram() : count_(0), total_us_(0), max_us_(0) {
+  for (auto& bucket : buckets_)
+    bucket.store(0, std::memory_order_relaxed);
+}
+
+AtomicHistogram::~AtomicHistogram() {}
+
+void AtomicHistogram::Record(uint64_t micros) {
+  buckets_[GetBucket(micros)].fetch_add(1, std::memory_order_relaxed);
+  total_us_.fetch_add(micros, std::memory_order_relaxed);
+  uint64_t max = max_us_.load(std::memory_order_relaxed);
+  while (micros > max &&
+         !max_us_.compare_exchange_weak(max, micros,
+                                        std::memory_order_relaxed)) {
+  }
+  count_.fetch_add(1, std::memory_order_release);
+}
+
+void AtomicHistogram::CopyTo(LatencyHistogram* histogram) const {
+  histogram->count = count_.load(std::memory_order_acquire);
+  histogram->total_us = total_us_.load(std::memory_order_relaxed);
+  histogram->max_us = max_us_.load(std::memory_order_relaxed);
+  for (size_t i = 0; i < LatencyHistogram::kBucketCount; i++)
+    histogram->buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+}
+
+}  // namespace util
+}  // namespace shaka
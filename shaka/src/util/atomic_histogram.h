@@ -0,0 +1,71 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SHAKA_EMBEDDED_UTIL_ATOMIC_HISTOGRAM_H_
+#define SHAKA_EMBEDDED_UTIL_ATOMIC_HISTOGRAM_H_
+
+#include <stdint.h>
+
+#include <atomic>
+#include <chrono>
+
+#include "shaka/pipeline_metrics.h"
+#include "src/util/macros.h"
+
+namespace shaka {
+namespace util {
+
+/**
+ * A latency histogram that can be recorded to and read from any thread without
+ * locking.  This uses the same buckets as LatencyHistogram.  Since the fields
+ * are updated separately, a copy made while samples are being recorded may be
+ * off by the samples in progress.
+ */
+class AtomicHistogram {
+ public:
+  using TimePoint = std::chrono::steady_clock::time_point;
+
+  AtomicHistogram();
+  ~AtomicHistogram();
+
+  NON_COPYABLE_OR_MOVABLE_TYPE(AtomicHistogram);
+
+  /** @return The current time, for use with RecordSince. */
+  static TimePoint Now() {
+    return std::chrono::steady_clock::now();
+  }
+
+  /** Records a sample of the given number of microseconds. */
+  void Record(uint64_t micros);
+
+  /** Records a sample of the time since |start|. */
+  void RecordSince(TimePoint start) {
+    Record(std::chrono::duration_cast<std::chrono::microseconds>(Now() - start)
+               .count());
+  }
+
+  /** Copies the recorded samples to the given histogram. */
+  void CopyTo(LatencyHistogram* histogram) const;
+
+ private:
+  std::atomic<uint64_t> count_;
+  std::atomic<uint64_t> total_us_;
+  std::atomic<uint64_t> max_us_;
+  std::atomic<uint64_t> buckets_[LatencyHistogram::kBucketCount];
+};
+
+}  // namespace util
+}  // namespace shaka
+
+#endif  // SHAKA_EMBEDDED_UTIL_ATOMIC_HISTOGRAM_H_
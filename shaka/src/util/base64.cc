@@ -0,0 +1,371 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/util/base64.h"
+
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  define BASE64_USE_SSSE3
+#  include <tmmintrin.h>
+#elif defined(__aarch64__)
+#  define BASE64_USE_NEON
+#  include <arm_neon.h>
+#endif
+
+namespace shaka {
+namespace util {
+
+namespace {
+
+constexpr const char kStandardCodes[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+constexpr const char kUrlCodes[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+/** A value in the decode tables for characters that aren't in the alphabet. */
+constexpr const uint8_t kInvalid = 0xff;
+
+/** Maps each character to its 6-bit value, or kInvalid. */
+struct DecodeTables {
+  DecodeTables() {
+    memset(standard, kInvalid, sizeof(standard));
+    memset(url, kInvalid, sizeof(url));
+    for (uint8_t i = 0; i < 64; i++) {
+      standard[static_cast<uint8_t>(kStandardCodes[i])] = i;
+      // Decoding URL-safe strings has always accepted both alphabets.
+      url[static_cast<uint8_t>(kStandardCodes[i])] = i;
+      url[static_cast<uint8_t>(kUrlCodes[i])] = i;
+    }
+  }
+
+  uint8_t standard[256];
+  uint8_t url[256];
+};
+
+const uint8_t* GetDecodeTable(bool url) {
+  static const DecodeTables tables;
+  return url ? tables.url : tables.standard;
+}
+
+
+// The vectorized functions below process whole blocks at the start of the
+// input and return the number of input bytes they consumed; the scalar code
+// handles the rest.  Decoding stops at the first block with an invalid
+// character so the scalar code can report it.
+
+#ifdef BASE64_USE_SSSE3
+bool HasSsse3() {
+  static const bool has_ssse3 = __builtin_cpu_supports("ssse3");
+  return has_ssse3;
+}
+
+__attribute__((target("ssse3"))) size_t EncodeBlocksSsse3(const uint8_t* in,
+                                                          size_t size,
+                                                          bool url,
+                                                          char* out) {
+  // Spreads each 3 bytes over 4 bytes so each 6-bit value can be shifted into
+  // its own byte.
+  const __m128i spread =
+      _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+  // The offsets to add to each range of 6-bit values to get the character.
+  const __m128i offsets = _mm_setr_epi8(
+      'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+      '0' - 52, '0' - 52, '0' - 52, '0' - 52, (url ? '-' : '+') - 62,
+      (url ? '_' : '/') - 63, 'A', 0, 0);
+
+  size_t i = 0;
+  // Each step uses 12 bytes of input, but loads 16.
+  for (; i + 16 <= size; i += 12) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+    v = _mm_shuffle_epi8(v, spread);
+    const __m128i high = _mm_mulhi_epu16(
+        _mm_and_si128(v, _mm_set1_epi32(0x0fc0fc00)),
+        _mm_set1_epi32(0x04000040));
+    const __m128i low = _mm_mullo_epi16(
+        _mm_and_si128(v, _mm_set1_epi32(0x003f03f0)),
+        _mm_set1_epi32(0x01000010));
+    const __m128i values = _mm_or_si128(high, low);
+
+    // Map 0-25 to 13, 26-51 to 0, 52-61 to 1-10, 62 to 11, and 63 to 12.
+    __m128i range = _mm_subs_epu8(values, _mm_set1_epi8(51));
+    const __m128i is_upper = _mm_cmpgt_epi8(_mm_set1_epi8(26), values);
+    range = _mm_or_si128(range, _mm_and_si128(is_upper, _mm_set1_epi8(13)));
+    const __m128i chars =
+        _mm_add_epi8(values, _mm_shuffle_epi8(offsets, range));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i / 3 * 4), chars);
+  }
+  return i;
+}
+
+__attribute__((target("ssse3"))) __m128i InRange(__m128i v, char low,
+                                                 char high) {
+  return _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(low - 1)),
+                       _mm_cmpgt_epi8(_mm_set1_epi8(high + 1), v));
+}
+
+__attribute__((target("ssse3"))) __m128i Offset(__m128i mask, char offset) {
+  return _mm_and_si128(mask, _mm_set1_epi8(offset));
+}
+
+__attribute__((target("ssse3"))) size_t DecodeBlocksSsse3(const uint8_t* in,
+                                                          size_t size,
+                                                          bool url,
+                                                          uint8_t* out) {
+  size_t i = 0;
+  for (; i + 16 <= size; i += 16) {
+    const __m128i v =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+    // Characters >= 0x80 are negative, so they aren't in any of the ranges.
+    const __m128i upper = InRange(v, 'A', 'Z');
+    const __m128i lower = InRange(v, 'a', 'z');
+    const __m128i digit = InRange(v, '0', '9');
+    const __m128i plus = _mm_cmpeq_epi8(v, _mm_set1_epi8('+'));
+    const __m128i slash = _mm_cmpeq_epi8(v, _mm_set1_epi8('/'));
+    __m128i valid =
+        _mm_or_si128(_mm_or_si128(upper, lower),
+                     _mm_or_si128(digit, _mm_or_si128(plus, slash)));
+    __m128i shift = _mm_or_si128(
+        _mm_or_si128(Offset(upper, -'A'), Offset(lower, 26 - 'a')),
+        _mm_or_si128(Offset(digit, 52 - '0'),
+                     _mm_or_si128(Offset(plus, 62 - '+'),
+                                  Offset(slash, 63 - '/'))));
+    if (url) {
+      const __m128i dash = _mm_cmpeq_epi8(v, _mm_set1_epi8('-'));
+      const __m128i underscore = _mm_cmpeq_epi8(v, _mm_set1_epi8('_'));
+      valid = _mm_or_si128(valid, _mm_or_si128(dash, underscore));
+      shift = _mm_or_si128(shift, _mm_or_si128(Offset(dash, 62 - '-'),
+                                               Offset(underscore, 63 - '_')));
+    }
+    if (_mm_movemask_epi8(valid) != 0xffff)
+      break;
+
+    // Merge pairs of 6-bit values into 12 bits, then pairs of those into 24
+    // bits, then pack the 3 bytes of each 32-bit value in big-endian order.
+    const __m128i values = _mm_add_epi8(v, shift);
+    const __m128i pairs =
+        _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+    const __m128i merged = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+    const __m128i packed = _mm_shuffle_epi8(
+        merged,
+        _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+    uint8_t block[16];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(block), packed);
+    memcpy(out + i / 4 * 3, block, 12);
+  }
+  return i;
+}
+#endif  // BASE64_USE_SSSE3
+
+#ifdef BASE64_USE_NEON
+uint8x16x4_t LoadTable(const uint8_t* table) {
+  uint8x16x4_t ret;
+  ret.val[0] = vld1q_u8(table);
+  ret.val[1] = vld1q_u8(table + 16);
+  ret.val[2] = vld1q_u8(table + 32);
+  ret.val[3] = vld1q_u8(table + 48);
+  return ret;
+}
+
+size_t EncodeBlocksNeon(const uint8_t* in, size_t size, bool url, char* out) {
+  const uint8x16x4_t codes = LoadTable(
+      reinterpret_cast<const uint8_t*>(url ? kUrlCodes : kStandardCodes));
+  const uint8x16_t mask = vdupq_n_u8(0x3f);
+
+  size_t i = 0;
+  for (; i + 48 <= size; i += 48) {
+    // Load 3 interleaved vectors so each lane holds one 3-byte group.
+    const uint8x16x3_t src = vld3q_u8(in + i);
+    uint8x16x4_t dest;
+    dest.val[0] = vshrq_n_u8(src.val[0], 2);
+    dest.val[1] = vandq_u8(
+        vorrq_u8(vshlq_n_u8(src.val[0], 4), vshrq_n_u8(src.val[1], 4)), mask);
+    dest.val[2] = vandq_u8(
+        vorrq_u8(vshlq_n_u8(src.val[1], 2), vshrq_n_u8(src.val[2], 6)), mask);
+    dest.val[3] = vandq_u8(src.val[2], mask);
+    for (auto& value : dest.val)
+      value = vqtbl4q_u8(codes, value);
+    vst4q_u8(reinterpret_cast<uint8_t*>(out + i / 3 * 4), dest);
+  }
+  return i;
+}
+
+size_t DecodeBlocksNeon(const uint8_t* in, size_t size, bool url,
+                        uint8_t* out) {
+  // Only the first 128 characters can be valid.
+  const uint8_t* table = GetDecodeTable(url);
+  const uint8x16x4_t low_table = LoadTable(table);
+  const uint8x16x4_t high_table = LoadTable(table + 64);
+
+  size_t i = 0;
+  for (; i + 64 <= size; i += 64) {
+    uint8x16x4_t src = vld4q_u8(in + i);
+    // Both kInvalid and characters >= 0x80 have the high bit set.
+    uint8x16_t invalid = vdupq_n_u8(0);
+    for (auto& value : src.val) {
+      const uint8x16_t low = vqtbl4q_u8(low_table, value);
+      const uint8x16_t decoded =
+          vqtbx4q_u8(low, high_table, vsubq_u8(value, vdupq_n_u8(64)));
+      invalid = vorrq_u8(invalid, vorrq_u8(value, decoded));
+      value = decoded;
+    }
+    if (vmaxvq_u8(invalid) & 0x80)
+      break;
+
+    uint8x16x3_t dest;
+    dest.val[0] =
+        vorrq_u8(vshlq_n_u8(src.val[0], 2), vshrq_n_u8(src.val[1], 4));
+    dest.val[1] =
+        vorrq_u8(vshlq_n_u8(src.val[1], 4), vshrq_n_u8(src.val[2], 2));
+    dest.val[2] = vorrq_u8(vshlq_n_u8(src.val[2], 6), src.val[3]);
+    vst3q_u8(out + i / 4 * 3, dest);
+  }
+  return i;
+}
+#endif  // BASE64_USE_NEON
+
+size_t EncodeBlocks(const uint8_t* in, size_t size, bool url, char* out) {
+#if defined(BASE64_USE_SSSE3)
+  if (HasSsse3())
+    return EncodeBlocksSsse3(in, size, url, out);
+#elif defined(BASE64_USE_NEON)
+  return EncodeBlocksNeon(in, size, url, out);
+#endif
+  return 0;
+}
+
+size_t DecodeBlocks(const uint8_t* in, size_t size, bool url, uint8_t* out) {
+#if defined(BASE64_USE_SSSE3)
+  if (HasSsse3())
+    return DecodeBlocksSsse3(in, size, url, out);
+#elif defined(BASE64_USE_NEON)
+  return DecodeBlocksNeon(in, size, url, out);
+#endif
+  return 0;
+}
+
+
+// https://en.wikipedia.org/wiki/Base64
+// Text    |       M        |       a       |       n        |
+// ASCI    |   77 (0x4d)    |   97 (0x61)   |   110 (0x6e)   |
+// Bits    | 0 1 0 0 1 1 0 1 0 1 1 0 0 0 0 1 0 1 1 0 1 1 1 0 |
+// Index   |     19     |     22    |      5    |     46     |
+// Base64  |      T     |      W    |      F    |      u     |
+//         | <-----------------  24-bits  -----------------> |
+
+std::string Encode(const uint8_t* data, size_t size, bool url) {
+  if (size == 0)
+    return "";
+
+  const size_t remaining = size % 3;
+  size_t out_size = size / 3 * 4;
+  if (remaining != 0)
+    out_size += url ? remaining + 1 : 4;
+  std::string result(out_size, '\0');
+
+  const char* codes = url ? kUrlCodes : kStandardCodes;
+  size_t i = EncodeBlocks(data, size, url, &result[0]);
+  size_t out_i = i / 3 * 4;
+  for (; i + 3 <= size; i += 3) {
+    const uint32_t temp = (data[i] << 16) | (data[i + 1] << 8) | data[i + 2];
+    result[out_i++] = codes[temp >> 18];
+    result[out_i++] = codes[(temp >> 12) & 0x3f];
+    result[out_i++] = codes[(temp >> 6) & 0x3f];
+    result[out_i++] = codes[temp & 0x3f];
+  }
+
+  if (remaining != 0) {
+    uint32_t temp = data[i] << 16;
+    if (remaining == 2)
+      temp |= data[i + 1] << 8;
+    result[out_i++] = codes[temp >> 18];
+    result[out_i++] = codes[(temp >> 12) & 0x3f];
+    if (remaining == 2)
+      result[out_i++] = codes[(temp >> 6) & 0x3f];
+    if (!url) {
+      while (out_i < out_size)
+        result[out_i++] = '=';
+    }
+  }
+  return result;
+}
+
+bool Decode(const char* data, size_t size, bool url,
+            std::vector<uint8_t>* result) {
+  // Padding can only appear at the end, but there can be any amount of it.
+  const char* padding = static_cast<const char*>(memchr(data, '=', size));
+  const size_t length = padding ? padding - data : size;
+  for (size_t i = length; i < size; i++) {
+    if (data[i] != '=')
+      return false;
+  }
+  if (length % 4 == 1)
+    return false;
+
+  result->resize(length / 4 * 3 + (length % 4 ? length % 4 - 1 : 0));
+  if (result->empty())
+    return true;
+
+  const uint8_t* in = reinterpret_cast<const uint8_t*>(data);
+  const uint8_t* table = GetDecodeTable(url);
+  uint8_t* out = result->data();
+  size_t i = DecodeBlocks(in, length, url, out);
+  out += i / 4 * 3;
+  for (; i + 4 <= length; i += 4) {
+    const uint32_t a = table[in[i]];
+    const uint32_t b = table[in[i + 1]];
+    const uint32_t c = table[in[i + 2]];
+    const uint32_t d = table[in[i + 3]];
+    if ((a | b | c | d) > 0x3f)
+      return false;
+    const uint32_t temp = (a << 18) | (b << 12) | (c << 6) | d;
+    *out++ = temp >> 16;
+    *out++ = (temp >> 8) & 0xff;
+    *out++ = temp & 0xff;
+  }
+
+  if (i < length) {
+    const uint32_t a = table[in[i]];
+    const uint32_t b = table[in[i + 1]];
+    const uint32_t c = length - i == 3 ? table[in[i + 2]] : 0;
+    if ((a | b | c) > 0x3f)
+      return false;
+    *out++ = (a << 2) | (b >> 4);
+    if (length - i == 3)
+      *out++ = ((b << 4) | (c >> 2)) & 0xff;
+  }
+  return true;
+}
+
+}  // namespace
+
+std::string Base64Encode(const uint8_t* data, size_t size) {
+  return Encode(data, size, /* url */ false);
+}
+
+std::string Base64EncodeUrl(const uint8_t* data, size_t size) {
+  return Encode(data, size, /* url */ true);
+}
+
+bool Base64Decode(const char* data, size_t size, std::vector<uint8_t>* result) {
+  return Decode(data, size, /* url */ false, result);
+}
+
+bool Base64DecodeUrl(const char* data, size_t size,
+                     std::vector<uint8_t>* result) {
+  return Decode(data, size, /* url */ true, result);
+}
+
+}  // namespace util
+}  // namespace shaka
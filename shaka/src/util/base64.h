@@ -0,0 +1,59 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SHAKA_EMBEDDED_UTIL_BASE64_H_
+#define SHAKA_EMBEDDED_UTIL_BASE64_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+namespace shaka {
+namespace util {
+
+/**
+ * Encodes the given data using the standard base64 alphabet, with padding.
+ * Large inputs are encoded using SIMD instructions when the CPU supports them.
+ */
+std::string Base64Encode(const uint8_t* data, size_t size);
+
+/**
+ * Encodes the given data using the URL-safe base64 alphabet ('-' and '_'),
+ * without padding.
+ */
+std::string Base64EncodeUrl(const uint8_t* data, size_t size);
+
+/**
+ * Decodes the given standard base64 string into |result|.  Padding is
+ * optional, but if present, it must only appear at the end.
+ *
+ * @return True on success, false if the input is not correctly encoded.
+ */
+bool Base64Decode(const char* data, size_t size, std::vector<uint8_t>* result);
+
+/**
+ * Decodes the given base64 string into |result|.  This accepts both the
+ * URL-safe and the standard alphabets.
+ *
+ * @return True on success, false if the input is not correctly encoded.
+ */
+bool Base64DecodeUrl(const char* data, size_t size,
+                     std::vector<uint8_t>* result);
+
+}  // namespace util
+}  // namespace shaka
+
+#endif  // SHAKA_EMBEDDED_UTIL_BASE64_H_
@@ -51,9 +51,9 @@ uint64_t BufferReader::ReadInteger(size_t size, Endianness endianness) {
   const size_t to_read = std::min(size, size_);
   for (size_t i = 0; i < to_read; i++) {
     if (endianness == kBigEndian)
-      ret |= data_[i] << ((size - i - 1) * 8);
+      ret |= static_cast<uint64_t>(data_[i]) << ((size - i - 1) * 8);
     else
-      ret |= data_[i] << (i * 8);
+      ret |= static_cast<uint64_t>(data_[i]) << (i * 8);
   }
 
   data_ += to_read;
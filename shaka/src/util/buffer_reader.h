@@ -44,6 +44,11 @@ class BufferReader {
     return size_;
   }
 
+  /** @return A pointer to the current read position. */
+  const uint8_t* data() const {
+    return data_;
+  }
+
   /** Resets the buffer that this type will read from. */
   void SetBuffer(const uint8_t* data, size_t data_size);
 
@@ -69,6 +74,14 @@ class BufferReader {
     return static_cast<uint8_t>(ReadInteger(1, kBigEndian));
   }
 
+  /**
+   * Reads a 16-bit integer from the buffer.  See ReadUint32 for how partial
+   * reads are handled.
+   */
+  uint16_t ReadUint16(Endianness endianness = kBigEndian) {
+    return static_cast<uint16_t>(ReadInteger(2, endianness));
+  }
+
   /**
    * Reads a 32-bit integer from the buffer.  If there aren't enough bytes, this
    * will fill remaining bytes with 0s.  For example, in big-endian, if this
@@ -78,6 +91,14 @@ class BufferReader {
     return static_cast<uint32_t>(ReadInteger(4, endianness));
   }
 
+  /**
+   * Reads a 64-bit integer from the buffer.  See ReadUint32 for how partial
+   * reads are handled.
+   */
+  uint64_t ReadUint64(Endianness endianness = kBigEndian) {
+    return ReadInteger(8, endianness);
+  }
+
  private:
   uint64_t ReadInteger(size_t size, Endianness endianness);
 
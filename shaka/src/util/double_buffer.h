@@ -0,0 +1,101 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SHAKA_EMBEDDED_UTIL_DOUBLE_BUFFER_H_
+#define SHAKA_EMBEDDED_UTIL_DOUBLE_BUFFER_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#include <atomic>
+#include <type_traits>
+
+#include "src/util/macros.h"
+
+namespace shaka {
+namespace util {
+
+/**
+ * Holds a value that is written by one thread at a time and can be read from
+ * any thread without locking.  There are two copies of the value; the writer
+ * always writes to the one readers aren't using, then makes it the current
+ * one.  Each copy is guarded by a sequence number, so a reader that is still
+ * copying when the writer reuses its copy (i.e. after two more writes) will
+ * notice and retry.
+ *
+ * Writers must be serialized by the caller, e.g. by only writing from one
+ * thread or while holding a lock.  Since values are copied with memcpy, the
+ * type must be trivially copyable.
+ */
+template <typename T>
+class DoubleBuffer {
+ public:
+  static_assert(std::is_trivially_copyable<T>::value,
+                "DoubleBuffer can only hold trivially copyable types");
+
+  DoubleBuffer() : DoubleBuffer(T()) {}
+  explicit DoubleBuffer(const T& value) : current_(0) {
+    for (auto& slot : slots_) {
+      slot.sequence.store(0, std::memory_order_relaxed);
+      memcpy(&slot.value, &value, sizeof(T));
+    }
+  }
+
+  NON_COPYABLE_OR_MOVABLE_TYPE(DoubleBuffer);
+
+  /** @return A copy of the most recently stored value. */
+  T Load() const {
+    T ret;
+    while (true) {
+      const Slot& slot = slots_[current_.load(std::memory_order_acquire) & 1];
+      const uint32_t before = slot.sequence.load(std::memory_order_acquire);
+      if (before & 1)
+        continue;  // The writer has already come back to this slot.
+
+      memcpy(&ret, &slot.value, sizeof(T));
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (slot.sequence.load(std::memory_order_relaxed) == before)
+        return ret;
+    }
+  }
+
+  /** Stores a new value.  Calls to this must not happen concurrently. */
+  void Store(const T& value) {
+    const uint32_t next = current_.load(std::memory_order_relaxed) + 1;
+    Slot& slot = slots_[next & 1];
+    const uint32_t sequence = slot.sequence.load(std::memory_order_relaxed);
+
+    // An odd sequence number marks the slot as being written.
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(&slot.value, &value, sizeof(T));
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+
+    current_.store(next, std::memory_order_release);
+  }
+
+ private:
+  struct Slot {
+    std::atomic<uint32_t> sequence;
+    T value;
+  };
+
+  Slot slots_[2];
+  std::atomic<uint32_t> current_;
+};
+
+}  // namespace util
+}  // namespace shaka
+
+#endif  // SHAKA_EMBEDDED_UTIL_DOUBLE_BUFFER_H_
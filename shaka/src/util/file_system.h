@@ -15,6 +15,7 @@
 #ifndef SHAKA_EMBEDDED_UTIL_FILE_SYSTEM_H_
 #define SHAKA_EMBEDDED_UTIL_FILE_SYSTEM_H_
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -23,6 +24,33 @@
 namespace shaka {
 namespace util {
 
+/**
+ * A read-only view of the contents of a file that is mapped into memory.  The
+ * pages are shared with the OS page cache, so mapping the same file in
+ * multiple processes doesn't use more memory.
+ */
+class MappedFile {
+ public:
+  ~MappedFile();
+
+  NON_COPYABLE_OR_MOVABLE_TYPE(MappedFile);
+
+  const uint8_t* data() const {
+    return data_;
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+ private:
+  friend class FileSystem;
+  MappedFile(const uint8_t* data, size_t size);
+
+  const uint8_t* data_;
+  size_t size_;
+};
+
 /**
  * An abstraction of the file system.  This manages interactions with the file
  * system like reading and writing files.
@@ -65,6 +93,28 @@ class FileSystem {
    */
   MUST_USE_RESULT virtual bool DeleteFile(const std::string& path) const;
 
+  /**
+   * Renames the given file, replacing any file at the new path.  The files
+   * need to be on the same file system; then readers will see either the old
+   * or the new file, never a partial one.
+   * @param from The path to the file to rename.
+   * @param to The new path for the file.
+   * @return True on success, false on error.
+   */
+  MUST_USE_RESULT virtual bool RenameFile(const std::string& from,
+                                          const std::string& to) const;
+
+  /**
+   * Creates a new path for the given file, failing if the new path already
+   * exists.  Like RenameFile, readers of the new path will see the whole file;
+   * this is used to create a file only if another process hasn't already.
+   * @param from The path to the existing file.
+   * @param to The new path for the file.
+   * @return True on success, false on error or if |to| exists.
+   */
+  MUST_USE_RESULT virtual bool LinkFile(const std::string& from,
+                                        const std::string& to) const;
+
   /**
    * Creates a directory (and any parent directories) at the given path.
    * @param path The path to the directory to create.
@@ -90,6 +140,17 @@ class FileSystem {
   MUST_USE_RESULT virtual bool ReadFile(const std::string& path,
                                         std::vector<uint8_t>* data) const;
 
+  /**
+   * Maps the contents of the given file into memory.  This should be used
+   * instead of ReadFile for large files that don't need to be modified.
+   *
+   * @param path The path of the file to map.
+   * @param file [OUT] Will contain the mapped file.
+   * @return True on success, false on error.
+   */
+  MUST_USE_RESULT virtual bool MapFile(
+      const std::string& path, std::shared_ptr<MappedFile>* file) const;
+
   /**
    * @param path The path of the file to write to.
    * @param data The data to write into the file.
@@ -15,7 +15,10 @@
 #include "src/util/file_system.h"
 
 #include <dirent.h>
+#include <fcntl.h>
 #include <libgen.h>
+#include <stdio.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
@@ -30,6 +33,14 @@ const char kDirectorySeparator = '/';
 
 }  // namespace
 
+MappedFile::MappedFile(const uint8_t* data, size_t size)
+    : data_(data), size_(size) {}
+
+MappedFile::~MappedFile() {
+  if (size_ > 0 && munmap(const_cast<uint8_t*>(data_), size_) != 0)
+    PLOG(ERROR) << "Error unmapping file";
+}
+
 // static
 std::string FileSystem::PathJoin(const std::string& a, const std::string& b) {
   if (b.empty())
@@ -65,6 +76,16 @@ bool FileSystem::DeleteFile(const std::string& path) const {
   return unlink(path.c_str()) == 0;
 }
 
+bool FileSystem::RenameFile(const std::string& from,
+                            const std::string& to) const {
+  return rename(from.c_str(), to.c_str()) == 0;
+}
+
+bool FileSystem::LinkFile(const std::string& from,
+                          const std::string& to) const {
+  return link(from.c_str(), to.c_str()) == 0;
+}
+
 bool FileSystem::CreateDirectory(const std::string& path) const {
   std::string::size_type pos = 0;
   while ((pos = path.find(kDirectorySeparator, pos + 1)) != std::string::npos) {
@@ -103,5 +124,39 @@ bool FileSystem::ListFiles(const std::string& path,
   return true;
 }
 
+bool FileSystem::MapFile(const std::string& path,
+                         std::shared_ptr<MappedFile>* file) const {
+  const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    PLOG(ERROR) << "Error opening file '" << path << "'";
+    return false;
+  }
+
+  struct stat info;
+  if (fstat(fd, &info) != 0) {
+    PLOG(ERROR) << "Error getting file size '" << path << "'";
+    close(fd);
+    return false;
+  }
+
+  // mmap doesn't allow empty mappings, so just use an empty buffer.
+  const size_t size = static_cast<size_t>(info.st_size);
+  void* data = nullptr;
+  if (size > 0) {
+    // The mapping keeps its own reference to the file, so we can close the
+    // file descriptor now.
+    data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+      PLOG(ERROR) << "Error mapping file '" << path << "'";
+      close(fd);
+      return false;
+    }
+  }
+  close(fd);
+
+  file->reset(new MappedFile(static_cast<const uint8_t*>(data), size));
+  return true;
+}
+
 }  // namespace util
 }  // namespace shaka
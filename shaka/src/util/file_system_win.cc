@@ -21,6 +21,13 @@
 namespace shaka {
 namespace util {
 
+MappedFile::MappedFile(const uint8_t* data, size_t size)
+    : data_(data), size_(size) {}
+
+MappedFile::~MappedFile() {
+#error "Not implemented for Windows"
+}
+
 // static
 std::string FileSystem::PathJoin(const std::string& a, const std::string& b) {
   std::string ret(MAX_PATH, '\0');
@@ -53,5 +60,10 @@ bool FileSystem::ListFiles(const std::string& path,
   return true;
 }
 
+bool FileSystem::MapFile(const std::string& path,
+                         std::shared_ptr<MappedFile>* file) const {
+#error "Not implemented for Windows"
+}
+
 }  // namespace util
 }  // namespace shaka
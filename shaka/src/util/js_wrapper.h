@@ -15,25 +15,36 @@
 #ifndef SHAKA_EMBEDDED_JS_WRAPPER_H_
 #define SHAKA_EMBEDDED_JS_WRAPPER_H_
 
+#include "src/core/js_manager_impl.h"
 #include "src/core/ref_ptr.h"
 
 namespace shaka {
 namespace util {
 
+/**
+ * A helper for public types that wrap a JavaScript object.  These are used on
+ * app threads, so this binds the manager that owns the object while calling
+ * into it.
+ */
 template <typename T>
 class JSWrapper {
  public:
+  JsManagerImpl* const manager;
   RefPtr<T> inner;
 
-  JSWrapper() {}
+  explicit JSWrapper(JsManagerImpl* manager) : manager(manager) {}
+  ~JSWrapper() {
+    JsManagerImpl::ThreadScope scope(manager);
+    inner.reset();
+  }
   NON_COPYABLE_OR_MOVABLE_TYPE(JSWrapper);
 
   template <typename Func, typename... Args>
   auto CallInnerMethod(Func member, Args... args)
       -> decltype((inner->*member)(args...)) {
     DCHECK(inner) << "Must call Initialize.";
-    return JsManagerImpl::Instance()
-        ->MainThread()
+    JsManagerImpl::ThreadScope scope(manager);
+    return manager->MainThread()
         ->AddInternalTask(TaskPriority::Internal, "",
                           PlainCallbackTask(std::bind(member, inner, args...)))
         ->GetValue();
@@ -42,9 +53,9 @@ class JSWrapper {
   template <typename Var, typename Val>
   void SetMemberVariable(Var member, Val val) {
     DCHECK(inner) << "Must call Initialize.";
+    JsManagerImpl::ThreadScope scope(manager);
     auto callback = [this, member, val]() { inner->*member = val; };
-    JsManagerImpl::Instance()
-        ->MainThread()
+    manager->MainThread()
         ->AddInternalTask(TaskPriority::Internal, "",
                           PlainCallbackTask(callback))
         ->GetValue();
@@ -53,8 +64,8 @@ class JSWrapper {
   template <typename Var>
   auto GetMemberVariable(Var member) -> decltype(inner->*member) {
     DCHECK(inner) << "Must call Initialize.";
-    return JsManagerImpl::Instance()
-        ->MainThread()
+    JsManagerImpl::ThreadScope scope(manager);
+    return manager->MainThread()
         ->AddInternalTask(TaskPriority::Internal, "",
                           PlainCallbackTask(std::bind(member, inner)))
         ->GetValue();
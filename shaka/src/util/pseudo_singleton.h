@@ -17,18 +17,26 @@
 
 #include <glog/logging.h>
 
+#include <algorithm>
 #include <atomic>
+#include <mutex>
 #include <type_traits>
+#include <vector>
 
 #include "src/util/macros.h"
 
 namespace shaka {
 
 /**
- * A base class for types that should only have one instance at a time.  This
+ * A base class for types that usually have one instance at a time.  This
  * defines a static method to get the instance that will be inherited to the
  * type.  This type is fully thread-safe and can be used on any thread.
  *
+ * There can be more than one instance alive (e.g. one per JsManager).  In that
+ * case, a thread needs to bind the instance it uses with a
+ * ScopedThreadInstance; Instance() returns the instance bound to the current
+ * thread, or the only instance alive if the thread isn't bound.
+ *
  * The type argument should be the type itself.  For example:
  *
  * class Foo : public PseudoSingleton<Foo> {};
@@ -41,17 +49,42 @@ class PseudoSingleton {
    * of this object's lifetime.
    */
   struct UnsetForTesting {
-    UnsetForTesting()
-        : value_(instance_.exchange(nullptr, std::memory_order_acq_rel)) {}
+    UnsetForTesting() {
+      std::unique_lock<std::mutex> lock(GetMutex());
+      values_.swap(GetInstances());
+      UpdateInstance();
+    }
 
     ~UnsetForTesting() {
-      T* expected = nullptr;
-      CHECK(instance_.compare_exchange_strong(expected, value_,
-                                              std::memory_order_acq_rel));
+      std::unique_lock<std::mutex> lock(GetMutex());
+      CHECK(GetInstances().empty());
+      GetInstances().swap(values_);
+      UpdateInstance();
+    }
+
+   private:
+    std::vector<T*> values_;
+  };
+
+  /**
+   * An RAII type that makes the given instance the one returned by Instance()
+   * on the current thread for the duration of this object's lifetime.  These
+   * can be nested and must be destroyed on the thread that created them.
+   */
+  class ScopedThreadInstance {
+   public:
+    explicit ScopedThreadInstance(T* value) : previous_(thread_instance_) {
+      thread_instance_ = value;
     }
 
+    ~ScopedThreadInstance() {
+      thread_instance_ = previous_;
+    }
+
+    NON_COPYABLE_OR_MOVABLE_TYPE(ScopedThreadInstance);
+
    private:
-    T* value_;
+    T* const previous_;
   };
 
   // Since the base class is initialized first, the virtual pointers in *this
@@ -59,34 +92,72 @@ class PseudoSingleton {
   // invalid cast.
   NO_SANITIZE("vptr")
   PseudoSingleton() {
-    T* expected = nullptr;
-    CHECK(instance_.compare_exchange_strong(expected, static_cast<T*>(this),
-                                            std::memory_order_acq_rel));
+    std::unique_lock<std::mutex> lock(GetMutex());
+    GetInstances().push_back(static_cast<T*>(this));
+    UpdateInstance();
   }
 
+  NO_SANITIZE("vptr")
   ~PseudoSingleton() {
-    T* expected = static_cast<T*>(this);
-    CHECK(instance_.compare_exchange_strong(expected, nullptr,
-                                            std::memory_order_acq_rel));
+    std::unique_lock<std::mutex> lock(GetMutex());
+    auto& instances = GetInstances();
+    auto it = std::find(instances.begin(), instances.end(),
+                        static_cast<T*>(this));
+    CHECK(it != instances.end());
+    instances.erase(it);
+    UpdateInstance();
   }
 
   static T* Instance() {
-    T* ret = instance_.load(std::memory_order_acquire);
-    CHECK(ret);
+    T* ret = InstanceOrNull();
+    CHECK(ret) << "No instance is bound to this thread; with several "
+                  "instances alive, use a ScopedThreadInstance.";
     return ret;
   }
 
   static T* InstanceOrNull() {
-    return instance_.load(std::memory_order_acquire);
+    T* ret = thread_instance_;
+    return ret ? ret : instance_.load(std::memory_order_acquire);
+  }
+
+  /** @return The instance bound to the current thread, if any. */
+  static T* ThreadInstanceOrNull() {
+    return thread_instance_;
   }
 
  private:
+  static std::mutex& GetMutex() {
+    BEGIN_ALLOW_COMPLEX_STATICS
+    static std::mutex mutex;
+    END_ALLOW_COMPLEX_STATICS
+    return mutex;
+  }
+
+  static std::vector<T*>& GetInstances() {
+    BEGIN_ALLOW_COMPLEX_STATICS
+    static std::vector<T*> instances;
+    END_ALLOW_COMPLEX_STATICS
+    return instances;
+  }
+
+  /** Updates |instance_|; must be called with the mutex held. */
+  static void UpdateInstance() {
+    auto& instances = GetInstances();
+    instance_.store(instances.size() == 1 ? instances[0] : nullptr,
+                    std::memory_order_release);
+  }
+
+  // The only instance alive, or nullptr if there are zero or several.
   static std::atomic<T*> instance_;
+  static thread_local T* thread_instance_;
 };
 
 template <typename T>
 std::atomic<T*> PseudoSingleton<T>::instance_{nullptr};
 
+template <typename T>
+thread_local T* PseudoSingleton<T>::thread_instance_ = nullptr;
+
 }  // namespace shaka
 
 #endif  // SHAKA_EMBEDDED_UTIL_PSEUDO_SINGLETON_H_
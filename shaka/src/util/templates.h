@@ -15,6 +15,8 @@
 #ifndef SHAKA_EMBEDDED_UTIL_TEMPLATES_H_
 #define SHAKA_EMBEDDED_UTIL_TEMPLATES_H_
 
+#include <stddef.h>
+
 #include <type_traits>
 
 #if defined(USING_V8)
@@ -58,6 +60,24 @@ struct decay_is_same
 template <bool B, typename T = void>
 using enable_if_t = typename std::enable_if<B, T>::type;
 
+/**
+ * A C++11 version of std::index_sequence.  This is used to expand the values
+ * of a std::tuple into an argument list.
+ */
+template <size_t... I>
+struct index_sequence {};
+
+template <size_t N, size_t... I>
+struct make_index_sequence_helper
+    : make_index_sequence_helper<N - 1, N - 1, I...> {};
+template <size_t... I>
+struct make_index_sequence_helper<0, I...> {
+  using type = index_sequence<I...>;
+};
+
+template <size_t N>
+using make_index_sequence = typename make_index_sequence_helper<N>::type;
+
 }  // namespace util
 }  // namespace shaka
 
@@ -0,0 +1,70 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#include <string>
+
+#include "shaka/js_manager.h"
+#include "src/media/media_processor.h"
+#include "src/test/benchmark.h"
+#include "src/test/media_files.h"
+#include "src/util/file_system.h"
+#include "src/util/macros.h"
+
+namespace shaka {
+
+namespace {
+
+BEGIN_ALLOW_COMPLEX_STATICS
+DEFINE_string(benchmark_filter, ".",
+              "A regex of the names of the benchmarks to run.");
+DEFINE_string(benchmark_format, "console",
+              "The format of the results printed to stdout: console or json.");
+DEFINE_string(benchmark_out, "",
+              "If set, also writes the results as JSON to this file.");
+DEFINE_double(benchmark_min_time, 0.5,
+              "The minimum number of seconds to run each benchmark for.");
+END_ALLOW_COMPLEX_STATICS
+
+int RunAllBenchmarks(int argc, char** argv) {
+  const std::string data_dir = util::FileSystem::DirName(argv[0]);
+
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+
+  InitMediaFiles(argv[0]);
+  media::MediaProcessor::Initialize();
+
+  // Some of the media benchmarks post events to the main thread, so this needs
+  // a JavaScript engine running.
+  JsManager::StartupOptions opts;
+  opts.dynamic_data_dir = data_dir;
+  opts.static_data_dir = data_dir;
+  opts.is_static_relative_to_bundle = true;
+  JsManager engine(opts);
+
+  return benchmark::RunBenchmarks(FLAGS_benchmark_filter,
+                                  FLAGS_benchmark_format, FLAGS_benchmark_out,
+                                  FLAGS_benchmark_min_time);
+}
+
+}  // namespace
+
+}  // namespace shaka
+
+int main(int argc, char** argv) {
+  return shaka::RunAllBenchmarks(argc, argv);
+}
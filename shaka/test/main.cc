@@ -92,7 +92,7 @@ int RunTests(int argc, char** argv) {
   opts.is_static_relative_to_bundle = true;
   JsManager engine(opts);
 
-  JsManagerImpl::Instance()->MainThread()->AddInternalTask(
+  JsManagerImpl::Get(&engine)->MainThread()->AddInternalTask(
       TaskPriority::Immediate, "", PlainCallbackTask(&RegisterTestFixture));
 
   LoadJsTests();
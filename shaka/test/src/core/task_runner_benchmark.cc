@@ -0,0 +1,84 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/core/task_runner.h"
+
+#include <atomic>
+
+#include "src/test/benchmark.h"
+
+namespace shaka {
+
+namespace {
+
+void RunLoop(TaskRunner::RunLoop loop) {
+  loop();
+}
+
+void BM_TaskRunnerThroughput(benchmark::State& state) {
+  // Posts a batch of tasks and waits for them all to run.  Since tasks are
+  // picked from a list, this also shows how the cost scales with queue length.
+  const int64_t count = state.range(0);
+  TaskRunner runner(&RunLoop, /* is_worker */ true);
+  std::atomic<int64_t> ran{0};
+  while (state.KeepRunning()) {
+    for (int64_t i = 0; i < count; i++) {
+      runner.AddInternalTask(TaskPriority::Internal, "",
+                             PlainCallbackTask([&ran]() { ran++; }));
+    }
+    runner.WaitUntilFinished();
+  }
+  runner.Stop();
+  state.SetItemsProcessed(ran.load());
+}
+BENCHMARK(BM_TaskRunnerThroughput)->Arg(1)->Arg(64)->Arg(1024);
+
+void BM_TaskRunnerPostThroughput(benchmark::State& state) {
+  // The same as above, but using tasks that report their own results, like
+  // the non-blocking Player methods, so no ThreadEvent is created.
+  const int64_t count = state.range(0);
+  TaskRunner runner(&RunLoop, /* is_worker */ true);
+  std::atomic<int64_t> ran{0};
+  while (state.KeepRunning()) {
+    for (int64_t i = 0; i < count; i++) {
+      runner.PostInternalTask(TaskPriority::Internal, "",
+                              PlainCallbackTask([&ran]() { ran++; }));
+    }
+    runner.WaitUntilFinished();
+  }
+  runner.Stop();
+  state.SetItemsProcessed(ran.load());
+}
+BENCHMARK(BM_TaskRunnerPostThroughput)->Arg(1)->Arg(64)->Arg(1024);
+
+void BM_TaskRunnerRoundTrip(benchmark::State& state) {
+  // The latency of posting a task from another thread and waiting for its
+  // result, like the public API does for calls into JavaScript.
+  TaskRunner runner(&RunLoop, /* is_worker */ true);
+  int value = 0;
+  while (state.KeepRunning()) {
+    auto result = runner.AddInternalTask(
+        TaskPriority::Immediate, "", PlainCallbackTask([&value]() {
+          return ++value;
+        }));
+    benchmark::DoNotOptimize(result->GetValue());
+  }
+  runner.Stop();
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TaskRunnerRoundTrip);
+
+}  // namespace
+
+}  // namespace shaka
@@ -0,0 +1,167 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/debug/async_log.h"
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace shaka {
+
+namespace {
+
+std::string FormatNumber(double number) {
+  std::string ret;
+  AsyncLog::AppendNumber(number, &ret);
+  return ret;
+}
+
+std::unique_ptr<AsyncLog::Entry> MakeEntry(const std::string& message,
+                                           uint64_t site) {
+  std::unique_ptr<AsyncLog::Entry> entry(new AsyncLog::Entry);
+  entry->level = "Log";
+  entry->site = site;
+  entry->arguments.emplace_back(AsyncLog::Argument::kText, message);
+  return entry;
+}
+
+}  // namespace
+
+class AsyncLogTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    AsyncLog::SetOutput([this](const std::string& batch) {
+      std::unique_lock<std::mutex> lock(mutex_);
+      output_ += batch;
+    });
+  }
+
+  void TearDown() override {
+    AsyncLog::Flush();
+    AsyncLog::SetOutput(nullptr);
+  }
+
+  std::string GetOutput() {
+    AsyncLog::Flush();
+    std::unique_lock<std::mutex> lock(mutex_);
+    return output_;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::string output_;
+};
+
+TEST_F(AsyncLogTest, FormatsEntries) {
+  std::unique_ptr<AsyncLog::Entry> entry(new AsyncLog::Entry);
+  entry->level = "Error";
+  entry->prefix = "Assertion failed: ";
+  entry->arguments.emplace_back(AsyncLog::Argument::kString, "a\t\"b\"");
+  entry->arguments.emplace_back(1.5);
+  entry->arguments.emplace_back(AsyncLog::Argument::kText, "{...}");
+  entry->suffix = "  at foo";
+  ASSERT_TRUE(AsyncLog::Write(std::move(entry)));
+
+  EXPECT_EQ("[Error]: Assertion failed: \"a\\t\\\"b\\\"\"\t1.5\t{...}\n"
+            "  at foo\n",
+            GetOutput());
+}
+
+TEST_F(AsyncLogTest, KeepsOrderFromOneThread) {
+  std::string expected;
+  for (int i = 0; i < 100; i++) {
+    ASSERT_TRUE(AsyncLog::Write(MakeEntry(std::to_string(i), 0)));
+    expected += "[Log]: " + std::to_string(i) + "\n";
+  }
+  EXPECT_EQ(expected, GetOutput());
+}
+
+TEST_F(AsyncLogTest, WritesFromManyThreads) {
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; i++) {
+    threads.emplace_back([]() {
+      for (int j = 0; j < 100; j++)
+        AsyncLog::Write(MakeEntry("line", 0));
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+
+  const std::string output = GetOutput();
+  size_t count = 0;
+  for (size_t pos = output.find("[Log]: line\n"); pos != std::string::npos;
+       pos = output.find("[Log]: line\n", pos + 1)) {
+    count++;
+  }
+  EXPECT_EQ(400u, count);
+}
+
+TEST_F(AsyncLogTest, LimitsLinesPerSite) {
+  const uint64_t dropped = AsyncLog::DroppedCount();
+  const uint64_t site = AsyncLog::HashSite("Log", "LimitsLinesPerSite");
+  size_t written = 0;
+  for (int i = 0; i < 1000; i++) {
+    if (AsyncLog::Write(MakeEntry("spam", site)))
+      written++;
+  }
+
+  // The limit may be reset once if the loop crosses a second boundary.
+  EXPECT_LE(written, 2 * AsyncLog::kMaxLinesPerSecond);
+  EXPECT_EQ(1000 - written, AsyncLog::DroppedCount() - dropped);
+  EXPECT_NE(std::string::npos, GetOutput().find("log lines were dropped"));
+
+  // Other sites aren't affected.
+  EXPECT_TRUE(AsyncLog::Write(
+      MakeEntry("other", AsyncLog::HashSite("Log", "OtherSite"))));
+}
+
+TEST_F(AsyncLogTest, WritesGlogLines) {
+  AsyncLog::InstallGlogSink();
+  LOG(ERROR) << "Written by glog";
+
+  // glog lines keep the glog prefix instead of having a level added.
+  const std::string output = GetOutput();
+  EXPECT_NE(std::string::npos, output.find("async_log_unittest.cc:"));
+  EXPECT_NE(std::string::npos, output.find("] Written by glog\n"));
+  EXPECT_EQ(std::string::npos, output.find("[]: "));
+}
+
+TEST(AsyncLogFormatTest, FormatsNumbersLikeJavaScript) {
+  EXPECT_EQ("0", FormatNumber(0));
+  EXPECT_EQ("0", FormatNumber(-0.0));
+  EXPECT_EQ("12", FormatNumber(12));
+  EXPECT_EQ("-3", FormatNumber(-3));
+  EXPECT_EQ("1.5", FormatNumber(1.5));
+  EXPECT_EQ("0.1", FormatNumber(0.1));
+  EXPECT_EQ("0.30000000000000004", FormatNumber(0.1 + 0.2));
+  EXPECT_EQ("123456.789", FormatNumber(123456.789));
+  EXPECT_EQ("0.000015", FormatNumber(0.000015));
+  EXPECT_EQ("1e-7", FormatNumber(1e-7));
+  EXPECT_EQ("1.5e-10", FormatNumber(1.5e-10));
+  EXPECT_EQ("100000000000000000000", FormatNumber(1e20));
+  EXPECT_EQ("1e+21", FormatNumber(1e21));
+  EXPECT_EQ("NaN", FormatNumber(std::numeric_limits<double>::quiet_NaN()));
+  EXPECT_EQ("Infinity", FormatNumber(std::numeric_limits<double>::infinity()));
+  EXPECT_EQ("-Infinity",
+            FormatNumber(-std::numeric_limits<double>::infinity()));
+}
+
+}  // namespace shaka
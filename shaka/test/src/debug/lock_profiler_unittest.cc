@@ -0,0 +1,134 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/debug/lock_profiler.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+#include "src/util/shared_lock.h"
+
+namespace shaka {
+
+namespace {
+
+// Since the stats are global, the tests compare against the stats before the
+// test so they can be run repeatedly.
+LockProfiler::Entry GetEntry(const std::string& name) {
+  for (auto& item : LockProfiler::GetReport()) {
+    if (item.name == name)
+      return item;
+  }
+  LockProfiler::Entry empty;
+  empty.name = name;
+  empty.acquisitions = empty.contended = 0;
+  return empty;
+}
+
+}  // namespace
+
+TEST(LockProfilerTest, SharesStatsByName) {
+  LockStats* stats = LockProfiler::GetStats("LockProfilerTest.Shared");
+  EXPECT_EQ(stats, LockProfiler::GetStats("LockProfilerTest.Shared"));
+  EXPECT_NE(stats, LockProfiler::GetStats("LockProfilerTest.Other"));
+  EXPECT_EQ("LockProfilerTest.Shared", stats->name());
+}
+
+TEST(LockProfilerTest, CountsAcquisitions) {
+  constexpr const uint32_t kCount = LockProfiler::kSampleRate * 10;
+  const LockProfiler::Entry before = GetEntry("LockProfilerTest.Counts");
+  ProfiledMutex<std::mutex> mutex("LockProfilerTest.Counts");
+  for (uint32_t i = 0; i < kCount; i++) {
+    std::unique_lock<ProfiledMutex<std::mutex>> lock(mutex);
+  }
+
+  const LockProfiler::Entry after = GetEntry("LockProfilerTest.Counts");
+  EXPECT_EQ(kCount, after.acquisitions - before.acquisitions);
+  EXPECT_EQ(0u, after.contended - before.contended);
+  // Since the sampling counter is per-thread, exactly 1 in kSampleRate calls
+  // should have been sampled.
+  EXPECT_EQ(10u, after.wait.count - before.wait.count);
+  EXPECT_EQ(10u, after.hold.count - before.hold.count);
+  EXPECT_EQ(0u, after.wait.max_us);
+}
+
+TEST(LockProfilerTest, CountsContention) {
+  const LockProfiler::Entry before = GetEntry("LockProfilerTest.Contention");
+  ProfiledMutex<std::mutex> mutex("LockProfilerTest.Contention");
+  std::atomic<bool> started{false};
+
+  mutex.lock();
+  std::thread other([&]() {
+    started = true;
+    std::unique_lock<ProfiledMutex<std::mutex>> lock(mutex);
+  });
+  while (!started)
+    std::this_thread::yield();
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  mutex.unlock();
+  other.join();
+
+  const LockProfiler::Entry after = GetEntry("LockProfilerTest.Contention");
+  EXPECT_EQ(2u, after.acquisitions - before.acquisitions);
+  EXPECT_EQ(1u, after.contended - before.contended);
+}
+
+TEST(LockProfilerTest, SupportsSharedLocks) {
+  const LockProfiler::Entry before = GetEntry("LockProfilerTest.SharedLock");
+  ProfiledMutex<util::shared_mutex> mutex("LockProfilerTest.SharedLock");
+  {
+    util::shared_lock<ProfiledMutex<util::shared_mutex>> lock1(mutex);
+    std::thread other([&]() {
+      util::shared_lock<ProfiledMutex<util::shared_mutex>> lock2(mutex);
+    });
+    other.join();
+  }
+  {
+    std::unique_lock<ProfiledMutex<util::shared_mutex>> lock(mutex);
+  }
+
+  const LockProfiler::Entry after = GetEntry("LockProfilerTest.SharedLock");
+  EXPECT_EQ(3u, after.acquisitions - before.acquisitions);
+  EXPECT_EQ(0u, after.contended - before.contended);
+}
+
+TEST(LockProfilerTest, SortsByTotalWait) {
+  LockStats* small = LockProfiler::GetStats("LockProfilerTest.SortSmall");
+  LockStats* large = LockProfiler::GetStats("LockProfilerTest.SortLarge");
+  const auto start = util::AtomicHistogram::Now() - std::chrono::seconds(1);
+  small->OnAcquiredAfterWait(/* sampled= */ true,
+                             util::AtomicHistogram::Now());
+  large->OnAcquiredAfterWait(/* sampled= */ true, start);
+
+  auto report = LockProfiler::GetReport();
+  ASSERT_FALSE(report.empty());
+  EXPECT_EQ("LockProfilerTest.SortLarge", report[0].name);
+  EXPECT_GE(report[0].EstimatedTotalWaitMs(), 1000);
+  for (size_t i = 1; i < report.size(); i++) {
+    EXPECT_LE(report[i].wait.total_us, report[i - 1].wait.total_us);
+  }
+
+  const std::string text = LockProfiler::FormatReport();
+  const size_t large_pos = text.find("LockProfilerTest.SortLarge");
+  const size_t small_pos = text.find("LockProfilerTest.SortSmall");
+  ASSERT_NE(std::string::npos, large_pos);
+  ASSERT_NE(std::string::npos, small_pos);
+  EXPECT_LT(large_pos, small_pos);
+}
+
+}  // namespace shaka
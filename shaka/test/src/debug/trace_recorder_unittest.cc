@@ -0,0 +1,164 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/debug/trace_recorder.h"
+
+#include <gtest/gtest.h>
+#include <stdio.h>
+
+#include <atomic>
+#include <string>
+
+#include "src/debug/thread.h"
+
+namespace shaka {
+
+namespace {
+
+size_t CountOccurrences(const std::string& str, const std::string& sub) {
+  size_t count = 0;
+  for (size_t pos = str.find(sub); pos != std::string::npos;
+       pos = str.find(sub, pos + sub.size())) {
+    count++;
+  }
+  return count;
+}
+
+/**
+ * Checks that each event named "EventN" was recorded with a start time of N.
+ * @return The number of events found.
+ */
+size_t CheckNumberedEvents(const std::string& json) {
+  const std::string prefix = "{\"name\":\"Event";
+  size_t count = 0;
+  for (size_t pos = json.find(prefix); pos != std::string::npos;
+       pos = json.find(prefix, pos + prefix.size())) {
+    unsigned long long name_num;  // NOLINT
+    unsigned long long ts;  // NOLINT
+    EXPECT_EQ(2, sscanf(json.c_str() + pos,
+                        "{\"name\":\"Event%llu\",\"ph\":\"X\",\"ts\":%llu",
+                        &name_num, &ts));
+    EXPECT_EQ(name_num, ts);
+    count++;
+  }
+  return count;
+}
+
+}  // namespace
+
+class TraceRecorderTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    TraceRecorder::Clear();
+  }
+
+  void TearDown() override {
+    TraceRecorder::SetEnabled(false);
+    TraceRecorder::Clear();
+  }
+};
+
+TEST_F(TraceRecorderTest, DoesNothingWhenDisabled) {
+  { ScopedTrace trace("DisabledSpan"); }
+  TraceRecorder::AddInstantEvent("DisabledInstant");
+
+  const std::string json = TraceRecorder::ExportJson();
+  EXPECT_EQ(std::string::npos, json.find("DisabledSpan"));
+  EXPECT_EQ(std::string::npos, json.find("DisabledInstant"));
+}
+
+TEST_F(TraceRecorderTest, RecordsEvents) {
+  TraceRecorder::SetEnabled(true);
+  { ScopedTrace trace("MySpan"); }
+  TraceRecorder::AddInstantEvent("MyInstant");
+
+  const std::string json = TraceRecorder::ExportJson();
+  EXPECT_EQ(0u, json.find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["));
+  EXPECT_NE(std::string::npos, json.find("{\"name\":\"MySpan\",\"ph\":\"X\""));
+  EXPECT_NE(std::string::npos,
+            json.find("{\"name\":\"MyInstant\",\"ph\":\"i\""));
+}
+
+TEST_F(TraceRecorderTest, EscapesAndTruncatesNames) {
+  TraceRecorder::SetEnabled(true);
+  { ScopedTrace trace(std::string("a\"b\\c\n")); }
+  { ScopedTrace trace(std::string(100, 'x')); }
+
+  const std::string json = TraceRecorder::ExportJson();
+  EXPECT_NE(std::string::npos, json.find("\"a\\\"b\\\\c\\u000a\""));
+  EXPECT_NE(std::string::npos,
+            json.find('"' + std::string(TraceRecorder::kMaxNameSize, 'x') +
+                      '"'));
+  EXPECT_EQ(std::string::npos,
+            json.find(std::string(TraceRecorder::kMaxNameSize + 1, 'x')));
+}
+
+TEST_F(TraceRecorderTest, KeepsNewestEventsWhenFull) {
+  TraceRecorder::SetEnabled(true);
+  TraceRecorder::AddInstantEvent("OldEvent");
+  for (size_t i = 0; i < TraceRecorder::kEventsPerThread; i++)
+    TraceRecorder::AddInstantEvent("NewEvent");
+
+  const std::string json = TraceRecorder::ExportJson();
+  EXPECT_EQ(std::string::npos, json.find("OldEvent"));
+  // The reader can't tell whether the oldest slot is being overwritten, so it
+  // always skips it once the buffer has wrapped.
+  EXPECT_EQ(TraceRecorder::kEventsPerThread - 1,
+            CountOccurrences(json, "\"NewEvent\""));
+}
+
+TEST_F(TraceRecorderTest, ClearRemovesEvents) {
+  TraceRecorder::SetEnabled(true);
+  TraceRecorder::AddInstantEvent("BeforeClear");
+  TraceRecorder::Clear();
+  TraceRecorder::AddInstantEvent("AfterClear");
+
+  const std::string json = TraceRecorder::ExportJson();
+  EXPECT_EQ(std::string::npos, json.find("BeforeClear"));
+  EXPECT_NE(std::string::npos, json.find("AfterClear"));
+}
+
+TEST_F(TraceRecorderTest, NamesThreads) {
+  TraceRecorder::SetEnabled(true);
+  Thread thread("TraceThread", []() { ScopedTrace trace("ThreadSpan"); });
+  thread.join();
+
+  const std::string json = TraceRecorder::ExportJson();
+  EXPECT_NE(std::string::npos,
+            json.find("\"args\":{\"name\":\"TraceThread\"}"));
+  EXPECT_NE(std::string::npos, json.find("ThreadSpan"));
+}
+
+TEST_F(TraceRecorderTest, ExportsWhileRecording) {
+  // Export while another thread keeps wrapping its buffer; every exported event
+  // should be whole, even when it was overwritten while it was being copied.
+  TraceRecorder::SetEnabled(true);
+  std::atomic<bool> done{false};
+  Thread thread("TraceWriter", [&]() {
+    for (uint64_t i = 0; !done.load(std::memory_order_relaxed); i++) {
+      TraceRecorder::AddCompleteEvent(("Event" + std::to_string(i)).c_str(),
+                                      i);
+    }
+  });
+
+  size_t total = 0;
+  for (int i = 0; i < 20; i++)
+    total += CheckNumberedEvents(TraceRecorder::ExportJson());
+  done.store(true, std::memory_order_relaxed);
+  thread.join();
+
+  EXPECT_GT(total, 0u);
+}
+
+}  // namespace shaka
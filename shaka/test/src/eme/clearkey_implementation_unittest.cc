@@ -33,6 +33,7 @@ class MockImplementationHelper : public ImplementationHelper {
   MOCK_CONST_METHOD4(OnMessage, void(const std::string&, MediaKeyMessageType,
                                      const uint8_t*, size_t));
   MOCK_CONST_METHOD1(OnKeyStatusChange, void(const std::string&));
+  MOCK_CONST_METHOD0(StorageKey, std::vector<uint8_t>());
 };
 
 }  // namespace
@@ -0,0 +1,264 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/eme/clearkey_license_store.h"
+
+#ifdef OS_POSIX
+#  include <ftw.h>
+#endif
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+#include <stdlib.h>
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "src/util/darwin_utils.h"
+
+namespace shaka {
+namespace eme {
+
+namespace {
+
+std::vector<ClearKeyLicenseStore::Key> MakeKeys() {
+  ClearKeyLicenseStore::Key first;
+  first.key_id = std::vector<uint8_t>(16, 0x01);
+  first.key = std::vector<uint8_t>(16, 0x02);
+  ClearKeyLicenseStore::Key second;
+  second.key_id = std::vector<uint8_t>(16, 0x03);
+  second.key = std::vector<uint8_t>(16, 0x04);
+  return {first, second};
+}
+
+void ExpectSameKeys(const std::vector<ClearKeyLicenseStore::Key>& expected,
+                    const std::vector<ClearKeyLicenseStore::Key>& actual) {
+  ASSERT_EQ(expected.size(), actual.size());
+  for (size_t i = 0; i < expected.size(); i++) {
+    EXPECT_EQ(expected[i].key_id, actual[i].key_id);
+    EXPECT_EQ(expected[i].key, actual[i].key);
+  }
+}
+
+}  // namespace
+
+class ClearKeyLicenseStoreTest : public testing::Test {
+ public:
+  void SetUp() override {
+#ifdef OS_POSIX
+#  ifdef OS_IOS
+    temp_dir = util::GetTemporaryDirectory() + "/dirXXXXXX";
+#  else
+    temp_dir = "/tmp/dirXXXXXX";
+#  endif
+    if (!mkdtemp(&temp_dir[0]))
+      PLOG(FATAL) << "Error creating temp directory";
+    // Use a sub-directory so the store has to create it.
+    store_dir = temp_dir + "/eme";
+#else
+#  error "Not implemented for Windows"
+#endif
+  }
+
+  void TearDown() override {
+#ifdef OS_POSIX
+    if (nftw(temp_dir.c_str(), DeleteItem, FOPEN_MAX, FTW_DEPTH))
+      PLOG(FATAL) << "Error traversing folder.";
+#else
+#  error "Not implemented for Windows"
+#endif
+  }
+
+ protected:
+#ifdef OS_POSIX
+  static int DeleteItem(const char* path, const struct stat* st, int flags,
+                        struct FTW*) {
+    const int status = flags == FTW_DP ? rmdir(path) : unlink(path);
+    if (status != 0) {
+      PLOG(FATAL) << "Error deleting file/directory " << path << " with status "
+                  << status;
+    }
+    return status;
+  }
+#endif
+
+  std::string temp_dir;
+  std::string store_dir;
+};
+
+TEST_F(ClearKeyLicenseStoreTest, CreatesValidSessionIds) {
+  const std::string first = ClearKeyLicenseStore::CreateSessionId();
+  const std::string second = ClearKeyLicenseStore::CreateSessionId();
+  EXPECT_TRUE(ClearKeyLicenseStore::IsValidSessionId(first));
+  EXPECT_TRUE(ClearKeyLicenseStore::IsValidSessionId(second));
+  EXPECT_NE(first, second);
+
+  EXPECT_FALSE(ClearKeyLicenseStore::IsValidSessionId(""));
+  EXPECT_FALSE(ClearKeyLicenseStore::IsValidSessionId("1"));
+  EXPECT_FALSE(ClearKeyLicenseStore::IsValidSessionId(
+      "../00000000000000000000000000000"));
+  EXPECT_FALSE(ClearKeyLicenseStore::IsValidSessionId(
+      "0000000000000000000000000000000a"));
+}
+
+TEST_F(ClearKeyLicenseStoreTest, SavesAndLoads) {
+  const std::string session_id = ClearKeyLicenseStore::CreateSessionId();
+  const std::vector<ClearKeyLicenseStore::Key> keys = MakeKeys();
+  {
+    ClearKeyLicenseStore store(store_dir);
+    EXPECT_FALSE(store.Contains(session_id));
+    ASSERT_TRUE(store.Save(session_id, keys));
+    EXPECT_TRUE(store.Contains(session_id));
+  }
+
+  // A new store should see the sessions from older ones.
+  ClearKeyLicenseStore store(store_dir);
+  EXPECT_TRUE(store.Contains(session_id));
+  std::vector<ClearKeyLicenseStore::Key> loaded;
+  ASSERT_TRUE(store.Load(session_id, &loaded));
+  ExpectSameKeys(keys, loaded);
+}
+
+TEST_F(ClearKeyLicenseStoreTest, SharesStorageKeyWhenCreatedConcurrently) {
+  // Each store creates the storage key at the same time; they should all end
+  // up using the same key.
+  constexpr const size_t kStoreCount = 8;
+  std::vector<std::string> session_ids;
+  for (size_t i = 0; i < kStoreCount; i++)
+    session_ids.push_back(ClearKeyLicenseStore::CreateSessionId());
+  const std::vector<ClearKeyLicenseStore::Key> keys = MakeKeys();
+
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < kStoreCount; i++) {
+    threads.emplace_back([&, i]() {
+      ClearKeyLicenseStore store(store_dir);
+      EXPECT_TRUE(store.Save(session_ids[i], keys));
+    });
+  }
+  for (std::thread& thread : threads)
+    thread.join();
+
+  ClearKeyLicenseStore store(store_dir);
+  for (const std::string& session_id : session_ids) {
+    std::vector<ClearKeyLicenseStore::Key> loaded;
+    ASSERT_TRUE(store.Load(session_id, &loaded));
+    ExpectSameKeys(keys, loaded);
+  }
+}
+
+TEST_F(ClearKeyLicenseStoreTest, UsesGivenStorageKey) {
+  const std::string session_id = ClearKeyLicenseStore::CreateSessionId();
+  const std::vector<ClearKeyLicenseStore::Key> keys = MakeKeys();
+  const std::vector<uint8_t> storage_key(16, 0x05);
+  {
+    ClearKeyLicenseStore store(store_dir, storage_key);
+    ASSERT_TRUE(store.Save(session_id, keys));
+  }
+
+  // The given key is used instead of one stored next to the licenses, and only
+  // the license file is left in the directory.
+  util::FileSystem fs;
+  std::vector<std::string> files;
+  ASSERT_TRUE(fs.ListFiles(store_dir, &files));
+  EXPECT_EQ(std::vector<std::string>{session_id + ".license"}, files);
+
+  ClearKeyLicenseStore store(store_dir, storage_key);
+  std::vector<ClearKeyLicenseStore::Key> loaded;
+  ASSERT_TRUE(store.Load(session_id, &loaded));
+  ExpectSameKeys(keys, loaded);
+
+  // The license can't be loaded with a different key.
+  ClearKeyLicenseStore other_store(store_dir, std::vector<uint8_t>(16, 0x06));
+  EXPECT_FALSE(other_store.Load(session_id, &loaded));
+  ClearKeyLicenseStore file_key_store(store_dir);
+  EXPECT_FALSE(file_key_store.Load(session_id, &loaded));
+}
+
+TEST_F(ClearKeyLicenseStoreTest, RejectsInvalidStorageKey) {
+  const std::string session_id = ClearKeyLicenseStore::CreateSessionId();
+  ClearKeyLicenseStore store(store_dir, std::vector<uint8_t>(8, 0x05));
+  EXPECT_FALSE(store.Save(session_id, MakeKeys()));
+  EXPECT_FALSE(store.Contains(session_id));
+}
+
+TEST_F(ClearKeyLicenseStoreTest, ReplacesLicenses) {
+  const std::string session_id = ClearKeyLicenseStore::CreateSessionId();
+  ClearKeyLicenseStore store(store_dir);
+  ASSERT_TRUE(store.Save(session_id, MakeKeys()));
+
+  std::vector<ClearKeyLicenseStore::Key> keys = MakeKeys();
+  keys.pop_back();
+  ASSERT_TRUE(store.Save(session_id, keys));
+  std::vector<ClearKeyLicenseStore::Key> loaded;
+  ASSERT_TRUE(store.Load(session_id, &loaded));
+  ExpectSameKeys(keys, loaded);
+
+  // No temporary files are left behind.
+  util::FileSystem fs;
+  std::vector<std::string> files;
+  ASSERT_TRUE(fs.ListFiles(store_dir, &files));
+  EXPECT_EQ(2u, files.size());
+}
+
+TEST_F(ClearKeyLicenseStoreTest, DoesntStoreKeysInPlainText) {
+  const std::string session_id = ClearKeyLicenseStore::CreateSessionId();
+  ClearKeyLicenseStore store(store_dir);
+  ASSERT_TRUE(store.Save(session_id, MakeKeys()));
+
+  std::ifstream file(store_dir + "/" + session_id + ".license",
+                     std::ios::binary);
+  ASSERT_TRUE(file);
+  const std::string contents((std::istreambuf_iterator<char>(file)),
+                             std::istreambuf_iterator<char>());
+  EXPECT_EQ(std::string::npos, contents.find(std::string(16, '\x02')));
+  EXPECT_EQ(std::string::npos, contents.find(std::string(16, '\x04')));
+}
+
+TEST_F(ClearKeyLicenseStoreTest, Removes) {
+  const std::string session_id = ClearKeyLicenseStore::CreateSessionId();
+  ClearKeyLicenseStore store(store_dir);
+  ASSERT_TRUE(store.Save(session_id, MakeKeys()));
+  ASSERT_TRUE(store.Remove(session_id));
+  EXPECT_FALSE(store.Contains(session_id));
+
+  std::vector<ClearKeyLicenseStore::Key> loaded;
+  EXPECT_FALSE(store.Load(session_id, &loaded));
+  // Removing a missing session isn't an error.
+  EXPECT_TRUE(store.Remove(session_id));
+}
+
+TEST_F(ClearKeyLicenseStoreTest, RejectsCorruptFiles) {
+  const std::string session_id = ClearKeyLicenseStore::CreateSessionId();
+  ClearKeyLicenseStore store(store_dir);
+  ASSERT_TRUE(store.Save(session_id, MakeKeys()));
+
+  const std::string path = store_dir + "/" + session_id + ".license";
+  {
+    std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+    ASSERT_TRUE(file);
+    file.seekg(-1, std::ios::end);
+    const char last = static_cast<char>(file.get());
+    file.seekp(-1, std::ios::end);
+    file.put(static_cast<char>(last ^ 0x01));
+  }
+
+  std::vector<ClearKeyLicenseStore::Key> loaded;
+  EXPECT_FALSE(store.Load(session_id, &loaded));
+  EXPECT_TRUE(loaded.empty());
+}
+
+}  // namespace eme
+}  // namespace shaka
@@ -0,0 +1,139 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/js/dom/xml_document_parser.h"
+
+#include <glog/logging.h>
+
+#include <string>
+
+#include "src/core/js_manager_impl.h"
+#include "src/js/dom/document.h"
+#include "src/test/benchmark.h"
+#include "src/util/utils.h"
+
+namespace shaka {
+namespace js {
+namespace dom {
+
+namespace {
+
+/** The minimum size of the generated manifest, in bytes. */
+constexpr const size_t kManifestSize = 5 * 1024 * 1024;
+
+/**
+ * Creates a live-style DASH manifest of about |kManifestSize| bytes.  Most of
+ * the size comes from long SegmentTimelines, like in real live manifests.
+ */
+std::string CreateManifest() {
+  std::string ret =
+      "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+      "<MPD xmlns=\"urn:mpeg:dash:schema:mpd:2011\" type=\"dynamic\" "
+      "availabilityStartTime=\"1970-01-01T00:00:00Z\" "
+      "minimumUpdatePeriod=\"PT2S\" timeShiftBufferDepth=\"PT4H\">\n";
+  for (int period = 0; ret.size() < kManifestSize; period++) {
+    ret += util::StringPrintf("  <Period id=\"%d\" start=\"PT%dS\">\n", period,
+                              period * 3600);
+    for (int set = 0; set < 4; set++) {
+      ret += util::StringPrintf(
+          "    <AdaptationSet id=\"%d\" contentType=\"%s\" "
+          "segmentAlignment=\"true\">\n",
+          set, set == 0 ? "audio" : "video");
+      ret +=
+          "      <SegmentTemplate timescale=\"90000\" "
+          "media=\"$RepresentationID$/$Time$.m4s\" "
+          "initialization=\"$RepresentationID$/init.mp4\">\n"
+          "        <SegmentTimeline>\n";
+      for (int i = 0; i < 1800; i++) {
+        ret += util::StringPrintf("          <S t=\"%d\" d=\"180000\" />\n",
+                                  i * 180000);
+      }
+      ret +=
+          "        </SegmentTimeline>\n"
+          "      </SegmentTemplate>\n";
+      for (int rep = 0; rep < 3; rep++) {
+        ret += util::StringPrintf(
+            "      <Representation id=\"%d_%d\" bandwidth=\"%d\" "
+            "codecs=\"avc1.4d401f\" width=\"1280\" height=\"720\" />\n",
+            set, rep, (rep + 1) * 1000000);
+      }
+      ret += "    </AdaptationSet>\n";
+    }
+    ret += "  </Period>\n";
+  }
+  ret += "</MPD>\n";
+  return ret;
+}
+
+const std::string& GetManifest() {
+  static const std::string* manifest = new std::string(CreateManifest());
+  return *manifest;
+}
+
+template <typename Func>
+void RunOnMainThread(Func&& callback) {
+  JsManagerImpl::Instance()
+      ->MainThread()
+      ->AddInternalTask(TaskPriority::Immediate, "XmlParserBenchmark",
+                        PlainCallbackTask(std::forward<Func>(callback)))
+      ->GetValue();
+}
+
+void BM_XmlParseFromString(benchmark::State& state) {
+  // The old behavior: the whole parse blocks the event thread.
+  const std::string& manifest = GetManifest();
+  while (state.KeepRunning()) {
+    RunOnMainThread([&]() {
+      XMLDocumentParser parser;
+      parser.Parse(manifest);
+      CHECK(!holds_alternative<JsError>(parser.CreateDocument()));
+    });
+  }
+  state.SetBytesProcessed(state.iterations() * manifest.size());
+}
+BENCHMARK(BM_XmlParseFromString);
+
+void BM_XmlParseBackground(benchmark::State& state) {
+  // The part of parseFromStringAsync that runs on the background thread.
+  const std::string& manifest = GetManifest();
+  while (state.KeepRunning()) {
+    XMLDocumentParser parser;
+    parser.Parse(manifest);
+  }
+  state.SetBytesProcessed(state.iterations() * manifest.size());
+}
+BENCHMARK(BM_XmlParseBackground);
+
+void BM_XmlParseEventThread(benchmark::State& state) {
+  // The part of parseFromStringAsync that blocks the event thread.
+  const std::string& manifest = GetManifest();
+  while (state.KeepRunning()) {
+    state.PauseTiming();
+    XMLDocumentParser parser;
+    parser.Parse(manifest);
+    state.ResumeTiming();
+
+    RunOnMainThread([&]() {
+      CHECK(!holds_alternative<JsError>(parser.CreateDocument()));
+    });
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_XmlParseEventThread);
+
+}  // namespace
+
+}  // namespace dom
+}  // namespace js
+}  // namespace shaka
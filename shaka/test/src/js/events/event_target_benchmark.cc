@@ -0,0 +1,132 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/js/events/event_target.h"
+
+#include <cstring>
+
+#include "src/core/js_manager_impl.h"
+#include "src/core/ref_ptr.h"
+#include "src/js/events/event.h"
+#include "src/js/events/progress_event.h"
+#include "src/mapping/callback.h"
+#include "src/mapping/js_engine.h"
+#include "src/mapping/js_wrappers.h"
+#include "src/test/benchmark.h"
+
+namespace shaka {
+namespace js {
+namespace events {
+
+namespace {
+
+/** The number of events raised per benchmark iteration. */
+constexpr const int kEventsPerIteration = 1000;
+
+/** Kept as a static string since RunScript requires it to stay alive. */
+constexpr const char kListenerScript[] =
+    "var benchmarkListener = function(e) { e.type; };";
+
+/** The kind of listener attached to the target, the benchmark argument. */
+enum ListenerKind {
+  kNoListeners = 0,
+  kCppListener = 1,
+  kJsListener = 2,
+};
+
+template <typename Func>
+void RunOnMainThread(Func&& callback) {
+  // Events are scheduled with the same priority, so this runs after any events
+  // scheduled before it.
+  JsManagerImpl::Instance()
+      ->MainThread()
+      ->AddInternalTask(TaskPriority::Events, "EventTargetBenchmark",
+                        PlainCallbackTask(std::forward<Func>(callback)))
+      ->GetValue();
+}
+
+/** Creates a new target on the event thread with the given listener. */
+RefPtr<EventTarget> CreateTarget(benchmark::State& state, EventType type) {
+  RefPtr<EventTarget> ret;
+  RunOnMainThread([&]() {
+    ret = new EventTarget;
+    if (state.range(0) == kCppListener) {
+      ret->SetCppEventListener(type, []() {});
+    } else if (state.range(0) == kJsListener) {
+      CHECK(RunScript("benchmark/event_target.js",
+                      reinterpret_cast<const uint8_t*>(kListenerScript),
+                      strlen(kListenerScript)));
+      LocalVar<JsValue> value = GetMemberRaw(
+          JsEngine::Instance()->global_handle(), "benchmarkListener");
+      Callback callback;
+      CHECK(callback.TryConvert(value));
+      ret->AddEventListener(to_string(type), callback);
+    }
+  });
+  return ret;
+}
+
+void BM_ScheduleEvent(benchmark::State& state) {
+  // Events scheduled from a background thread, like XMLHttpRequest and the
+  // media pipeline do.  Events per second are reported as items per second.
+  RefPtr<EventTarget> target = CreateTarget(state, EventType::Progress);
+  while (state.KeepRunning()) {
+    for (int i = 0; i < kEventsPerIteration; i++) {
+      target->ScheduleEvent<ProgressEvent>(EventType::Progress, true, i,
+                                           kEventsPerIteration);
+    }
+    RunOnMainThread([]() {});
+  }
+  state.SetItemsProcessed(state.iterations() * kEventsPerIteration);
+}
+BENCHMARK(BM_ScheduleEvent)
+    ->Arg(kNoListeners)
+    ->Arg(kCppListener)
+    ->Arg(kJsListener);
+
+void BM_ScheduleCoalescedEvent(benchmark::State& state) {
+  // Repeated state-change events; only one is pending on the target at a time.
+  RefPtr<EventTarget> target = CreateTarget(state, EventType::ReadyStateChange);
+  while (state.KeepRunning()) {
+    for (int i = 0; i < kEventsPerIteration; i++)
+      target->ScheduleEvent<Event>(EventType::ReadyStateChange);
+    RunOnMainThread([]() {});
+  }
+  state.SetItemsProcessed(state.iterations() * kEventsPerIteration);
+}
+BENCHMARK(BM_ScheduleCoalescedEvent)->Arg(kNoListeners)->Arg(kJsListener);
+
+void BM_RaiseEvent(benchmark::State& state) {
+  // Events raised synchronously on the event thread.
+  RefPtr<EventTarget> target = CreateTarget(state, EventType::Progress);
+  while (state.KeepRunning()) {
+    RunOnMainThread([&]() {
+      for (int i = 0; i < kEventsPerIteration; i++) {
+        target->RaiseEvent<ProgressEvent>(EventType::Progress, true, i,
+                                          kEventsPerIteration);
+      }
+    });
+  }
+  state.SetItemsProcessed(state.iterations() * kEventsPerIteration);
+}
+BENCHMARK(BM_RaiseEvent)
+    ->Arg(kNoListeners)
+    ->Arg(kCppListener)
+    ->Arg(kJsListener);
+
+}  // namespace
+
+}  // namespace events
+}  // namespace js
+}  // namespace shaka
@@ -0,0 +1,176 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/mapping/register_member.h"
+
+#include <cstring>
+#include <functional>
+#include <string>
+
+#include "src/core/js_manager_impl.h"
+#include "src/mapping/convert_js.h"
+#include "src/mapping/js_engine.h"
+#include "src/mapping/js_wrappers.h"
+#include "src/test/benchmark.h"
+
+namespace shaka {
+
+namespace {
+
+/** The number of native calls made per benchmark iteration. */
+constexpr const int kCallsPerIteration = 1000;
+
+/**
+ * Each script defines a global |benchmarkBody| function that makes the given
+ * number of calls into a TestType object.  These are kept as static strings
+ * since RunScript requires the source to live as long as the isolate.
+ */
+struct BindingCase {
+  const char* name;
+  const char* script;
+};
+
+const BindingCase kBindingCases[] = {
+    {"js_baseline",
+     "var benchmarkBody = (function() {\n"
+     "  var obj = { acceptNumber: function(x) {} };\n"
+     "  return function(n) {\n"
+     "    for (var i = 0; i < n; i++) obj.acceptNumber(i);\n"
+     "  };\n"
+     "})();"},
+    {"accept_number",
+     "var benchmarkBody = (function() {\n"
+     "  var t = new TestType();\n"
+     "  return function(n) {\n"
+     "    for (var i = 0; i < n; i++) t.acceptNumber(i);\n"
+     "  };\n"
+     "})();"},
+    {"accept_boolean",
+     "var benchmarkBody = (function() {\n"
+     "  var t = new TestType();\n"
+     "  return function(n) {\n"
+     "    for (var i = 0; i < n; i++) t.acceptBoolean(true);\n"
+     "  };\n"
+     "})();"},
+    {"accept_short_string",
+     "var benchmarkBody = (function() {\n"
+     "  var t = new TestType();\n"
+     "  return function(n) {\n"
+     "    for (var i = 0; i < n; i++) t.acceptString('video/mp4');\n"
+     "  };\n"
+     "})();"},
+    {"accept_long_string",
+     "var benchmarkBody = (function() {\n"
+     "  var t = new TestType();\n"
+     "  var str = new Array(1025).join('x');\n"
+     "  return function(n) {\n"
+     "    for (var i = 0; i < n; i++) t.acceptString(str);\n"
+     "  };\n"
+     "})();"},
+    {"accept_string_enum",
+     "var benchmarkBody = (function() {\n"
+     "  var t = new TestType();\n"
+     "  return function(n) {\n"
+     "    for (var i = 0; i < n; i++) t.acceptStringEnum('auto');\n"
+     "  };\n"
+     "})();"},
+    {"accept_struct",
+     "var benchmarkBody = (function() {\n"
+     "  var t = new TestType();\n"
+     "  var opts = { string: 'abc', boolean: true };\n"
+     "  return function(n) {\n"
+     "    for (var i = 0; i < n; i++) t.acceptStruct(opts);\n"
+     "  };\n"
+     "})();"},
+    {"accept_array_of_strings",
+     "var benchmarkBody = (function() {\n"
+     "  var t = new TestType();\n"
+     "  var arr = ['abc', 'def', 'ghi'];\n"
+     "  return function(n) {\n"
+     "    for (var i = 0; i < n; i++) t.acceptArrayOfStrings(arr);\n"
+     "  };\n"
+     "})();"},
+    {"get_string",
+     "var benchmarkBody = (function() {\n"
+     "  var t = new TestType();\n"
+     "  return function(n) {\n"
+     "    for (var i = 0; i < n; i++) t.getString();\n"
+     "  };\n"
+     "})();"},
+    {"get_struct",
+     "var benchmarkBody = (function() {\n"
+     "  var t = new TestType();\n"
+     "  return function(n) {\n"
+     "    for (var i = 0; i < n; i++) t.getStruct();\n"
+     "  };\n"
+     "})();"},
+};
+
+/** Runs the benchmark loop on the JavaScript main thread. */
+void RunOnMainThread(benchmark::State& state, const BindingCase& test) {
+  const std::string path = std::string("benchmark/") + test.name + ".js";
+  if (!RunScript(path, reinterpret_cast<const uint8_t*>(test.script),
+                 strlen(test.script))) {
+    state.SkipWithError("Error running benchmark script");
+    return;
+  }
+  LocalVar<JsValue> body_value =
+      GetMemberRaw(JsEngine::Instance()->global_handle(), "benchmarkBody");
+  if (GetValueType(body_value) != JSValueType::Function) {
+    state.SkipWithError("Benchmark script didn't define benchmarkBody");
+    return;
+  }
+  LocalVar<JsFunction> body = UnsafeJsCast<JsFunction>(body_value);
+
+  while (state.KeepRunning()) {
+#ifdef USING_V8
+    // Don't let the handles from each iteration build up.
+    v8::HandleScope handles(GetIsolate());
+#endif
+    LocalVar<JsValue> args[] = {ToJsValue(kCallsPerIteration)};
+    LocalVar<JsValue> result;
+    if (!InvokeMethod(body, JsEngine::Instance()->global_handle(), 1, args,
+                      &result)) {
+      state.SkipWithError(ConvertToString(result));
+      return;
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kCallsPerIteration);
+}
+
+void BindingBenchmark(benchmark::State& state, const BindingCase& test) {
+  // Calls per second are reported as items per second.
+  JsManagerImpl::Instance()
+      ->MainThread()
+      ->AddInternalTask(TaskPriority::Immediate, "RegisterMemberBenchmark",
+                        PlainCallbackTask(std::bind(&RunOnMainThread,
+                                                    std::ref(state),
+                                                    std::cref(test))))
+      ->GetValue();
+}
+
+bool RegisterBindingBenchmarks() {
+  for (const BindingCase& test : kBindingCases) {
+    benchmark::RegisterBenchmark(
+        std::string("BM_Binding/") + test.name,
+        std::bind(&BindingBenchmark, std::placeholders::_1, std::cref(test)));
+  }
+  return true;
+}
+
+__attribute__((unused)) const bool kRegistered = RegisterBindingBenchmarks();
+
+}  // namespace
+
+}  // namespace shaka
@@ -0,0 +1,127 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/mapping/struct.h"
+
+#include <string>
+
+#include "src/core/js_manager_impl.h"
+#include "src/mapping/convert_js.h"
+#include "src/mapping/js_wrappers.h"
+#include "src/test/benchmark.h"
+
+namespace shaka {
+
+namespace {
+
+/** The number of conversions made per benchmark iteration. */
+constexpr const int kCallsPerIteration = 1000;
+
+/** A Struct with the same shape as the numeric fields of Player::GetStats(). */
+struct BenchmarkStats : Struct {
+  static std::string name() {
+    return "BenchmarkStats";
+  }
+
+  ADD_DICT_FIELD(double, width);
+  ADD_DICT_FIELD(double, height);
+  ADD_DICT_FIELD(double, streamBandwidth);
+  ADD_DICT_FIELD(double, decodedFrames);
+  ADD_DICT_FIELD(double, droppedFrames);
+  ADD_DICT_FIELD(double, corruptedFrames);
+  ADD_DICT_FIELD(double, estimatedBandwidth);
+  ADD_DICT_FIELD(double, loadLatency);
+  ADD_DICT_FIELD(double, manifestTimeSeconds);
+  ADD_DICT_FIELD(double, drmTimeSeconds);
+  ADD_DICT_FIELD(double, playTime);
+  ADD_DICT_FIELD(double, pauseTime);
+  ADD_DICT_FIELD(double, bufferingTime);
+  ADD_DICT_FIELD(double, licenseTime);
+  ADD_DICT_FIELD(double, liveLatency);
+  ADD_DICT_FIELD(double, maxSegmentDuration);
+};
+
+template <typename Func>
+void RunOnMainThread(Func&& callback) {
+  JsManagerImpl::Instance()
+      ->MainThread()
+      ->AddInternalTask(TaskPriority::Immediate, "StructBenchmark",
+                        PlainCallbackTask(std::forward<Func>(callback)))
+      ->GetValue();
+}
+
+void BM_StructRoundTrip(benchmark::State& state) {
+  // Converts a stats object to JavaScript and back, like a GetStats() call
+  // where the JavaScript side builds the object.
+  BenchmarkStats stats;
+  stats.width = 1920;
+  stats.height = 1080;
+  stats.estimatedBandwidth = 5e6;
+  while (state.KeepRunning()) {
+    RunOnMainThread([&]() {
+      for (int i = 0; i < kCallsPerIteration; i++) {
+#ifdef USING_V8
+        v8::HandleScope handles(GetIsolate());
+#endif
+        LocalVar<JsValue> value = ToJsValue(stats);
+        BenchmarkStats result;
+        CHECK(FromJsValue(value, &result));
+        benchmark::DoNotOptimize(result.width);
+      }
+    });
+  }
+  state.SetItemsProcessed(state.iterations() * kCallsPerIteration);
+}
+BENCHMARK(BM_StructRoundTrip);
+
+void BM_GetMemberDynamicName(benchmark::State& state) {
+  // A property read that has to create a new string for the name.
+  const std::string name = "estimatedBandwidth";
+  while (state.KeepRunning()) {
+    RunOnMainThread([&]() {
+#ifdef USING_V8
+      v8::HandleScope handles(GetIsolate());
+#endif
+      BenchmarkStats stats;
+      LocalVar<JsValue> value = ToJsValue(stats);
+      LocalVar<JsObject> object = UnsafeJsCast<JsObject>(value);
+      for (int i = 0; i < kCallsPerIteration; i++)
+        benchmark::DoNotOptimize(GetMemberRaw(object, name));
+    });
+  }
+  state.SetItemsProcessed(state.iterations() * kCallsPerIteration);
+}
+BENCHMARK(BM_GetMemberDynamicName);
+
+void BM_GetMemberPropertyName(benchmark::State& state) {
+  // The same read using an interned name.
+  while (state.KeepRunning()) {
+    RunOnMainThread([&]() {
+#ifdef USING_V8
+      v8::HandleScope handles(GetIsolate());
+#endif
+      BenchmarkStats stats;
+      LocalVar<JsValue> value = ToJsValue(stats);
+      LocalVar<JsObject> object = UnsafeJsCast<JsObject>(value);
+      for (int i = 0; i < kCallsPerIteration; i++)
+        benchmark::DoNotOptimize(GetMemberRaw(object, "estimatedBandwidth"));
+    });
+  }
+  state.SetItemsProcessed(state.iterations() * kCallsPerIteration);
+}
+BENCHMARK(BM_GetMemberPropertyName);
+
+}  // namespace
+
+}  // namespace shaka
@@ -0,0 +1,125 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/mapping/struct.h"
+
+#include <gtest/gtest.h>
+#include <stdlib.h>
+
+#include <new>
+#include <string>
+#include <utility>
+
+// This replaces the global operator new, so it is built as its own test
+// executable (see BUILD.gn) rather than being part of the main tests.
+
+namespace {
+
+// Allocations are only counted on the thread that is running the test and only
+// while an AllocationCounter exists.
+thread_local bool counting_allocations_ = false;
+thread_local size_t allocation_count_ = 0;
+
+}  // namespace
+
+void* operator new(size_t size) {
+  if (counting_allocations_)
+    allocation_count_++;
+  void* ret = malloc(size ? size : 1);
+  if (!ret)
+    throw std::bad_alloc();
+  return ret;
+}
+
+void operator delete(void* ptr) noexcept {
+  free(ptr);
+}
+
+namespace shaka {
+
+namespace {
+
+class AllocationCounter {
+ public:
+  AllocationCounter() {
+    allocation_count_ = 0;
+    counting_allocations_ = true;
+  }
+  ~AllocationCounter() {
+    counting_allocations_ = false;
+  }
+
+  size_t count() const {
+    return allocation_count_;
+  }
+};
+
+struct TestStruct : Struct {
+  static std::string name() {
+    return "TestStruct";
+  }
+
+  ADD_DICT_FIELD(double, number);
+  ADD_DICT_FIELD(bool, flag);
+  ADD_DICT_FIELD(std::string, string);
+};
+
+struct OuterStruct : Struct {
+  static std::string name() {
+    return "OuterStruct";
+  }
+
+  ADD_DICT_FIELD(double, before);
+  ADD_DICT_FIELD(TestStruct, inner);
+  ADD_DICT_FIELD(double, after);
+};
+
+}  // namespace
+
+TEST(StructTest, DoesNotAllocatePerInstance) {
+  // The first instance builds the field table for the type.
+  { TestStruct first; }
+
+  AllocationCounter counter;
+  TestStruct value;
+  value.number = 12;
+  value.flag = true;
+  TestStruct copy(value);
+  TestStruct moved(std::move(copy));
+  TestStruct assigned;
+  assigned = moved;
+  EXPECT_EQ(0u, counter.count());
+
+  EXPECT_EQ(12, assigned.number);
+  EXPECT_TRUE(assigned.flag);
+}
+
+TEST(StructTest, SupportsNestedStructs) {
+  // Building the outer table creates an inner struct, which needs to build its
+  // own table without adding its fields to the outer one.
+  OuterStruct value;
+  value.before = 1;
+  value.inner.number = 2;
+  value.after = 3;
+
+  AllocationCounter counter;
+  OuterStruct copy(value);
+  EXPECT_EQ(0u, counter.count());
+
+  EXPECT_EQ(1, copy.before);
+  EXPECT_EQ(2, copy.inner.number);
+  EXPECT_EQ(3, copy.after);
+}
+
+}  // namespace shaka
@@ -0,0 +1,282 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifdef USING_V8
+
+#  include "src/mapping/v8/v8_code_cache.h"
+
+#  ifdef OS_POSIX
+#    include <ftw.h>
+#  endif
+#  include <glog/logging.h>
+#  include <gtest/gtest.h>
+#  include <stdlib.h>
+
+#  include <cstring>
+#  include <string>
+#  include <vector>
+
+#  include "src/test/v8_test.h"
+#  include "src/util/darwin_utils.h"
+#  include "src/util/file_system.h"
+
+namespace shaka {
+
+namespace {
+
+// The cache header is the magic (4 bytes), the version tag (4 bytes), the
+// source size (8 bytes), and the store time (8 bytes).
+constexpr size_t kVersionTagOffset = 4;
+constexpr size_t kStoreTimeOffset = 16;
+constexpr size_t kHeaderSize = 24;
+
+constexpr const char* kScript =
+    "function add(a, b) { return a + b; }\n"
+    "add(1, 2);";
+constexpr const char* kOtherScript =
+    "function multiply(a, b) { return a * b; }\n"
+    "multiply(1, 3);";
+constexpr const char* kThirdScript =
+    "function subtract(a, b) { return a - b; }\n"
+    "subtract(7, 3);";
+
+const uint8_t* Data(const char* source) {
+  return reinterpret_cast<const uint8_t*>(source);
+}
+
+}  // namespace
+
+class V8CodeCacheTest : public V8Test {
+ public:
+  void SetUp() override {
+    V8Test::SetUp();
+#  ifdef OS_POSIX
+#    ifdef OS_IOS
+    temp_dir = util::GetTemporaryDirectory() + "/dirXXXXXX";
+#    else
+    temp_dir = "/tmp/dirXXXXXX";
+#    endif
+    if (!mkdtemp(&temp_dir[0]))
+      PLOG(FATAL) << "Error creating temp directory";
+    // Use a sub-directory so the cache has to create it.
+    cache_dir = temp_dir + "/cache";
+#  else
+#    error "Not implemented for Windows"
+#  endif
+  }
+
+  void TearDown() override {
+#  ifdef OS_POSIX
+    if (nftw(temp_dir.c_str(), DeleteItem, FOPEN_MAX, FTW_DEPTH))
+      PLOG(FATAL) << "Error traversing folder.";
+#  else
+#    error "Not implemented for Windows"
+#  endif
+    V8Test::TearDown();
+  }
+
+ protected:
+#  ifdef OS_POSIX
+  static int DeleteItem(const char* path, const struct stat* st, int flags,
+                        struct FTW*) {
+    const int status = flags == FTW_DP ? rmdir(path) : unlink(path);
+    if (status != 0) {
+      PLOG(FATAL) << "Error deleting file/directory " << path << " with status "
+                  << status;
+    }
+    return status;
+  }
+#  endif
+
+  /**
+   * Compiles and runs the given script, consuming the given cached data if
+   * given.  This takes ownership of |cached_data|.
+   *
+   * @param rejected [OUT] Set to whether V8 rejected the cached data.
+   * @return The compiled script, or an empty handle on error.
+   */
+  v8::Local<v8::Script> CompileAndRun(
+      const char* source, v8::ScriptCompiler::CachedData* cached_data,
+      bool* rejected) {
+    auto context = isolate()->GetCurrentContext();
+    v8::ScriptCompiler::Source script_source(
+        v8::String::NewFromUtf8(isolate(), source, v8::NewStringType::kNormal)
+            .ToLocalChecked(),
+        cached_data);
+    v8::Local<v8::Script> script;
+    if (!v8::ScriptCompiler::Compile(
+             context, &script_source,
+             cached_data ? v8::ScriptCompiler::kConsumeCodeCache
+                         : v8::ScriptCompiler::kNoCompileOptions)
+             .ToLocal(&script)) {
+      return v8::Local<v8::Script>();
+    }
+    *rejected = cached_data && cached_data->rejected;
+
+    v8::Local<v8::Value> result;
+    if (!script->Run(context).ToLocal(&result) || !result->IsNumber())
+      return v8::Local<v8::Script>();
+    return script;
+  }
+
+  /** Compiles the given script and stores it in the given cache. */
+  void CompileAndStore(V8CodeCache* cache, const char* source) {
+    bool rejected;
+    v8::Local<v8::Script> script = CompileAndRun(source, nullptr, &rejected);
+    ASSERT_FALSE(script.IsEmpty());
+    cache->Store(Data(source), strlen(source), script->GetUnboundScript());
+  }
+
+  /** @return The paths of the files in the cache directory. */
+  std::vector<std::string> ListCacheFiles() {
+    util::FileSystem fs;
+    std::vector<std::string> names;
+    if (!fs.DirectoryExists(cache_dir) || !fs.ListFiles(cache_dir, &names))
+      return {};
+    for (std::string& name : names)
+      name = util::FileSystem::PathJoin(cache_dir, name);
+    return names;
+  }
+
+  /** Overwrites part of the only file in the cache directory. */
+  void ModifyCacheFile(size_t offset, const void* data, size_t size) {
+    const std::vector<std::string> paths = ListCacheFiles();
+    ASSERT_EQ(1u, paths.size());
+
+    util::FileSystem fs;
+    std::vector<uint8_t> contents;
+    ASSERT_TRUE(fs.ReadFile(paths[0], &contents));
+    ASSERT_LE(offset + size, contents.size());
+    std::memcpy(contents.data() + offset, data, size);
+    ASSERT_TRUE(fs.WriteFile(paths[0], contents));
+  }
+
+  std::string temp_dir;
+  std::string cache_dir;
+};
+
+TEST_F(V8CodeCacheTest, StoresAndLoads) {
+  v8::HandleScope handles(isolate());
+  V8CodeCache cache(cache_dir);
+  EXPECT_EQ(nullptr, cache.Load(Data(kScript), strlen(kScript)));
+
+  CompileAndStore(&cache, kScript);
+  EXPECT_EQ(1u, ListCacheFiles().size());
+
+  v8::ScriptCompiler::CachedData* cached_data =
+      cache.Load(Data(kScript), strlen(kScript));
+  ASSERT_NE(nullptr, cached_data);
+  bool rejected = true;
+  EXPECT_FALSE(CompileAndRun(kScript, cached_data, &rejected).IsEmpty());
+  EXPECT_FALSE(rejected);
+
+  // Other scripts don't use the entry.
+  EXPECT_EQ(nullptr, cache.Load(Data(kOtherScript), strlen(kOtherScript)));
+}
+
+TEST_F(V8CodeCacheTest, DisabledWithoutDirectory) {
+  v8::HandleScope handles(isolate());
+  V8CodeCache cache("");
+  CompileAndStore(&cache, kScript);
+  EXPECT_EQ(nullptr, cache.Load(Data(kScript), strlen(kScript)));
+}
+
+TEST_F(V8CodeCacheTest, FallsBackToCompileWhenRejected) {
+  v8::HandleScope handles(isolate());
+  V8CodeCache cache(cache_dir);
+  CompileAndStore(&cache, kScript);
+
+  // Corrupt the magic number at the start of the V8 data so V8 rejects it.
+  const uint32_t garbage = 0;
+  ModifyCacheFile(kHeaderSize, &garbage, sizeof(garbage));
+
+  v8::ScriptCompiler::CachedData* cached_data =
+      cache.Load(Data(kScript), strlen(kScript));
+  ASSERT_NE(nullptr, cached_data);
+  bool rejected = false;
+  v8::Local<v8::Script> script = CompileAndRun(kScript, cached_data, &rejected);
+  ASSERT_FALSE(script.IsEmpty());
+  EXPECT_TRUE(rejected);
+
+  // Storing the freshly compiled script replaces the bad entry.
+  cache.Store(Data(kScript), strlen(kScript), script->GetUnboundScript());
+  cached_data = cache.Load(Data(kScript), strlen(kScript));
+  ASSERT_NE(nullptr, cached_data);
+  EXPECT_FALSE(CompileAndRun(kScript, cached_data, &rejected).IsEmpty());
+  EXPECT_FALSE(rejected);
+}
+
+TEST_F(V8CodeCacheTest, IgnoresDifferentVersion) {
+  v8::HandleScope handles(isolate());
+  V8CodeCache cache(cache_dir);
+  CompileAndStore(&cache, kScript);
+
+  // The version tag covers both the V8 version and the flags.
+  const uint32_t tag = v8::ScriptCompiler::CachedDataVersionTag() + 1;
+  ModifyCacheFile(kVersionTagOffset, &tag, sizeof(tag));
+
+  EXPECT_EQ(nullptr, cache.Load(Data(kScript), strlen(kScript)));
+  EXPECT_TRUE(ListCacheFiles().empty());
+}
+
+TEST_F(V8CodeCacheTest, RemovesOldEntries) {
+  v8::HandleScope handles(isolate());
+  V8CodeCache cache(cache_dir);
+  CompileAndStore(&cache, kScript);
+
+  const uint64_t store_time = 0;
+  ModifyCacheFile(kStoreTimeOffset, &store_time, sizeof(store_time));
+
+  CompileAndStore(&cache, kOtherScript);
+  EXPECT_EQ(1u, ListCacheFiles().size());
+  EXPECT_EQ(nullptr, cache.Load(Data(kScript), strlen(kScript)));
+  EXPECT_NE(nullptr, cache.Load(Data(kOtherScript), strlen(kOtherScript)));
+}
+
+TEST_F(V8CodeCacheTest, LimitsTotalSize) {
+  v8::HandleScope handles(isolate());
+  util::FileSystem fs;
+  size_t max_size;
+  {
+    V8CodeCache cache(cache_dir);
+    CompileAndStore(&cache, kScript);
+    const std::vector<std::string> paths = ListCacheFiles();
+    ASSERT_EQ(1u, paths.size());
+    // Leave room for two entries, allowing for scripts of different sizes.
+    max_size = fs.FileSize(paths[0]) * 5 / 2;
+  }
+
+  V8CodeCache cache(cache_dir, max_size);
+  CompileAndStore(&cache, kOtherScript);
+  CompileAndStore(&cache, kThirdScript);
+
+  const std::vector<std::string> paths = ListCacheFiles();
+  EXPECT_EQ(2u, paths.size());
+  size_t total_size = 0;
+  for (const std::string& path : paths)
+    total_size += fs.FileSize(path);
+  EXPECT_LE(total_size, max_size);
+  // The newest entry is always kept.
+  EXPECT_NE(nullptr, cache.Load(Data(kThirdScript), strlen(kThirdScript)));
+
+  // Entries larger than the whole cache aren't stored.
+  V8CodeCache small_cache(cache_dir, kHeaderSize);
+  small_cache.Remove(Data(kScript), strlen(kScript));
+  CompileAndStore(&small_cache, kScript);
+  EXPECT_EQ(nullptr, small_cache.Load(Data(kScript), strlen(kScript)));
+}
+
+}  // namespace shaka
+
+#endif  // USING_V8
@@ -0,0 +1,417 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/media/decoder_thread.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "src/media/base_frame.h"
+#include "src/media/pipeline_manager.h"
+#include "src/media/stream.h"
+#include "src/util/clock.h"
+
+namespace shaka {
+namespace media {
+
+namespace {
+
+using testing::_;
+using testing::ElementsAre;
+using testing::InSequence;
+using testing::Invoke;
+using testing::NiceMock;
+
+/** The time between demuxed frames; every fourth frame is a key frame. */
+constexpr const double kFrameDuration = 0.25;
+constexpr const int kFrameCount = 40;
+
+class MockMediaProcessor : public MediaProcessor {
+ public:
+  MockMediaProcessor() : MediaProcessor("mp4", "avc1.42c01e", nullptr) {}
+
+  MOCK_METHOD4(DecodeFrame,
+               Status(double, const BaseFrame*, eme::Implementation*,
+                      std::vector<std::unique_ptr<BaseFrame>>*));
+  MOCK_METHOD0(ResetDecoder, void());
+  MOCK_METHOD1(SetDecodeDegradation, void(DecodeDegradation));
+  MOCK_METHOD1(SetSeekTarget, void(double));
+};
+
+class MockClock : public util::Clock {
+ public:
+  MOCK_CONST_METHOD0(GetMonotonicTime, uint64_t());
+  MOCK_CONST_METHOD1(SleepSeconds, void(double));
+};
+
+void IgnoreStatus(PipelineStatus) {}
+void IgnoreSeek() {}
+
+}  // namespace
+
+class DecoderThreadTest : public testing::Test {
+ public:
+  DecoderThreadTest()
+      : pipeline_(&IgnoreStatus, &IgnoreSeek, &clock_),
+        cur_time_(0),
+        playback_rate_(1),
+        started_(false) {}
+
+  void SetUp() override {
+    MediaProcessor::Initialize();
+    for (int i = 0; i < kFrameCount; i++) {
+      const double time = i * kFrameDuration;
+      stream_.GetDemuxedFrames()->AppendFrame(std::unique_ptr<BaseFrame>(
+          new BaseFrame(time, time, kFrameDuration, i % 4 == 0)));
+    }
+
+    ON_CALL(processor_, DecodeFrame(_, _, _, _))
+        .WillByDefault(Invoke(this, &DecoderThreadTest::OnDecodeFrame));
+  }
+
+ protected:
+  /**
+   * Creates a new DecoderThread.  The thread doesn't read the time until
+   * Start() is called, so it can be configured first.
+   */
+  std::unique_ptr<DecoderThread> CreateDecoder() {
+    return std::unique_ptr<DecoderThread>(new DecoderThread(
+        [this]() {
+          while (!started_.load(std::memory_order_acquire))
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+          // The decoder reads the time once each time through its loop.
+          {
+            std::unique_lock<std::mutex> lock(mutex_);
+            time_reads_++;
+            cond_.notify_all();
+          }
+          return cur_time_.load(std::memory_order_acquire);
+        },
+        [this]() { return playback_rate_.load(std::memory_order_acquire); },
+        []() {}, []() {}, [](Status) {}, &processor_, &pipeline_, &stream_));
+  }
+
+  void Start() {
+    started_.store(true, std::memory_order_release);
+  }
+
+  /**
+   * Waits until the given number of frames have been given to the decoder.
+   * Use GetDecodes to get the frame times.
+   */
+  testing::AssertionResult WaitForDecodes(size_t count) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!cond_.wait_for(lock, std::chrono::seconds(5),
+                        [&]() { return decoded_times_.size() >= count; })) {
+      return testing::AssertionFailure()
+             << "Timed out waiting for " << count << " decodes, got "
+             << decoded_times_.size();
+    }
+    return testing::AssertionSuccess();
+  }
+
+  /**
+   * Waits until the decoder thread has finished the pass through its loop it
+   * is currently in and then a whole new pass.  So anything the decoder would
+   * do with the current playhead time has been done.
+   */
+  testing::AssertionResult WaitForDecoderToSettle() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    const uint64_t target = time_reads_ + 2;
+    if (!cond_.wait_for(lock, std::chrono::seconds(5),
+                        [&]() { return time_reads_ >= target; })) {
+      return testing::AssertionFailure()
+             << "Timed out waiting for the decoder thread";
+    }
+    return testing::AssertionSuccess();
+  }
+
+  /**
+   * Gets the times of the frames given to the decoder, in order.  When
+   * decoding doesn't stop, |count| limits this to the first frames.
+   */
+  std::vector<double> GetDecodes(size_t count = SIZE_MAX) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (decoded_times_.size() <= count)
+      return decoded_times_;
+    return std::vector<double>(decoded_times_.begin(),
+                               decoded_times_.begin() + count);
+  }
+
+  /**
+   * If set, this is called after each frame is decoded with the frame time
+   * to get the new playhead time.  This simulates how long decoding takes.
+   */
+  std::function<double(double)> time_after_decode_;
+
+  /**
+   * If set, this is called with the frame time before each frame is decoded;
+   * if this returns an error, the frame isn't decoded and the error is
+   * returned to the decoder thread.
+   */
+  std::function<Status(double)> decode_status_;
+
+  NiceMock<MockClock> clock_;
+  NiceMock<MockMediaProcessor> processor_;
+  PipelineManager pipeline_;
+  Stream stream_;
+  std::atomic<double> cur_time_;
+  std::atomic<double> playback_rate_;
+
+ private:
+  Status OnDecodeFrame(double, const BaseFrame* frame, eme::Implementation*,
+                       std::vector<std::unique_ptr<BaseFrame>>*) {
+    // A null frame is a flush.
+    if (frame) {
+      if (decode_status_) {
+        const Status status = decode_status_(frame->pts);
+        if (status != Status::Success)
+          return status;
+      }
+
+      std::unique_lock<std::mutex> lock(mutex_);
+      decoded_times_.push_back(frame->pts);
+      if (time_after_decode_)
+        cur_time_ = time_after_decode_(frame->pts);
+      cond_.notify_all();
+    }
+    return Status::Success;
+  }
+
+  std::atomic<bool> started_;
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  std::vector<double> decoded_times_;
+  uint64_t time_reads_ = 0;
+};
+
+TEST_F(DecoderThreadTest, DecodesKeyFramesAheadAtHighRates) {
+  cur_time_ = 5;
+  playback_rate_ = 8;
+  auto decoder = CreateDecoder();
+  decoder->SetAllowTrickPlay(true);
+  Start();
+
+  // The playhead will reach 7 soon, so that key frame is decoded.
+  ASSERT_TRUE(WaitForDecodes(1));
+  ASSERT_THAT(GetDecodes(), ElementsAre(7));
+
+  // The target is still after the same key frame, so it isn't decoded again.
+  cur_time_ = 5.5;
+  ASSERT_TRUE(WaitForDecoderToSettle());
+  EXPECT_THAT(GetDecodes(), ElementsAre(7));
+
+  // Frames between key frames are never decoded.
+  cur_time_ = 6;
+  ASSERT_TRUE(WaitForDecodes(2));
+  EXPECT_THAT(GetDecodes(), ElementsAre(7, 8));
+  cur_time_ = 7.5;
+  ASSERT_TRUE(WaitForDecodes(3));
+  EXPECT_THAT(GetDecodes(), ElementsAre(7, 8, 9));
+  decoder->Stop();
+}
+
+TEST_F(DecoderThreadTest, DecodesKeyFramesBehindInReverse) {
+  cur_time_ = 5;
+  playback_rate_ = -8;
+  auto decoder = CreateDecoder();
+  decoder->SetAllowTrickPlay(true);
+  Start();
+
+  ASSERT_TRUE(WaitForDecodes(1));
+  ASSERT_THAT(GetDecodes(), ElementsAre(3));
+  cur_time_ = 4;
+  ASSERT_TRUE(WaitForDecodes(2));
+  EXPECT_THAT(GetDecodes(), ElementsAre(3, 2));
+  cur_time_ = 3.5;
+  ASSERT_TRUE(WaitForDecodes(3));
+  EXPECT_THAT(GetDecodes(), ElementsAre(3, 2, 1));
+  decoder->Stop();
+}
+
+TEST_F(DecoderThreadTest, DecodesAllFramesAtNormalRates) {
+  cur_time_ = 5;
+  playback_rate_ = kMaxPlaybackRate;
+  auto decoder = CreateDecoder();
+  decoder->SetAllowTrickPlay(true);
+  Start();
+
+  ASSERT_TRUE(WaitForDecodes(3));
+  EXPECT_THAT(GetDecodes(3), ElementsAre(5, 5.25, 5.5));
+  decoder->Stop();
+}
+
+TEST_F(DecoderThreadTest, DecodesAllFramesWhenPaused) {
+  // The rate callback gives 0 when not playing.
+  cur_time_ = 5;
+  playback_rate_ = 0;
+  auto decoder = CreateDecoder();
+  decoder->SetAllowTrickPlay(true);
+  Start();
+
+  ASSERT_TRUE(WaitForDecodes(3));
+  EXPECT_THAT(GetDecodes(3), ElementsAre(5, 5.25, 5.5));
+  decoder->Stop();
+}
+
+TEST_F(DecoderThreadTest, DecodesAllFramesWithoutTrickPlay) {
+  // Trick play is only used for video, so audio decodes every frame.
+  cur_time_ = 5;
+  playback_rate_ = 8;
+  auto decoder = CreateDecoder();
+  Start();
+
+  ASSERT_TRUE(WaitForDecodes(3));
+  EXPECT_THAT(GetDecodes(3), ElementsAre(5, 5.25, 5.5));
+  decoder->Stop();
+}
+
+TEST_F(DecoderThreadTest, DegradesWhenFramesAreLate) {
+  // Each frame finishes decoding just after the next frame should be shown.
+  time_after_decode_ = [](double pts) { return pts + 0.3; };
+  {
+    InSequence seq;
+    EXPECT_CALL(processor_,
+                SetDecodeDegradation(DecodeDegradation::SkipLoopFilter))
+        .Times(1);
+    EXPECT_CALL(processor_,
+                SetDecodeDegradation(DecodeDegradation::SkipNonReference))
+        .Times(1);
+  }
+
+  auto decoder = CreateDecoder();
+  decoder->SetAllowDegradation(true);
+  Start();
+  ASSERT_TRUE(WaitForDecodes(kFrameCount));
+  ASSERT_TRUE(WaitForDecoderToSettle());
+  decoder->Stop();
+
+  // The first frame is on-time.  After 5 late frames (1-5) the loop filter is
+  // skipped, then after 5 more (6-10) non-reference frames are skipped too.
+  VideoPlaybackQuality quality;
+  decoder->GetDegradationStats(&quality);
+  EXPECT_EQ(quality.decodeDegradationLevel,
+            static_cast<uint64_t>(DecodeDegradation::SkipNonReference));
+  EXPECT_EQ(quality.skipLoopFilterFrames, kFrameCount - 6u);
+  EXPECT_EQ(quality.skipNonReferenceFrames, kFrameCount - 11u);
+  EXPECT_EQ(quality.keyFrameSkips, 0u);
+  EXPECT_EQ(quality.keyFrameSkippedFrames, 0u);
+}
+
+TEST_F(DecoderThreadTest, RecoversWhenFramesAreOnTime) {
+  // Frames before 2s are late; after that they are decoded well ahead.
+  time_after_decode_ = [](double pts) {
+    return pts < 2 ? pts + 0.3 : pts - 0.6;
+  };
+  {
+    InSequence seq;
+    EXPECT_CALL(processor_,
+                SetDecodeDegradation(DecodeDegradation::SkipLoopFilter))
+        .Times(1);
+    EXPECT_CALL(processor_, SetDecodeDegradation(DecodeDegradation::None))
+        .Times(1);
+  }
+
+  auto decoder = CreateDecoder();
+  decoder->SetAllowDegradation(true);
+  Start();
+  ASSERT_TRUE(WaitForDecodes(kFrameCount));
+  ASSERT_TRUE(WaitForDecoderToSettle());
+  decoder->Stop();
+
+  // Frames 1-8 are late, so the level is raised after frame 5.  Frames 9-38
+  // are on-time, so the level is lowered again after frame 38.
+  VideoPlaybackQuality quality;
+  decoder->GetDegradationStats(&quality);
+  EXPECT_EQ(quality.decodeDegradationLevel,
+            static_cast<uint64_t>(DecodeDegradation::None));
+  EXPECT_EQ(quality.skipLoopFilterFrames, 33u);
+  EXPECT_EQ(quality.skipNonReferenceFrames, 0u);
+}
+
+TEST_F(DecoderThreadTest, SkipsToNextKeyFrameWhenHopelesslyLate) {
+  // Decoding the first frame takes so long the playhead is over a second past
+  // the next frame.
+  time_after_decode_ = [](double pts) { return pts == 0 ? 1.5 : pts; };
+
+  auto decoder = CreateDecoder();
+  decoder->SetAllowDegradation(true);
+  Start();
+  ASSERT_TRUE(WaitForDecodes(3));
+  EXPECT_THAT(GetDecodes(3), ElementsAre(0, 1, 1.25));
+  decoder->Stop();
+
+  // The frames at 0.25, 0.5, and 0.75 were skipped.
+  VideoPlaybackQuality quality;
+  decoder->GetDegradationStats(&quality);
+  EXPECT_EQ(quality.keyFrameSkips, 1u);
+  EXPECT_EQ(quality.keyFrameSkippedFrames, 3u);
+}
+
+TEST_F(DecoderThreadTest, CountsKeyFrameSkipsOnceWhenWaitingForKey) {
+  time_after_decode_ = [](double pts) { return pts == 0 ? 1.5 : pts; };
+  // The key frame we skip to is missing its key the first few times.
+  int missing_key_count = 3;
+  decode_status_ = [&missing_key_count](double pts) {
+    if (pts == 1 && missing_key_count > 0) {
+      missing_key_count--;
+      return Status::KeyNotFound;
+    }
+    return Status::Success;
+  };
+
+  auto decoder = CreateDecoder();
+  decoder->SetAllowDegradation(true);
+  Start();
+  ASSERT_TRUE(WaitForDecodes(3));
+  EXPECT_THAT(GetDecodes(3), ElementsAre(0, 1, 1.25));
+  decoder->Stop();
+
+  VideoPlaybackQuality quality;
+  decoder->GetDegradationStats(&quality);
+  EXPECT_EQ(missing_key_count, 0);
+  EXPECT_EQ(quality.keyFrameSkips, 1u);
+  EXPECT_EQ(quality.keyFrameSkippedFrames, 3u);
+}
+
+TEST_F(DecoderThreadTest, DoesntDegradeUnlessAllowed) {
+  // Degradation is only used for video.
+  time_after_decode_ = [](double pts) { return pts + 1.5; };
+  EXPECT_CALL(processor_, SetDecodeDegradation(_)).Times(0);
+
+  auto decoder = CreateDecoder();
+  Start();
+  ASSERT_TRUE(WaitForDecodes(kFrameCount));
+  ASSERT_TRUE(WaitForDecoderToSettle());
+  decoder->Stop();
+
+  VideoPlaybackQuality quality;
+  decoder->GetDegradationStats(&quality);
+  EXPECT_EQ(quality.decodeDegradationLevel, 0u);
+  EXPECT_EQ(quality.skipLoopFilterFrames, 0u);
+  EXPECT_EQ(quality.keyFrameSkips, 0u);
+}
+
+}  // namespace media
+}  // namespace shaka
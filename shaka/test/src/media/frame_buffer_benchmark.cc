@@ -0,0 +1,119 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/media/frame_buffer.h"
+
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "src/test/benchmark.h"
+
+namespace shaka {
+namespace media {
+
+namespace {
+
+constexpr const double kFrameDuration = 1.0 / 24;
+constexpr const int kKeyFrameInterval = 48;
+constexpr const bool kDtsOrder = true;
+
+std::vector<std::unique_ptr<const BaseFrame>> MakeFrames(int64_t count) {
+  std::vector<std::unique_ptr<const BaseFrame>> ret;
+  ret.reserve(count);
+  for (int64_t i = 0; i < count; i++) {
+    const double time = i * kFrameDuration;
+    ret.emplace_back(new BaseFrame(time, time, kFrameDuration,
+                                   i % kKeyFrameInterval == 0));
+  }
+  return ret;
+}
+
+void FillBuffer(int64_t count, FrameBuffer* buffer) {
+  for (auto& frame : MakeFrames(count))
+    buffer->AppendFrame(std::move(frame));
+}
+
+void BM_FrameBufferAppend(benchmark::State& state) {
+  const int64_t count = state.range(0);
+  while (state.KeepRunning()) {
+    state.PauseTiming();
+    std::unique_ptr<FrameBuffer> buffer(new FrameBuffer(kDtsOrder));
+    auto frames = MakeFrames(count);
+    state.ResumeTiming();
+
+    for (auto& frame : frames)
+      buffer->AppendFrame(std::move(frame));
+
+    state.PauseTiming();
+    buffer.reset();
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_FrameBufferAppend)->Arg(1000)->Arg(10000)->Arg(100000);
+
+void BM_FrameBufferGetFrameNear(benchmark::State& state) {
+  const int64_t count = state.range(0);
+  FrameBuffer buffer(kDtsOrder);
+  FillBuffer(count, &buffer);
+
+  std::mt19937 rand(0);
+  std::uniform_real_distribution<double> times(0, count * kFrameDuration);
+  while (state.KeepRunning()) {
+    auto frame = buffer.GetFrameNear(times(rand));
+    benchmark::DoNotOptimize(frame.get());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FrameBufferGetFrameNear)->Arg(1000)->Arg(10000)->Arg(100000);
+
+void BM_FrameBufferGetFrameAfter(benchmark::State& state) {
+  // This is how the decoder walks the buffer, so time a full walk.
+  const int64_t count = state.range(0);
+  FrameBuffer buffer(kDtsOrder);
+  FillBuffer(count, &buffer);
+
+  while (state.KeepRunning()) {
+    auto frame = buffer.GetKeyFrameBefore(0);
+    while (frame) {
+      const double dts = frame->dts;
+      frame = buffer.GetFrameAfter(dts);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_FrameBufferGetFrameAfter)->Arg(1000)->Arg(10000)->Arg(100000);
+
+void BM_FrameBufferRemove(benchmark::State& state) {
+  // Remove one second at a time from the front, like buffer eviction does.
+  const int64_t count = state.range(0);
+  const double duration = count * kFrameDuration;
+  while (state.KeepRunning()) {
+    state.PauseTiming();
+    FrameBuffer buffer(kDtsOrder);
+    FillBuffer(count, &buffer);
+    state.ResumeTiming();
+
+    for (double start = 0; start < duration; start += 1)
+      buffer.Remove(start, start + 1);
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_FrameBufferRemove)->Arg(1000)->Arg(10000)->Arg(100000);
+
+}  // namespace
+
+}  // namespace media
+}  // namespace shaka
@@ -264,6 +264,45 @@ TEST(FrameBufferTest, GetKeyFrameBefore_WontReturnFutureFrames) {
   EXPECT_EQ(nullptr, frame);
 }
 
+TEST(FrameBufferTest, GetKeyFrameAfter_FindsFrameAfter) {
+  FrameBuffer buffer(kPtsOrder);
+  buffer.AppendFrame(MakeFrame(0, 10));
+  buffer.AppendFrame(MakeFrame(10, 20, false));
+  buffer.AppendFrame(MakeFrame(20, 30));
+  buffer.AppendFrame(MakeFrame(30, 40, false));
+  ASSERT_EQ(1u, buffer.GetBufferedRanges().size());
+
+  const BaseFrame* frame = buffer.GetKeyFrameAfter(0).get();
+  ASSERT_NE(nullptr, frame);
+  EXPECT_EQ(20, frame->pts);
+
+  frame = buffer.GetKeyFrameAfter(15).get();
+  ASSERT_NE(nullptr, frame);
+  EXPECT_EQ(20, frame->pts);
+}
+
+TEST(FrameBufferTest, GetKeyFrameAfter_FindsFrameInNextRange) {
+  FrameBuffer buffer(kPtsOrder);
+  buffer.AppendFrame(MakeFrame(0, 2));
+  buffer.AppendFrame(MakeFrame(2, 3, false));
+  buffer.AppendFrame(MakeFrame(10, 12));
+  buffer.AppendFrame(MakeFrame(12, 14, false));
+  ASSERT_EQ(2u, buffer.GetBufferedRanges().size());
+
+  const BaseFrame* frame = buffer.GetKeyFrameAfter(0).get();
+  ASSERT_NE(nullptr, frame);
+  EXPECT_EQ(10, frame->pts);
+}
+
+TEST(FrameBufferTest, GetKeyFrameAfter_ReturnsNull) {
+  FrameBuffer buffer(kPtsOrder);
+  buffer.AppendFrame(MakeFrame(0, 10));
+  buffer.AppendFrame(MakeFrame(10, 20, false));
+
+  EXPECT_EQ(nullptr, buffer.GetKeyFrameAfter(0).get());
+  EXPECT_EQ(nullptr, buffer.GetKeyFrameAfter(20).get());
+}
+
 
 TEST(FrameBufferTest, GetFrameAfter_GetsNext) {
   FrameBuffer buffer(kPtsOrder);
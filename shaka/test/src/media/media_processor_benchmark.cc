@@ -0,0 +1,428 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/media/media_processor.h"
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/eme/clearkey_implementation.h"
+#include "src/media/ffmpeg_encoded_frame.h"
+#include "src/media/media_utils.h"
+#include "src/media/mp4_parser.h"
+#include "src/test/benchmark.h"
+#include "src/test/media_files.h"
+#include "src/util/buffer_reader.h"
+
+namespace shaka {
+namespace media {
+
+namespace {
+
+struct MediaCase {
+  const char* name;
+  const char* container;
+  const char* codec;
+  std::vector<const char*> files;
+};
+
+BEGIN_ALLOW_COMPLEX_STATICS
+const MediaCase kDemuxCases[] = {
+    {"mp4_fragmented", "mp4", "avc1.42c01e",
+     {"clear_low_frag_init.mp4", "clear_low_frag_seg1.mp4"}},
+    {"mp4_single_file", "mp4", "avc1.42c01e", {"clear_high.mp4"}},
+    {"webm", "webm", "vp9", {"clear_low.webm"}},
+};
+
+const MediaCase kDecodeCases[] = {
+    {"h264_256x110", "mp4", "avc1.42c01e",
+     {"clear_low_frag_init.mp4", "clear_low_frag_seg1.mp4"}},
+    {"h264_426x182", "mp4", "avc1.42c01e", {"clear_high.mp4"}},
+    {"vp9_256x110", "webm", "vp9", {"clear_low.webm"}},
+};
+
+const MediaCase kDecryptCases[] = {
+    {"cenc", "mp4", "avc1.42c01e", {"encrypted_low_cenc.mp4"}},
+    {"cens", "mp4", "avc1.42c01e", {"encrypted_low_cens.mp4"}},
+    {"cbc1", "mp4", "avc1.42c01e", {"encrypted_low_cbc1.mp4"}},
+    {"cbcs", "mp4", "avc1.42c01e", {"encrypted_low_cbcs.mp4"}},
+};
+END_ALLOW_COMPLEX_STATICS
+
+void IgnoreInitData(eme::MediaKeyInitDataType, const uint8_t*, size_t) {}
+
+void IgnoreResetRead() {}
+
+/** Feeds the given buffers to the demuxer, in order. */
+class SegmentReader {
+ public:
+  explicit SegmentReader(const std::vector<std::vector<uint8_t>>* buffers)
+      : buffers_(buffers), index_(0), offset_(0) {}
+
+  /** Rewinds to the start of the current buffer. */
+  void Reset() {
+    offset_ = 0;
+  }
+
+  size_t Read(uint8_t* dest, size_t dest_size) {
+    if (index_ >= buffers_->size())
+      return 0;
+
+    const std::vector<uint8_t>& buffer = (*buffers_)[index_];
+    dest_size = std::min(dest_size, buffer.size() - offset_);
+    memcpy(dest, buffer.data() + offset_, dest_size);
+    offset_ += dest_size;
+    if (offset_ >= buffer.size()) {
+      index_++;
+      offset_ = 0;
+    }
+    return dest_size;
+  }
+
+ private:
+  const std::vector<std::vector<uint8_t>>* buffers_;
+  size_t index_;
+  size_t offset_;
+};
+
+std::vector<std::vector<uint8_t>> LoadFiles(const MediaCase& test_case,
+                                            int64_t* total_size) {
+  std::vector<std::vector<uint8_t>> ret;
+  *total_size = 0;
+  for (const char* file : test_case.files) {
+    ret.emplace_back(GetMediaFile(file));
+    *total_size += ret.back().size();
+  }
+  return ret;
+}
+
+/** Demuxes all the frames in the given buffers. */
+bool DemuxAll(MediaProcessor* processor,
+              const std::vector<std::vector<uint8_t>>* buffers,
+              std::vector<std::unique_ptr<BaseFrame>>* frames) {
+  using namespace std::placeholders;  // NOLINT
+  SegmentReader reader(buffers);
+  if (processor->InitializeDemuxer(
+          std::bind(&SegmentReader::Read, &reader, _1, _2),
+          &IgnoreResetRead) != Status::Success) {
+    return false;
+  }
+
+  while (true) {
+    std::unique_ptr<BaseFrame> frame;
+    const Status status = processor->ReadDemuxedFrame(&frame);
+    if (status == Status::EndOfStream)
+      return true;
+    if (status != Status::Success)
+      return false;
+    frames->emplace_back(std::move(frame));
+  }
+}
+
+bool CheckSupported(const MediaCase& test_case, benchmark::State* state) {
+  if (!IsTypeSupported(test_case.container, test_case.codec, 0, 0)) {
+    state->SkipWithError(std::string(test_case.codec) + " isn't supported");
+    return false;
+  }
+  return true;
+}
+
+void DemuxBenchmark(const MediaCase& test_case, benchmark::State& state) {
+  if (!CheckSupported(test_case, &state))
+    return;
+
+  int64_t total_size;
+  const auto buffers = LoadFiles(test_case, &total_size);
+  int64_t frame_count = 0;
+  while (state.KeepRunning()) {
+    MediaProcessor processor(test_case.container, test_case.codec,
+                             &IgnoreInitData);
+    std::vector<std::unique_ptr<BaseFrame>> frames;
+    if (!DemuxAll(&processor, &buffers, &frames)) {
+      state.SkipWithError("Error demuxing media");
+      return;
+    }
+    frame_count += frames.size();
+
+    state.PauseTiming();
+    frames.clear();
+    state.ResumeTiming();
+  }
+
+  state.SetBytesProcessed(state.iterations() * total_size);
+  state.SetItemsProcessed(frame_count);
+#ifdef ENABLE_NATIVE_MP4_DEMUXER
+  state.SetLabel("native_mp4_demuxer");
+#endif
+}
+
+void DecodeBenchmark(const MediaCase& test_case, benchmark::State& state) {
+  if (!CheckSupported(test_case, &state))
+    return;
+
+  int64_t total_size;
+  const auto buffers = LoadFiles(test_case, &total_size);
+  MediaProcessor processor(test_case.container, test_case.codec,
+                           &IgnoreInitData);
+  std::vector<std::unique_ptr<BaseFrame>> frames;
+  if (!DemuxAll(&processor, &buffers, &frames)) {
+    state.SkipWithError("Error demuxing media");
+    return;
+  }
+
+  int64_t decoded_count = 0;
+  std::vector<std::unique_ptr<BaseFrame>> decoded;
+  while (state.KeepRunning()) {
+    processor.ResetDecoder();
+    for (size_t i = 0; i <= frames.size(); i++) {
+      // Pass null at the end to flush the decoder.
+      const BaseFrame* frame = i < frames.size() ? frames[i].get() : nullptr;
+      if (processor.DecodeFrame(0, frame, nullptr, &decoded) !=
+          Status::Success) {
+        state.SkipWithError("Error decoding media");
+        return;
+      }
+      decoded_count += decoded.size();
+      decoded.clear();
+    }
+  }
+
+  // Items are decoded frames, so items/s is the decode frame rate.
+  state.SetItemsProcessed(decoded_count);
+}
+
+void DemuxSwitchBenchmark(size_t switch_index, benchmark::State& state) {
+  // This appends the low rendition, the high rendition, then the low rendition
+  // again, like an ABR switch away and back.  Only the read that reinitializes
+  // the demuxer and returns the first frame after the given switch is timed;
+  // the second switch reuses the codec parameters cached by the first append.
+  std::vector<uint8_t> low = GetMediaFile("clear_low_frag_init.mp4");
+  const std::vector<uint8_t> low_seg = GetMediaFile("clear_low_frag_seg1.mp4");
+  low.insert(low.end(), low_seg.begin(), low_seg.end());
+  const std::vector<std::vector<uint8_t>> buffers = {
+      low, GetMediaFile("clear_high.mp4"), low};
+
+  using namespace std::placeholders;  // NOLINT
+  while (state.KeepRunning()) {
+    MediaProcessor processor("mp4", "avc1.42c01e", &IgnoreInitData);
+    SegmentReader reader(&buffers);
+    if (processor.InitializeDemuxer(
+            std::bind(&SegmentReader::Read, &reader, _1, _2),
+            std::bind(&SegmentReader::Reset, &reader)) != Status::Success) {
+      state.SkipWithError("Error initializing demuxer");
+      return;
+    }
+
+    // Each append starts at time 0, so a switch is seen as the DTS going back.
+    size_t switch_count = 0;
+    double prev_dts = -1;
+    double switch_time = -1;
+    while (true) {
+      std::unique_ptr<BaseFrame> frame;
+      const auto start = std::chrono::steady_clock::now();
+      const Status status = processor.ReadDemuxedFrame(&frame);
+      const auto end = std::chrono::steady_clock::now();
+      if (status == Status::EndOfStream)
+        break;
+      if (status != Status::Success) {
+        state.SkipWithError("Error demuxing media");
+        return;
+      }
+      if (frame->dts < prev_dts && ++switch_count == switch_index)
+        switch_time = std::chrono::duration<double>(end - start).count();
+      prev_dts = frame->dts;
+    }
+    if (switch_time < 0) {
+      state.SkipWithError("Didn't see the stream switch");
+      return;
+    }
+    state.SetIterationTime(switch_time);
+  }
+}
+
+void DemuxMp4ParserBenchmark(benchmark::State& state) {
+  // This is the 'moof' parsing used by the native MP4 demuxer; it doesn't
+  // depend on the build flag, so it can be compared with libavformat above.
+  const std::vector<uint8_t> init = GetMediaFile("clear_low_frag_init.mp4");
+  const std::vector<uint8_t> segment = GetMediaFile("clear_low_frag_seg1.mp4");
+
+  auto find_box = [](const std::vector<uint8_t>& data, uint32_t type,
+                     size_t* size) -> const uint8_t* {
+    util::BufferReader reader(data.data(), data.size());
+    while (!reader.empty()) {
+      const size_t offset = data.size() - reader.BytesRemaining();
+      Mp4BoxHeader header;
+      if (!Mp4Parser::ReadBoxHeader(&reader, &header))
+        break;
+      if (header.type == type) {
+        *size = header.box_size;
+        return data.data() + offset;
+      }
+      reader.Skip(header.box_size - header.header_size);
+    }
+    return nullptr;
+  };
+
+  size_t moov_size = 0;
+  size_t moof_size = 0;
+  const uint8_t* moov = find_box(init, Mp4BoxType('m', 'o', 'o', 'v'),
+                                 &moov_size);
+  const uint8_t* moof = find_box(segment, Mp4BoxType('m', 'o', 'o', 'f'),
+                                 &moof_size);
+  Mp4Parser parser;
+  if (!moov || !moof || !parser.ParseInitSegment(moov, moov_size)) {
+    state.SkipWithError("Error parsing init segment");
+    return;
+  }
+
+  std::vector<Mp4Sample> samples;
+  std::vector<uint8_t> pssh;
+  int64_t sample_count = 0;
+  while (state.KeepRunning()) {
+    samples.clear();
+    pssh.clear();
+    if (!parser.ParseFragment(moof, moof_size, &samples, &pssh)) {
+      state.SkipWithError("Error parsing fragment");
+      return;
+    }
+    sample_count += samples.size();
+  }
+  state.SetBytesProcessed(state.iterations() * moof_size);
+  state.SetItemsProcessed(sample_count);
+}
+
+}  // namespace
+
+/** Has access to ClearKeyImplementation to load the test key. */
+class MediaProcessorBenchmark {
+ public:
+  static void LoadKey(eme::ClearKeyImplementation* cdm) {
+    cdm->LoadKeyForTesting({0xab, 0xba, 0x27, 0x1e, 0x8b, 0xcf, 0x55, 0x2b,
+                            0xbd, 0x2e, 0x86, 0xa4, 0x34, 0xa9, 0xa5, 0xd9},
+                           {0x69, 0xea, 0xa8, 0x02, 0xa6, 0x76, 0x3a, 0xf9,
+                            0x79, 0xe8, 0xd1, 0x94, 0x0f, 0xb8, 0x83, 0x92});
+  }
+
+  static void DecryptBenchmark(const MediaCase& test_case,
+                               benchmark::State& state) {
+    int64_t total_size;
+    const auto buffers = LoadFiles(test_case, &total_size);
+    MediaProcessor processor(test_case.container, test_case.codec,
+                             &IgnoreInitData);
+    std::vector<std::unique_ptr<BaseFrame>> frames;
+    if (!DemuxAll(&processor, &buffers, &frames)) {
+      state.SkipWithError("Error demuxing media");
+      return;
+    }
+
+    eme::ClearKeyImplementation cdm(nullptr);
+    LoadKey(&cdm);
+
+    std::vector<const FFmpegEncodedFrame*> encrypted;
+    std::vector<std::unique_ptr<AVPacket, void (*)(AVPacket*)>> packets;
+    int64_t encrypted_size = 0;
+    for (auto& frame : frames) {
+      if (frame->frame_type() != FrameType::FFmpegEncodedFrame)
+        continue;
+      auto* ffmpeg_frame = static_cast<const FFmpegEncodedFrame*>(frame.get());
+      if (!ffmpeg_frame->is_encrypted())
+        continue;
+
+      const int size = ffmpeg_frame->raw_packet()->size;
+      packets.emplace_back(av_packet_alloc(), [](AVPacket* packet) {
+        av_packet_free(&packet);
+      });
+      if (!packets.back() || av_new_packet(packets.back().get(), size) < 0) {
+        state.SkipWithError("Error allocating packet");
+        return;
+      }
+      encrypted.push_back(ffmpeg_frame);
+      encrypted_size += size;
+    }
+    if (encrypted.empty()) {
+      state.SkipWithError("No encrypted frames");
+      return;
+    }
+
+    while (state.KeepRunning()) {
+      for (size_t i = 0; i < encrypted.size(); i++) {
+        if (encrypted[i]->Decrypt(&cdm, packets[i].get()) !=
+            Status::Success) {
+          state.SkipWithError("Error decrypting frame");
+          return;
+        }
+      }
+    }
+    state.SetBytesProcessed(state.iterations() * encrypted_size);
+    state.SetItemsProcessed(state.iterations() * encrypted.size());
+  }
+};
+
+namespace {
+
+bool RegisterMediaProcessorBenchmarks() {
+  for (const MediaCase& test_case : kDemuxCases) {
+    benchmark::RegisterBenchmark(
+        std::string("BM_Demux/") + test_case.name,
+        std::bind(&DemuxBenchmark, std::cref(test_case),
+                  std::placeholders::_1));
+  }
+  benchmark::RegisterBenchmark("BM_Demux/mp4_parser_moof",
+                               &DemuxMp4ParserBenchmark);
+  benchmark::RegisterBenchmark(
+      "BM_DemuxSwitch/new_init_segment",
+      std::bind(&DemuxSwitchBenchmark, 1, std::placeholders::_1))
+      ->UseManualTime()
+      ->Unit(benchmark::TimeUnit::Microsecond);
+  benchmark::RegisterBenchmark(
+      "BM_DemuxSwitch/repeated_init_segment",
+      std::bind(&DemuxSwitchBenchmark, 2, std::placeholders::_1))
+      ->UseManualTime()
+      ->Unit(benchmark::TimeUnit::Microsecond);
+  for (const MediaCase& test_case : kDecodeCases) {
+    benchmark::RegisterBenchmark(
+        std::string("BM_Decode/") + test_case.name,
+        std::bind(&DecodeBenchmark, std::cref(test_case),
+                  std::placeholders::_1))
+        ->Unit(benchmark::TimeUnit::Millisecond);
+  }
+  for (const MediaCase& test_case : kDecryptCases) {
+    benchmark::RegisterBenchmark(
+        std::string("BM_Decrypt/") + test_case.name,
+        std::bind(&MediaProcessorBenchmark::DecryptBenchmark,
+                  std::cref(test_case), std::placeholders::_1))
+        ->Unit(benchmark::TimeUnit::Microsecond);
+  }
+  return true;
+}
+
+BEGIN_ALLOW_COMPLEX_STATICS
+__attribute__((unused)) const bool kRegistered =
+    RegisterMediaProcessorBenchmarks();
+END_ALLOW_COMPLEX_STATICS
+
+}  // namespace
+
+}  // namespace media
+}  // namespace shaka
@@ -17,6 +17,9 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <iterator>
+
 extern "C" {
 #include <libavutil/imgutils.h>
 }
@@ -129,6 +132,24 @@ void DecodeFramesAndCheckHashes(MediaProcessor* processor,
   EXPECT_EQ(results, std::string(expected.begin(), expected.end()));
 }
 
+#ifdef ENABLE_NATIVE_MP4_DEMUXER
+/**
+ * Changes the size of the last top-level box in the given MP4 data to 0, which
+ * means the box extends to the end of the data.
+ */
+void MakeLastBoxExtendToEnd(std::vector<uint8_t>* data) {
+  size_t offset = 0;
+  size_t last = 0;
+  while (offset + 4 <= data->size()) {
+    last = offset;
+    const uint8_t* size = data->data() + offset;
+    offset += (static_cast<size_t>(size[0]) << 24) | (size[1] << 16) |
+              (size[2] << 8) | size[3];
+  }
+  std::fill(data->begin() + last, data->begin() + last + 4, 0);
+}
+#endif
+
 void ExpectNoAdaptation() {
   EXPECT_FALSE(true) << "Not expecting adaptation.";
 }
@@ -214,6 +235,45 @@ TEST_F(MediaProcessorIntegration, HandlesMp4Adaptation) {
   ASSERT_EQ(processor.ReadDemuxedFrame(&frame), Status::EndOfStream);
 }
 
+TEST_F(MediaProcessorIntegration, ReusesStreamForRepeatedInitSegment) {
+  // Each append contains both the init segment and the media segment so the
+  // reset callback rewinds to the start of the init segment.
+  std::vector<uint8_t> low = GetMediaFile(kMp4LowInit);
+  const std::vector<uint8_t> low_seg = GetMediaFile(kMp4LowSeg);
+  low.insert(low.end(), low_seg.begin(), low_seg.end());
+
+  SegmentReader reader;
+  reader.AppendSegment(low);
+  reader.AppendSegment(GetMediaFile(kMp4High));
+  reader.AppendSegment(low);
+
+  MediaProcessor::Initialize();
+  MediaProcessor processor("mp4", "avc1.42c01e", &IgnoreInitData);
+  ASSERT_EQ(processor.InitializeDemuxer(reader.MakeReadCallback(),
+                                        reader.MakeResetReadCallback()),
+            Status::Success);
+
+  std::vector<size_t> stream_ids;
+  for (size_t i = 0; i < 3 * 120; i++) {
+    std::unique_ptr<BaseFrame> frame;
+    ASSERT_EQ(processor.ReadDemuxedFrame(&frame), Status::Success);
+    ASSERT_EQ(frame->frame_type(), FrameType::FFmpegEncodedFrame);
+    EXPECT_NEAR(frame->dts, (i % 120) * 0.041666, 0.0001);
+    if (i % 120 == 0) {
+      stream_ids.push_back(
+          static_cast<FFmpegEncodedFrame*>(frame.get())->stream_id());
+    }
+  }
+
+  std::unique_ptr<BaseFrame> frame;
+  ASSERT_EQ(processor.ReadDemuxedFrame(&frame), Status::EndOfStream);
+
+  ASSERT_EQ(stream_ids.size(), 3u);
+  EXPECT_NE(stream_ids[0], stream_ids[1]);
+  // Returning to the low rendition should reuse the same stream.
+  EXPECT_EQ(stream_ids[0], stream_ids[2]);
+}
+
 TEST_F(MediaProcessorIntegration, AccountsForTimestampOffset) {
   SegmentReader reader;
   reader.AppendSegment(GetMediaFile(kMp4LowInit));
@@ -304,6 +364,114 @@ TEST_F(MediaProcessorIntegration, CanDecodeFrames) {
   DecodeFramesAndCheckHashes(&processor, nullptr);
 }
 
+#ifdef ENABLE_NATIVE_MP4_DEMUXER
+TEST_F(MediaProcessorIntegration, DecodesFragmentedMp4Natively) {
+  SegmentReader reader;
+  reader.AppendSegment(GetMediaFile(kMp4LowInit));
+  reader.AppendSegment(GetMediaFile(kMp4LowSeg));
+
+  MediaProcessor::Initialize();
+  MediaProcessor processor("mp4", "avc1.42c01e", &IgnoreInitData);
+  ASSERT_EQ(processor.InitializeDemuxer(reader.MakeReadCallback(),
+                                        &ExpectNoAdaptation),
+            Status::Success);
+  EXPECT_TRUE(processor.IsUsingNativeDemuxer());
+
+  DecodeFramesAndCheckHashes(&processor, nullptr);
+  EXPECT_TRUE(processor.IsUsingNativeDemuxer());
+}
+
+TEST_F(MediaProcessorIntegration, NativeDemuxerHandlesMdatExtendingToEnd) {
+  std::vector<uint8_t> segment = GetMediaFile(kMp4LowSeg);
+  MakeLastBoxExtendToEnd(&segment);
+  SegmentReader reader;
+  reader.AppendSegment(GetMediaFile(kMp4LowInit));
+  reader.AppendSegment(segment);
+
+  MediaProcessor::Initialize();
+  MediaProcessor processor("mp4", "avc1.42c01e", &IgnoreInitData);
+  ASSERT_EQ(processor.InitializeDemuxer(reader.MakeReadCallback(),
+                                        &ExpectNoAdaptation),
+            Status::Success);
+
+  // We can't know where the 'mdat' ends, so libavformat reads it.
+  DecodeFramesAndCheckHashes(&processor, nullptr);
+  EXPECT_FALSE(processor.IsUsingNativeDemuxer());
+}
+
+TEST_F(MediaProcessorIntegration, NativeDemuxerHandlesBoxExtendingToEnd) {
+  // A trailing 'free' box that extends to the end of the data.
+  std::vector<uint8_t> segment = GetMediaFile(kMp4LowSeg);
+  const uint8_t free_box[] = {0, 0, 0, 16, 'f', 'r', 'e', 'e',
+                              1, 2, 3, 4,  5,   6,   7,   8};
+  segment.insert(segment.end(), std::begin(free_box), std::end(free_box));
+  MakeLastBoxExtendToEnd(&segment);
+  SegmentReader reader;
+  reader.AppendSegment(GetMediaFile(kMp4LowInit));
+  reader.AppendSegment(segment);
+
+  MediaProcessor::Initialize();
+  MediaProcessor processor("mp4", "avc1.42c01e", &IgnoreInitData);
+  ASSERT_EQ(processor.InitializeDemuxer(reader.MakeReadCallback(),
+                                        &ExpectNoAdaptation),
+            Status::Success);
+
+  for (size_t i = 0; i < 120; i++) {
+    std::unique_ptr<BaseFrame> frame;
+    ASSERT_EQ(processor.ReadDemuxedFrame(&frame), Status::Success);
+    EXPECT_NEAR(frame->dts, i * 0.041666, 0.0001);
+  }
+  EXPECT_TRUE(processor.IsUsingNativeDemuxer());
+
+  std::unique_ptr<BaseFrame> frame;
+  ASSERT_EQ(processor.ReadDemuxedFrame(&frame), Status::EndOfStream);
+}
+#endif
+
+TEST_F(MediaProcessorIntegration, DropsFramesBeforeSeekTarget) {
+  constexpr const double kSeekTarget = 2.5;
+  SegmentReader reader;
+  reader.AppendSegment(GetMediaFile(kMp4LowInit));
+  reader.AppendSegment(GetMediaFile(kMp4LowSeg));
+
+  MediaProcessor::Initialize();
+  MediaProcessor processor("mp4", "avc1.42c01e", &IgnoreInitData);
+  ASSERT_EQ(processor.InitializeDemuxer(reader.MakeReadCallback(),
+                                        &ExpectNoAdaptation),
+            Status::Success);
+  processor.SetSeekTarget(kSeekTarget);
+
+  size_t decoded_count = 0;
+  size_t demuxed_count = 0;
+  double first_pts = -1;
+  Status status = Status::Success;
+  while (status != Status::EndOfStream) {
+    std::unique_ptr<BaseFrame> frame;
+    status = processor.ReadDemuxedFrame(&frame);
+    if (status != Status::EndOfStream) {
+      ASSERT_EQ(status, Status::Success);
+      demuxed_count++;
+    }
+
+    std::vector<std::unique_ptr<BaseFrame>> decoded_frames;
+    ASSERT_EQ(processor.DecodeFrame(kSeekTarget, frame.get(), nullptr,
+                                    &decoded_frames),
+              Status::Success);
+    for (auto& decoded : decoded_frames) {
+      if (decoded_count == 0)
+        first_pts = decoded->pts;
+      EXPECT_GT(decoded->pts + decoded->duration, kSeekTarget);
+      decoded_count++;
+    }
+  }
+
+  // The first frame returned should be the one that contains the seek target;
+  // later frames aren't affected by the target.
+  EXPECT_LE(first_pts, kSeekTarget);
+  EXPECT_GT(decoded_count, 0u);
+  EXPECT_LT(decoded_count, demuxed_count);
+}
+
 TEST_F(MediaProcessorIntegration, CanDecodeWithAdaptation) {
   SegmentReader reader;
   reader.AppendSegment(GetMediaFile(kMp4LowInit));
@@ -0,0 +1,190 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/media/mp4_parser.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "test/src/test/media_files.h"
+
+namespace shaka {
+namespace media {
+
+namespace {
+
+constexpr const uint32_t kMoof = Mp4BoxType('m', 'o', 'o', 'f');
+constexpr const uint32_t kMoov = Mp4BoxType('m', 'o', 'o', 'v');
+
+/**
+ * Finds the top-level box with the given type.  Returns the offset of the box
+ * and sets |size| to the size of the box.
+ */
+size_t FindBox(const std::vector<uint8_t>& data, uint32_t type,
+               size_t* size) {
+  util::BufferReader reader(data.data(), data.size());
+  while (!reader.empty()) {
+    const size_t offset = data.size() - reader.BytesRemaining();
+    Mp4BoxHeader header;
+    if (!Mp4Parser::ReadBoxHeader(&reader, &header))
+      break;
+    if (header.type == type) {
+      *size = header.box_size;
+      return offset;
+    }
+    reader.Skip(header.box_size - header.header_size);
+  }
+  ADD_FAILURE() << "Unable to find box";
+  *size = 0;
+  return 0;
+}
+
+}  // namespace
+
+TEST(Mp4ParserTest, ReadBoxHeader) {
+  const uint8_t data[] = {0x00, 0x00, 0x00, 0x10, 'f', 'r', 'e', 'e',
+                          0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+  util::BufferReader reader(data, sizeof(data));
+  Mp4BoxHeader header;
+  ASSERT_TRUE(Mp4Parser::ReadBoxHeader(&reader, &header));
+  EXPECT_EQ(Mp4BoxType('f', 'r', 'e', 'e'), header.type);
+  EXPECT_EQ(8u, header.header_size);
+  EXPECT_EQ(16u, header.box_size);
+  EXPECT_EQ(8u, reader.BytesRemaining());
+}
+
+TEST(Mp4ParserTest, ReadBoxHeader_LargeSize) {
+  const uint8_t data[] = {0x00, 0x00, 0x00, 0x01, 'm',  'd',  'a',  't',
+                          0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00};
+  util::BufferReader reader(data, sizeof(data));
+  Mp4BoxHeader header;
+  ASSERT_TRUE(Mp4Parser::ReadBoxHeader(&reader, &header));
+  EXPECT_EQ(Mp4BoxType('m', 'd', 'a', 't'), header.type);
+  EXPECT_EQ(16u, header.header_size);
+  EXPECT_EQ(0x100000000u, header.box_size);
+}
+
+TEST(Mp4ParserTest, ReadBoxHeader_Invalid) {
+  Mp4BoxHeader header;
+  {
+    // Too short.
+    const uint8_t data[] = {0x00, 0x00, 0x00, 0x10, 'f', 'r'};
+    util::BufferReader reader(data, sizeof(data));
+    EXPECT_FALSE(Mp4Parser::ReadBoxHeader(&reader, &header));
+  }
+  {
+    // Size smaller than the header.
+    const uint8_t data[] = {0x00, 0x00, 0x00, 0x04, 'f', 'r', 'e', 'e'};
+    util::BufferReader reader(data, sizeof(data));
+    EXPECT_FALSE(Mp4Parser::ReadBoxHeader(&reader, &header));
+  }
+}
+
+TEST(Mp4ParserTest, RejectsNonFragmentedContent) {
+  // A 'moov' with only an 'mvhd'.
+  std::vector<uint8_t> data = {0x00, 0x00, 0x00, 0x74, 'm',  'o',  'o',  'v',
+                               0x00, 0x00, 0x00, 0x6c, 'm',  'v',  'h',  'd'};
+  data.resize(0x74);
+  Mp4Parser parser;
+  EXPECT_FALSE(parser.ParseInitSegment(data.data(), data.size()));
+}
+
+TEST(Mp4ParserTest, ParsesClearFragment) {
+  const std::vector<uint8_t> init = GetMediaFile("clear_low_frag_init.mp4");
+  const std::vector<uint8_t> segment = GetMediaFile("clear_low_frag_seg1.mp4");
+  size_t moov_size;
+  const size_t moov_offset = FindBox(init, kMoov, &moov_size);
+  size_t moof_size;
+  const size_t moof_offset = FindBox(segment, kMoof, &moof_size);
+
+  Mp4Parser parser;
+  ASSERT_TRUE(parser.ParseInitSegment(init.data() + moov_offset, moov_size));
+  EXPECT_EQ(12288u, parser.timescale());
+  EXPECT_FALSE(parser.is_encrypted());
+
+  std::vector<Mp4Sample> samples;
+  std::vector<uint8_t> pssh;
+  ASSERT_TRUE(parser.ParseFragment(segment.data() + moof_offset, moof_size,
+                                   &samples, &pssh));
+  EXPECT_TRUE(pssh.empty());
+  ASSERT_EQ(120u, samples.size());
+
+  // The sample data should cover the whole 'mdat' that follows the 'moof'.
+  const uint64_t mdat_start = moof_size + 8;
+  EXPECT_EQ(mdat_start, samples[0].offset);
+  for (size_t i = 0; i < samples.size(); i++) {
+    EXPECT_EQ(static_cast<int64_t>(i * 512), samples[i].dts);
+    EXPECT_EQ(samples[i].dts, samples[i].pts);
+    EXPECT_EQ(512u, samples[i].duration);
+    EXPECT_EQ(i == 0, samples[i].is_key_frame);
+    EXPECT_FALSE(samples[i].is_encrypted);
+    if (i > 0) {
+      EXPECT_EQ(samples[i - 1].offset + samples[i - 1].size,
+                samples[i].offset);
+    }
+  }
+  EXPECT_EQ(segment.size() - moof_offset,
+            samples.back().offset + samples.back().size);
+}
+
+TEST(Mp4ParserTest, ParsesEncryptedFragment) {
+  const std::vector<uint8_t> file = GetMediaFile("encrypted_low_cenc.mp4");
+  size_t moov_size;
+  const size_t moov_offset = FindBox(file, kMoov, &moov_size);
+  size_t moof_size;
+  const size_t moof_offset = FindBox(file, kMoof, &moof_size);
+
+  Mp4Parser parser;
+  ASSERT_TRUE(parser.ParseInitSegment(file.data() + moov_offset, moov_size));
+  EXPECT_TRUE(parser.is_encrypted());
+  EXPECT_EQ(Mp4BoxType('c', 'e', 'n', 'c'), parser.scheme());
+  EXPECT_EQ(16u, parser.key_id().size());
+
+  std::vector<Mp4Sample> samples;
+  std::vector<uint8_t> pssh;
+  ASSERT_TRUE(parser.ParseFragment(file.data() + moof_offset, moof_size,
+                                   &samples, &pssh));
+  ASSERT_EQ(120u, samples.size());
+  for (const Mp4Sample& sample : samples) {
+    EXPECT_TRUE(sample.is_encrypted);
+    EXPECT_EQ(8u, sample.iv.size());
+    ASSERT_FALSE(sample.subsamples.empty());
+
+    uint64_t total = 0;
+    for (const Mp4Subsample& subsample : sample.subsamples)
+      total += subsample.clear_bytes + subsample.protected_bytes;
+    EXPECT_EQ(sample.size, total);
+  }
+}
+
+TEST(Mp4ParserTest, RejectsFragmentWithoutTrackFragment) {
+  const std::vector<uint8_t> init = GetMediaFile("clear_low_frag_init.mp4");
+  size_t moov_size;
+  const size_t moov_offset = FindBox(init, kMoov, &moov_size);
+
+  Mp4Parser parser;
+  ASSERT_TRUE(parser.ParseInitSegment(init.data() + moov_offset, moov_size));
+
+  // A 'moof' without a 'traf'.
+  const uint8_t moof[] = {0x00, 0x00, 0x00, 0x18, 'm',  'o',  'o',  'f',
+                          0x00, 0x00, 0x00, 0x10, 'm',  'f',  'h',  'd',
+                          0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01};
+  std::vector<Mp4Sample> samples;
+  std::vector<uint8_t> pssh;
+  EXPECT_FALSE(parser.ParseFragment(moof, sizeof(moof), &samples, &pssh));
+}
+
+}  // namespace media
+}  // namespace shaka
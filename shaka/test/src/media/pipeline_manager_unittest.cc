@@ -101,6 +101,38 @@ TEST(PipelineManagerTest, CalculatesCurrentTime) {
   EXPECT_EQ(pipeline.GetCurrentTime(), 10);
 }
 
+TEST(PipelineManagerTest, PublishesTimeline) {
+  NiceMock<MockClock> clock;
+  NiceMock<MockFunction<void(PipelineStatus)>> client;
+  auto callback = std::bind(&decltype(client)::Call, &client, _1);
+  EXPECT_CALL(clock, GetMonotonicTime()).WillRepeatedly(Return(1000));
+
+  PipelineManager pipeline(callback, &IgnoreSeek, &clock);
+  EXPECT_EQ(pipeline.GetTimeline().status, PipelineStatus::Initializing);
+  pipeline.DoneInitializing();
+  pipeline.SetDuration(20);
+  pipeline.Play();
+  pipeline.CanPlay();
+
+  // The time can be calculated from the timeline without calling back into
+  // the pipeline.
+  PipelineTimeline timeline = pipeline.GetTimeline();
+  EXPECT_EQ(timeline.status, PipelineStatus::Playing);
+  EXPECT_EQ(timeline.duration, 20);
+  EXPECT_EQ(timeline.GetTimeFor(1000), 0);
+  EXPECT_EQ(timeline.GetTimeFor(4000), 3);
+  EXPECT_EQ(timeline.GetTimeFor(100000), 20);
+
+  pipeline.SetPlaybackRate(2);
+  EXPECT_EQ(pipeline.GetTimeline().GetTimeFor(2000), 2);
+
+  EXPECT_CALL(clock, GetMonotonicTime()).WillRepeatedly(Return(3000));
+  pipeline.Pause();
+  timeline = pipeline.GetTimeline();
+  EXPECT_EQ(timeline.status, PipelineStatus::Paused);
+  EXPECT_EQ(timeline.GetTimeFor(10000), 4);
+}
+
 TEST(PipelineManagerTest, SeeksIfPastEndWhenSettingDuration) {
   NiceMock<MockClock> clock;
   MockFunction<void(PipelineStatus)> client;
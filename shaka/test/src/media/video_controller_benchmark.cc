@@ -0,0 +1,183 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/media/video_controller.h"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "src/debug/thread_event.h"
+#include "src/test/benchmark.h"
+#include "src/test/media_files.h"
+
+namespace shaka {
+namespace media {
+
+namespace {
+
+constexpr const char* kMimeType = "video/mp4; codecs=\"avc1.42c01e\"";
+constexpr const char* kInitSegment = "clear_low_frag_init.mp4";
+constexpr const char* kMediaSegment = "clear_low_frag_seg1.mp4";
+
+/** How long to wait for the pipeline before failing the benchmark. */
+constexpr const std::chrono::seconds kTimeout{10};
+
+using Clock = std::chrono::steady_clock;
+
+/** A VideoController with a single video stream, run headlessly. */
+class VideoHarness {
+ public:
+  VideoHarness()
+      : has_error_(false),
+        controller_([this](SourceType, Status) { has_error_ = true; }, []() {},
+                    [](eme::MediaKeyInitDataType, ByteBuffer) {},
+                    [](MediaReadyState) {}, [](PipelineStatus) {}) {}
+
+  bool has_error() const {
+    return has_error_;
+  }
+
+  VideoController* controller() {
+    return &controller_;
+  }
+
+  bool AddSource() {
+    return controller_.AddSource(kMimeType, &type_) == Status::Success;
+  }
+
+  /** Starts appending the given data; doesn't wait for it to be demuxed. */
+  std::shared_ptr<ThreadEvent<Status>> StartAppend(
+      const std::vector<uint8_t>& data) {
+    std::shared_ptr<ThreadEvent<Status>> ret(
+        new ThreadEvent<Status>("Benchmark append"));
+    if (!controller_.AppendData(type_, 0, 0, HUGE_VAL, data.data(),
+                                data.size(), [ret](Status status) {
+                                  ret->SignalAllIfNotSet(status);
+                                })) {
+      ret->SignalAllIfNotSet(Status::UnknownError);
+    }
+    return ret;
+  }
+
+  /**
+   * Waits until the given callback returns true.
+   * @return False on timeout or pipeline error.
+   */
+  template <typename Func>
+  bool WaitFor(Func&& done) {
+    const auto deadline = Clock::now() + kTimeout;
+    while (!done()) {
+      if (has_error_ || Clock::now() > deadline)
+        return false;
+      std::this_thread::sleep_for(std::chrono::microseconds(500));
+    }
+    return true;
+  }
+
+  bool HasDecodedFrames() {
+    PipelineMetrics metrics;
+    controller_.GetPipelineMetrics(&metrics);
+    return metrics.video.decoded_buffer_seconds > 0;
+  }
+
+ private:
+  std::atomic<bool> has_error_;
+  VideoController controller_;
+  SourceType type_;
+};
+
+std::vector<uint8_t> LoadSegments() {
+  std::vector<uint8_t> ret = GetMediaFile(kInitSegment);
+  const std::vector<uint8_t> segment = GetMediaFile(kMediaSegment);
+  ret.insert(ret.end(), segment.begin(), segment.end());
+  return ret;
+}
+
+void BM_AppendToFirstDecodedFrame(benchmark::State& state) {
+  // The time from an appendBuffer() call with the first segments until the
+  // decoder has a frame to show, which is most of the startup latency.
+  const std::vector<uint8_t> data = LoadSegments();
+  while (state.KeepRunning()) {
+    std::unique_ptr<VideoHarness> harness(new VideoHarness);
+    if (!harness->AddSource()) {
+      state.SkipWithError("Unable to add source");
+      return;
+    }
+
+    const auto start = Clock::now();
+    auto append = harness->StartAppend(data);
+    if (!harness->WaitFor([&]() { return harness->HasDecodedFrames(); })) {
+      state.SkipWithError("Timed out waiting for the first frame");
+      return;
+    }
+    state.SetIterationTime(
+        std::chrono::duration<double>(Clock::now() - start).count());
+
+    // Wait for the append to finish so it doesn't use |data| after this.
+    append->GetValue();
+  }
+}
+BENCHMARK(BM_AppendToFirstDecodedFrame)
+    ->UseManualTime()
+    ->Unit(benchmark::TimeUnit::Millisecond);
+
+void BM_SeekLatency(benchmark::State& state) {
+  // The time from a seek within buffered content until the pipeline leaves
+  // the seeking state, alternating between two times in different GOPs.
+  const std::vector<uint8_t> data = LoadSegments();
+  VideoHarness harness;
+  if (!harness.AddSource()) {
+    state.SkipWithError("Unable to add source");
+    return;
+  }
+  if (harness.StartAppend(data)->GetValue() != Status::Success) {
+    state.SkipWithError("Error appending media");
+    return;
+  }
+  harness.controller()->EndOfStream();
+
+  PipelineManager* pipeline = harness.controller()->GetPipelineManager();
+  auto is_paused = [pipeline]() {
+    return pipeline->GetPipelineStatus() == PipelineStatus::Paused;
+  };
+  if (!harness.WaitFor(is_paused)) {
+    state.SkipWithError("Timed out waiting for initialization");
+    return;
+  }
+
+  const double kSeekTimes[] = {7.3, 2.1};
+  size_t seek_index = 0;
+  while (state.KeepRunning()) {
+    const auto start = Clock::now();
+    pipeline->SetCurrentTime(kSeekTimes[seek_index++ % 2]);
+    if (!harness.WaitFor(is_paused)) {
+      state.SkipWithError("Timed out waiting for the seek");
+      return;
+    }
+    state.SetIterationTime(
+        std::chrono::duration<double>(Clock::now() - start).count());
+  }
+}
+BENCHMARK(BM_SeekLatency)
+    ->UseManualTime()
+    ->Unit(benchmark::TimeUnit::Millisecond);
+
+}  // namespace
+
+}  // namespace media
+}  // namespace shaka
@@ -0,0 +1,413 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/test/benchmark.h"
+
+#include <glog/logging.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <fstream>
+#include <regex>
+#include <thread>
+#include <utility>
+
+#include "shaka/version.h"
+#include "src/util/utils.h"
+
+namespace shaka {
+namespace benchmark {
+
+namespace {
+
+/** The most iterations to run a benchmark for. */
+constexpr const uint64_t kMaxIterations = 1000000000;
+
+struct Result {
+  std::string name;
+  uint64_t iterations = 0;
+  double real_time = 0;
+  double cpu_time = 0;
+  TimeUnit unit = TimeUnit::Nanosecond;
+  double items_per_second = 0;
+  double bytes_per_second = 0;
+  std::string label;
+  std::string error;
+  std::map<std::string, double> counters;
+};
+
+std::vector<Benchmark*>* GetBenchmarks() {
+  static std::vector<Benchmark*>* benchmarks = new std::vector<Benchmark*>;
+  return benchmarks;
+}
+
+double UnitMultiplier(TimeUnit unit) {
+  switch (unit) {
+    case TimeUnit::Nanosecond:
+      return 1e9;
+    case TimeUnit::Microsecond:
+      return 1e6;
+    case TimeUnit::Millisecond:
+      return 1e3;
+  }
+  return 1;
+}
+
+const char* UnitName(TimeUnit unit) {
+  switch (unit) {
+    case TimeUnit::Nanosecond:
+      return "ns";
+    case TimeUnit::Microsecond:
+      return "us";
+    case TimeUnit::Millisecond:
+      return "ms";
+  }
+  return "";
+}
+
+std::string EscapeJson(const std::string& str) {
+  std::string ret;
+  for (char c : str) {
+    if (c == '"' || c == '\\') {
+      ret.push_back('\\');
+      ret.push_back(c);
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      ret += util::StringPrintf("\\u%04x", c);
+    } else {
+      ret.push_back(c);
+    }
+  }
+  return ret;
+}
+
+std::string FormatRate(double value, const char* suffix) {
+  const char* kPrefixes[] = {"", "k", "M", "G", "T"};
+  size_t i = 0;
+  while (value >= 1000 && i + 1 < sizeof(kPrefixes) / sizeof(kPrefixes[0])) {
+    value /= 1000;
+    i++;
+  }
+  return util::StringPrintf("%.3g%s%s", value, kPrefixes[i], suffix);
+}
+
+std::string FormatConsoleHeader(size_t name_width) {
+  std::string ret = util::StringPrintf(
+      "%-*s %15s %15s %12s\n", static_cast<int>(name_width), "Benchmark",
+      "Time", "CPU", "Iterations");
+  ret += std::string(name_width + 45, '-') + "\n";
+  return ret;
+}
+
+std::string FormatConsoleLine(const Result& result, size_t name_width) {
+  std::string ret = util::StringPrintf(
+      "%-*s ", static_cast<int>(name_width), result.name.c_str());
+  if (!result.error.empty())
+    return ret + "ERROR: " + result.error + "\n";
+
+  ret += util::StringPrintf(
+      "%12.0f %-2s %12.0f %-2s %12llu", result.real_time,
+      UnitName(result.unit), result.cpu_time, UnitName(result.unit),
+      static_cast<unsigned long long>(result.iterations));  // NOLINT
+  if (result.bytes_per_second > 0)
+    ret += " " + FormatRate(result.bytes_per_second, "B/s");
+  if (result.items_per_second > 0)
+    ret += " " + FormatRate(result.items_per_second, " items/s");
+  for (auto& pair : result.counters)
+    ret += util::StringPrintf(" %s=%g", pair.first.c_str(), pair.second);
+  if (!result.label.empty())
+    ret += " " + result.label;
+  return ret + "\n";
+}
+
+std::string FormatJson(const std::vector<Result>& results) {
+  char date[64] = {0};
+  const std::time_t now = std::time(nullptr);
+  std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+  std::string ret = "{\n  \"context\": {\n";
+  ret += util::StringPrintf("    \"date\": \"%s\",\n", date);
+  ret += util::StringPrintf("    \"shaka_version\": \"%s\",\n",
+                            EscapeJson(GetShakaEmbeddedVersion()).c_str());
+  ret += util::StringPrintf("    \"num_cpus\": %u,\n",
+                            std::thread::hardware_concurrency());
+#ifdef NDEBUG
+  ret += "    \"library_build_type\": \"release\"\n";
+#else
+  ret += "    \"library_build_type\": \"debug\"\n";
+#endif
+  ret += "  },\n  \"benchmarks\": [";
+
+  bool first = true;
+  for (auto& result : results) {
+    ret += first ? "\n" : ",\n";
+    first = false;
+
+    ret += util::StringPrintf("    {\n      \"name\": \"%s\",\n",
+                              EscapeJson(result.name).c_str());
+    if (!result.error.empty()) {
+      ret += util::StringPrintf(
+          "      \"error_occurred\": true,\n"
+          "      \"error_message\": \"%s\"\n    }",
+          EscapeJson(result.error).c_str());
+      continue;
+    }
+
+    ret += util::StringPrintf(
+        "      \"iterations\": %llu,\n"
+        "      \"real_time\": %f,\n"
+        "      \"cpu_time\": %f,\n"
+        "      \"time_unit\": \"%s\"",
+        static_cast<unsigned long long>(result.iterations),  // NOLINT
+        result.real_time, result.cpu_time, UnitName(result.unit));
+    if (result.bytes_per_second > 0) {
+      ret += util::StringPrintf(",\n      \"bytes_per_second\": %f",
+                                result.bytes_per_second);
+    }
+    if (result.items_per_second > 0) {
+      ret += util::StringPrintf(",\n      \"items_per_second\": %f",
+                                result.items_per_second);
+    }
+    for (auto& pair : result.counters) {
+      ret += util::StringPrintf(",\n      \"%s\": %f",
+                                EscapeJson(pair.first).c_str(), pair.second);
+    }
+    if (!result.label.empty()) {
+      ret += util::StringPrintf(",\n      \"label\": \"%s\"",
+                                EscapeJson(result.label).c_str());
+    }
+    ret += "\n    }";
+  }
+  ret += "\n  ]\n}\n";
+  return ret;
+}
+
+}  // namespace
+
+class Runner {
+ public:
+  explicit Runner(double min_time) : min_time_(min_time) {}
+
+  /** @return The benchmarks to run and their arguments, in order. */
+  static std::vector<std::pair<const Benchmark*, std::vector<int64_t>>>
+  GetRuns() {
+    std::vector<std::pair<const Benchmark*, std::vector<int64_t>>> ret;
+    for (const Benchmark* benchmark : *GetBenchmarks()) {
+      if (benchmark->args_.empty()) {
+        ret.emplace_back(benchmark, std::vector<int64_t>());
+      } else {
+        for (auto& args : benchmark->args_)
+          ret.emplace_back(benchmark, args);
+      }
+    }
+    return ret;
+  }
+
+  static std::string GetName(const Benchmark& benchmark,
+                             const std::vector<int64_t>& args) {
+    std::string ret = benchmark.name_;
+    for (int64_t arg : args)
+      ret += "/" + std::to_string(arg);
+    return ret;
+  }
+
+  Result Run(const Benchmark& benchmark, const std::vector<int64_t>& args) {
+    Result result;
+    result.name = GetName(benchmark, args);
+    result.unit = benchmark.unit_;
+
+    uint64_t iterations = benchmark.iterations_ ? benchmark.iterations_ : 1;
+    while (true) {
+      State state(iterations, args);
+      benchmark.function_(state);
+      if (!state.error_.empty()) {
+        result.error = state.error_;
+        return result;
+      }
+      CHECK(!state.running_) << "Benchmark didn't finish its loop.";
+
+      const double seconds = benchmark.use_manual_time_ ? state.manual_seconds_
+                                                        : state.real_seconds_;
+      if (benchmark.iterations_ || seconds >= min_time_ ||
+          iterations >= kMaxIterations) {
+        Fill(state, seconds, &result);
+        return result;
+      }
+
+      // Predict how many iterations are needed, but don't grow too fast in
+      // case the first iterations were noisy.
+      const double multiplier =
+          seconds <= min_time_ / 100 ? 10 : min_time_ * 1.4 / seconds;
+      iterations = std::min<uint64_t>(
+          kMaxIterations,
+          std::max<uint64_t>(iterations + 1,
+                             static_cast<uint64_t>(iterations * multiplier)));
+    }
+  }
+
+ private:
+  void Fill(const State& state, double seconds, Result* result) {
+    const double iterations = static_cast<double>(state.iterations_);
+    const double multiplier = UnitMultiplier(result->unit);
+    result->iterations = state.iterations_;
+    result->real_time = seconds / iterations * multiplier;
+    result->cpu_time = state.cpu_seconds_ / iterations * multiplier;
+    if (seconds > 0) {
+      result->items_per_second = state.items_processed_ / seconds;
+      result->bytes_per_second = state.bytes_processed_ / seconds;
+    }
+    result->label = state.label_;
+    result->counters = state.counters;
+  }
+
+  const double min_time_;
+};
+
+
+State::State(uint64_t max_iterations, std::vector<int64_t> args)
+    : max_iterations_(max_iterations),
+      args_(std::move(args)),
+      iterations_(0),
+      started_(false),
+      running_(false),
+      cpu_start_(0),
+      real_seconds_(0),
+      cpu_seconds_(0),
+      manual_seconds_(0),
+      items_processed_(0),
+      bytes_processed_(0) {}
+
+State::~State() {}
+
+void State::PauseTiming() {
+  CHECK(running_);
+  running_ = false;
+  real_seconds_ +=
+      std::chrono::duration<double>(Clock::now() - real_start_).count();
+  cpu_seconds_ +=
+      static_cast<double>(std::clock() - cpu_start_) / CLOCKS_PER_SEC;
+}
+
+void State::ResumeTiming() {
+  CHECK(!running_);
+  running_ = true;
+  cpu_start_ = std::clock();
+  real_start_ = Clock::now();
+}
+
+void State::SetIterationTime(double seconds) {
+  manual_seconds_ += seconds;
+}
+
+int64_t State::range(size_t index) const {
+  CHECK_LT(index, args_.size()) << "Benchmark doesn't have enough arguments.";
+  return args_[index];
+}
+
+void State::SkipWithError(const std::string& error) {
+  error_ = error;
+  if (running_)
+    PauseTiming();
+}
+
+
+Benchmark::Benchmark(const std::string& name, Function function)
+    : name_(name),
+      function_(function),
+      iterations_(0),
+      use_manual_time_(false),
+      unit_(TimeUnit::Nanosecond) {}
+
+Benchmark::~Benchmark() {}
+
+Benchmark* Benchmark::Arg(int64_t arg) {
+  args_.push_back({arg});
+  return this;
+}
+
+Benchmark* Benchmark::Args(const std::vector<int64_t>& args) {
+  args_.push_back(args);
+  return this;
+}
+
+Benchmark* Benchmark::Iterations(uint64_t iterations) {
+  iterations_ = iterations;
+  return this;
+}
+
+Benchmark* Benchmark::UseManualTime() {
+  use_manual_time_ = true;
+  return this;
+}
+
+Benchmark* Benchmark::Unit(TimeUnit unit) {
+  unit_ = unit;
+  return this;
+}
+
+
+Benchmark* RegisterBenchmark(const std::string& name, Benchmark::Function fn) {
+  Benchmark* ret = new Benchmark(name, fn);
+  GetBenchmarks()->push_back(ret);
+  return ret;
+}
+
+int RunBenchmarks(const std::string& filter, const std::string& format,
+                  const std::string& out_file, double min_time) {
+  if (format != "console" && format != "json") {
+    LOG(ERROR) << "Unknown benchmark format: " << format;
+    return 1;
+  }
+
+  const std::regex filter_regex(filter);
+  std::vector<std::pair<const Benchmark*, std::vector<int64_t>>> runs;
+  size_t name_width = 10;
+  for (auto& run : Runner::GetRuns()) {
+    const std::string name = Runner::GetName(*run.first, run.second);
+    if (std::regex_search(name, filter_regex)) {
+      name_width = std::max(name_width, name.size());
+      runs.emplace_back(std::move(run));
+    }
+  }
+
+  if (format == "console")
+    fputs(FormatConsoleHeader(name_width).c_str(), stdout);
+
+  Runner runner(min_time);
+  std::vector<Result> results;
+  for (auto& run : runs) {
+    Result result = runner.Run(*run.first, run.second);
+    if (format == "console") {
+      // Print the results as we go since benchmarks can be slow.
+      fputs(FormatConsoleLine(result, name_width).c_str(), stdout);
+      fflush(stdout);
+    }
+    results.emplace_back(std::move(result));
+  }
+
+  if (format == "json")
+    fputs(FormatJson(results).c_str(), stdout);
+
+  if (!out_file.empty()) {
+    std::ofstream out(out_file);
+    out << FormatJson(results);
+    if (!out) {
+      LOG(ERROR) << "Unable to write benchmark results to " << out_file;
+      return 1;
+    }
+  }
+  return 0;
+}
+
+}  // namespace benchmark
+}  // namespace shaka
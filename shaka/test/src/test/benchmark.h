@@ -0,0 +1,205 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SHAKA_EMBEDDED_TEST_TEST_BENCHMARK_H_
+#define SHAKA_EMBEDDED_TEST_TEST_BENCHMARK_H_
+
+#include <stdint.h>
+
+#include <chrono>
+#include <ctime>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "src/util/macros.h"
+
+namespace shaka {
+namespace benchmark {
+
+/**
+ * A small benchmark harness that follows the API and output format of Google
+ * Benchmark, which we don't have as a dependency.  Benchmarks are functions
+ * that take a State and loop while KeepRunning() returns true:
+ *
+ * \code{cpp}
+ *   void BM_Something(benchmark::State& state) {
+ *     while (state.KeepRunning()) {
+ *       DoSomething(state.range(0));
+ *     }
+ *     state.SetItemsProcessed(state.iterations());
+ *   }
+ *   BENCHMARK(BM_Something)->Arg(10)->Arg(1000);
+ * \endcode
+ *
+ * The runner increases the number of iterations until the benchmark runs for
+ * at least --benchmark_min_time seconds, then reports the time per iteration.
+ */
+class State final {
+ public:
+  State(uint64_t max_iterations, std::vector<int64_t> args);
+  ~State();
+
+  NON_COPYABLE_OR_MOVABLE_TYPE(State);
+
+  /**
+   * @return Whether to run another iteration.  This starts the timer on the
+   *   first call and stops it after the last iteration.
+   */
+  bool KeepRunning() {
+    if (!started_) {
+      started_ = true;
+      ResumeTiming();
+    }
+    if (iterations_ < max_iterations_ && error_.empty()) {
+      iterations_++;
+      return true;
+    }
+    if (running_)
+      PauseTiming();
+    return false;
+  }
+
+  /** Stops the timer, e.g. to exclude per-iteration setup. */
+  void PauseTiming();
+  /** Restarts the timer after PauseTiming. */
+  void ResumeTiming();
+
+  /**
+   * Sets the time of the current iteration when the benchmark uses manual
+   * timing.  This is used to time work done on other threads.
+   */
+  void SetIterationTime(double seconds);
+
+  /** @return The argument at the given index. */
+  int64_t range(size_t index = 0) const;
+  /** @return The number of iterations run so far. */
+  uint64_t iterations() const {
+    return iterations_;
+  }
+
+  /** Reports the number of items processed to give an items/s rate. */
+  void SetItemsProcessed(int64_t items) {
+    items_processed_ = items;
+  }
+  /** Reports the number of bytes processed to give a bytes/s rate. */
+  void SetBytesProcessed(int64_t bytes) {
+    bytes_processed_ = bytes;
+  }
+  /** Sets a label that is printed with the results. */
+  void SetLabel(const std::string& label) {
+    label_ = label;
+  }
+  /** Stops running the benchmark and reports the given error. */
+  void SkipWithError(const std::string& error);
+
+  /** Extra values to report with the results. */
+  std::map<std::string, double> counters;
+
+ private:
+  friend class Runner;
+
+  using Clock = std::chrono::steady_clock;
+
+  const uint64_t max_iterations_;
+  const std::vector<int64_t> args_;
+  uint64_t iterations_;
+  bool started_;
+  bool running_;
+  Clock::time_point real_start_;
+  std::clock_t cpu_start_;
+  double real_seconds_;
+  double cpu_seconds_;
+  double manual_seconds_;
+  int64_t items_processed_;
+  int64_t bytes_processed_;
+  std::string label_;
+  std::string error_;
+};
+
+enum class TimeUnit {
+  Nanosecond,
+  Microsecond,
+  Millisecond,
+};
+
+/** A registered benchmark function and the arguments to run it with. */
+class Benchmark final {
+ public:
+  using Function = std::function<void(State&)>;
+
+  Benchmark(const std::string& name, Function function);
+  ~Benchmark();
+
+  NON_COPYABLE_OR_MOVABLE_TYPE(Benchmark);
+
+  /** Runs the benchmark with the given argument; can be called many times. */
+  Benchmark* Arg(int64_t arg);
+  /** Runs the benchmark with the given set of arguments. */
+  Benchmark* Args(const std::vector<int64_t>& args);
+  /** Runs exactly the given number of iterations. */
+  Benchmark* Iterations(uint64_t iterations);
+  /** Uses the times given to SetIterationTime instead of the real time. */
+  Benchmark* UseManualTime();
+  /** Sets the unit the times are reported in. */
+  Benchmark* Unit(TimeUnit unit);
+
+ private:
+  friend class Runner;
+
+  const std::string name_;
+  const Function function_;
+  std::vector<std::vector<int64_t>> args_;
+  uint64_t iterations_;
+  bool use_manual_time_;
+  TimeUnit unit_;
+};
+
+/**
+ * Registers a new benchmark; the returned object is never freed.  This can be
+ * used directly to register benchmarks from a table of cases.
+ */
+Benchmark* RegisterBenchmark(const std::string& name, Benchmark::Function fn);
+
+/**
+ * Runs all the benchmarks whose name matches the given regex.  This prints the
+ * results to stdout in the given format ("console" or "json").  If |out_file|
+ * isn't empty, this also writes the results as JSON to that file.
+ *
+ * @return The process exit code.
+ */
+int RunBenchmarks(const std::string& filter, const std::string& format,
+                  const std::string& out_file, double min_time);
+
+/** Stops the compiler from optimizing away the given value. */
+template <typename T>
+inline void DoNotOptimize(const T& value) {
+  asm volatile("" : : "r,m"(value) : "memory");  // NOLINT
+}
+
+}  // namespace benchmark
+}  // namespace shaka
+
+#define SHAKA_BENCHMARK_CONCAT_(a, b) a##b
+#define SHAKA_BENCHMARK_NAME_(line) \
+  SHAKA_BENCHMARK_CONCAT_(benchmark_registration_, line)
+
+/** Registers the given function as a benchmark. */
+#define BENCHMARK(fn)                                       \
+  __attribute__((unused)) static ::shaka::benchmark::Benchmark* \
+      SHAKA_BENCHMARK_NAME_(__LINE__) =                         \
+          ::shaka::benchmark::RegisterBenchmark(#fn, &fn)
+
+#endif  // SHAKA_EMBEDDED_TEST_TEST_BENCHMARK_H_
@@ -56,7 +56,16 @@ class CallbackHolder : public BackingObject {
 
 class TestImpl : public testing::Test {
  public:
-  TestImpl(RefPtr<CallbackHolder> callback) : callback_(callback) {}
+  // This is created on the event thread, but is run and destroyed on the
+  // gtest thread.  Workers create more managers, so that thread needs to bind
+  // this manager before using it.
+  TestImpl(RefPtr<CallbackHolder> callback)
+      : manager_(JsManagerImpl::Instance()), callback_(callback) {}
+
+  ~TestImpl() override {
+    JsManagerImpl::ThreadScope scope(manager_);
+    callback_.reset();
+  }
 
   void TestBody() override {
     std::promise<void> test_done;
@@ -90,8 +99,8 @@ class TestImpl : public testing::Test {
                      test_done.set_value();
                    });
     };
-    JsManagerImpl::Instance()->MainThread()->AddInternalTask(
-        TaskPriority::Immediate, "", PlainCallbackTask(task));
+    manager_->MainThread()->AddInternalTask(TaskPriority::Immediate, "",
+                                            PlainCallbackTask(task));
     test_done.get_future().get();
   }
 
@@ -105,6 +114,7 @@ class TestImpl : public testing::Test {
     return ConvertToString(except);
   }
 
+  JsManagerImpl* const manager_;
   RefPtr<CallbackHolder> callback_;
 };
 
@@ -0,0 +1,99 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/util/atomic_histogram.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+namespace shaka {
+namespace util {
+
+TEST(AtomicHistogramTest, StartsEmpty) {
+  AtomicHistogram histogram;
+  LatencyHistogram copy;
+  histogram.CopyTo(&copy);
+  EXPECT_EQ(0u, copy.count);
+  EXPECT_EQ(0u, copy.total_us);
+  EXPECT_EQ(0u, copy.max_us);
+  EXPECT_EQ(0, copy.MeanMs());
+  EXPECT_EQ(0, copy.PercentileMs(50));
+}
+
+TEST(AtomicHistogramTest, UsesPowerOfTwoBuckets) {
+  AtomicHistogram histogram;
+  histogram.Record(0);
+  histogram.Record(1);
+  histogram.Record(2);
+  histogram.Record(3);
+  histogram.Record(1000);
+  histogram.Record(uint64_t{1} << 40);
+
+  LatencyHistogram copy;
+  histogram.CopyTo(&copy);
+  EXPECT_EQ(6u, copy.count);
+  EXPECT_EQ(uint64_t{1} << 40, copy.max_us);
+  EXPECT_EQ(1u, copy.buckets[0]);
+  EXPECT_EQ(1u, copy.buckets[1]);
+  EXPECT_EQ(2u, copy.buckets[2]);
+  // 512 <= 1000 < 1024
+  EXPECT_EQ(1u, copy.buckets[10]);
+  // Large values are put in the last bucket.
+  EXPECT_EQ(1u, copy.buckets[LatencyHistogram::kBucketCount - 1]);
+}
+
+TEST(AtomicHistogramTest, CalculatesPercentiles) {
+  AtomicHistogram histogram;
+  for (int i = 0; i < 90; i++)
+    histogram.Record(100);
+  for (int i = 0; i < 10; i++)
+    histogram.Record(5000);
+
+  LatencyHistogram copy;
+  histogram.CopyTo(&copy);
+  EXPECT_DOUBLE_EQ(0.59, copy.MeanMs());
+  // 100us is in the [64, 128) bucket.
+  EXPECT_DOUBLE_EQ(0.128, copy.PercentileMs(50));
+  EXPECT_DOUBLE_EQ(0.128, copy.PercentileMs(90));
+  // The upper bound of the [4096, 8192) bucket is limited by the max.
+  EXPECT_DOUBLE_EQ(5, copy.PercentileMs(99));
+  EXPECT_DOUBLE_EQ(5, copy.PercentileMs(100));
+}
+
+TEST(AtomicHistogramTest, CanRecordFromMultipleThreads) {
+  constexpr const int kThreadCount = 4;
+  constexpr const int kSampleCount = 10000;
+  AtomicHistogram histogram;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreadCount; i++) {
+    threads.emplace_back([&histogram, i]() {
+      for (int j = 0; j < kSampleCount; j++)
+        histogram.Record(i + 1);
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+
+  LatencyHistogram copy;
+  histogram.CopyTo(&copy);
+  EXPECT_EQ(static_cast<uint64_t>(kThreadCount * kSampleCount), copy.count);
+  EXPECT_EQ(static_cast<uint64_t>(kSampleCount * (1 + 2 + 3 + 4)),
+            copy.total_us);
+  EXPECT_EQ(static_cast<uint64_t>(kThreadCount), copy.max_us);
+}
+
+}  // namespace util
+}  // namespace shaka
@@ -0,0 +1,76 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/util/base64.h"
+
+#include <string>
+#include <vector>
+
+#include "src/test/benchmark.h"
+
+namespace shaka {
+namespace util {
+
+namespace {
+
+std::vector<uint8_t> MakeData(size_t size) {
+  std::vector<uint8_t> ret(size);
+  uint32_t value = 1;
+  for (uint8_t& byte : ret) {
+    value = value * 1103515245 + 12345;
+    byte = static_cast<uint8_t>(value >> 16);
+  }
+  return ret;
+}
+
+void BM_Base64Encode(benchmark::State& state) {
+  const std::vector<uint8_t> data = MakeData(state.range(0));
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(Base64Encode(data.data(), data.size()));
+  }
+  state.SetBytesProcessed(state.iterations() * data.size());
+}
+BENCHMARK(BM_Base64Encode)->Arg(1 << 10)->Arg(64 << 10)->Arg(1 << 20);
+
+void BM_Base64Decode(benchmark::State& state) {
+  // Bytes processed are counted as the decoded size so the rates match the
+  // encode benchmark.
+  const std::vector<uint8_t> data = MakeData(state.range(0));
+  const std::string encoded = Base64Encode(data.data(), data.size());
+  std::vector<uint8_t> result;
+  while (state.KeepRunning()) {
+    if (!Base64Decode(encoded.data(), encoded.size(), &result)) {
+      state.SkipWithError("Error decoding");
+      break;
+    }
+    benchmark::DoNotOptimize(result);
+  }
+  state.SetBytesProcessed(state.iterations() * data.size());
+}
+BENCHMARK(BM_Base64Decode)->Arg(1 << 10)->Arg(64 << 10)->Arg(1 << 20);
+
+void BM_Base64EncodeUrl(benchmark::State& state) {
+  // ClearKey encodes 16-byte key IDs.
+  const std::vector<uint8_t> data = MakeData(state.range(0));
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(Base64EncodeUrl(data.data(), data.size()));
+  }
+  state.SetBytesProcessed(state.iterations() * data.size());
+}
+BENCHMARK(BM_Base64EncodeUrl)->Arg(16)->Arg(1 << 10);
+
+}  // namespace
+
+}  // namespace util
+}  // namespace shaka
@@ -0,0 +1,164 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/util/base64.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+namespace shaka {
+namespace util {
+
+namespace {
+
+constexpr const char kCodes[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/** A simple bit-at-a-time encoder to compare against. */
+std::string ReferenceEncode(const std::vector<uint8_t>& data) {
+  std::string ret;
+  uint32_t bits = 0;
+  int bit_count = 0;
+  for (uint8_t byte : data) {
+    bits = (bits << 8) | byte;
+    bit_count += 8;
+    while (bit_count >= 6) {
+      bit_count -= 6;
+      ret.push_back(kCodes[(bits >> bit_count) & 0x3f]);
+    }
+  }
+  if (bit_count > 0)
+    ret.push_back(kCodes[(bits << (6 - bit_count)) & 0x3f]);
+  while (ret.size() % 4 != 0)
+    ret.push_back('=');
+  return ret;
+}
+
+std::string ToUrl(std::string str) {
+  for (char& c : str) {
+    if (c == '+')
+      c = '-';
+    else if (c == '/')
+      c = '_';
+  }
+  return str.substr(0, str.find('='));
+}
+
+std::vector<uint8_t> RandomData(size_t size, std::mt19937* random) {
+  std::vector<uint8_t> ret(size);
+  for (uint8_t& byte : ret)
+    byte = static_cast<uint8_t>((*random)());
+  return ret;
+}
+
+std::string Encode(const std::string& str) {
+  return Base64Encode(reinterpret_cast<const uint8_t*>(str.data()),
+                      str.size());
+}
+
+bool Decode(const std::string& str, std::string* result) {
+  std::vector<uint8_t> bytes;
+  if (!Base64Decode(str.data(), str.size(), &bytes))
+    return false;
+  result->assign(bytes.begin(), bytes.end());
+  return true;
+}
+
+}  // namespace
+
+TEST(Base64Test, Encodes) {
+  EXPECT_EQ("", Encode(""));
+  EXPECT_EQ("QSBjYXQu", Encode("A cat."));
+  EXPECT_EQ("WFk=", Encode("XY"));
+  EXPECT_EQ("WA==", Encode("X"));
+  EXPECT_EQ("AAECA1VW+v//",
+            Encode(std::string("\x00\x01\x02\x03\x55\x56\xfa\xff\xff", 9)));
+}
+
+TEST(Base64Test, EncodesUrl) {
+  const std::vector<uint8_t> data = {0x00, 0x01, 0x02, 0x03, 0x55,
+                                     0x56, 0xfa, 0xff, 0xff, 0x01};
+  EXPECT_EQ("AAECA1VW-v__AQ", Base64EncodeUrl(data.data(), data.size()));
+  EXPECT_EQ("AAECA1VW-v__", Base64EncodeUrl(data.data(), 9));
+  EXPECT_EQ("", Base64EncodeUrl(data.data(), 0));
+}
+
+TEST(Base64Test, Decodes) {
+  std::string result;
+  ASSERT_TRUE(Decode("", &result));
+  EXPECT_EQ("", result);
+  ASSERT_TRUE(Decode("QSBjYXQu", &result));
+  EXPECT_EQ("A cat.", result);
+  ASSERT_TRUE(Decode("WFk=", &result));
+  EXPECT_EQ("XY", result);
+  ASSERT_TRUE(Decode("WA==", &result));
+  EXPECT_EQ("X", result);
+  ASSERT_TRUE(Decode("WA", &result));
+  EXPECT_EQ("X", result);
+  ASSERT_TRUE(Decode("AAECA1VW+v//", &result));
+  EXPECT_EQ(std::string("\x00\x01\x02\x03\x55\x56\xfa\xff\xff", 9), result);
+}
+
+TEST(Base64Test, RejectsBadInput) {
+  std::string result;
+  EXPECT_FALSE(Decode(std::string("\x00\xff", 2), &result));
+  EXPECT_FALSE(Decode("AA=AA", &result));
+  EXPECT_FALSE(Decode("A", &result));
+  EXPECT_FALSE(Decode("AAAAA", &result));
+  EXPECT_FALSE(Decode("AA-_", &result));
+
+  // Check each position of inputs long enough to use the vectorized code.
+  const std::string valid(256, 'A');
+  for (size_t i = 0; i < valid.size(); i++) {
+    for (char bad : {'\0', '-', '.', ' ', '\x80', '\xff'}) {
+      std::string input = valid;
+      input[i] = bad;
+      EXPECT_FALSE(Decode(input, &result)) << "at " << i;
+    }
+  }
+}
+
+TEST(Base64Test, DecodeUrlAcceptsBothAlphabets) {
+  const std::string input = "AAECA1VW-v__AQ+/";
+  std::vector<uint8_t> result;
+  ASSERT_TRUE(Base64DecodeUrl(input.data(), input.size(), &result));
+  EXPECT_EQ(std::vector<uint8_t>({0x00, 0x01, 0x02, 0x03, 0x55, 0x56, 0xfa,
+                                  0xff, 0xff, 0x01, 0x0f, 0xbf}),
+            result);
+}
+
+TEST(Base64Test, MatchesReferenceForAllSizes) {
+  std::mt19937 random(1234);
+  for (size_t size = 0; size < 300; size++) {
+    const std::vector<uint8_t> data = RandomData(size, &random);
+    const std::string expected = ReferenceEncode(data);
+    ASSERT_EQ(expected, Base64Encode(data.data(), data.size()))
+        << "size " << size;
+    ASSERT_EQ(ToUrl(expected), Base64EncodeUrl(data.data(), data.size()))
+        << "size " << size;
+
+    std::vector<uint8_t> decoded;
+    ASSERT_TRUE(Base64Decode(expected.data(), expected.size(), &decoded));
+    EXPECT_EQ(data, decoded) << "size " << size;
+    const std::string url = ToUrl(expected);
+    ASSERT_TRUE(Base64DecodeUrl(url.data(), url.size(), &decoded));
+    EXPECT_EQ(data, decoded) << "size " << size;
+  }
+}
+
+}  // namespace util
+}  // namespace shaka
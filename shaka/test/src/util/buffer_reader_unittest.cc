@@ -86,6 +86,18 @@ TEST(BufferReaderTest, ReadInteger_LittleEndian) {
   EXPECT_EQ(0x08070605u, reader.ReadUint32(kLittleEndian));
 }
 
+TEST(BufferReaderTest, ReadInteger_OtherSizes) {
+  const uint8_t buffer[] = {0x1, 0x2, 0x3, 0x4, 0x5, 0x6, 0x7, 0x8,
+                            0x9, 0xa, 0xb, 0xc, 0xd, 0xe, 0xf, 0x10};
+  BufferReader reader(buffer, sizeof(buffer));
+
+  EXPECT_EQ(0x0102u, reader.ReadUint16());
+  EXPECT_EQ(0x0403u, reader.ReadUint16(kLittleEndian));
+  EXPECT_EQ(0x05060708090a0b0cull, reader.ReadUint64());
+  EXPECT_EQ(0x0du, reader.ReadUint8());
+  EXPECT_EQ(buffer + 13, reader.data());
+}
+
 TEST(BufferReaderTest, ReadInteger_NotEnoughDataBigEndian) {
   const uint8_t buffer[] = {0x1, 0x2};
   BufferReader reader(buffer, sizeof(buffer));
@@ -0,0 +1,96 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/util/double_buffer.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace shaka {
+namespace util {
+
+namespace {
+
+/** A value that is only consistent if it wasn't torn while copying. */
+struct Value {
+  uint64_t first;
+  uint64_t values[16];
+  uint64_t last;
+};
+
+Value MakeValue(uint64_t i) {
+  Value ret;
+  ret.first = i;
+  for (auto& value : ret.values)
+    value = i;
+  ret.last = i;
+  return ret;
+}
+
+}  // namespace
+
+TEST(DoubleBufferTest, StoresValues) {
+  DoubleBuffer<int> buffer(1);
+  EXPECT_EQ(1, buffer.Load());
+
+  buffer.Store(2);
+  EXPECT_EQ(2, buffer.Load());
+  buffer.Store(3);
+  buffer.Store(4);
+  EXPECT_EQ(4, buffer.Load());
+}
+
+TEST(DoubleBufferTest, DefaultConstructs) {
+  DoubleBuffer<int> buffer;
+  EXPECT_EQ(0, buffer.Load());
+}
+
+TEST(DoubleBufferTest, ReadsConsistentValuesWhileWriting) {
+  DoubleBuffer<Value> buffer(MakeValue(0));
+  std::atomic<bool> done{false};
+  std::atomic<bool> torn{false};
+
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 4; i++) {
+    readers.emplace_back([&]() {
+      uint64_t previous = 0;
+      while (!done) {
+        const Value value = buffer.Load();
+        for (uint64_t item : value.values) {
+          if (item != value.first)
+            torn = true;
+        }
+        // Values are written in order, so readers should never go back.
+        if (value.last != value.first || value.first < previous)
+          torn = true;
+        previous = value.first;
+      }
+    });
+  }
+
+  for (uint64_t i = 1; i < 100000; i++)
+    buffer.Store(MakeValue(i));
+  done = true;
+  for (auto& reader : readers)
+    reader.join();
+
+  EXPECT_FALSE(torn);
+  EXPECT_EQ(99999u, buffer.Load().first);
+}
+
+}  // namespace util
+}  // namespace shaka
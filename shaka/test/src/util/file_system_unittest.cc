@@ -129,6 +129,29 @@ TEST_F(FileSystemTest, ReadAndWrite) {
   EXPECT_EQ(expected_data, file_data);
 }
 
+TEST_F(FileSystemTest, MapFile) {
+  const std::string path = FileSystem::PathJoin(temp_dir, "file");
+  Touch(path);
+
+  std::shared_ptr<MappedFile> file;
+  ASSERT_FALSE(fs.MapFile(non_exist, &file));
+
+  ASSERT_TRUE(fs.MapFile(path, &file));
+  EXPECT_EQ(0u, file->size());
+
+  const std::vector<uint8_t> expected_data = {0x01, 0x02, 0x03, 0x04};
+  ASSERT_TRUE(fs.WriteFile(path, expected_data));
+  ASSERT_TRUE(fs.MapFile(path, &file));
+  ASSERT_EQ(expected_data.size(), file->size());
+  EXPECT_EQ(expected_data,
+            std::vector<uint8_t>(file->data(), file->data() + file->size()));
+
+  // The mapping should still be valid after the file is deleted.
+  ASSERT_TRUE(fs.DeleteFile(path));
+  EXPECT_EQ(expected_data,
+            std::vector<uint8_t>(file->data(), file->data() + file->size()));
+}
+
 TEST_F(FileSystemTest, FileSize) {
   const std::string path = FileSystem::PathJoin(temp_dir, "file");
   Touch(path);
@@ -153,6 +176,40 @@ TEST_F(FileSystemTest, Delete) {
   ASSERT_FALSE(fs.DeleteFile(path));
 }
 
+TEST_F(FileSystemTest, Rename) {
+  const std::string path = FileSystem::PathJoin(temp_dir, "file");
+  const std::vector<uint8_t> data = {0x01, 0x02, 0x03, 0x04};
+  ASSERT_TRUE(fs.WriteFile(path, data));
+
+  // Renaming should replace the existing file.
+  ASSERT_TRUE(fs.RenameFile(path, existing_file));
+  EXPECT_FALSE(fs.FileExists(path));
+  std::vector<uint8_t> file_data;
+  ASSERT_TRUE(fs.ReadFile(existing_file, &file_data));
+  EXPECT_EQ(data, file_data);
+
+  ASSERT_FALSE(fs.RenameFile(non_exist, path));
+}
+
+TEST_F(FileSystemTest, Link) {
+  const std::string path = FileSystem::PathJoin(temp_dir, "file");
+  const std::vector<uint8_t> data = {0x01, 0x02, 0x03, 0x04};
+  ASSERT_TRUE(fs.WriteFile(path, data));
+
+  const std::string link_path = FileSystem::PathJoin(temp_dir, "link");
+  ASSERT_TRUE(fs.LinkFile(path, link_path));
+  std::vector<uint8_t> file_data;
+  ASSERT_TRUE(fs.ReadFile(link_path, &file_data));
+  EXPECT_EQ(data, file_data);
+
+  // Linking shouldn't replace an existing file.
+  ASSERT_FALSE(fs.LinkFile(path, existing_file));
+  ASSERT_TRUE(fs.ReadFile(existing_file, &file_data));
+  EXPECT_NE(data, file_data);
+
+  ASSERT_FALSE(fs.LinkFile(non_exist, FileSystem::PathJoin(temp_dir, "x")));
+}
+
 TEST_F(FileSystemTest, CreateDirectory) {
   const std::string first_path = FileSystem::PathJoin(temp_dir, "dir");
 
@@ -0,0 +1,90 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/util/pseudo_singleton.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+namespace shaka {
+
+namespace {
+
+class Foo : public PseudoSingleton<Foo> {};
+
+}  // namespace
+
+TEST(PseudoSingletonTest, ReturnsOnlyInstance) {
+  EXPECT_EQ(nullptr, Foo::InstanceOrNull());
+  {
+    Foo foo;
+    EXPECT_EQ(&foo, Foo::Instance());
+
+    std::thread thread([&]() { EXPECT_EQ(&foo, Foo::InstanceOrNull()); });
+    thread.join();
+  }
+  EXPECT_EQ(nullptr, Foo::InstanceOrNull());
+}
+
+TEST(PseudoSingletonTest, NoDefaultWithSeveralInstances) {
+  Foo first;
+  {
+    Foo second;
+    EXPECT_EQ(nullptr, Foo::InstanceOrNull());
+  }
+  // Once only one is left, it is used again.
+  EXPECT_EQ(&first, Foo::InstanceOrNull());
+}
+
+TEST(PseudoSingletonTest, UsesThreadInstance) {
+  Foo first;
+  Foo second;
+  {
+    Foo::ScopedThreadInstance bind_first(&first);
+    EXPECT_EQ(&first, Foo::Instance());
+    EXPECT_EQ(&first, Foo::ThreadInstanceOrNull());
+    {
+      Foo::ScopedThreadInstance bind_second(&second);
+      EXPECT_EQ(&second, Foo::Instance());
+    }
+    EXPECT_EQ(&first, Foo::Instance());
+
+    // Bindings only apply to the thread that made them.
+    std::thread thread([&]() {
+      EXPECT_EQ(nullptr, Foo::ThreadInstanceOrNull());
+      EXPECT_EQ(nullptr, Foo::InstanceOrNull());
+
+      Foo::ScopedThreadInstance bind_second(&second);
+      EXPECT_EQ(&second, Foo::Instance());
+    });
+    thread.join();
+    EXPECT_EQ(&first, Foo::Instance());
+  }
+  EXPECT_EQ(nullptr, Foo::InstanceOrNull());
+}
+
+TEST(PseudoSingletonTest, UnsetForTesting) {
+  Foo foo;
+  {
+    Foo::UnsetForTesting unset;
+    EXPECT_EQ(nullptr, Foo::InstanceOrNull());
+
+    Foo other;
+    EXPECT_EQ(&other, Foo::Instance());
+  }
+  EXPECT_EQ(&foo, Foo::Instance());
+}
+
+}  // namespace shaka
@@ -215,6 +215,60 @@ testGroup('EME', function() {
       expectEq(obj.kids, [keyIdBase64, keyId2Base64]);
     });
 
+    test('PersistentLicenseFlow', async function() {
+      let config = emptyConfig();
+      config.persistentState = 'required';
+      config.sessionTypes = ['persistent-license'];
+      let access = await navigator.requestMediaKeySystemAccess(
+          testKeySystem, [config]);
+      let mediaKeys = await access.createMediaKeys();
+
+      let session = mediaKeys.createSession('persistent-license');
+      let onMessage = jasmine.createSpy('onmessage');
+      session.onmessage = onMessage;
+      const initData = makeBuffer('{"kids":["' + keyIdBase64 + '"]}');
+      await session.generateRequest('keyids', initData);
+
+      expectToHaveBeenCalledTimes(onMessage, 1);
+      let requestObj =
+          JSON.parse(makeString(onMessage.calls.argsFor(0)[0].message));
+      expectEq(requestObj.type, 'persistent-license');
+
+      let responseObj = {
+        keys: [{kty: 'oct', k: keyBase64, kid: keyIdBase64}],
+        type: 'persistent-license',
+      };
+      await session.update(makeBuffer(JSON.stringify(responseObj)));
+      const sessionId = session.sessionId;
+      await session.close();
+
+      // The keys should be usable in a new session without a license request.
+      let loaded = mediaKeys.createSession('persistent-license');
+      onMessage = jasmine.createSpy('onmessage');
+      loaded.onmessage = onMessage;
+      expectTrue(await loaded.load(sessionId));
+      expectNotToHaveBeenCalled(onMessage);
+      let callback = jasmine.createSpy('forEach').and.callFake((status, id) => {
+        expectEq(makeString(id), makeString(keyId));
+        expectEq(status, 'usable');
+      });
+      loaded.keyStatuses.forEach(callback);
+      expectToHaveBeenCalledTimes(callback, 1);
+
+      // Removing sends a release message; the license is deleted once the
+      // release is acknowledged.
+      await loaded.remove();
+      expectToHaveBeenCalledTimes(onMessage, 1);
+      let msgEvent = onMessage.calls.argsFor(0)[0];
+      expectEq(msgEvent.messageType, 'license-release');
+      expectEq(JSON.parse(makeString(msgEvent.message)).kids, [keyIdBase64]);
+      await loaded.update(msgEvent.message);
+      await loaded.close();
+
+      let other = mediaKeys.createSession('persistent-license');
+      expectFalse(await other.load(sessionId));
+    });
+
     /**
      * @param {string} data
      * @return {!ArrayBuffer}
@@ -68,6 +68,26 @@ describe('events', function() {
     expect(extra_listener).toHaveBeenCalled();
   });
 
+  it('matches built-in and custom event types', function() {
+    var progress_listener = jasmine.createSpy('progress');
+    var custom_listener = jasmine.createSpy('custom');
+    event_target.addEventListener('progress', progress_listener);
+    event_target.addEventListener('progress_custom', custom_listener);
+
+    event_target.dispatchEvent(new ProgressEvent('progress'));
+
+    expect(progress_listener).toHaveBeenCalled();
+    expect(custom_listener).not.toHaveBeenCalled();
+    expect(add_listener).not.toHaveBeenCalled();
+
+    progress_listener.calls.reset();
+
+    event_target.dispatchEvent(new Event('progress_custom'));
+
+    expect(progress_listener).not.toHaveBeenCalled();
+    expect(custom_listener).toHaveBeenCalled();
+  });
+
   it('won\'t dispatch to on- listener when field is cleared', function() {
     event_target.onerror = null;
 
@@ -0,0 +1,27 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+testGroup('Player', function() {
+  // When built with v8_player_snapshot, the library comes from the V8 startup
+  // snapshot instead of being run when the JsManager starts.
+  test('ConstructsPlayer', async function() {
+    expectEq(typeof shaka.Player, 'function');
+
+    const video = document.createElement('video');
+    const player = new shaka.Player(video);
+    expectInstanceOf(player, shaka.Player);
+    expectSame(player.getMediaElement(), video);
+    await player.destroy();
+  });
+});
@@ -0,0 +1,133 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+testGroup('Worker', function() {
+  /**
+   * Posts the given message to a new echo worker and resolves with the data of
+   * the reply.
+   *
+   * @param {*} message
+   * @param {!Array=} transfer
+   * @return {!Promise}
+   */
+  function echo(message, transfer) {
+    return new Promise((resolve, reject) => {
+      const worker = new Worker('echo_worker.js');
+      worker.onmessage = (event) => {
+        worker.terminate();
+        resolve(event.data);
+      };
+      worker.onerror = reject;
+      worker.postMessage(message, transfer);
+    });
+  }
+
+  test('ClonesPrimitives', async function() {
+    expectSame(await echo(12), 12);
+    expectSame(await echo('foo'), 'foo');
+    expectSame(await echo(true), true);
+    expectSame(await echo(null), null);
+  });
+
+  test('ClonesObjects', async function() {
+    const message = {
+      number: 1,
+      string: 'bar',
+      array: [1, 'a', {nested: null}],
+      bytes: new Uint8Array([1, 2, 3]),
+    };
+    const reply = await echo(message);
+    expectEq(reply, message);
+    expectInstanceOf(reply.bytes, Uint8Array);
+  });
+
+  test('TransfersArrayBuffers', async function() {
+    const buffer = new Uint8Array([4, 5, 6]).buffer;
+    const reply = echo(buffer, [buffer]);
+    // The buffer is detached when it is posted.
+    expectEq(buffer.byteLength, 0);
+
+    expectInstanceOf(await reply, ArrayBuffer);
+    expectEq(new Uint8Array(await reply), new Uint8Array([4, 5, 6]));
+  });
+
+  test('ExposesOnMessageOnTheGlobal', async function() {
+    expectSame(await echo('onmessage'), true);
+  });
+
+  test('ThrowsForValuesThatCantBeCloned', function() {
+    const worker = new Worker('echo_worker.js');
+    expectToThrow(() => worker.postMessage({callback: () => {}}));
+
+    const cyclic = {};
+    cyclic.self = cyclic;
+    expectToThrow(() => worker.postMessage(cyclic));
+
+    // Only ArrayBuffers can be transferred.
+    expectToThrow(() => worker.postMessage(1, [new Uint8Array(1)]));
+    worker.terminate();
+  });
+
+  test('RunsRequestsInSeveralManagers', async function() {
+    // Each worker has its own JsManager, but they share the network thread.
+    // Nothing listens on this port, so the requests fail quickly; each failure
+    // needs to be delivered to the manager that made the request.
+    const url = 'http://127.0.0.1:1/';
+
+    const request = () => new Promise((resolve) => {
+      const xhr = new XMLHttpRequest();
+      xhr.onload = xhr.onerror = xhr.ontimeout = xhr.onabort = (e) => {
+        resolve(e.type);
+      };
+      xhr.open('GET', url);
+      xhr.send();
+    });
+    const requestInWorker = () => new Promise((resolve, reject) => {
+      const worker = new Worker('xhr_worker.js');
+      worker.onmessage = (event) => {
+        worker.terminate();
+        resolve(event.data);
+      };
+      worker.onerror = reject;
+      worker.postMessage(url);
+    });
+
+    const results =
+        await Promise.all([request(), requestInWorker(), requestInWorker()]);
+    expectEq(results, ['error', 'error', 'error']);
+  });
+
+  test('RaisesErrorForMissingScript', async function() {
+    return new Promise((resolve) => {
+      const worker = new Worker('does_not_exist.js');
+      worker.onerror = () => {
+        worker.terminate();
+        resolve();
+      };
+    });
+  });
+
+  test('ThrowsForMissingImportedScript', async function() {
+    const result = await new Promise((resolve, reject) => {
+      const worker = new Worker('import_worker.js');
+      worker.onmessage = (event) => {
+        worker.terminate();
+        resolve(event.data);
+      };
+      worker.onerror = reject;
+      worker.postMessage('does_not_exist.js');
+    });
+    expectEq(result, 'NetworkError');
+  });
+});
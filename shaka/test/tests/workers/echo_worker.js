@@ -0,0 +1,30 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// The script run by the Worker tests in worker.js.  This echoes each message
+// back to the page, transferring any ArrayBuffer it is given.  The message
+// 'onmessage' checks that the global handler is the one on "self".
+
+onmessage = function(event) {
+  const data = event.data;
+  if (data instanceof ArrayBuffer) {
+    postMessage(data, [data]);
+  } else if (data == 'close') {
+    close();
+  } else if (data == 'onmessage') {
+    postMessage(self.onmessage === onmessage);
+  } else {
+    postMessage(data);
+  }
+};
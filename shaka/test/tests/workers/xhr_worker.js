@@ -0,0 +1,25 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// The script run by the Worker tests in worker.js.  This requests each URL it
+// is given and posts back the type of the event that ended the request.
+
+onmessage = function(event) {
+  const xhr = new XMLHttpRequest();
+  xhr.onload = xhr.onerror = xhr.ontimeout = xhr.onabort = function(e) {
+    postMessage(e.type);
+  };
+  xhr.open('GET', event.data);
+  xhr.send();
+};
@@ -87,6 +87,99 @@ testGroup('XML', function() {
     expectEq(fifth.getAttributeNS('https://example.com/bar', 'attr'), null);
   });
 
+  test('GetsElementsByTagName', function() {
+    const text = [
+      '<top xmlns:foo="https://example.com/foo">',
+      '<item id="1"><item id="2" /><other><item id="3" /></other></item>',
+      '<foo:item id="4" />',
+      '<other>text<item id="5" /></other>',
+      '</top>'
+    ].join('');
+
+    let document = new DOMParser().parseFromString(text, 'text/xml');
+    let items = document.getElementsByTagName('item');
+    expectEq(items.length, 4);
+    expectEq(items.map((e) => e.getAttribute('id')), ['1', '2', '3', '5']);
+
+    let prefixed = document.getElementsByTagName('foo:item');
+    expectEq(prefixed.length, 1);
+    expectEq(prefixed[0].getAttribute('id'), '4');
+    expectEq(document.getElementsByTagName('missing').length, 0);
+
+    // The same objects are returned when walking the tree.
+    let root = document.documentElement;
+    expectSame(items[0], root.childNodes[0]);
+    expectSame(items[1], root.childNodes[0].childNodes[0]);
+    expectSame(items[2].parentNode.parentNode, items[0]);
+    expectSame(items[3].parentNode, root.childNodes[2]);
+
+    let nested = items[0].getElementsByTagName('item');
+    expectEq(nested.length, 2);
+    expectSame(nested[0], items[1]);
+    expectSame(nested[1], items[2]);
+  });
+
+  test('SupportsChangingParsedDocuments', function() {
+    const text = '<top><a x="1" y="2">foo<b>bar</b></a><c /></top>';
+
+    let document = new DOMParser().parseFromString(text, 'text/xml');
+    let root = document.documentElement;
+    expectEq(root.textContent, 'foobar');
+
+    let a = root.firstChild;
+    expectEq(a.attributes.length, 2);
+    a.setAttribute('x', '3');
+    a.removeAttribute('y');
+    expectEq(a.getAttribute('x'), '3');
+    expectEq(a.hasAttribute('y'), false);
+    expectEq(a.attributes.length, 1);
+
+    let c = root.lastChild;
+    root.removeChild(c);
+    a.appendChild(c);
+    expectEq(root.childNodes.length, 1);
+    expectEq(a.childNodes.length, 3);
+    expectSame(a.lastChild, c);
+    expectEq(document.getElementsByTagName('c').length, 1);
+
+    a.appendChild(document.createTextNode('baz'));
+    expectEq(root.textContent, 'foobarbaz');
+  });
+
+  test('ParsesAsynchronously', async function() {
+    const text = '<top><item attr="1">foo</item><item attr="2" /></top>';
+
+    let parser = new DOMParser();
+    let promise = parser.parseFromStringAsync(text, 'text/xml');
+    expectInstanceOf(promise, Promise);
+
+    let document = await promise;
+    expectInstanceOf(document, Document);
+    let root = document.documentElement;
+    expectEq(root.tagName, 'top');
+    expectEq(root.textContent, 'foo');
+    let items = root.getElementsByTagName('item');
+    expectEq(items.length, 2);
+    expectEq(items[1].getAttribute('attr'), '2');
+  });
+
+  test('RejectsAsyncParseErrors', async function() {
+    let parser = new DOMParser();
+    try {
+      await parser.parseFromStringAsync('<top><a></top>', 'text/xml');
+      fail('Should reject invalid XML');
+    } catch (error) {
+      expectEq(error.name, 'UnknownError');
+    }
+
+    try {
+      await parser.parseFromStringAsync('<top />', 'text/html');
+      fail('Should reject unsupported types');
+    } catch (error) {
+      expectInstanceOf(error, TypeError);
+    }
+  });
+
   function expectElement(element, tag, localName, prefix, ns) {
     expectInstanceOf(element, Element);
     expectEq(element.tagName, tag);
@@ -0,0 +1,118 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Creates a V8 startup snapshot that has the Shaka Player library already
+// evaluated.  This is run at build time by the "v8_player_snapshot" target and
+// the output is embedded by //shaka/tools/embed_v8_snapshot.py.
+//
+// Usage: create_v8_snapshot <library> <output>
+
+#include <libplatform/libplatform.h>
+#include <v8.h>
+
+#include <stdio.h>
+
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "src/mapping/v8/v8_snapshot.h"
+
+namespace {
+
+bool ReadFile(const char* path, std::string* contents) {
+  std::ifstream file(path, std::ios::in | std::ios::binary);
+  if (!file)
+    return false;
+  std::stringstream stream;
+  stream << file.rdbuf();
+  *contents = stream.str();
+  return true;
+}
+
+bool RunScript(v8::Local<v8::Context> context, const char* path,
+               const std::string& source) {
+  v8::Isolate* isolate = context->GetIsolate();
+  v8::TryCatch try_catch(isolate);
+  v8::ScriptOrigin origin(
+      v8::String::NewFromUtf8(isolate, path, v8::NewStringType::kNormal)
+          .ToLocalChecked());
+  v8::Local<v8::String> code;
+  v8::Local<v8::Script> script;
+  if (!v8::String::NewFromUtf8(isolate, source.c_str(),
+                               v8::NewStringType::kNormal,
+                               static_cast<int>(source.size()))
+           .ToLocal(&code) ||
+      !v8::Script::Compile(context, code, &origin).ToLocal(&script) ||
+      script->Run(context).IsEmpty()) {
+    v8::String::Utf8Value error(try_catch.Exception());
+    fprintf(stderr, "Error evaluating %s: %s\n", path,
+            *error ? *error : "unknown error");
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc != 3) {
+    fprintf(stderr, "Usage: %s <library> <output>\n", argv[0]);
+    return 1;
+  }
+
+  std::string library;
+  if (!ReadFile(argv[1], &library)) {
+    fprintf(stderr, "Unable to read %s\n", argv[1]);
+    return 1;
+  }
+
+  v8::V8::InitializeICU();
+  v8::V8::InitializeExternalStartupData(argv[0]);
+  std::unique_ptr<v8::Platform> platform(v8::platform::CreateDefaultPlatform());
+  v8::V8::InitializePlatform(platform.get());
+  v8::V8::Initialize();
+
+  bool ok;
+  v8::StartupData blob;
+  {
+    v8::SnapshotCreator creator(shaka::GetV8SnapshotExternalReferences());
+    v8::Isolate* isolate = creator.GetIsolate();
+    {
+      v8::HandleScope handles(isolate);
+      v8::Local<v8::Context> context = v8::Context::New(isolate);
+      v8::Context::Scope context_scope(context);
+      shaka::SetupV8SnapshotGlobals(context);
+      ok = RunScript(context, argv[1], library);
+      creator.SetDefaultContext(context);
+    }
+    // Keep the compiled code so it doesn't need to be compiled at startup.
+    blob = creator.CreateBlob(v8::SnapshotCreator::FunctionCodeHandling::kKeep);
+  }
+
+  if (ok) {
+    std::ofstream output(argv[2], std::ios::out | std::ios::binary);
+    output.write(blob.data, blob.raw_size);
+    if (!output) {
+      fprintf(stderr, "Unable to write %s\n", argv[2]);
+      ok = false;
+    }
+  }
+  delete[] blob.data;
+
+  v8::V8::Dispose();
+  v8::V8::ShutdownPlatform();
+  return ok ? 0 : 1;
+}
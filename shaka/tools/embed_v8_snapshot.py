@@ -19,6 +19,11 @@
 This defines the following function
 
 void shaka::SetupV8Snapshots();
+
+By default this embeds the snapshot created by V8.  When using the
+v8_player_snapshot GN argument, the snapshot created by create_v8_snapshot is
+given with --snapshot instead, which has the Shaka Player library already
+evaluated.
 """
 
 import argparse
@@ -36,9 +41,9 @@ def _SetupStartupData(writer, var_name):
                var_name)
 
 
-def _GenerateFile(output):
+def _GenerateFile(output, snapshot_path):
   """Generates a C++ file which embeds the snapshot files."""
-  with open('snapshot_blob.bin', 'rb') as f:
+  with open(snapshot_path, 'rb') as f:
     snapshot_data = f.read()
   with open('natives_blob.bin', 'rb') as f:
     natives_data = f.read()
@@ -74,10 +79,13 @@ def main(args):
   parser = argparse.ArgumentParser(description=__doc__)
   parser.add_argument('--output', dest='output',
                       help='The filename to output to.')
+  parser.add_argument('--snapshot', dest='snapshot',
+                      default='snapshot_blob.bin',
+                      help='The snapshot file to embed.')
 
   ns = parser.parse_args(args)
   with open(ns.output, 'w') as output:
-    _GenerateFile(output)
+    _GenerateFile(output, ns.snapshot)
 
   return 0
 
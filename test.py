@@ -51,6 +51,8 @@ def _RunTests(build_dir, no_colors):
     ]
     if no_colors:
       args += ['--no_colors']
+    if subprocess.call([os.path.join(build_dir, 'struct_tests')]) != 0:
+      return 1
     return subprocess.call([os.path.join(build_dir, 'tests')] + args)
 
 